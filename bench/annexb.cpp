@@ -0,0 +1,149 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Mux and demux an H.264 elementary stream in Annex B format.
+//
+//  Access units of one large slice and an SEI are written with
+//  MP4WriteH264AnnexBSample, every tenth led by the parameter sets that
+//  end up in avcC, then read back with MP4ReadH264AnnexBSample into a
+//  caller supplied buffer. Slice payloads contain no zero bytes so the
+//  start code scan has to look at all of them. The best of several read
+//  passes is reported together with the single write pass.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench/impl.h"
+
+namespace mp4v2 { namespace bench {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    const uint32_t ACCESS_UNITS = 2000;
+    const uint32_t SLICE_SIZE   = 64 * 1024;
+    const uint32_t ITERATIONS   = 5;
+
+    void
+    putNal( vector<uint8_t>& au, uint8_t header, uint32_t size )
+    {
+        static const uint8_t startCode[4] = { 0, 0, 0, 1 };
+        au.insert( au.end(), startCode, startCode + sizeof(startCode) );
+        au.push_back( header );
+        for( uint32_t i = 1; i < size; i++ )
+            au.push_back( uint8_t( 0x10 + i % 0xe0 ));
+    }
+
+    uint64_t
+    mbPerSecond( uint64_t bytes, time::milliseconds_t ms )
+    {
+        return ms > 0 ? bytes * 1000 / uint64_t( ms ) / (1024 * 1024) : 0;
+    }
+
+    uint64_t
+    write( const char* name )
+    {
+        MP4FileHandle file = MP4Create( name );
+        if( file == MP4_INVALID_FILE_HANDLE ) {
+            fprintf( stderr, "unable to create %s\n", name );
+            exit( 1 );
+        }
+
+        MP4TrackId track = MP4AddH264VideoTrack( file, 90000, 3000, 1920, 1080, 100, 0, 40, 3 );
+
+        vector<uint8_t> idr;
+        putNal( idr, 0x67, 24 );
+        putNal( idr, 0x68, 6 );
+        putNal( idr, 0x65, SLICE_SIZE );
+        putNal( idr, 0x06, 32 );
+
+        vector<uint8_t> slice;
+        putNal( slice, 0x41, SLICE_SIZE );
+        putNal( slice, 0x06, 32 );
+
+        uint64_t bytes = 0;
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+
+        for( uint32_t i = 0; i < ACCESS_UNITS; i++ ) {
+            bool isSync = i % 10 == 0;
+            const vector<uint8_t>& au = isSync ? idr : slice;
+            if( !MP4WriteH264AnnexBSample( file, track, &au[0], uint32_t( au.size() ),
+                                           MP4_INVALID_DURATION, 0, isSync )) {
+                fprintf( stderr, "unable to write access unit %u\n", i );
+                exit( 1 );
+            }
+            bytes += au.size();
+        }
+
+        MP4Close( file );
+
+        time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+        printf( "bench=annexb-write access_units=%u bytes=%" PRIu64 " ms=%" PRId64 " mb_per_s=%" PRIu64 "\n",
+                ACCESS_UNITS, bytes, int64_t( elapsed ), mbPerSecond( bytes, elapsed ));
+        return bytes;
+    }
+
+    void
+    read( const char* name )
+    {
+        MP4FileHandle file = MP4Read( name );
+        if( file == MP4_INVALID_FILE_HANDLE ) {
+            fprintf( stderr, "unable to read %s\n", name );
+            exit( 1 );
+        }
+
+        MP4TrackId track = MP4FindTrackId( file, 0 );
+        MP4SampleId numSamples = MP4GetTrackNumberOfSamples( file, track );
+
+        vector<uint8_t> buf( SLICE_SIZE + 1024 );
+        uint64_t bytes = 0;
+        time::milliseconds_t best = 0;
+
+        for( uint32_t i = 0; i < ITERATIONS; i++ ) {
+            bytes = 0;
+            time::milliseconds_t start = time::getLocalTimeMilliseconds();
+
+            for( MP4SampleId sid = 1; sid <= numSamples; sid++ ) {
+                uint8_t* pBytes = &buf[0];
+                uint32_t numBytes = uint32_t( buf.size() );
+                if( !MP4ReadH264AnnexBSample( file, track, sid, &pBytes, &numBytes ))
+                    exit( 1 );
+                bytes += numBytes;
+            }
+
+            time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+            if( i == 0 || elapsed < best )
+                best = elapsed;
+        }
+
+        MP4Close( file );
+
+        printf( "bench=annexb-read access_units=%u bytes=%" PRIu64 " ms=%" PRId64 " mb_per_s=%" PRIu64 "\n",
+                numSamples, bytes, int64_t( best ), mbPerSecond( bytes, best ));
+    }
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+int
+run( int argc, char** argv )
+{
+    const char* name = argc > 1 ? argv[1] : "bench_annexb.mp4";
+
+    write( name );
+    read( name );
+
+    if( argc <= 1 )
+        remove( name );
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::bench
+
+///////////////////////////////////////////////////////////////////////////////
+
+extern "C"
+int main( int argc, char** argv )
+{
+    return mp4v2::bench::run( argc, argv );
+}
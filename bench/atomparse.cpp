@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Parse a file made of a very large number of small atoms.
+//
+//  The file is written byte by byte rather than through the library so the
+//  atom count is exact: a movie header, a user data box with many QTFF
+//  udta elements and a long run of movie fragments, each a moof holding
+//  mfhd, traf, tfhd and trun. Atom construction dominates the cost of
+//  reading such a file. It is read repeatedly with the heap and with the
+//  per-file arena, and one result line is printed for each mode.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench/impl.h"
+
+namespace mp4v2 { namespace bench {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    const uint32_t UDTA_ELEMENTS = 10000;
+    const uint32_t FRAGMENTS     = 18000;
+    const uint32_t ITERATIONS    = 5;
+
+    // one mix of udta element types, known and unknown to the factory
+    const char* const UDTA_TYPES[] = {
+        "\xA9" "nam", "\xA9" "day", "\xA9" "cpy", "\xA9" "inf",
+        "name", "LOOP", "WLOC", "xtra",
+    };
+
+    void
+    putInt( vector<uint8_t>& buf, uint32_t value, uint32_t size = 4 )
+    {
+        while( size-- )
+            buf.push_back( uint8_t( value >> (size * 8) ));
+    }
+
+    // start an atom, returns the offset to patch its size at
+    size_t
+    beginAtom( vector<uint8_t>& buf, const char* type )
+    {
+        size_t start = buf.size();
+        putInt( buf, 0 );
+        buf.insert( buf.end(), type, type + 4 );
+        return start;
+    }
+
+    void
+    endAtom( vector<uint8_t>& buf, size_t start )
+    {
+        uint32_t size = uint32_t( buf.size() - start );
+        for( int i = 0; i < 4; i++ )
+            buf[start + i] = uint8_t( size >> ((3 - i) * 8) );
+    }
+
+    // full atom with version and flags zero followed by count 32-bit fields
+    void
+    putFullAtom( vector<uint8_t>& buf, const char* type, uint32_t count, uint32_t value )
+    {
+        size_t start = beginAtom( buf, type );
+        putInt( buf, 0 );
+        for( uint32_t i = 0; i < count; i++ )
+            putInt( buf, value );
+        endAtom( buf, start );
+    }
+
+    uint32_t
+    generate( const char* name )
+    {
+        vector<uint8_t> buf;
+        uint32_t atoms = 0;
+
+        size_t ftyp = beginAtom( buf, "ftyp" );
+        buf.insert( buf.end(), "isom", "isom" + 4 );
+        putInt( buf, 0 );
+        buf.insert( buf.end(), "isom", "isom" + 4 );
+        endAtom( buf, ftyp );
+        atoms++;
+
+        size_t moov = beginAtom( buf, "moov" );
+        size_t mvhd = beginAtom( buf, "mvhd" );
+        putInt( buf, 0 );           // version, flags
+        putInt( buf, 0 );           // creation time
+        putInt( buf, 0 );           // modification time
+        putInt( buf, 1000 );        // timescale
+        putInt( buf, 0 );           // duration
+        putInt( buf, 0x00010000 );  // rate
+        putInt( buf, 0x0100, 2 );   // volume
+        buf.insert( buf.end(), 10, 0 );
+        static const uint32_t matrix[9] = { 0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000 };
+        for( int i = 0; i < 9; i++ )
+            putInt( buf, matrix[i] );
+        buf.insert( buf.end(), 24, 0 );
+        putInt( buf, 1 );           // next track id
+        endAtom( buf, mvhd );
+
+        size_t udta = beginAtom( buf, "udta" );
+        for( uint32_t i = 0; i < UDTA_ELEMENTS; i++ ) {
+            size_t element = beginAtom( buf, UDTA_TYPES[i % (sizeof(UDTA_TYPES) / sizeof(UDTA_TYPES[0]))] );
+            putInt( buf, i );
+            endAtom( buf, element );
+        }
+        endAtom( buf, udta );
+        endAtom( buf, moov );
+        atoms += 3 + UDTA_ELEMENTS;
+
+        for( uint32_t i = 0; i < FRAGMENTS; i++ ) {
+            size_t moof = beginAtom( buf, "moof" );
+            putFullAtom( buf, "mfhd", 1, i + 1 );
+            size_t traf = beginAtom( buf, "traf" );
+            putFullAtom( buf, "tfhd", 1, 1 );
+            putFullAtom( buf, "trun", 1, 0 );
+            endAtom( buf, traf );
+            endAtom( buf, moof );
+        }
+        atoms += 5 * FRAGMENTS;
+
+        FILE* out = fopen( name, "wb" );
+        if( !out || fwrite( &buf[0], 1, buf.size(), out ) != buf.size() ) {
+            fprintf( stderr, "unable to write %s\n", name );
+            exit( 1 );
+        }
+        fclose( out );
+
+        return atoms;
+    }
+
+    void
+    parse( const char* name, uint32_t atoms, uint32_t flags )
+    {
+        time::milliseconds_t best = 0;
+
+        for( uint32_t i = 0; i < ITERATIONS; i++ ) {
+            time::milliseconds_t start = time::getLocalTimeMilliseconds();
+
+            MP4FileHandle file = MP4ReadEx( name, NULL, flags );
+            if( file == MP4_INVALID_FILE_HANDLE ) {
+                fprintf( stderr, "unable to read %s\n", name );
+                exit( 1 );
+            }
+            MP4Close( file );
+
+            time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+            if( i == 0 || elapsed < best )
+                best = elapsed;
+        }
+
+        printf( "bench=atomparse mode=%s atoms=%u ms=%" PRId64 " atoms_per_sec=%" PRIu64 "\n",
+                flags & MP4_READ_ARENA ? "arena" : "heap", atoms, int64_t( best ),
+                best ? uint64_t( atoms ) * 1000 / uint64_t( best ) : uint64_t( 0 ));
+    }
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+int
+run( int argc, char** argv )
+{
+    const char* name = argc > 1 ? argv[1] : "bench_atomparse.mp4";
+
+    // the udta elements of unknown type are expected, keep the output clean
+    MP4LogSetLevel( MP4_LOG_NONE );
+
+    uint32_t atoms = generate( name );
+    parse( name, atoms, 0 );
+    parse( name, atoms, MP4_READ_ARENA );
+
+    if( argc <= 1 )
+        remove( name );
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::bench
+
+///////////////////////////////////////////////////////////////////////////////
+
+extern "C"
+int main( int argc, char** argv )
+{
+    return mp4v2::bench::run( argc, argv );
+}
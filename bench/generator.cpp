@@ -0,0 +1,355 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Deterministic synthetic file generator shared by the benchmarks.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench/impl.h"
+#include "bench/generator.h"
+
+#if defined( _WIN32 )
+#   include <psapi.h>
+#else
+#   include <sys/resource.h>
+#endif
+
+namespace mp4v2 { namespace bench {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    const uint32_t VIDEO_TIMESCALE = 90000;
+    const uint32_t VIDEO_DURATION  = 3000;
+    const uint32_t AUDIO_TIMESCALE = 48000;
+    const uint32_t AUDIO_DURATION  = 1024;
+    const uint32_t MAX_SAMPLE_SIZE = 20000;
+
+    uint32_t seed = 1;
+
+    uint32_t
+    nextRandom()
+    {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) & 0xffffff;
+    }
+
+    struct Sample {
+        uint32_t    size;
+        MP4Duration duration;
+        MP4Duration renderingOffset;
+        bool        isSync;
+    };
+
+    // the n-th sample of a track, consumes random numbers in a fixed order
+    Sample
+    nextSample( const GeneratorOptions& options, uint32_t track, uint32_t n )
+    {
+        Sample s;
+        if( track == 0 ) {
+            s.isSync = options.syncEvery ? n % options.syncEvery == 0 : true;
+            s.size = s.isSync ? 10000 + nextRandom() % 10000 : 500 + nextRandom() % 3000;
+            s.duration = VIDEO_DURATION;
+            s.renderingOffset = options.cttsEvery && n % options.cttsEvery == 0 ? 2 * VIDEO_DURATION : 0;
+        }
+        else {
+            s.isSync = true;
+            s.size = 200 + nextRandom() % 500;
+            s.duration = AUDIO_DURATION;
+            s.renderingOffset = 0;
+        }
+        return s;
+    }
+
+    void
+    putInt( vector<uint8_t>& buf, uint32_t value )
+    {
+        for( int i = 3; i >= 0; i-- )
+            buf.push_back( uint8_t( value >> (i * 8) ));
+    }
+
+    // start an atom, returns the offset to patch its size at
+    size_t
+    beginAtom( vector<uint8_t>& buf, const char* type )
+    {
+        size_t start = buf.size();
+        putInt( buf, 0 );
+        buf.insert( buf.end(), type, type + 4 );
+        return start;
+    }
+
+    void
+    endAtom( vector<uint8_t>& buf, size_t start )
+    {
+        uint32_t size = uint32_t( buf.size() - start );
+        for( int i = 0; i < 4; i++ )
+            buf[start + i] = uint8_t( size >> ((3 - i) * 8) );
+    }
+
+    // append one moof/mdat pair holding count samples of every track
+    uint64_t
+    writeFragment( FILE* out, const GeneratorOptions& options, const vector<uint8_t>& payload,
+                   const vector<MP4TrackId>& tracks, uint32_t sequence, uint32_t first, uint32_t count )
+    {
+        vector<uint8_t> moof;
+        vector<uint32_t> sizes;
+        vector<size_t> dataOffsets;
+
+        size_t moofStart = beginAtom( moof, "moof" );
+        size_t mfhd = beginAtom( moof, "mfhd" );
+        putInt( moof, 0 );
+        putInt( moof, sequence );
+        endAtom( moof, mfhd );
+
+        for( uint32_t t = 0; t < tracks.size(); t++ ) {
+            size_t traf = beginAtom( moof, "traf" );
+            size_t tfhd = beginAtom( moof, "tfhd" );
+            putInt( moof, 0x020000 );   // default-base-is-moof
+            putInt( moof, tracks[t] );
+            endAtom( moof, tfhd );
+
+            size_t trun = beginAtom( moof, "trun" );
+            putInt( moof, 0x000301 );   // data offset, sample duration and size present
+            putInt( moof, count );
+            dataOffsets.push_back( moof.size() );
+            putInt( moof, 0 );
+            for( uint32_t n = first; n < first + count; n++ ) {
+                Sample s = nextSample( options, t, n );
+                putInt( moof, uint32_t( s.duration ));
+                putInt( moof, s.size );
+                sizes.push_back( s.size );
+            }
+            endAtom( moof, trun );
+            endAtom( moof, traf );
+        }
+        endAtom( moof, moofStart );
+
+        // runs are relative to moof, each track's follows the one before
+        uint64_t bytes = 0;
+        for( size_t i = 0; i < sizes.size(); i++ ) {
+            if( i % count == 0 ) {
+                uint32_t offset = uint32_t( moof.size() + 8 + bytes );
+                for( int b = 0; b < 4; b++ )
+                    moof[dataOffsets[i / count] + b] = uint8_t( offset >> ((3 - b) * 8) );
+            }
+            bytes += sizes[i];
+        }
+
+        size_t mdat = beginAtom( moof, "mdat" );
+        moof[mdat]     = uint8_t( (bytes + 8) >> 24 );
+        moof[mdat + 1] = uint8_t( (bytes + 8) >> 16 );
+        moof[mdat + 2] = uint8_t( (bytes + 8) >> 8 );
+        moof[mdat + 3] = uint8_t( bytes + 8 );
+
+        bool ok = fwrite( &moof[0], 1, moof.size(), out ) == moof.size();
+        for( size_t i = 0; ok && i < sizes.size(); i++ )
+            ok = fwrite( &payload[0], 1, sizes[i], out ) == sizes[i];
+        if( !ok ) {
+            fprintf( stderr, "unable to write fragment\n" );
+            exit( 1 );
+        }
+
+        return bytes;
+    }
+
+    uint64_t
+    readSize( io::File& file, uint64_t offset, char* type )
+    {
+        uint8_t header[16];
+        io::File::Size nin;
+        if( file.seek( offset ) || file.read( header, 8, nin ) || nin != 8 )
+            return 0;
+        memcpy( type, header + 4, 4 );
+        uint64_t size = (uint32_t( header[0] ) << 24) | (header[1] << 16) | (header[2] << 8) | header[3];
+        if( size == 1 ) {
+            if( file.read( header + 8, 8, nin ) || nin != 8 )
+                return 0;
+            size = 0;
+            for( int i = 8; i < 16; i++ )
+                size = (size << 8) | header[i];
+        }
+        return size;
+    }
+
+    // MP4Close() always stamps the movie modification time, clear it afterwards
+    void
+    clearModificationTime( const char* name )
+    {
+        io::File file( name, io::File::MODE_MODIFY );
+        if( file.open() )
+            return;
+
+        char type[4];
+        uint64_t offset = 0;
+        uint64_t size;
+        while( (size = readSize( file, offset, type )) >= 8 && memcmp( type, "moov", 4 ))
+            offset += size;
+        if( size < 8 )
+            return;
+
+        uint64_t end = offset + size;
+        for( offset += 8; offset < end; offset += size ) {
+            size = readSize( file, offset, type );
+            if( size < 8 )
+                return;
+            if( memcmp( type, "mvhd", 4 ))
+                continue;
+
+            uint8_t version;
+            io::File::Size nio;
+            if( file.read( &version, 1, nio ) || nio != 1 )
+                return;
+            uint8_t zero[8] = { 0 };
+            uint32_t width = version == 1 ? 8 : 4;
+            if( !file.seek( offset + 12 + width ))
+                file.write( zero, width, nio );
+            return;
+        }
+    }
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+GeneratorOptions::GeneratorOptions()
+    : tracks        ( 2 )
+    , samples       ( 10000 )
+    , chunkMs       ( 0 )
+    , cttsEvery     ( 3 )
+    , syncEvery     ( 30 )
+    , fragments     ( 0 )
+    , metadataBytes ( 64 * 1024 )
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t
+generate( const char* name, const GeneratorOptions& options )
+{
+    seed = 1;
+
+    MP4FileHandle file = MP4Create( name );
+    if( file == MP4_INVALID_FILE_HANDLE ) {
+        fprintf( stderr, "unable to create %s\n", name );
+        exit( 1 );
+    }
+
+    vector<MP4TrackId> tracks;
+    for( uint32_t t = 0; t < options.tracks; t++ ) {
+        MP4TrackId track;
+        uint32_t timescale;
+        if( t == 0 ) {
+            track = MP4AddVideoTrack( file, VIDEO_TIMESCALE, MP4_INVALID_DURATION, 640, 480 );
+            timescale = VIDEO_TIMESCALE;
+        }
+        else {
+            track = MP4AddAudioTrack( file, AUDIO_TIMESCALE, AUDIO_DURATION );
+            timescale = AUDIO_TIMESCALE;
+        }
+        if( options.chunkMs )
+            MP4SetTrackDurationPerChunk( file, track, MP4Duration( timescale ) * options.chunkMs / 1000 );
+        tracks.push_back( track );
+    }
+
+    vector<uint8_t> payload( MAX_SAMPLE_SIZE );
+    for( size_t i = 0; i < payload.size(); i++ )
+        payload[i] = uint8_t( nextRandom() );
+
+    uint64_t bytes = 0;
+    if( !options.fragments ) {
+        // interleave tracks sample by sample as a muxer would
+        for( uint32_t n = 0; n < options.samples; n++ ) {
+            for( uint32_t t = 0; t < tracks.size(); t++ ) {
+                Sample s = nextSample( options, t, n );
+                if( !MP4WriteSample( file, tracks[t], &payload[0], s.size, s.duration,
+                                     s.renderingOffset, s.isSync )) {
+                    fprintf( stderr, "unable to write sample %u of track %u\n", n, tracks[t] );
+                    exit( 1 );
+                }
+                bytes += s.size;
+            }
+        }
+    }
+
+    if( options.metadataBytes ) {
+        const MP4Tags* tags = MP4TagsAlloc();
+        MP4TagsFetch( tags, file );
+        MP4TagsSetName( tags, "mp4v2 benchmark" );
+
+        MP4TagArtwork art;
+        art.data = &payload[0];
+        art.size = min( options.metadataBytes, MAX_SAMPLE_SIZE );
+        art.type = MP4_ART_UNDEFINED;
+        vector<uint8_t> large;
+        if( options.metadataBytes > MAX_SAMPLE_SIZE ) {
+            large.resize( options.metadataBytes );
+            for( size_t i = 0; i < large.size(); i++ )
+                large[i] = payload[i % payload.size()];
+            art.data = &large[0];
+            art.size = options.metadataBytes;
+        }
+        MP4TagsAddArtwork( tags, &art );
+
+        MP4TagsStore( tags, file );
+        MP4TagsFree( tags );
+    }
+
+    // clear wall clock timestamps so equal options give identical files
+    MP4SetIntegerProperty( file, "moov.mvhd.creationTime", 0 );
+    MP4SetIntegerProperty( file, "moov.mvhd.modificationTime", 0 );
+    for( uint32_t t = 0; t < tracks.size(); t++ ) {
+        MP4SetTrackIntegerProperty( file, tracks[t], "tkhd.creationTime", 0 );
+        MP4SetTrackIntegerProperty( file, tracks[t], "tkhd.modificationTime", 0 );
+        MP4SetTrackIntegerProperty( file, tracks[t], "mdia.mdhd.creationTime", 0 );
+        MP4SetTrackIntegerProperty( file, tracks[t], "mdia.mdhd.modificationTime", 0 );
+    }
+
+    MP4Close( file );
+    clearModificationTime( name );
+
+    if( options.fragments ) {
+        FILE* out = fopen( name, "ab" );
+        if( !out ) {
+            fprintf( stderr, "unable to append to %s\n", name );
+            exit( 1 );
+        }
+
+        uint32_t first = 0;
+        for( uint32_t f = 0; f < options.fragments; f++ ) {
+            uint32_t count = options.samples / options.fragments;
+            if( f == options.fragments - 1 )
+                count = options.samples - first;
+            bytes += writeFragment( out, options, payload, tracks, f + 1, first, count );
+            first += count;
+        }
+
+        fclose( out );
+    }
+
+    return bytes;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint64_t
+peakRssKilobytes()
+{
+#if defined( _WIN32 )
+    PROCESS_MEMORY_COUNTERS pmc;
+    if( !GetProcessMemoryInfo( GetCurrentProcess(), &pmc, sizeof(pmc) ))
+        return 0;
+    return uint64_t( pmc.PeakWorkingSetSize ) / 1024;
+#else
+    rusage ru;
+    if( getrusage( RUSAGE_SELF, &ru ))
+        return 0;
+#   if defined( __APPLE__ )
+    return uint64_t( ru.ru_maxrss ) / 1024; // bytes on darwin
+#   else
+    return uint64_t( ru.ru_maxrss );
+#   endif
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::bench
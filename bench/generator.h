@@ -0,0 +1,44 @@
+#ifndef MP4V2_BENCH_GENERATOR_H
+#define MP4V2_BENCH_GENERATOR_H
+
+namespace mp4v2 { namespace bench {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Shape of a synthetic file written by generate().
+///
+/// The first track is video, the remaining tracks are audio. Sample sizes
+/// and payloads come from a fixed seed so a given set of options always
+/// produces the same file.
+///
+///////////////////////////////////////////////////////////////////////////////
+struct GeneratorOptions
+{
+    uint32_t tracks;        ///< number of tracks
+    uint32_t samples;       ///< samples per track
+    uint32_t chunkMs;       ///< duration per chunk in ms, 0 for library default
+    uint32_t cttsEvery;     ///< every Nth video sample is reordered, 0 for none
+    uint32_t syncEvery;     ///< every Nth video sample is a sync sample
+    uint32_t fragments;     ///< if not 0, samples go to this many movie fragments
+    uint32_t metadataBytes; ///< size of the cover art stored in ilst
+
+    GeneratorOptions();
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// Write a synthetic file, returns the number of sample bytes in it.
+///
+/// The library cannot write movie fragments, so in fragment mode the
+/// tracks in moov carry no samples and moof/mdat pairs are appended to
+/// the file directly.
+uint64_t generate( const char* name, const GeneratorOptions& options );
+
+/// Peak resident set size of this process in kilobytes, 0 if unknown.
+uint64_t peakRssKilobytes();
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::bench
+
+#endif // MP4V2_BENCH_GENERATOR_H
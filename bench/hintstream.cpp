@@ -0,0 +1,206 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Stream every RTP packet of a hinted file.
+//
+//  A file with a video and an audio track is generated, each with an RTP
+//  hint track. Video packets alternate between fragments of the current
+//  frame and redundant fragments of the previous frame, the access pattern
+//  that defeats a single-sample cache. All packets of all hint tracks are
+//  then assembled once per sample cache capacity, packet by packet and a
+//  whole hint at a time, and one result line is printed for each run.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench/impl.h"
+
+namespace mp4v2 { namespace bench {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    const uint32_t VIDEO_FRAMES  = 1800;
+    const uint32_t AUDIO_FRAMES  = 2800;
+    const uint32_t PACKET_SIZE   = 1400;
+
+    uint32_t seed = 1;
+
+    // deterministic so results are comparable across runs and hosts
+    uint32_t
+    nextRandom()
+    {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) & 0xffffff;
+    }
+
+    void
+    hintVideoFrame( MP4FileHandle file, MP4TrackId hint, MP4SampleId sid,
+                    uint32_t size, uint32_t prevSize )
+    {
+        MP4AddRtpHint( file, hint );
+
+        uint32_t prevOffset = 0;
+        for( uint32_t offset = 0; offset < size; offset += PACKET_SIZE ) {
+            uint32_t len = min( PACKET_SIZE, size - offset );
+            MP4AddRtpPacket( file, hint, offset + len == size );
+            MP4AddRtpSampleData( file, hint, sid, offset, len );
+
+            if( prevSize && prevOffset < prevSize ) {
+                uint32_t plen = min( PACKET_SIZE / 4, prevSize - prevOffset );
+                MP4AddRtpPacket( file, hint );
+                MP4AddRtpSampleData( file, hint, sid - 1, prevOffset, plen );
+                prevOffset += plen;
+            }
+        }
+
+        MP4WriteRtpHint( file, hint, 3000, sid % 30 == 1 );
+    }
+
+    void
+    generate( const char* name )
+    {
+        MP4FileHandle file = MP4Create( name );
+        if( file == MP4_INVALID_FILE_HANDLE ) {
+            fprintf( stderr, "unable to create %s\n", name );
+            exit( 1 );
+        }
+
+        MP4TrackId video = MP4AddVideoTrack( file, 90000, 3000, 640, 480 );
+        MP4TrackId audio = MP4AddAudioTrack( file, 48000, 1024 );
+        MP4TrackId videoHint = MP4AddHintTrack( file, video );
+        MP4TrackId audioHint = MP4AddHintTrack( file, audio );
+
+        uint8_t payload = MP4_SET_DYNAMIC_PAYLOAD;
+        MP4SetHintTrackRtpPayload( file, videoHint, "MP4V-ES", &payload, PACKET_SIZE );
+        payload = MP4_SET_DYNAMIC_PAYLOAD;
+        MP4SetHintTrackRtpPayload( file, audioHint, "mpeg4-generic", &payload, PACKET_SIZE );
+
+        vector<uint8_t> buf( 64 * 1024 );
+        for( size_t i = 0; i < buf.size(); i++ )
+            buf[i] = uint8_t( nextRandom() );
+
+        uint32_t prevSize = 0;
+        for( MP4SampleId sid = 1; sid <= VIDEO_FRAMES; sid++ ) {
+            uint32_t size = sid % 30 == 1 ? 40000 + nextRandom() % 20000 : 2000 + nextRandom() % 12000;
+            MP4WriteSample( file, video, &buf[0], size, 3000, 0, sid % 30 == 1 );
+            hintVideoFrame( file, videoHint, sid, size, prevSize );
+            prevSize = size;
+        }
+
+        for( MP4SampleId sid = 1; sid <= AUDIO_FRAMES; sid++ ) {
+            uint32_t size = 200 + nextRandom() % 500;
+            MP4WriteSample( file, audio, &buf[0], size );
+            MP4AddRtpHint( file, audioHint );
+            MP4AddRtpPacket( file, audioHint, true );
+            MP4AddRtpSampleData( file, audioHint, sid, 0, size );
+            MP4WriteRtpHint( file, audioHint, 1024 );
+        }
+
+        MP4Close( file );
+    }
+
+    void
+    stream( const char* name, uint32_t cacheBytes, bool batch )
+    {
+        MP4FileHandle file = MP4Read( name );
+        if( file == MP4_INVALID_FILE_HANDLE ) {
+            fprintf( stderr, "unable to read %s\n", name );
+            exit( 1 );
+        }
+
+        uint32_t numHints = MP4GetNumberOfTracks( file, MP4_HINT_TRACK_TYPE );
+        for( uint32_t i = 0; i < numHints; i++ ) {
+            MP4TrackId hint = MP4FindTrackId( file, i, MP4_HINT_TRACK_TYPE );
+            MP4SetTrackSampleCacheSize( file, MP4GetHintTrackReferenceTrackId( file, hint ), cacheBytes );
+        }
+
+        uint64_t packets = 0;
+        uint64_t bytes = 0;
+        vector<uint8_t> buffer( 64 * 1024 );
+        vector<MP4RtpIovec> iov( 256 );
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+
+        for( uint32_t i = 0; i < numHints; i++ ) {
+            MP4TrackId hint = MP4FindTrackId( file, i, MP4_HINT_TRACK_TYPE );
+            MP4SampleId numSamples = MP4GetTrackNumberOfSamples( file, hint );
+
+            for( MP4SampleId sid = 1; sid <= numSamples; sid++ ) {
+                uint16_t numPackets = 0;
+                if( !MP4ReadRtpHint( file, hint, sid, &numPackets ))
+                    exit( 1 );
+
+                if( batch ) {
+                    uint32_t bufferSize = uint32_t( buffer.size() );
+                    uint32_t numIov = uint32_t( iov.size() );
+                    while( !MP4ReadRtpHintPackets( file, hint, &buffer[0], &bufferSize, &iov[0], &numIov )) {
+                        if( bufferSize <= buffer.size() && numIov <= iov.size() )
+                            exit( 1 );
+                        buffer.resize( max( size_t( bufferSize ), buffer.size() ));
+                        iov.resize( max( size_t( numIov ), iov.size() ));
+                        bufferSize = uint32_t( buffer.size() );
+                        numIov = uint32_t( iov.size() );
+                    }
+                    packets += numIov;
+                    bytes += bufferSize;
+                    continue;
+                }
+
+                for( uint16_t p = 0; p < numPackets; p++ ) {
+                    uint8_t* packet = NULL;
+                    uint32_t packetSize = 0;
+                    if( !MP4ReadRtpPacket( file, hint, p, &packet, &packetSize ))
+                        exit( 1 );
+                    MP4Free( packet );
+                    packets++;
+                    bytes += packetSize;
+                }
+            }
+        }
+
+        time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        for( uint32_t i = 0; i < numHints; i++ ) {
+            MP4TrackId hint = MP4FindTrackId( file, i, MP4_HINT_TRACK_TYPE );
+            uint64_t h, m;
+            MP4GetTrackSampleCacheStats( file, MP4GetHintTrackReferenceTrackId( file, hint ), &h, &m );
+            hits += h;
+            misses += m;
+        }
+
+        MP4Close( file );
+
+        printf( "bench=hintstream mode=%s cache_bytes=%u packets=%" PRIu64 " bytes=%" PRIu64
+                " ms=%" PRId64 " hits=%" PRIu64 " misses=%" PRIu64 "\n",
+                batch ? "batch" : "packet", cacheBytes, packets, bytes, int64_t( elapsed ), hits, misses );
+    }
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+int
+run( int argc, char** argv )
+{
+    const char* name = argc > 1 ? argv[1] : "bench_hintstream.mp4";
+
+    generate( name );
+    stream( name, 0, false );
+    stream( name, 2 * 1024 * 1024, false );
+    stream( name, 2 * 1024 * 1024, true );
+
+    if( argc <= 1 )
+        remove( name );
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::bench
+
+///////////////////////////////////////////////////////////////////////////////
+
+extern "C"
+int main( int argc, char** argv )
+{
+    return mp4v2::bench::run( argc, argv );
+}
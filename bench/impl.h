@@ -0,0 +1,23 @@
+#ifndef MP4V2_BENCH_IMPL_H
+#define MP4V2_BENCH_IMPL_H
+
+///////////////////////////////////////////////////////////////////////////////
+
+#include "libplatform/impl.h"
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// @namespace mp4v2::bench (private) Benchmark programs.
+/// <b>WARNING: THIS IS A PRIVATE NAMESPACE. NOT FOR PUBLIC CONSUMPTION.</b>
+///
+/// Benchmarks are built by "make bench" and exercise the library only
+/// through its public API.
+///
+namespace mp4v2 { namespace bench {
+    using namespace std;
+    using namespace mp4v2::platform;
+}} // namespace mp4v2::bench
+
+///////////////////////////////////////////////////////////////////////////////
+
+#endif // MP4V2_BENCH_IMPL_H
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Read every sample of a track of many small samples.
+//
+//  With samples this small the fixed per-call cost of MP4ReadSample, such
+//  as table lookups and logging that is discarded at the default log
+//  level, dominates over copying the data. The track is read several
+//  times into a caller supplied buffer and the best pass is reported.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench/impl.h"
+
+namespace mp4v2 { namespace bench {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    const uint32_t SAMPLES     = 300000;
+    const uint32_t SAMPLE_SIZE = 64;
+    const uint32_t ITERATIONS  = 5;
+
+    void
+    generate( const char* name )
+    {
+        MP4FileHandle file = MP4Create( name );
+        if( file == MP4_INVALID_FILE_HANDLE ) {
+            fprintf( stderr, "unable to create %s\n", name );
+            exit( 1 );
+        }
+
+        MP4TrackId track = MP4AddAudioTrack( file, 48000, 1024 );
+
+        uint8_t buf[SAMPLE_SIZE];
+        for( uint32_t i = 0; i < SAMPLE_SIZE; i++ )
+            buf[i] = uint8_t( i );
+
+        for( uint32_t i = 0; i < SAMPLES; i++ )
+            MP4WriteSample( file, track, buf, SAMPLE_SIZE );
+
+        MP4Close( file );
+    }
+
+    void
+    read( const char* name )
+    {
+        MP4FileHandle file = MP4Read( name );
+        if( file == MP4_INVALID_FILE_HANDLE ) {
+            fprintf( stderr, "unable to read %s\n", name );
+            exit( 1 );
+        }
+
+        MP4TrackId track = MP4FindTrackId( file, 0 );
+        MP4SampleId numSamples = MP4GetTrackNumberOfSamples( file, track );
+
+        uint8_t buf[SAMPLE_SIZE];
+        time::milliseconds_t best = 0;
+
+        for( uint32_t i = 0; i < ITERATIONS; i++ ) {
+            time::milliseconds_t start = time::getLocalTimeMilliseconds();
+
+            for( MP4SampleId sid = 1; sid <= numSamples; sid++ ) {
+                uint8_t* bytes = buf;
+                uint32_t numBytes = sizeof(buf);
+                if( !MP4ReadSample( file, track, sid, &bytes, &numBytes ))
+                    exit( 1 );
+            }
+
+            time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+            if( i == 0 || elapsed < best )
+                best = elapsed;
+        }
+
+        MP4Close( file );
+
+        printf( "bench=sampleread samples=%u ms=%" PRId64 " ns_per_sample=%" PRIu64 "\n",
+                numSamples, int64_t( best ),
+                numSamples ? uint64_t( best ) * 1000000 / numSamples : uint64_t( 0 ));
+    }
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+int
+run( int argc, char** argv )
+{
+    const char* name = argc > 1 ? argv[1] : "bench_sampleread.mp4";
+
+    generate( name );
+    read( name );
+
+    if( argc <= 1 )
+        remove( name );
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::bench
+
+///////////////////////////////////////////////////////////////////////////////
+
+extern "C"
+int main( int argc, char** argv )
+{
+    return mp4v2::bench::run( argc, argv );
+}
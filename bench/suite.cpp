@@ -0,0 +1,788 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Benchmark suite over a synthetic file.
+//
+//  Each invocation runs a single case so that the reported peak RSS
+//  belongs to that case alone; "make bench" runs them one after the
+//  other. The input file is written by the "generate" case, or on demand
+//  by any case that finds it missing, and is shaped by the options
+//  below. One result line of key=value pairs is printed per case.
+//
+//  usage: bench_suite CASE [--file NAME] [--tracks N] [--samples N]
+//                          [--chunk-ms N] [--ctts-every N] [--sync-every N]
+//                          [--fragments N] [--metadata-bytes N]
+//                          [--iterations N] [--prefetch N]
+//                          [--read-latency-us N] [--file-io stream|uring]
+//
+//  --prefetch reads sample data ahead into N buffers and --read-latency-us
+//  delays every read of the reading cases, to stand in for remote storage.
+//  --file-io selects the file I/O of the library, see MP4SetFileIO().
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "bench/impl.h"
+#include "bench/generator.h"
+
+namespace mp4v2 { namespace bench {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    struct Context {
+        GeneratorOptions options;
+        string           file;
+        string           output;
+        uint32_t         iterations;
+        uint32_t         prefetch;
+        uint32_t         readLatencyUs;
+        MP4FileIO        fileIo;
+    };
+
+    uint32_t seed = 1;
+
+    uint32_t
+    nextRandom()
+    {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) & 0xffffff;
+    }
+
+    // extra is appended to the line as further key=value pairs
+    void
+    report( const char* name, uint64_t ops, uint64_t bytes, time::milliseconds_t elapsed,
+            const string& extra = "" )
+    {
+        uint64_t ms = elapsed > 0 ? uint64_t( elapsed ) : 0;
+        printf( "bench=suite case=%s ops=%" PRIu64 " bytes=%" PRIu64 " ms=%" PRIu64
+                " ops_per_sec=%" PRIu64 " bytes_per_sec=%" PRIu64 " peak_rss_kb=%" PRIu64 "%s\n",
+                name, ops, bytes, ms,
+                ms ? ops * 1000 / ms : uint64_t( 0 ),
+                ms ? bytes * 1000 / ms : uint64_t( 0 ),
+                peakRssKilobytes(), extra.c_str() );
+    }
+
+    uint64_t
+    fileSize( const string& name )
+    {
+        io::File::Size size = 0;
+        if( io::FileSystem::getFileSize( name, size )) {
+            fprintf( stderr, "unable to stat %s\n", name.c_str() );
+            exit( 1 );
+        }
+        return uint64_t( size );
+    }
+
+    void
+    ensureInput( const Context& ctx )
+    {
+        if( !io::FileSystem::exists( ctx.file ))
+            generate( ctx.file.c_str(), ctx.options );
+    }
+
+    // read-only file I/O that spins for a while before every read
+    time::microseconds_t readLatency = 0;
+
+    void*
+    latencyOpen( const char* name, MP4FileMode mode )
+    {
+        io::File* file = new io::File( name, io::File::MODE_READ );
+        if( mode != FILEMODE_READ || file->open() ) {
+            delete file;
+            return NULL;
+        }
+        return file;
+    }
+
+    int
+    latencySeek( void* handle, int64_t pos )
+    {
+        return static_cast<io::File*>( handle )->seek( pos );
+    }
+
+    int
+    latencyRead( void* handle, void* buffer, int64_t size, int64_t* nin, int64_t maxChunkSize )
+    {
+        time::microseconds_t until = time::getLocalTimeMicroseconds() + readLatency;
+        while( time::getLocalTimeMicroseconds() < until )
+            ;
+        io::File::Size n = 0;
+        bool failed = static_cast<io::File*>( handle )->read( buffer, size, n, maxChunkSize );
+        *nin = n;
+        return failed;
+    }
+
+    int
+    latencyWrite( void*, const void*, int64_t, int64_t*, int64_t )
+    {
+        return 1;
+    }
+
+    int
+    latencyClose( void* handle )
+    {
+        delete static_cast<io::File*>( handle );
+        return 0;
+    }
+
+    const MP4FileProvider latencyProvider = {
+        latencyOpen, latencySeek, latencyRead, latencyWrite, latencyClose
+    };
+
+    MP4FileHandle
+    openInput( const Context& ctx )
+    {
+        readLatency = ctx.readLatencyUs;
+        MP4FileHandle file = MP4ReadProvider( ctx.file.c_str(),
+                                              ctx.readLatencyUs ? &latencyProvider : NULL );
+        if( file == MP4_INVALID_FILE_HANDLE ) {
+            fprintf( stderr, "unable to read %s\n", ctx.file.c_str() );
+            exit( 1 );
+        }
+        if( ctx.prefetch && !MP4EnablePrefetch( file, ctx.prefetch ))
+            exit( 1 );
+        return file;
+    }
+
+    // a buffer large enough for any sample of the file
+    void
+    sizeBuffer( MP4FileHandle file, vector<uint8_t>& buf )
+    {
+        uint32_t numTracks = MP4GetNumberOfTracks( file );
+        for( uint32_t i = 0; i < numTracks; i++ ) {
+            uint32_t size = MP4GetTrackMaxSampleSize( file, MP4FindTrackId( file, uint16_t( i )));
+            if( size > buf.size() )
+                buf.resize( size );
+        }
+        if( buf.empty() )
+            buf.resize( 1 );
+    }
+
+    uint32_t
+    readSample( MP4FileHandle file, MP4TrackId track, MP4SampleId sid, vector<uint8_t>& buf )
+    {
+        uint8_t* bytes = &buf[0];
+        uint32_t numBytes = uint32_t( buf.size() );
+        if( !MP4ReadSample( file, track, sid, &bytes, &numBytes ))
+            exit( 1 );
+        return numBytes;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+
+    void
+    caseGenerate( const Context& ctx )
+    {
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+        uint64_t bytes = generate( ctx.file.c_str(), ctx.options );
+        report( "generate", uint64_t( ctx.options.samples ) * ctx.options.tracks, bytes,
+                time::getLocalTimeMilliseconds() - start );
+    }
+
+    void
+    caseOpen( const Context& ctx )
+    {
+        ensureInput( ctx );
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+        for( uint32_t i = 0; i < ctx.iterations; i++ )
+            MP4Close( openInput( ctx ));
+        report( "open", ctx.iterations, fileSize( ctx.file ) * ctx.iterations,
+                time::getLocalTimeMilliseconds() - start );
+    }
+
+    void
+    caseReadSequential( const Context& ctx )
+    {
+        ensureInput( ctx );
+        MP4FileHandle file = openInput( ctx );
+        vector<uint8_t> buf;
+        sizeBuffer( file, buf );
+        uint64_t ops = 0;
+        uint64_t bytes = 0;
+
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+        uint32_t numTracks = MP4GetNumberOfTracks( file );
+        for( uint32_t i = 0; i < numTracks; i++ ) {
+            MP4TrackId track = MP4FindTrackId( file, uint16_t( i ));
+            MP4SampleId numSamples = MP4GetTrackNumberOfSamples( file, track );
+            for( MP4SampleId sid = 1; sid <= numSamples; sid++ ) {
+                bytes += readSample( file, track, sid, buf );
+                ops++;
+            }
+        }
+        time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+
+        MP4Close( file );
+        report( "read-seq", ops, bytes, elapsed );
+    }
+
+    // all tracks in decoding time order, as a player reads them
+    void
+    caseDemux( const Context& ctx )
+    {
+        ensureInput( ctx );
+        MP4FileHandle file = openInput( ctx );
+        vector<uint8_t> buf;
+        sizeBuffer( file, buf );
+        uint64_t ops = 0;
+        uint64_t bytes = 0;
+
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+        uint32_t numTracks = MP4GetNumberOfTracks( file );
+        vector<MP4TrackId> tracks( numTracks );
+        vector<MP4SampleId> next( numTracks, 1 );
+        for( uint32_t i = 0; i < numTracks; i++ )
+            tracks[i] = MP4FindTrackId( file, uint16_t( i ));
+
+        for( ;; ) {
+            uint32_t earliest = numTracks;
+            double earliestTime = 0;
+            for( uint32_t i = 0; i < numTracks; i++ ) {
+                if( next[i] > MP4GetTrackNumberOfSamples( file, tracks[i] ))
+                    continue;
+                double t = double( MP4GetSampleTime( file, tracks[i], next[i] ))
+                           / MP4GetTrackTimeScale( file, tracks[i] );
+                if( earliest == numTracks || t < earliestTime ) {
+                    earliest = i;
+                    earliestTime = t;
+                }
+            }
+            if( earliest == numTracks )
+                break;
+            bytes += readSample( file, tracks[earliest], next[earliest]++, buf );
+            ops++;
+        }
+        time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+
+        MP4Close( file );
+        report( "demux", ops, bytes, elapsed );
+    }
+
+    // every track in runs of samples, written out raw as by an extractor
+    void
+    caseExtract( const Context& ctx )
+    {
+        const uint32_t runSamples = 256;
+
+        ensureInput( ctx );
+        MP4FileHandle file = openInput( ctx );
+        FILE* out = fopen( ctx.output.c_str(), "wb" );
+        if( !out )
+            exit( 1 );
+        vector<uint8_t> buf;
+        vector<uint32_t> sizes( runSamples );
+        uint64_t ops = 0;
+        uint64_t bytes = 0;
+
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+        uint32_t numTracks = MP4GetNumberOfTracks( file );
+        for( uint32_t i = 0; i < numTracks; i++ ) {
+            MP4TrackId track = MP4FindTrackId( file, uint16_t( i ));
+            MP4SampleId numSamples = MP4GetTrackNumberOfSamples( file, track );
+            buf.resize( max( size_t( MP4GetTrackMaxSampleSize( file, track )) * runSamples, size_t( 1 )));
+            for( MP4SampleId sid = 1; sid <= numSamples; sid += runSamples ) {
+                uint32_t count = min( runSamples, numSamples + 1 - sid );
+                if( !MP4ReadSamples( file, track, sid, count, &buf[0], uint32_t( buf.size() ), &sizes[0] ))
+                    exit( 1 );
+                uint32_t size = 0;
+                for( uint32_t j = 0; j < count; j++ )
+                    size += sizes[j];
+                if( fwrite( &buf[0], 1, size, out ) != size )
+                    exit( 1 );
+                ops += count;
+                bytes += size;
+            }
+        }
+        fclose( out );
+        time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+
+        MP4Close( file );
+        remove( ctx.output.c_str() );
+        report( "extract", ops, bytes, elapsed );
+    }
+
+    void
+    caseReadRandom( const Context& ctx )
+    {
+        ensureInput( ctx );
+        MP4FileHandle file = openInput( ctx );
+        vector<uint8_t> buf;
+        sizeBuffer( file, buf );
+        uint64_t ops = 0;
+        uint64_t bytes = 0;
+
+        vector<MP4TrackId> tracks;
+        vector<MP4SampleId> counts;
+        uint64_t total = 0;
+        uint32_t numTracks = MP4GetNumberOfTracks( file );
+        for( uint32_t i = 0; i < numTracks; i++ ) {
+            MP4TrackId track = MP4FindTrackId( file, uint16_t( i ));
+            MP4SampleId numSamples = MP4GetTrackNumberOfSamples( file, track );
+            if( !numSamples )
+                continue;
+            tracks.push_back( track );
+            counts.push_back( numSamples );
+            total += numSamples;
+        }
+
+        // fragment mode leaves no samples in moov
+        if( tracks.empty() )
+            total = 0;
+
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+        for( uint64_t n = 0; n < total; n++ ) {
+            uint32_t t = nextRandom() % tracks.size();
+            MP4SampleId sid = 1 + nextRandom() % counts[t];
+            bytes += readSample( file, tracks[t], sid, buf );
+            ops++;
+        }
+        time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+
+        MP4Close( file );
+        report( "read-random", ops, bytes, elapsed );
+    }
+
+    void
+    caseSeek( const Context& ctx )
+    {
+        ensureInput( ctx );
+        MP4FileHandle file = openInput( ctx );
+        uint64_t ops = 0;
+
+        vector<MP4TrackId> tracks;
+        vector<MP4Duration> durations;
+        uint64_t total = 0;
+        uint32_t numTracks = MP4GetNumberOfTracks( file );
+        for( uint32_t i = 0; i < numTracks; i++ ) {
+            MP4TrackId track = MP4FindTrackId( file, uint16_t( i ));
+            MP4Duration duration = MP4GetTrackDuration( file, track );
+            if( !duration )
+                continue;
+            tracks.push_back( track );
+            durations.push_back( duration );
+            total += MP4GetTrackNumberOfSamples( file, track );
+        }
+
+        // fragment mode leaves no samples in moov
+        if( tracks.empty() )
+            total = 0;
+
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+        for( uint64_t n = 0; n < total; n++ ) {
+            uint32_t t = nextRandom() % tracks.size();
+            MP4Timestamp when = (uint64_t( nextRandom() ) << 24 | nextRandom()) % durations[t];
+            // searches forward for a sync sample, none after the last one
+            MP4GetSampleIdFromTime( file, tracks[t], when, true );
+            ops++;
+        }
+        time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+
+        MP4Close( file );
+        report( "seek", ops, 0, elapsed );
+    }
+
+    void
+    caseWrite( const Context& ctx )
+    {
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+        uint64_t bytes = generate( ctx.output.c_str(), ctx.options );
+        time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+
+        remove( ctx.output.c_str() );
+        report( "write", uint64_t( ctx.options.samples ) * ctx.options.tracks, bytes, elapsed );
+    }
+
+    void
+    caseOptimize( const Context& ctx )
+    {
+        ensureInput( ctx );
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+        if( !MP4Optimize( ctx.file.c_str(), ctx.output.c_str() ))
+            exit( 1 );
+        time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+
+        remove( ctx.output.c_str() );
+        report( "optimize", 1, fileSize( ctx.file ), elapsed );
+    }
+
+    void
+    caseCopyTrack( const Context& ctx )
+    {
+        ensureInput( ctx );
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+
+        MP4FileHandle src = openInput( ctx );
+        MP4FileHandle dst = MP4Create( ctx.output.c_str() );
+        if( dst == MP4_INVALID_FILE_HANDLE )
+            exit( 1 );
+
+        uint64_t ops = 0;
+        uint32_t numTracks = MP4GetNumberOfTracks( src );
+        for( uint32_t i = 0; i < numTracks; i++ ) {
+            if( MP4CopyTrack( src, MP4FindTrackId( src, uint16_t( i )), dst ) == MP4_INVALID_TRACK_ID )
+                exit( 1 );
+            ops += MP4GetTrackNumberOfSamples( src, MP4FindTrackId( src, uint16_t( i )));
+        }
+
+        MP4Close( dst );
+        MP4Close( src );
+        time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+
+        uint64_t bytes = fileSize( ctx.output );
+        remove( ctx.output.c_str() );
+        report( "copytrack", ops, bytes, elapsed );
+    }
+
+    void
+    caseTags( const Context& ctx )
+    {
+        ensureInput( ctx );
+
+        // work on a copy, storing tags modifies the file in place
+        FILE* in = fopen( ctx.file.c_str(), "rb" );
+        FILE* out = fopen( ctx.output.c_str(), "wb" );
+        if( !in || !out )
+            exit( 1 );
+        vector<uint8_t> buf( 1024 * 1024 );
+        for( size_t n; (n = fread( &buf[0], 1, buf.size(), in )) > 0; ) {
+            if( fwrite( &buf[0], 1, n, out ) != n )
+                exit( 1 );
+        }
+        fclose( in );
+        fclose( out );
+
+        time::milliseconds_t start = time::getLocalTimeMilliseconds();
+        for( uint32_t i = 0; i < ctx.iterations; i++ ) {
+            MP4FileHandle file = MP4Modify( ctx.output.c_str() );
+            if( file == MP4_INVALID_FILE_HANDLE )
+                exit( 1 );
+
+            char comment[32];
+            snprintf( comment, sizeof(comment), "iteration %u", i );
+
+            const MP4Tags* tags = MP4TagsAlloc();
+            MP4TagsFetch( tags, file );
+            MP4TagsSetComments( tags, comment );
+            if( !MP4TagsStore( tags, file ))
+                exit( 1 );
+            MP4TagsFree( tags );
+
+            MP4Close( file );
+        }
+        time::milliseconds_t elapsed = time::getLocalTimeMilliseconds() - start;
+
+        remove( ctx.output.c_str() );
+        report( "tags", ctx.iterations, 0, elapsed );
+    }
+
+    // Demux through the forward-only reader, as from a pipe. A file with
+    // moov last cannot be streamed, so its optimized copy is used.
+    void
+    caseStream( const Context& ctx )
+    {
+        ensureInput( ctx );
+
+        // every sample must come out of the stream; the library does not
+        // count samples in movie fragments, so there the generated shape is
+        uint64_t expected = uint64_t( ctx.options.samples ) * ctx.options.tracks;
+        if( !ctx.options.fragments ) {
+            MP4FileHandle file = MP4Read( ctx.file.c_str() );
+            if( file == MP4_INVALID_FILE_HANDLE )
+                exit( 1 );
+            expected = 0;
+            const uint32_t numTracks = MP4GetNumberOfTracks( file );
+            for( uint32_t i = 0; i < numTracks; i++ )
+                expected += MP4GetTrackNumberOfSamples( file, MP4FindTrackId( file, uint16_t( i )));
+            MP4Close( file );
+        }
+
+        string name = ctx.file;
+        if( !ctx.options.fragments ) {
+            if( !MP4Optimize( ctx.file.c_str(), ctx.output.c_str() ))
+                exit( 1 );
+            name = ctx.output;
+        }
+
+        uint64_t ops = 0;
+        uint64_t bytes = 0;
+        time::microseconds_t first = 0;
+
+        time::microseconds_t start = time::getLocalTimeMicroseconds();
+        MP4StreamHandle stream = MP4StreamOpen( name.c_str() );
+        if( stream == MP4_INVALID_STREAM_HANDLE )
+            exit( 1 );
+
+        MP4StreamSample sample;
+        MP4StreamStatus status;
+        while( (status = MP4StreamReadSample( stream, &sample )) == MP4_STREAM_SAMPLE ) {
+            if( !ops )
+                first = time::getLocalTimeMicroseconds() - start;
+            bytes += sample.numBytes;
+            ops++;
+        }
+        MP4StreamClose( stream );
+        time::microseconds_t elapsed = time::getLocalTimeMicroseconds() - start;
+        if( status != MP4_STREAM_END || ops != expected ) {
+            fprintf( stderr, "stream: %" PRIu64 " of %" PRIu64 " samples, status %d\n",
+                     ops, expected, status );
+            exit( 1 );
+        }
+
+        if( name != ctx.file )
+            remove( name.c_str() );
+
+        ostringstream extra;
+        extra << " first_sample_us=" << first;
+        report( "stream", ops, bytes, elapsed / 1000, extra.str() );
+    }
+
+    // last message logged by the library while capturing
+    string lastLogMessage;
+
+    void
+    captureLog( MP4LogLevel, const char* fmt, va_list ap )
+    {
+        char buf[1024];
+        vsnprintf( buf, sizeof(buf), fmt, ap );
+        lastLogMessage = buf;
+    }
+
+    // A handle to a table entry fails alike on every lookup while the table
+    // is empty, whether or not the path was resolved again since, and
+    // succeeds once the entry has been written.
+    void
+    checkEmptyTableHandle( const Context& ctx )
+    {
+        MP4FileHandle file = MP4Create( ctx.output.c_str() );
+        if( file == MP4_INVALID_FILE_HANDLE )
+            exit( 1 );
+        MP4SetTimeScale( file, 48000 );
+        MP4TrackId track = MP4AddAudioTrack( file, 48000, 1024 );
+        MP4PropertyHandle handle =
+            MP4ResolveTrackProperty( file, track, "mdia.minf.stbl.stts.entries.sampleCount" );
+        if( handle == MP4_INVALID_PROPERTY_HANDLE )
+            exit( 1 );
+
+        const MP4LogLevel level = MP4LogGetLevel();
+        MP4LogSetLevel( MP4_LOG_ERROR );
+        MP4SetLogCallback( captureLog );
+        uint64_t value;
+        string failure[2];
+        for( int i = 0; i < 2; i++ ) {
+            lastLogMessage.clear();
+            if( MP4GetPropertyHandleInteger( file, handle, &value )) {
+                fprintf( stderr, "properties: lookup %d in an empty table succeeded\n", i + 1 );
+                exit( 1 );
+            }
+            failure[i] = lastLogMessage;
+        }
+        MP4SetLogCallback( NULL );
+        MP4LogSetLevel( level );
+        if( failure[0] != failure[1] ) {
+            fprintf( stderr, "properties: empty table lookups failed with \"%s\" and \"%s\"\n",
+                     failure[0].c_str(), failure[1].c_str() );
+            exit( 1 );
+        }
+
+        const uint8_t sample[4] = { 0 };
+        if( !MP4WriteSample( file, track, sample, sizeof(sample), 1024 )
+            || !MP4GetPropertyHandleInteger( file, handle, &value ) || value != 1 )
+        {
+            fprintf( stderr, "properties: written table entry not found\n" );
+            exit( 1 );
+        }
+
+        MP4Close( file );
+        remove( ctx.output.c_str() );
+    }
+
+    // Read a property repeatedly by name and through a resolved handle.
+    void
+    caseProperties( const Context& ctx )
+    {
+        checkEmptyTableHandle( ctx );
+
+        ensureInput( ctx );
+        MP4FileHandle file = openInput( ctx );
+        const MP4TrackId track = MP4FindTrackId( file, 0 );
+        const char* const name = "mdia.minf.stbl.stsd.*.width";
+        MP4PropertyHandle handle = MP4ResolveTrackProperty( file, track, name );
+        if( handle == MP4_INVALID_PROPERTY_HANDLE )
+            exit( 1 );
+
+        const uint64_t lookups = uint64_t( ctx.iterations ) * 50000;
+        uint64_t byName = 0;
+        uint64_t byHandle = 0;
+        uint64_t value;
+
+        time::microseconds_t start = time::getLocalTimeMicroseconds();
+        for( uint64_t i = 0; i < lookups; i++ ) {
+            if( !MP4GetTrackIntegerProperty( file, track, name, &value ))
+                exit( 1 );
+            byName += value;
+        }
+        time::microseconds_t nameUs = time::getLocalTimeMicroseconds() - start;
+
+        start = time::getLocalTimeMicroseconds();
+        for( uint64_t i = 0; i < lookups; i++ ) {
+            if( !MP4GetPropertyHandleInteger( file, handle, &value ))
+                exit( 1 );
+            byHandle += value;
+        }
+        time::microseconds_t handleUs = time::getLocalTimeMicroseconds() - start;
+
+        MP4Close( file );
+        if( byName != byHandle )
+            exit( 1 );
+
+        ostringstream extra;
+        extra << " name_ns=" << nameUs * 1000 / lookups << " handle_ns=" << handleUs * 1000 / lookups;
+        report( "properties", 2 * lookups, 0, (nameUs + handleUs) / 1000, extra.str() );
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+
+    struct Case {
+        const char* name;
+        void (*run)( const Context& );
+    };
+
+    const Case CASES[] = {
+        { "generate",    caseGenerate },
+        { "open",        caseOpen },
+        { "read-seq",    caseReadSequential },
+        { "read-random", caseReadRandom },
+        { "demux",       caseDemux },
+        { "extract",     caseExtract },
+        { "seek",        caseSeek },
+        { "write",       caseWrite },
+        { "optimize",    caseOptimize },
+        { "copytrack",   caseCopyTrack },
+        { "tags",        caseTags },
+        { "stream",      caseStream },
+        { "properties",  caseProperties },
+    };
+
+    enum {
+        OPT_FILE = 1,
+        OPT_TRACKS,
+        OPT_SAMPLES,
+        OPT_CHUNK_MS,
+        OPT_CTTS_EVERY,
+        OPT_SYNC_EVERY,
+        OPT_FRAGMENTS,
+        OPT_METADATA_BYTES,
+        OPT_ITERATIONS,
+        OPT_PREFETCH,
+        OPT_READ_LATENCY_US,
+        OPT_FILE_IO,
+    };
+
+    const prog::Option OPTIONS[] = {
+        { "file",           prog::Option::REQUIRED_ARG, NULL, OPT_FILE },
+        { "tracks",         prog::Option::REQUIRED_ARG, NULL, OPT_TRACKS },
+        { "samples",        prog::Option::REQUIRED_ARG, NULL, OPT_SAMPLES },
+        { "chunk-ms",       prog::Option::REQUIRED_ARG, NULL, OPT_CHUNK_MS },
+        { "ctts-every",     prog::Option::REQUIRED_ARG, NULL, OPT_CTTS_EVERY },
+        { "sync-every",     prog::Option::REQUIRED_ARG, NULL, OPT_SYNC_EVERY },
+        { "fragments",      prog::Option::REQUIRED_ARG, NULL, OPT_FRAGMENTS },
+        { "metadata-bytes", prog::Option::REQUIRED_ARG, NULL, OPT_METADATA_BYTES },
+        { "iterations",     prog::Option::REQUIRED_ARG, NULL, OPT_ITERATIONS },
+        { "prefetch",       prog::Option::REQUIRED_ARG, NULL, OPT_PREFETCH },
+        { "read-latency-us", prog::Option::REQUIRED_ARG, NULL, OPT_READ_LATENCY_US },
+        { "file-io",        prog::Option::REQUIRED_ARG, NULL, OPT_FILE_IO },
+        { NULL, prog::Option::NO_ARG, NULL, 0 }
+    };
+
+    void
+    usage()
+    {
+        fprintf( stderr, "usage: bench_suite CASE [--OPTION VALUE]...\ncases:" );
+        for( size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++ )
+            fprintf( stderr, " %s", CASES[i].name );
+        fprintf( stderr, "\noptions:" );
+        for( size_t i = 0; OPTIONS[i].name; i++ )
+            fprintf( stderr, " --%s", OPTIONS[i].name );
+        fprintf( stderr, "\n" );
+        exit( 1 );
+    }
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+int
+run( int argc, char** argv )
+{
+    if( argc < 2 )
+        usage();
+
+    const Case* selected = NULL;
+    for( size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++ ) {
+        if( !strcmp( argv[1], CASES[i].name ))
+            selected = &CASES[i];
+    }
+    if( !selected )
+        usage();
+
+    Context ctx;
+    ctx.file = "bench_suite.mp4";
+    ctx.iterations = 20;
+    ctx.prefetch = 0;
+    ctx.readLatencyUs = 0;
+    ctx.fileIo = MP4_FILE_IO_STREAM;
+
+    prog::optind = 2;
+    for( int c; (c = prog::getOption( argc, argv, "", OPTIONS, NULL )) != -1; ) {
+        if( c == OPT_FILE ) {
+            ctx.file = prog::optarg;
+            continue;
+        }
+        if( c == OPT_FILE_IO ) {
+            if( !strcmp( prog::optarg, "uring" ))
+                ctx.fileIo = MP4_FILE_IO_URING;
+            else if( strcmp( prog::optarg, "stream" ))
+                usage();
+            continue;
+        }
+        if( c == '?' || c == ':' )
+            usage();
+
+        uint32_t value = uint32_t( strtoul( prog::optarg, NULL, 0 ));
+        switch( c ) {
+            case OPT_TRACKS:         ctx.options.tracks = value;        break;
+            case OPT_SAMPLES:        ctx.options.samples = value;       break;
+            case OPT_CHUNK_MS:       ctx.options.chunkMs = value;       break;
+            case OPT_CTTS_EVERY:     ctx.options.cttsEvery = value;     break;
+            case OPT_SYNC_EVERY:     ctx.options.syncEvery = value;     break;
+            case OPT_FRAGMENTS:      ctx.options.fragments = value;     break;
+            case OPT_METADATA_BYTES: ctx.options.metadataBytes = value; break;
+            case OPT_ITERATIONS:     ctx.iterations = max( value, 1u ); break;
+            case OPT_PREFETCH:       ctx.prefetch = value;              break;
+            case OPT_READ_LATENCY_US: ctx.readLatencyUs = value;        break;
+            default:                 usage();
+        }
+    }
+    if( ctx.options.tracks == 0 )
+        usage();
+
+    ctx.output = ctx.file + ".out";
+    MP4LogSetLevel( MP4_LOG_ERROR );
+    if( !MP4SetFileIO( ctx.fileIo )) {
+        fprintf( stderr, "file I/O not supported\n" );
+        exit( 1 );
+    }
+
+    selected->run( ctx );
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::bench
+
+///////////////////////////////////////////////////////////////////////////////
+
+extern "C"
+int main( int argc, char** argv )
+{
+    return mp4v2::bench::run( argc, argv );
+}
@@ -12,6 +12,40 @@
 #define MP4_CREATE_64BIT_DATA 0x01
 /** Bit: enable 64-bit time-atoms. @note Incompatible with QuickTime. */
 #define MP4_CREATE_64BIT_TIME 0x02
+/** Bit: allocate the parsed atom tree from a per-file arena. */
+#define MP4_READ_ARENA 0x01
+/** Bit: enable performance counters, see MP4GetPerfCounters(). */
+#define MP4_READ_PERF_COUNTERS 0x02
+/** Bit: read sample data ahead on a background thread, see MP4EnablePrefetch(). */
+#define MP4_READ_PREFETCH 0x04
+/** Bit: write only edited atoms back in place when possible. */
+#define MP4_MODIFY_PATCH 0x01
+
+/** Performance counters of a file handle.
+ *
+ *  I/O counts cover calls made to the file provider; reads and writes of
+ *  in-memory buffers used while writing atoms are not counted, nor are
+ *  the reads of the prefetch thread.
+ */
+typedef struct MP4PerfCounters_s
+{
+    uint64_t readCalls;         /**< provider read calls, a batch counting as one */
+    uint64_t readBytes;         /**< bytes read through the provider */
+    uint64_t writeCalls;        /**< provider write calls */
+    uint64_t writeBytes;        /**< bytes written through the provider */
+    uint64_t seekCalls;         /**< provider seek calls */
+    uint64_t atomsParsed;       /**< atoms read from the file */
+    uint64_t tableEntries;      /**< table entries decoded, e.g. of stsz */
+    uint64_t sttsHits;          /**< sample time lookups continuing from the last one */
+    uint64_t sttsMisses;        /**< sample time lookups scanning from the start */
+    uint64_t cttsHits;          /**< rendering offset lookups continuing from the last one */
+    uint64_t cttsMisses;        /**< rendering offset lookups scanning from the start */
+    uint64_t stscHits;          /**< sample to chunk lookups within the last entry */
+    uint64_t stscMisses;        /**< sample to chunk lookups needing a scan */
+    uint64_t readFromFileUsecs; /**< microseconds spent parsing the file on open */
+    uint64_t prefetchHits;      /**< samples copied from read-ahead buffers */
+    uint64_t prefetchMisses;    /**< samples read directly while prefetching */
+} MP4PerfCounters;
 
 /** Enumeration of file modes for custom file provider. */
 typedef enum MP4FileMode_e
@@ -40,6 +74,21 @@ typedef struct MP4FileProvider_s
     int   ( *close )( void* handle );
 } MP4FileProvider;
 
+/** Structure of functions implementing a progressive file provider.
+ *
+ *  A progressive provider serves a file that is still being downloaded or
+ *  written. Besides the functions of <b>file</b>, it reports the size the
+ *  file will have once complete and which bytes have not arrived yet.
+ *  Like those of <b>file</b>, both functions return a true value to
+ *  indicate failure, or for <b>pending</b> unavailable data.
+ */
+typedef struct MP4ProgressiveProvider_s
+{
+    MP4FileProvider file;
+    int ( *size    )( void* handle, int64_t* size );
+    int ( *pending )( void* handle, int64_t pos, int64_t size );
+} MP4ProgressiveProvider;
+
 /** Close an mp4 file.
  *  MP4Close closes a previously opened mp4 file. If the file was opened
  *  writable with MP4Create() or MP4Modify(), then MP4Close() will write
@@ -245,7 +294,15 @@ char* MP4Info(
  *      On other platforms, it should be an 8-bit encoding that is
  *      appropriate for the platform, locale, file system, etc.
  *      (prefer to use UTF-8 when possible).
- *  @param flags currently ignored.
+ *  @param flags bitmask that allows the user to set extra options.
+ *      Valid bits may be any combination of:
+ *          @li #MP4_MODIFY_PATCH leave the file layout untouched until
+ *              MP4Close(). If by then no atom was added or removed, no
+ *              samples were written and every edited atom still has its
+ *              original size, only the edited atoms are written back at
+ *              their original offsets. Otherwise the file is rewritten as
+ *              without this flag. Suited to fixed-size header edits such as
+ *              track flags, layer, volume, dimensions or language.
  *
  *  @return On success a handle of the target file for use in subsequent calls
  *      to the library.
@@ -351,6 +408,292 @@ MP4FileHandle MP4ReadProvider(
     const char*            fileName,
     const MP4FileProvider* fileProvider DEFAULT(NULL) );
 
+/** Read an existing mp4 file with options.
+ *
+ *  MP4ReadEx is MP4ReadProvider with additional flags controlling how the
+ *  file is loaded.
+ *
+ *  @param fileName pathname of the file to be read.
+ *      On Windows, this should be a UTF-8 encoded string.
+ *      On other platforms, it should be an 8-bit encoding that is
+ *      appropriate for the platform, locale, file system, etc.
+ *      (prefer to use UTF-8 when possible).
+ *  @param fileProvider custom implementation of file I/O operations.
+ *      If NULL the standard file I/O is used.
+ *  @param flags bitmask that allows the caller to set desired behavior.
+ *      Available flags are as follows:
+ *          @li #MP4_READ_ARENA allocate the parsed atom tree from a
+ *              per-file arena. Opening and closing is faster and less
+ *              fragmenting, at the cost of holding the memory of atoms
+ *              deleted while the file is open until MP4Close().
+ *          @li #MP4_READ_PERF_COUNTERS enable performance counters
+ *              before the file is parsed, see MP4GetPerfCounters().
+ *          @li #MP4_READ_PREFETCH read sample data ahead with the
+ *              default buffers, see MP4EnablePrefetch().
+ *
+ *  @return On success a handle of the file for use in subsequent calls to
+ *      the library.
+ *      On error, #MP4_INVALID_FILE_HANDLE.
+ */
+MP4V2_EXPORT
+MP4FileHandle MP4ReadEx(
+    const char*            fileName,
+    const MP4FileProvider* fileProvider DEFAULT(NULL),
+    uint32_t               flags DEFAULT(0) );
+
+/** Enable or disable performance counters.
+ *
+ *  MP4EnablePerfCounters starts or stops counting I/O and parsing work
+ *  done on behalf of a file handle. Counting is cheap enough to leave
+ *  enabled in production. Counters start from zero when enabled and are
+ *  discarded when disabled. Pass #MP4_READ_PERF_COUNTERS to MP4ReadEx()
+ *  to also count the work of opening the file.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param enable true to enable counting, false to disable it.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ *
+ *  @see MP4GetPerfCounters().
+ */
+MP4V2_EXPORT
+bool MP4EnablePerfCounters(
+    MP4FileHandle hFile,
+    bool          enable );
+
+/** Get performance counters.
+ *
+ *  MP4GetPerfCounters reports the work counted since counters were
+ *  enabled or last reset.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param counters receives the counters; all zero if counting is disabled.
+ *  @param reset if true, the counters are reset after being read.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ *
+ *  @see MP4EnablePerfCounters().
+ */
+MP4V2_EXPORT
+bool MP4GetPerfCounters(
+    MP4FileHandle    hFile,
+    MP4PerfCounters* counters,
+    bool             reset DEFAULT(false) );
+
+/** Enable or disable read-ahead of sample data.
+ *
+ *  MP4EnablePrefetch starts a background thread that reads the sample
+ *  data of the tracks being read with MP4ReadSample() ahead of time. The
+ *  upcoming chunks of each track are known from its sample tables, so
+ *  the thread loads the blocks of the file holding them into a bounded
+ *  pool of buffers, taking turns between tracks. Sequential demux of
+ *  files on high latency storage then waits on the latency once rather
+ *  than at every chunk.
+ *
+ *  The thread reads through its own handle of the file, opened with the
+ *  provider the file was read with. Only files opened for reading, other
+ *  than with MP4ReadProgressive(), can prefetch. Calls on the handle
+ *  must still come from one thread at a time.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param numBuffers number of buffers in the pool, 0 to stop
+ *      prefetching and free the buffers.
+ *  @param bufferSize size of each buffer in bytes, 0 for 1 MiB.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ */
+MP4V2_EXPORT
+bool MP4EnablePrefetch(
+    MP4FileHandle hFile,
+    uint32_t      numBuffers DEFAULT(8),
+    uint32_t      bufferSize DEFAULT(0) );
+
+/** File I/O implementations, see MP4SetFileIO(). */
+typedef enum MP4FileIO_e
+{
+    MP4_FILE_IO_STREAM = 0, /**< buffered file streams, the default */
+    MP4_FILE_IO_URING  = 1  /**< io_uring batches, positional reads and writes where unavailable */
+} MP4FileIO;
+
+/** Select the file I/O used by files opened afterwards.
+ *
+ *  MP4SetFileIO chooses how files opened without a custom provider are
+ *  accessed, whether for reading, modifying, creating or optimizing.
+ *
+ *  With #MP4_FILE_IO_URING every read and write is a positional system
+ *  call on the file descriptor, and batches of reads, as issued by
+ *  MP4Optimize(), MP4ReadSamples() and the prefetch thread, are submitted
+ *  to the kernel together through io_uring. Where io_uring is not
+ *  available, on kernels without it or where it is disabled, each run of
+ *  adjacent reads of a batch is one preadv() call instead. On storage
+ *  where the cost per request dominates, such as NVMe, this saves most
+ *  system calls of copying or extracting sample data. Pipes, sockets and
+ *  other files that are not regular files, such as the input of
+ *  MP4StreamOpen(), are read and written in order with plain read() and
+ *  write() calls.
+ *
+ *  The setting is process wide and should be made before files are opened.
+ *
+ *  @param io file I/O to use.
+ *
+ *  @return <b>true</b> on success, <b>false</b> if the platform does not
+ *      support it, as for #MP4_FILE_IO_URING on Windows.
+ */
+MP4V2_EXPORT
+bool MP4SetFileIO(
+    MP4FileIO io );
+
+/** Sample delivered by MP4StreamReadSample(). */
+typedef struct MP4StreamSample_s
+{
+    MP4TrackId     trackId;         /**< track of the sample */
+    MP4SampleId    sampleId;        /**< id of the sample within its track */
+    uint64_t       fileOffset;      /**< offset of the sample data in the stream */
+    const uint8_t* bytes;           /**< sample data, valid until the next call */
+    uint32_t       numBytes;        /**< size of the sample data */
+    MP4Timestamp   startTime;       /**< decoding time in track timescale units */
+    MP4Duration    duration;        /**< duration in track timescale units */
+    MP4Duration    renderingOffset; /**< composition time offset */
+    bool           isSyncSample;    /**< sample is a random access point */
+} MP4StreamSample;
+
+/** Status of MP4StreamReadSample(). */
+typedef enum MP4StreamStatus_e
+{
+    MP4_STREAM_SAMPLE = 0, /**< a sample was delivered */
+    MP4_STREAM_END    = 1, /**< the stream ended after its last sample */
+    MP4_STREAM_ERROR  = 2  /**< the stream is malformed, truncated or unreadable */
+} MP4StreamStatus;
+
+/** Open an mp4 stream for forward-only reading.
+ *
+ *  MP4StreamOpen prepares to demux a stream that can only be read once from
+ *  start to end, such as a pipe, a socket or the body of an HTTP response.
+ *  The stream is never seeked: top-level boxes are parsed as they arrive,
+ *  and samples are delivered in the order their data appears, buffering
+ *  no more than one chunk or track run at a time. Time to the first sample
+ *  is thus independent of the size of the stream.
+ *
+ *  Files with the moov box ahead of their media data, as written by
+ *  MP4Optimize(), and fragmented files can be streamed. A file with media
+ *  data ahead of its moov box makes MP4StreamReadSample() fail.
+ *
+ *  No I/O is done until the first call to MP4StreamGetFile() or
+ *  MP4StreamReadSample().
+ *
+ *  @param name name of the stream passed to the provider, e.g. /dev/stdin
+ *      for the standard provider.
+ *  @param fileProvider custom implementation of file I/O operations, of
+ *      which only open, read and close are called. At the end of the
+ *      stream read must succeed with fewer bytes or none, a failing read
+ *      is reported as #MP4_STREAM_ERROR. If NULL, the standard file I/O
+ *      is used.
+ *
+ *  @return On success a handle of the stream for use in subsequent calls.
+ *      On error, #MP4_INVALID_STREAM_HANDLE.
+ */
+MP4V2_EXPORT
+MP4StreamHandle MP4StreamOpen(
+    const char*            name,
+    const MP4FileProvider* fileProvider DEFAULT(NULL) );
+
+/** Get the movie of an mp4 stream.
+ *
+ *  MP4StreamGetFile reads the stream up to the end of its moov box if that
+ *  has not happened yet, and returns a file handle for querying tracks and
+ *  properties of the movie. Sample data cannot be read through the handle,
+ *  use MP4StreamReadSample() instead. The handle belongs to the stream and
+ *  must not be passed to MP4Close().
+ *
+ *  @param hStream handle of stream for operation.
+ *
+ *  @return On success a handle of the movie.
+ *      On error, #MP4_INVALID_FILE_HANDLE.
+ */
+MP4V2_EXPORT
+MP4FileHandle MP4StreamGetFile(
+    MP4StreamHandle hStream );
+
+/** Read the next sample of an mp4 stream.
+ *
+ *  MP4StreamReadSample delivers the samples of all tracks in the order
+ *  their data is stored. The samples of fragments continue the numbering
+ *  and timeline of the samples declared in the moov box.
+ *
+ *  @param hStream handle of stream for operation.
+ *  @param sample receives the sample. Its data is owned by the stream
+ *      and valid until the next call.
+ *
+ *  @return #MP4_STREAM_SAMPLE when a sample was delivered,
+ *      #MP4_STREAM_END at the end of the stream, or #MP4_STREAM_ERROR
+ *      after which the stream can only be closed.
+ */
+MP4V2_EXPORT
+MP4StreamStatus MP4StreamReadSample(
+    MP4StreamHandle  hStream,
+    MP4StreamSample* sample );
+
+/** Close an mp4 stream.
+ *
+ *  MP4StreamClose closes the stream and frees the movie returned by
+ *  MP4StreamGetFile().
+ *
+ *  @param hStream handle of stream to close.
+ */
+MP4V2_EXPORT
+void MP4StreamClose(
+    MP4StreamHandle hStream );
+
+/** Range of bytes of a file. */
+typedef struct MP4ByteRange_s
+{
+    uint64_t offset; /**< file position of the first byte */
+    uint64_t size;   /**< number of bytes */
+} MP4ByteRange;
+
+/** Status of reading a file that is still arriving. */
+typedef enum MP4ProgressiveStatus_e
+{
+    MP4_PROGRESSIVE_OK      = 0, /**< the operation succeeded */
+    MP4_PROGRESSIVE_PENDING = 1, /**< data has not arrived yet, retry later */
+    MP4_PROGRESSIVE_ERROR   = 2  /**< the operation failed */
+} MP4ProgressiveStatus;
+
+/** Read an existing mp4 file that is still arriving.
+ *
+ *  MP4ReadProgressive is like MP4ReadEx() for a file that is being
+ *  downloaded or written, so playback can start as soon as its header
+ *  boxes and first chunks are available.
+ *
+ *  The file is parsed once all of its top-level boxes other than mdat,
+ *  free and skip have arrived, along with the headers of those. Until
+ *  then the call reports the next range it needs and can be repeated
+ *  whenever more data has arrived. For a file with moov last this is
+ *  the tail of the file, which can be fetched out of order.
+ *
+ *  Sample data of the opened file may still be missing, see
+ *  MP4ReadSampleProgressive() and MP4GetSampleByteRange().
+ *
+ *  @param fileName pathname of the file passed to the provider.
+ *  @param provider progressive implementation of file I/O operations.
+ *  @param flags bitmask of read options, as for MP4ReadEx().
+ *  @param hFile receives the handle of the file on success, for use in
+ *      subsequent calls to the library and to be closed with MP4Close().
+ *  @param pending if non-NULL, receives the range of bytes to wait for
+ *      when the data is not available yet.
+ *
+ *  @return #MP4_PROGRESSIVE_OK when the file was read,
+ *      #MP4_PROGRESSIVE_PENDING when <b>pending</b> has not arrived yet,
+ *      or #MP4_PROGRESSIVE_ERROR on failure.
+ */
+MP4V2_EXPORT
+MP4ProgressiveStatus MP4ReadProgressive(
+    const char*                   fileName,
+    const MP4ProgressiveProvider* provider,
+    uint32_t                      flags,
+    MP4FileHandle*                hFile,
+    MP4ByteRange*                 pending DEFAULT(NULL) );
+
 /** @} ***********************************************************************/
 
 #endif /* MP4V2_FILE_H */
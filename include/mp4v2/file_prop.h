@@ -65,6 +65,85 @@ bool MP4SetBytesProperty(
     const uint8_t* pValue,
     uint32_t       valueSize );
 
+/** Resolve a property path once for repeated access.
+ *
+ *  MP4ResolveProperty parses a property path such as
+ *  "moov.mvhd.timeScale" and returns a handle for the
+ *  MP4GetPropertyHandle and MP4SetPropertyHandle functions. Those skip the
+ *  path parsing and atom tree walk that MP4GetIntegerProperty() and
+ *  friends perform on every call, and take constant time as long as the
+ *  atom tree is not modified. If atoms are added or removed, the path is
+ *  resolved again on next use.
+ *
+ *  The path need not name an existing property: access through the
+ *  handle then fails until the property is created.
+ *
+ *  Resolving the same path again returns the same handle. Handles are
+ *  owned by the file and remain valid until it is closed.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param propName path of the property, from the root of the file.
+ *
+ *  @return On success, a property handle.
+ *      On error, #MP4_INVALID_PROPERTY_HANDLE.
+ *
+ *  @see MP4ResolveTrackProperty().
+ */
+MP4V2_EXPORT
+MP4PropertyHandle MP4ResolveProperty(
+    MP4FileHandle hFile,
+    const char*   propName );
+
+MP4V2_EXPORT
+bool MP4GetPropertyHandleInteger(
+    MP4FileHandle     hFile,
+    MP4PropertyHandle hProperty,
+    uint64_t*         retvalue );
+
+MP4V2_EXPORT
+bool MP4GetPropertyHandleFloat(
+    MP4FileHandle     hFile,
+    MP4PropertyHandle hProperty,
+    float*            retvalue );
+
+MP4V2_EXPORT
+bool MP4GetPropertyHandleString(
+    MP4FileHandle     hFile,
+    MP4PropertyHandle hProperty,
+    const char**      retvalue );
+
+MP4V2_EXPORT
+bool MP4GetPropertyHandleBytes(
+    MP4FileHandle     hFile,
+    MP4PropertyHandle hProperty,
+    uint8_t**         ppValue,
+    uint32_t*         pValueSize );
+
+MP4V2_EXPORT
+bool MP4SetPropertyHandleInteger(
+    MP4FileHandle     hFile,
+    MP4PropertyHandle hProperty,
+    int64_t           value );
+
+MP4V2_EXPORT
+bool MP4SetPropertyHandleFloat(
+    MP4FileHandle     hFile,
+    MP4PropertyHandle hProperty,
+    float             value );
+
+MP4V2_EXPORT
+bool MP4SetPropertyHandleString(
+    MP4FileHandle     hFile,
+    MP4PropertyHandle hProperty,
+    const char*       value );
+
+MP4V2_EXPORT
+bool MP4SetPropertyHandleBytes(
+    MP4FileHandle     hFile,
+    MP4PropertyHandle hProperty,
+    const uint8_t*    pValue,
+    uint32_t          valueSize );
+
 /* specific props */
 
 MP4V2_EXPORT
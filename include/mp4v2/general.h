@@ -15,6 +15,8 @@ typedef uint32_t    MP4SampleId;
 typedef uint64_t    MP4Timestamp;
 typedef uint64_t    MP4Duration;
 typedef uint32_t    MP4EditId;
+typedef void*       MP4PropertyHandle;
+typedef void*       MP4StreamHandle;
 
 typedef enum {
     MP4_LOG_NONE = 0,
@@ -40,6 +42,7 @@ typedef void (*MP4LogCallback)(
  *
  * @see MP4EncAndCopySample().
  * @see MP4EncAndCopyTrack().
+ * @see MP4EncAndCopyTrackPipelined().
  */
 typedef uint32_t (*encryptFunc_t)( uint32_t, uint32_t, uint8_t*, uint32_t*, uint8_t** );
 
@@ -51,6 +54,8 @@ typedef uint32_t (*encryptFunc_t)( uint32_t, uint32_t, uint8_t*, uint32_t*, uint
 #define MP4_INVALID_TIMESTAMP   ((MP4Timestamp)-1)    /**< Constant: invalid MP4Timestamp. */
 #define MP4_INVALID_DURATION    ((MP4Duration)-1)     /**< Constant: invalid MP4Duration. */
 #define MP4_INVALID_EDIT_ID     ((MP4EditId)0)        /**< Constant: invalid MP4EditId. */
+#define MP4_INVALID_PROPERTY_HANDLE ((MP4PropertyHandle)NULL) /**< Constant: invalid MP4PropertyHandle. */
+#define MP4_INVALID_STREAM_HANDLE ((MP4StreamHandle)NULL) /**< Constant: invalid MP4StreamHandle. */
 
 /* Macros to test for API type validity */
 #define MP4_IS_VALID_FILE_HANDLE(x) ((x) != MP4_INVALID_FILE_HANDLE)
@@ -59,6 +64,7 @@ typedef uint32_t (*encryptFunc_t)( uint32_t, uint32_t, uint8_t*, uint32_t*, uint
 #define MP4_IS_VALID_TIMESTAMP(x)   ((x) != MP4_INVALID_TIMESTAMP)
 #define MP4_IS_VALID_DURATION(x)    ((x) != MP4_INVALID_DURATION)
 #define MP4_IS_VALID_EDIT_ID(x)     ((x) != MP4_INVALID_EDIT_ID)
+#define MP4_IS_VALID_PROPERTY_HANDLE(x) ((x) != MP4_INVALID_PROPERTY_HANDLE)
 
 /*
  * MP4 Known track type names - e.g. MP4GetNumberOfTracks(type)
@@ -75,6 +75,58 @@ MP4TrackId MP4EncAndCopyTrack(
     bool                  applyEdits DEFAULT(false),
     MP4TrackId            dstHintTrackReferenceTrack DEFAULT(MP4_INVALID_TRACK_ID) );
 
+/** Encrypt and copy a track using a pool of encryption threads.
+ *
+ *  MP4EncAndCopyTrackPipelined produces the same destination track as
+ *  MP4EncAndCopyTrack() but runs the encryption callback on worker
+ *  threads. Samples are read ahead of the encryption workers and written
+ *  to the destination in sample order on the calling thread. At most
+ *  4 * <b>numThreads</b> samples are in flight at any time, so memory use
+ *  does not grow with the length of the track.
+ *
+ *  The callback contract differs from MP4EncAndCopyTrack():
+ *      @li <b>encfcnp</b> is called concurrently from up to
+ *      <b>numThreads</b> threads, each time with the same
+ *      <b>encfcnparam1</b>. It must be reentrant for that parameter.
+ *      @li calls are not made in sample order, so the output for a sample
+ *      must not depend on which samples were encrypted before it.
+ *      @li the input buffer must not be modified. The output buffer is
+ *      allocated by the callback with malloc() and freed by the library.
+ *      @li a non-zero return fails the copy.
+ *
+ *  Callbacks that keep running state across calls must use
+ *  MP4EncAndCopyTrack() instead.
+ *
+ *  @param srcFile source file handle.
+ *  @param srcTrackId id of track in source file to be copied.
+ *  @param icPp ismacryp session parameters for the new track.
+ *  @param encfcnp encryption callback.
+ *  @param encfcnparam1 opaque value passed to each callback invocation.
+ *  @param numThreads number of encryption threads. Use 0 for one thread
+ *      per online processor.
+ *  @param dstFile handle of destination file. If #MP4_INVALID_FILE_HANDLE
+ *      the copy is created in the source file.
+ *  @param applyEdits if true, edit lists are applied when copying.
+ *  @param dstHintTrackReferenceTrack id of the track in the destination
+ *      file that a copied hint track refers to.
+ *
+ *  @return On success, the id of the new track.
+ *      On error, #MP4_INVALID_TRACK_ID.
+ *
+ *  @see MP4EncAndCopyTrack().
+ */
+MP4V2_EXPORT
+MP4TrackId MP4EncAndCopyTrackPipelined(
+    MP4FileHandle         srcFile,
+    MP4TrackId            srcTrackId,
+    mp4v2_ismacrypParams* icPp,
+    encryptFunc_t         encfcnp,
+    uint32_t              encfcnparam1,
+    uint32_t              numThreads DEFAULT(0),
+    MP4FileHandle         dstFile DEFAULT(MP4_INVALID_FILE_HANDLE),
+    bool                  applyEdits DEFAULT(false),
+    MP4TrackId            dstHintTrackReferenceTrack DEFAULT(MP4_INVALID_TRACK_ID) );
+
 MP4V2_EXPORT
 bool MP4MakeIsmaCompliant(
     const char* fileName,
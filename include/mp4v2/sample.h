@@ -24,6 +24,12 @@ typedef enum MP4SampleDependencyType_e {
     _MP4_SDT_RESERVED                     = 0x80 /**< reserved */
 } MP4SampleDependencyType;
 
+/** Checksum granularities. */
+typedef enum MP4ChecksumGranularity_e {
+    MP4_CHECKSUM_SAMPLE = 0, /**< one digest per sample */
+    MP4_CHECKSUM_CHUNK  = 1  /**< one digest per chunk */
+} MP4ChecksumGranularity;
+
 /** Read a track sample.
  *
  *  MP4ReadSample reads the specified sample from the specified track.
@@ -99,6 +105,38 @@ bool MP4ReadSample(
     MP4Duration*  pRenderingOffset DEFAULT(NULL),
     bool*         pIsSyncSample DEFAULT(NULL) );
 
+/** Read consecutive track samples.
+ *
+ *  MP4ReadSamples reads the data of the samples <b>firstSampleId</b>
+ *  through <b>firstSampleId</b> + <b>numSamples</b> - 1 back to back into
+ *  the caller's buffer. The chunks holding them are read in one batch, so
+ *  that extracting a track in large runs of samples costs few system calls,
+ *  see MP4SetFileIO(). The samples must be stored in the file itself.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param firstSampleId id of the first sample to read.
+ *  @param numSamples number of samples to read.
+ *  @param pBytes buffer receiving the sample data.
+ *  @param numBytes size of the buffer in bytes, at least the sum of the
+ *      sizes of the samples as given by MP4GetSampleSize().
+ *  @param pSampleSizes if non-NULL, array of <b>numSamples</b> entries
+ *      receiving the size of each sample.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ *
+ *  @see MP4ReadSample().
+ */
+MP4V2_EXPORT
+bool MP4ReadSamples(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    MP4SampleId   firstSampleId,
+    uint32_t      numSamples,
+    uint8_t*      pBytes,
+    uint32_t      numBytes,
+    uint32_t*     pSampleSizes DEFAULT(NULL) );
+
 /** Read a track sample based on a specified time.
  *
  *  MP4ReadSampleFromTime is similar to MP4ReadSample() except the sample
@@ -273,6 +311,82 @@ bool MP4WriteSampleDependency(
     bool           isSyncSample,
     uint32_t       dependencyFlags );
 
+/** Write an H.264 sample given in Annex B byte stream format.
+ *
+ *  MP4WriteH264AnnexBSample converts an access unit whose NAL units are
+ *  separated by 00 00 01 or 00 00 00 01 start codes into the length
+ *  prefixed form stored in <b>avc1</b> tracks, using the length size of
+ *  the track's <b>avcC</b> atom, and writes it like MP4WriteSample().
+ *
+ *  Sequence and picture parameter sets found in the access unit are moved
+ *  to <b>avcC</b> with MP4AddH264SequenceParameterSet() and
+ *  MP4AddH264PictureParameterSet() instead of being written to the sample.
+ *  An access unit that holds nothing but parameter sets adds no sample.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of H.264 track for operation.
+ *  @param pBytes pointer to Annex B access unit.
+ *  @param numBytes length of access unit in bytes.
+ *  @param duration sample duration. Caveat: should be in track timescale.
+ *  @param renderingOffset the rendering offset for this sample.
+ *      Caveat: The offset should be in the track timescale.
+ *  @param isSyncSample the sync/random access flag for this sample.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure, including
+ *      input without start codes and NAL units too large for the length
+ *      size of the track.
+ *
+ *  @see MP4WriteSample().
+ *  @see MP4AddH264VideoTrack().
+ */
+MP4V2_EXPORT
+bool MP4WriteH264AnnexBSample(
+    MP4FileHandle  hFile,
+    MP4TrackId     trackId,
+    const uint8_t* pBytes,
+    uint32_t       numBytes,
+    MP4Duration    duration DEFAULT(MP4_INVALID_DURATION),
+    MP4Duration    renderingOffset DEFAULT(0),
+    bool           isSyncSample DEFAULT(true) );
+
+/** Read an H.264 sample in Annex B byte stream format.
+ *
+ *  MP4ReadH264AnnexBSample reads the specified sample of an <b>avc1</b>
+ *  track and replaces the length prefix of each NAL unit with a start
+ *  code. With a length size of 3 or 4 the prefixes are rewritten in place
+ *  in the output buffer, smaller length sizes take an extra copy.
+ *
+ *  If <b>withParameterSets</b> is true, sync samples are preceded by the
+ *  sequence and picture parameter sets of the track's <b>avcC</b> atom so
+ *  the concatenated samples form a decodable elementary stream.
+ *
+ *  Buffer handling is that of MP4ReadSample(): if <b>*ppBytes</b> is NULL
+ *  the library allocates the buffer, which the caller frees with
+ *  MP4Free(); otherwise <b>*pNumBytes</b> gives the size of the caller's
+ *  buffer on input.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of H.264 track for operation.
+ *  @param sampleId which sample is to be read.
+ *  @param ppBytes pointer to the pointer to the sample data.
+ *  @param pNumBytes pointer to variable that will be hold the size in bytes
+ *      of the converted sample.
+ *  @param withParameterSets prepend the avcC parameter sets to sync samples.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure, including a
+ *      caller buffer that is too small and malformed NAL unit lengths.
+ *
+ *  @see MP4ReadSample().
+ */
+MP4V2_EXPORT
+bool MP4ReadH264AnnexBSample(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    MP4SampleId   sampleId,
+    uint8_t**     ppBytes,
+    uint32_t*     pNumBytes,
+    bool          withParameterSets DEFAULT(true) );
+
 /** Make a copy of a sample.
  *
  *  MP4CopySample creates a new sample based on an existing sample. Note that
@@ -552,6 +666,286 @@ int8_t MP4GetSampleSync(
     MP4TrackId    trackId,
     MP4SampleId   sampleId );
 
+/** Get dependency flags of sample.
+ *
+ *  MP4GetSampleDependencyFlags returns the <b>sdtp</b> flags of the
+ *  specified sample. For <b>avc1</b> tracks that were not written with
+ *  MP4WriteSampleDependency() the flags are derived from nal_ref_idc and
+ *  slice_type of the sample's NAL units: a sample of I or SI slices only
+ *  is independent, one of non-reference slices only has no dependents.
+ *  Without an <b>sdtp</b> atom this reads the NAL unit headers of the
+ *  track up to the sample on first use, not the whole samples.
+ *
+ *  The library also derives these flags when writing samples to such
+ *  tracks and when optimizing, and stores them in an <b>sdtp</b> atom.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param sampleId id of sample for operation. Caveat: the first sample has
+ *      id <b>1</b>, not <b>0</b>.
+ *
+ *  @return bitmask of #MP4SampleDependencyType flags, #MP4_SDT_UNKNOWN
+ *      when nothing is known about the sample or on error.
+ */
+MP4V2_EXPORT
+uint32_t MP4GetSampleDependencyFlags(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    MP4SampleId   sampleId );
+
+/** Get next independently decodable sample.
+ *
+ *  MP4GetNextIndependentSample returns the first sample at or after the
+ *  specified one that is a sync sample or is flagged as not depending on
+ *  other samples, see MP4GetSampleDependencyFlags(). Unlike sync samples
+ *  this includes I frames that are not IDR pictures.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param sampleId id of sample to start from.
+ *
+ *  @return On success, the id of the independent sample. If there is none
+ *      or on error, #MP4_INVALID_SAMPLE_ID.
+ */
+MP4V2_EXPORT
+MP4SampleId MP4GetNextIndependentSample(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    MP4SampleId   sampleId );
+
+/** Get samples to decode for trick play.
+ *
+ *  MP4GetTrickPlaySamples selects the samples of a range to decode for
+ *  playback at <b>speed</b> times the normal rate, without decoding
+ *  anything. The finest decodable subset that holds no more than
+ *  1/<b>speed</b> of the range's samples is chosen from: all samples,
+ *  samples without the #MP4_SDT_HAS_NO_DEPENDENTS flag, independent
+ *  samples, and an even selection of independent samples. Samples before
+ *  the first independent one in the range are never selected.
+ *
+ *  For example with speed 4 a stream of reference I and P frames and
+ *  disposable B frames in the pattern IBBBP... drops the B frames, while
+ *  an all-reference IPPP... stream is reduced to its I frames.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param firstSampleId first sample of the range.
+ *  @param lastSampleId last sample of the range, inclusive.
+ *  @param speed playback rate multiplier, 1 selects every decodable sample.
+ *  @param ppSampleIds receives the selected sample ids in increasing
+ *      order, allocated by the library and freed with MP4Free(), or NULL
+ *      when none are selected.
+ *  @param pNumSamples receives the number of selected samples.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ *
+ *  @see MP4GetSampleDependencyFlags().
+ */
+MP4V2_EXPORT
+bool MP4GetTrickPlaySamples(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    MP4SampleId   firstSampleId,
+    MP4SampleId   lastSampleId,
+    uint32_t      speed,
+    MP4SampleId** ppSampleIds,
+    uint32_t*     pNumSamples );
+
+/** Compute checksums of a track's sample data.
+ *
+ *  MP4GetTrackChecksums computes the CRC-32C (Castagnoli) of every sample
+ *  or every chunk of a track. Chunks that follow each other in the file
+ *  are read together in large blocks, and the CRC uses the SSE 4.2 crc32
+ *  instruction where the processor has it, so this runs at about the
+ *  speed of the disk.
+ *
+ *  Per chunk digests are cheaper to store, per sample digests pinpoint a
+ *  corruption more exactly.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param granularity digest per sample or per chunk.
+ *  @param ppChecksums receives the digests in sample or chunk order,
+ *      allocated by the library and freed with MP4Free(), or NULL when the
+ *      track is empty.
+ *  @param pNumChecksums receives the number of digests.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ *
+ *  @see MP4StoreTrackChecksums().
+ */
+MP4V2_EXPORT
+bool MP4GetTrackChecksums(
+    MP4FileHandle          hFile,
+    MP4TrackId             trackId,
+    MP4ChecksumGranularity granularity,
+    uint32_t**             ppChecksums,
+    uint32_t*              pNumChecksums );
+
+/** Store checksums of a track's sample data in the file.
+ *
+ *  MP4StoreTrackChecksums computes the digests of MP4GetTrackChecksums()
+ *  and stores them in a uuid box in the track's udta atom, replacing any
+ *  stored before. The box is written when the file is closed, so store
+ *  after the last sample has been written.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param granularity digest per sample or per chunk.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ *
+ *  @see MP4VerifyTrackChecksums().
+ */
+MP4V2_EXPORT
+bool MP4StoreTrackChecksums(
+    MP4FileHandle          hFile,
+    MP4TrackId             trackId,
+    MP4ChecksumGranularity granularity );
+
+/** Verify a track's sample data against its stored checksums.
+ *
+ *  MP4VerifyTrackChecksums recomputes the digests stored by
+ *  MP4StoreTrackChecksums() and reports the samples that no longer match.
+ *  With per chunk digests every sample of a mismatching chunk is reported.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param ppBadSampleIds receives the ids of corrupted samples in
+ *      increasing order, allocated by the library and freed with
+ *      MP4Free(), or NULL when all samples match.
+ *  @param pNumBadSamples receives the number of corrupted samples.
+ *
+ *  @return <b>true</b> when the verification ran, <b>false</b> on failure,
+ *      for example if the track has no stored checksums or its number of
+ *      samples or chunks changed.
+ */
+MP4V2_EXPORT
+bool MP4VerifyTrackChecksums(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    MP4SampleId** ppBadSampleIds,
+    uint32_t*     pNumBadSamples );
+
+/** Read a track sample of a file that is still arriving.
+ *
+ *  MP4ReadSampleProgressive is like MP4ReadSample() for a file opened
+ *  with MP4ReadProgressive(). When the sample data has not arrived yet
+ *  nothing is read and the call can be repeated later.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param sampleId specifies which sample is to be read.
+ *  @param ppBytes pointer to the pointer to the sample data, as for
+ *      MP4ReadSample().
+ *  @param pNumBytes pointer to variable that will be hold the size in bytes
+ *      of the sample.
+ *  @param pStartTime if non-NULL, receives the starting timestamp.
+ *  @param pDuration if non-NULL, receives the duration.
+ *  @param pRenderingOffset if non-NULL, receives the rendering offset.
+ *  @param pIsSyncSample if non-NULL, receives the sync flag.
+ *
+ *  @return #MP4_PROGRESSIVE_OK when the sample was read,
+ *      #MP4_PROGRESSIVE_PENDING when its data has not arrived yet,
+ *      or #MP4_PROGRESSIVE_ERROR on failure.
+ *
+ *  @see MP4GetSampleByteRange().
+ */
+MP4V2_EXPORT
+MP4ProgressiveStatus MP4ReadSampleProgressive(
+    /* input parameters */
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    MP4SampleId   sampleId,
+    /* input/output parameters */
+    uint8_t** ppBytes,
+    uint32_t* pNumBytes,
+    /* output parameters */
+    MP4Timestamp* pStartTime DEFAULT(NULL),
+    MP4Duration*  pDuration DEFAULT(NULL),
+    MP4Duration*  pRenderingOffset DEFAULT(NULL),
+    bool*         pIsSyncSample DEFAULT(NULL) );
+
+/** Get the bytes of a track sample.
+ *
+ *  MP4GetSampleByteRange reports where the data MP4ReadSample() reads
+ *  for a sample is stored, so a progressive download can fetch it.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param sampleId id of the sample.
+ *  @param range receives the range of the sample data.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure, for example if
+ *      the sample is stored in another file.
+ */
+MP4V2_EXPORT
+bool MP4GetSampleByteRange(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    MP4SampleId   sampleId,
+    MP4ByteRange* range );
+
+/** Get the bytes needed to decode a track sample at a time.
+ *
+ *  MP4GetSampleByteRangeFromTime reports the range holding the data of
+ *  the sample at <b>when</b>, as chosen by MP4GetSampleIdFromTime(), and
+ *  of all samples from the preceding sync sample on, which decoding it
+ *  depends on. The range may include data of other tracks.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param when time in the track timeline, in track timescale units.
+ *  @param range receives the range of the sample data.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ */
+MP4V2_EXPORT
+bool MP4GetSampleByteRangeFromTime(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    MP4Timestamp  when,
+    MP4ByteRange* range );
+
+/** Get the bytes of several tracks needed for a time window.
+ *
+ *  MP4GetByteRangesForTime plans the reads for playing <b>trackIds</b>
+ *  from <b>startTime</b> to <b>endTime</b>, e.g. to issue HTTP range
+ *  requests or prefetch from object storage. The sample tables of each
+ *  track are walked once, chunk by chunk, and the extents of all tracks
+ *  are sorted and merged, so a few large reads replace one per sample.
+ *
+ *  Each track contributes the samples overlapping the window, starting
+ *  with the sync sample that decoding the first of them depends on.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackIds ids of the tracks to play.
+ *  @param numTracks number of ids in <b>trackIds</b>.
+ *  @param startTime start of the window in the movie timescale.
+ *  @param endTime end of the window, exclusive, in the movie timescale.
+ *  @param maxGap extents no more than this many bytes apart are merged,
+ *      trading unneeded bytes for fewer reads. 0 merges adjacent extents
+ *      only.
+ *  @param ppRanges receives the ranges in increasing offset order,
+ *      allocated by the library and freed with MP4Free(), or NULL when
+ *      the window holds no samples.
+ *  @param pNumRanges receives the number of ranges.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ *
+ *  @see MP4GetSampleByteRangeFromTime().
+ */
+MP4V2_EXPORT
+bool MP4GetByteRangesForTime(
+    MP4FileHandle     hFile,
+    const MP4TrackId* trackIds,
+    uint32_t          numTracks,
+    MP4Timestamp      startTime,
+    MP4Timestamp      endTime,
+    uint64_t          maxGap,
+    MP4ByteRange**    ppRanges,
+    uint32_t*         pNumRanges );
+
 /* @} ***********************************************************************/
 
 #endif /* MP4V2_SAMPLE_H */
@@ -101,6 +101,100 @@ bool MP4ReadRtpPacket(
     bool          includeHeader DEFAULT(true),
     bool          includePayload DEFAULT(true) );
 
+/** Location of one packet written by MP4ReadRtpHintPackets(). */
+typedef struct MP4RtpIovec_s
+{
+    uint8_t* base;   /**< first byte of the packet */
+    uint32_t length; /**< packet length in bytes */
+} MP4RtpIovec;
+
+/** Write all packets of the current hint into a caller buffer.
+ *
+ *  MP4ReadRtpHintPackets writes each packet of the hint last read with
+ *  MP4ReadRtpHint() back to back into <b>pBuffer</b> and describes it with
+ *  one entry of <b>pPackets</b>, in packet order. The entries map directly
+ *  onto struct iovec, so the whole hint can be handed to sendmmsg() or a
+ *  similar scatter/gather call without further copying.
+ *
+ *  Together with MP4ReadRtpHint(), which reuses its hint objects and
+ *  sample buffer from one hint to the next, this reads a hint track
+ *  without per-packet heap allocation once the buffers have reached their
+ *  working size.
+ *
+ *  If either the buffer or the packet array is too small, nothing is
+ *  written, false is returned and the required sizes are reported in
+ *  <b>pBufferSize</b> and <b>pNumPackets</b>.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param hintTrackId id of the hint track.
+ *  @param pBuffer buffer to receive the packet bytes.
+ *  @param pBufferSize on input the size of <b>pBuffer</b>, on output the
+ *      number of bytes needed for all packets.
+ *  @param pPackets array to receive one entry per packet.
+ *  @param pNumPackets on input the number of entries in <b>pPackets</b>,
+ *      on output the number of packets in the hint.
+ *  @param ssrc RTP synchronization source written into each header.
+ *  @param includeHeader if true, each packet starts with its RTP header.
+ *  @param includePayload if true, each packet includes its payload.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ *
+ *  @see MP4ReadRtpPacket().
+ */
+MP4V2_EXPORT
+bool MP4ReadRtpHintPackets(
+    MP4FileHandle hFile,
+    MP4TrackId    hintTrackId,
+    uint8_t*      pBuffer,
+    uint32_t*     pBufferSize,
+    MP4RtpIovec*  pPackets,
+    uint32_t*     pNumPackets,
+    uint32_t      ssrc DEFAULT(0),
+    bool          includeHeader DEFAULT(true),
+    bool          includePayload DEFAULT(true) );
+
+/** Set the capacity of a track's sample cache.
+ *
+ *  Packets read with MP4ReadRtpPacket() copy payload from the samples of
+ *  the hint track's reference track. Those samples are kept in a per-track
+ *  least-recently-used cache so that packets referring to several samples
+ *  in turn do not re-read them. The default capacity is 2 MB.
+ *
+ *  The most recently read sample is always kept, so a capacity of 0 caches
+ *  exactly one sample.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of the media track, not the hint track.
+ *  @param maxBytes cache capacity in bytes.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ */
+MP4V2_EXPORT
+bool MP4SetTrackSampleCacheSize(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    uint32_t      maxBytes );
+
+/** Get hit and miss counters of a track's sample cache.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of the media track, not the hint track.
+ *  @param pHits if not NULL, receives the number of cache hits.
+ *  @param pMisses if not NULL, receives the number of cache misses.
+ *  @param reset if true, the counters are reset after being read.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ *
+ *  @see MP4SetTrackSampleCacheSize().
+ */
+MP4V2_EXPORT
+bool MP4GetTrackSampleCacheStats(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    uint64_t*     pHits,
+    uint64_t*     pMisses,
+    bool          reset DEFAULT(false) );
+
 MP4V2_EXPORT
 MP4Timestamp MP4GetRtpTimestampStart(
     MP4FileHandle hFile,
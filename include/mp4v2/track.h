@@ -376,6 +376,40 @@ MP4TrackId MP4CopyTrack(
     bool          applyEdits DEFAULT(false),
     MP4TrackId    dstHintTrackReferenceTrack DEFAULT(MP4_INVALID_TRACK_ID) );
 
+/** Copy several tracks with interleaved output.
+ *
+ *  MP4CopyTracks clones each of the source tracks into the destination file
+ *  and then copies their samples in a single pass. Unlike calling
+ *  MP4CopyTrack() once per track, samples of all tracks are written in
+ *  decode-time order, so the chunks of the new tracks are interleaved in
+ *  the destination mdat much as MP4Optimize() would order them. Source
+ *  samples are read a whole chunk at a time rather than one sample at a time.
+ *
+ *  A hint track is only copied if its reference track is also listed in
+ *  <b>srcTrackIds</b>; the copy then references the new track.
+ *
+ *  @param srcFile handle of file containing the tracks to copy.
+ *  @param srcTrackIds array of source track-ids.
+ *  @param numTracks number of entries in <b>srcTrackIds</b>.
+ *  @param dstFile handle of file for new tracks, or #MP4_INVALID_FILE_HANDLE
+ *      to copy into the source file.
+ *  @param dstTrackIds array of <b>numTracks</b> entries receiving the
+ *      track-ids of the new tracks, or NULL.
+ *  @param applyEdits if <b>true</b> sample selection and durations follow
+ *      each source track's edit list.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure. On failure no
+ *      new tracks remain in the destination file.
+ */
+MP4V2_EXPORT
+bool MP4CopyTracks(
+    MP4FileHandle     srcFile,
+    const MP4TrackId* srcTrackIds,
+    uint32_t          numTracks,
+    MP4FileHandle     dstFile DEFAULT(MP4_INVALID_FILE_HANDLE),
+    MP4TrackId*       dstTrackIds DEFAULT(NULL),
+    bool              applyEdits DEFAULT(false) );
+
 MP4V2_EXPORT
 bool MP4DeleteTrack(
     MP4FileHandle hFile,
@@ -192,6 +192,39 @@ uint32_t MP4GetTrackBitRate(
     MP4FileHandle hFile,
     MP4TrackId    trackId );
 
+/** Track sample statistics. */
+typedef struct MP4TrackStats_s
+{
+    uint32_t    numSamples;    /**< number of samples */
+    uint64_t    totalBytes;    /**< sum of all sample sizes in bytes */
+    uint32_t    maxSampleSize; /**< largest sample size in bytes */
+    uint32_t    avgBitrate;    /**< average bitrate in bits per second */
+    uint32_t    maxBitrate;    /**< peak bitrate over one second in bits per second */
+    MP4Duration duration;      /**< media duration in track timescale units */
+} MP4TrackStats;
+
+/** Get track sample statistics.
+ *
+ *  MP4GetTrackStats reports size and bitrate statistics for a track. For
+ *  a track being written the values are maintained as each sample is
+ *  written, so this may be called at any time during recording at
+ *  constant cost. For other tracks the sample tables are scanned.
+ *
+ *  The values match those recorded in the esds decoder configuration
+ *  when the file is closed.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param stats structure to receive the statistics.
+ *
+ *  @return <b>true</b> on success, <b>false</b> on failure.
+ */
+MP4V2_EXPORT
+bool MP4GetTrackStats(
+    MP4FileHandle  hFile,
+    MP4TrackId     trackId,
+    MP4TrackStats* stats );
+
 MP4V2_EXPORT
 bool MP4GetTrackVideoMetadata(
     MP4FileHandle hFile,
@@ -332,6 +365,29 @@ bool MP4SetTrackBytesProperty(
     const uint8_t* pValue,
     uint32_t       valueSize);
 
+/** Resolve a track property path once for repeated access.
+ *
+ *  MP4ResolveTrackProperty is the track counterpart of
+ *  MP4ResolveProperty(). The path is relative to the track, as for
+ *  MP4GetTrackIntegerProperty(), e.g. "mdia.minf.stbl.stsd.*.width", and
+ *  the handle follows the track if other tracks are added or deleted.
+ *
+ *  Handles are owned by the track and remain valid until the file is
+ *  closed or the track is deleted.
+ *
+ *  @param hFile handle of file for operation.
+ *  @param trackId id of track for operation.
+ *  @param propName path of the property within the track.
+ *
+ *  @return On success, a property handle.
+ *      On error, #MP4_INVALID_PROPERTY_HANDLE.
+ */
+MP4V2_EXPORT
+MP4PropertyHandle MP4ResolveTrackProperty(
+    MP4FileHandle hFile,
+    MP4TrackId    trackId,
+    const char*   propName );
+
 /** @} ***********************************************************************/
 
 #endif /* MP4V2_TRACK_PROP_H */
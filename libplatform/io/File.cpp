@@ -10,6 +10,32 @@ namespace {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+bool
+FileProvider::readBatch( Transfer* transfers, uint32_t count )
+{
+    for( uint32_t i = 0; i < count; i++ ) {
+        Transfer& t = transfers[i];
+        t.count = 0;
+        if( seek( t.pos ) || read( t.buffer, t.size, t.count, 0 ))
+            return true;
+    }
+    return false;
+}
+
+bool
+FileProvider::writeBatch( Transfer* transfers, uint32_t count )
+{
+    for( uint32_t i = 0; i < count; i++ ) {
+        Transfer& t = transfers[i];
+        t.count = 0;
+        if( seek( t.pos ) || write( t.buffer, t.size, t.count, 0 ))
+            return true;
+    }
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 File::File( std::string name_, Mode mode_, FileProvider* provider_ )
     : _name     ( name_ )
     , _isOpen   ( false )
@@ -63,7 +89,8 @@ File::open( std::string name_, Mode mode_ )
     if( _provider.open( _name, _mode ))
         return true;
 
-    FileSystem::getFileSize( _name, _size );
+    if( _provider.getSize( _size ))
+        FileSystem::getFileSize( _name, _size );
 
     _isOpen = true;
     return false;
@@ -117,6 +144,36 @@ File::write( const void* buffer, Size size, Size& nout, Size maxChunkSize )
     return false;
 }
 
+bool
+File::pending( Size pos, Size size )
+{
+    return _isOpen && _provider.pending( pos, size );
+}
+
+bool
+File::readBatch( Transfer* transfers, uint32_t count )
+{
+    if( !_isOpen )
+        return true;
+
+    const bool failed = _provider.readBatch( transfers, count );
+    return _provider.seek( _position ) || failed;
+}
+
+bool
+File::writeBatch( Transfer* transfers, uint32_t count )
+{
+    if( !_isOpen )
+        return true;
+
+    const bool failed = _provider.writeBatch( transfers, count );
+    for( uint32_t i = 0; i < count; i++ ) {
+        if( transfers[i].pos + transfers[i].count > _size )
+            _size = transfers[i].pos + transfers[i].count;
+    }
+    return _provider.seek( _position ) || failed;
+}
+
 bool
 File::close()
 {
@@ -182,4 +239,24 @@ CustomFileProvider::close()
 
 ///////////////////////////////////////////////////////////////////////////////
 
+ProgressiveFileProvider::ProgressiveFileProvider( const MP4ProgressiveProvider& provider )
+    : CustomFileProvider( provider.file )
+{
+    memcpy( &_progressive, &provider, sizeof(MP4ProgressiveProvider) );
+}
+
+bool
+ProgressiveFileProvider::getSize( Size& size )
+{
+    return _progressive.size( _handle, &size );
+}
+
+bool
+ProgressiveFileProvider::pending( Size pos, Size size )
+{
+    return _progressive.pending( _handle, pos, size );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 }}} // namespace mp4v2::platform::io
@@ -8,8 +8,17 @@ namespace mp4v2 { namespace platform { namespace io {
 class MP4V2_EXPORT FileProvider
 {
 public:
+    //! implementations returned by standard()
+    enum Standard {
+        STANDARD_STREAM, //!< buffered file streams
+        STANDARD_URING,  //!< io_uring batches, positional reads/writes where unavailable
+    };
+
     static FileProvider& standard();
 
+    //! selects the implementation of standard(), true if not supported
+    static bool setStandard( Standard );
+
 public:
     //! file operation mode flags
     enum Mode {
@@ -22,6 +31,14 @@ public:
     //! type used to represent all file sizes and offsets
     typedef int64_t Size;
 
+    //! one read or write of a batch
+    struct Transfer {
+        Size  pos;      //!< file position in bytes
+        void* buffer;   //!< data read or written
+        Size  size;     //!< number of bytes to transfer
+        Size  count;    //!< output: bytes transferred, short only at end-of-file
+    };
+
 public:
     virtual ~FileProvider() { }
 
@@ -31,6 +48,15 @@ public:
     virtual bool write( const void* buffer, Size size, Size& nout, Size maxChunkSize ) = 0;
     virtual bool close() = 0;
 
+    //! size of a file whose data is still arriving, true if not known
+    virtual bool getSize( Size& size ) { return true; }
+    //! true if some of <b>size</b> bytes at <b>pos</b> cannot be read yet
+    virtual bool pending( Size pos, Size size ) { return false; }
+
+    //! performs every transfer, leaving the position undefined, true on failure
+    virtual bool readBatch( Transfer* transfers, uint32_t count );
+    virtual bool writeBatch( Transfer* transfers, uint32_t count );
+
 protected:
     FileProvider() { }
 };
@@ -163,6 +189,58 @@ public:
 
     bool write( const void* buffer, Size size, Size& nout, Size maxChunkSize = 0 );
 
+    ///////////////////////////////////////////////////////////////////////////
+    //!
+    //! Check data availability.
+    //!
+    //! Files that are still being downloaded or written report the bytes
+    //! that have not arrived yet, all others are complete.
+    //!
+    //! @param pos file position in bytes.
+    //! @param size number of bytes from <b>pos</b>.
+    //!
+    //! @return true if some of the bytes cannot be read yet, false otherwise.
+    //!
+    ///////////////////////////////////////////////////////////////////////////
+
+    bool pending( Size pos, Size size );
+
+    ///////////////////////////////////////////////////////////////////////////
+    //!
+    //! Batch read.
+    //!
+    //! Reads every transfer at its own position, handing them to the
+    //! operating system together where the provider supports it. The file
+    //! position is left unchanged.
+    //!
+    //! @param transfers reads to perform, the bytes read by each are
+    //!     returned in its <b>count</b>.
+    //! @param count number of transfers.
+    //!
+    //! @return true on failure, false on success.
+    //!
+    ///////////////////////////////////////////////////////////////////////////
+
+    bool readBatch( Transfer* transfers, uint32_t count );
+
+    ///////////////////////////////////////////////////////////////////////////
+    //!
+    //! Batch write.
+    //!
+    //! Writes every transfer at its own position, handing them to the
+    //! operating system together where the provider supports it. The file
+    //! position is left unchanged.
+    //!
+    //! @param transfers writes to perform, the bytes written by each are
+    //!     returned in its <b>count</b>.
+    //! @param count number of transfers.
+    //!
+    //! @return true on failure, false on success.
+    //!
+    ///////////////////////////////////////////////////////////////////////////
+
+    bool writeBatch( Transfer* transfers, uint32_t count );
+
 private:
     std::string   _name;
     bool          _isOpen;
@@ -196,13 +274,27 @@ public:
     bool write( const void* buffer, Size size, Size& nout, Size maxChunkSize );
     bool close();
 
-private:
+protected:
     MP4FileProvider _call;
     void*           _handle;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+class ProgressiveFileProvider : public CustomFileProvider
+{
+public:
+    ProgressiveFileProvider( const MP4ProgressiveProvider& );
+
+    bool getSize( Size& size );
+    bool pending( Size pos, Size size );
+
+private:
+    MP4ProgressiveProvider _progressive;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 }}} // namespace mp4v2::platform::io
 
 #endif // MP4V2_PLATFORM_IO_FILE_H
@@ -1,4 +1,15 @@
 #include "libplatform/impl.h"
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#ifdef HAVE_LINUX_IO_URING_H
+#   include <linux/io_uring.h>
+#   include <sys/mman.h>
+#   include <sys/syscall.h>
+#   if defined( __NR_io_uring_setup ) && defined( __NR_io_uring_enter )
+#       define MP4V2_USE_URING
+#   endif
+#endif
 
 namespace mp4v2 { namespace platform { namespace io {
 
@@ -73,9 +84,14 @@ bool
 StandardFileProvider::read( void* buffer, Size size, Size& nin, Size maxChunkSize )
 {
     _fstream.read( (char*)buffer, size );
+    nin = _fstream.gcount();
+    if( _fstream.eof() && !_fstream.bad() ) {
+        // short read at end-of-file, as ReadFile() reports it on win32
+        _fstream.clear();
+        return false;
+    }
     if( _fstream.fail() )
         return true;
-    nin = _fstream.gcount();
     return false;
 }
 
@@ -98,12 +114,654 @@ StandardFileProvider::close()
 
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace {
+    FileProvider::Standard __standard = FileProvider::STANDARD_STREAM;
+
+#ifdef IOV_MAX
+    const uint32_t __maxVectors = IOV_MAX;
+#else
+    const uint32_t __maxVectors = 16;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef MP4V2_USE_URING
+
+// Minimal io_uring: one submission queue of vectored reads and writes and
+// its completion queue, driven from a single thread.
+class Ring
+{
+public:
+    Ring();
+    ~Ring();
+
+    bool     setup( unsigned entries );
+    unsigned entries() const { return _entries; }
+
+    void prepare( bool write, int fd, const struct iovec* iov, unsigned n,
+                  FileProvider::Size pos, uint64_t data );
+    bool enter( unsigned wait );
+    bool complete( uint64_t& data, int& res );
+
+private:
+    int            _fd;
+    unsigned       _entries;
+    unsigned       _queued;     // prepared but not yet taken by the kernel
+    void*          _sqMap;
+    size_t         _sqMapSize;
+    void*          _cqMap;
+    size_t         _cqMapSize;
+    io_uring_sqe*  _sqes;
+    size_t         _sqesSize;
+    unsigned*      _sqTail;
+    unsigned*      _sqMask;
+    unsigned*      _sqArray;
+    unsigned*      _cqHead;
+    unsigned*      _cqTail;
+    unsigned*      _cqMask;
+    io_uring_cqe*  _cqes;
+};
+
+Ring::Ring()
+    : _fd        ( -1 )
+    , _entries   ( 0 )
+    , _queued    ( 0 )
+    , _sqMap     ( MAP_FAILED )
+    , _sqMapSize ( 0 )
+    , _cqMap     ( MAP_FAILED )
+    , _cqMapSize ( 0 )
+    , _sqes      ( (io_uring_sqe*)MAP_FAILED )
+    , _sqesSize  ( 0 )
+{
+}
+
+Ring::~Ring()
+{
+    if( _sqes != MAP_FAILED )
+        munmap( _sqes, _sqesSize );
+    if( _cqMap != MAP_FAILED )
+        munmap( _cqMap, _cqMapSize );
+    if( _sqMap != MAP_FAILED )
+        munmap( _sqMap, _sqMapSize );
+    if( _fd >= 0 )
+        ::close( _fd );
+}
+
+bool
+Ring::setup( unsigned entries_ )
+{
+    io_uring_params params;
+    memset( &params, 0, sizeof(params) );
+    _fd = int( syscall( __NR_io_uring_setup, entries_, &params ));
+    if( _fd < 0 )
+        return true;
+
+    _sqMapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _sqMap = mmap( NULL, _sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   _fd, IORING_OFF_SQ_RING );
+    _cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    _cqMap = mmap( NULL, _cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   _fd, IORING_OFF_CQ_RING );
+    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    _sqes = (io_uring_sqe*)mmap( NULL, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                 _fd, IORING_OFF_SQES );
+    if( _sqMap == MAP_FAILED || _cqMap == MAP_FAILED || _sqes == MAP_FAILED )
+        return true;
+
+    uint8_t* sq = (uint8_t*)_sqMap;
+    uint8_t* cq = (uint8_t*)_cqMap;
+    _sqTail  = (unsigned*)( sq + params.sq_off.tail );
+    _sqMask  = (unsigned*)( sq + params.sq_off.ring_mask );
+    _sqArray = (unsigned*)( sq + params.sq_off.array );
+    _cqHead  = (unsigned*)( cq + params.cq_off.head );
+    _cqTail  = (unsigned*)( cq + params.cq_off.tail );
+    _cqMask  = (unsigned*)( cq + params.cq_off.ring_mask );
+    _cqes    = (io_uring_cqe*)( cq + params.cq_off.cqes );
+    _entries = params.sq_entries;
+    return false;
+}
+
+// the caller keeps no more than entries() operations in flight
+void
+Ring::prepare( bool write, int fd, const struct iovec* iov, unsigned n,
+               FileProvider::Size pos, uint64_t data )
+{
+    const unsigned tail = *_sqTail;
+    const unsigned index = tail & *_sqMask;
+
+    io_uring_sqe& sqe = _sqes[index];
+    memset( &sqe, 0, sizeof(sqe) );
+    sqe.opcode    = write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe.fd        = fd;
+    sqe.off       = uint64_t( pos );
+    sqe.addr      = uint64_t( uintptr_t( iov ));
+    sqe.len       = n;
+    sqe.user_data = data;
+
+    _sqArray[index] = index;
+    __atomic_store_n( _sqTail, tail + 1, __ATOMIC_RELEASE );
+    _queued++;
+}
+
+// submits the prepared operations and waits for <wait> completions
+bool
+Ring::enter( unsigned wait )
+{
+    for( ;; ) {
+        const int n = int( syscall( __NR_io_uring_enter, _fd, _queued, wait,
+                                    wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0 ));
+        if( n >= 0 ) {
+            _queued -= unsigned( n );
+            return false;
+        }
+        if( errno != EINTR )
+            return true;
+    }
+}
+
+bool
+Ring::complete( uint64_t& data, int& res )
+{
+    const unsigned head = *_cqHead;
+    if( head == __atomic_load_n( _cqTail, __ATOMIC_ACQUIRE ))
+        return false;
+
+    const io_uring_cqe& cqe = _cqes[head & *_cqMask];
+    data = cqe.user_data;
+    res = cqe.res;
+    __atomic_store_n( _cqHead, head + 1, __ATOMIC_RELEASE );
+    return true;
+}
+
+#endif // MP4V2_USE_URING
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Positional I/O on a file descriptor.
+///
+/// Reads and writes are pread()/pwrite() at the current position, small
+/// ones going through a buffer as with a stream so that parsing and
+/// writing atoms a few bytes at a time costs few system calls. A batch is
+/// split in runs of transfers that follow each other in the file, each
+/// run being one vectored operation. The runs are submitted together
+/// through an io_uring, or one preadv()/pwritev() call each where the
+/// ring is not available. Files other than regular ones, such as pipes,
+/// are read and written in order with read()/write().
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class UringFileProvider : public FileProvider
+{
+public:
+    UringFileProvider();
+    ~UringFileProvider();
+
+    bool open( std::string name, Mode mode );
+    bool seek( Size pos );
+    bool read( void* buffer, Size size, Size& nin, Size maxChunkSize );
+    bool write( const void* buffer, Size size, Size& nout, Size maxChunkSize );
+    bool close();
+
+    bool readBatch( Transfer* transfers, uint32_t count );
+    bool writeBatch( Transfer* transfers, uint32_t count );
+
+private:
+    // transfers first..first+count-1, adjacent in the file from pos
+    struct Run {
+        uint32_t first;
+        uint32_t count;
+        Size     pos;
+        Size     size;
+        Size     done;
+    };
+
+    static const unsigned RingEntries = 64;
+    static const Size     BufferSize = 64 * 1024;
+
+    bool     readAt( void* buffer, Size size, Size pos, Size& nin );
+    bool     writeAt( const void* buffer, Size size, Size pos );
+    bool     flush();
+    bool     transfer( Transfer* transfers, uint32_t count, bool write );
+    uint32_t vectors( Transfer* transfers, const Run& run );
+    ssize_t  transferAt( const struct iovec* iov, uint32_t n, Size pos, bool write );
+    void     finish( Transfer* transfers, const Run& run );
+#ifdef MP4V2_USE_URING
+    bool     submit( Transfer* transfers, bool write );
+#endif
+
+private:
+    int                   _fd;
+    Size                  _position;
+    vector<uint8_t>       _buffer;      // data read ahead, or written and not flushed
+    Size                  _bufferPos;
+    Size                  _bufferLength;
+    bool                  _dirty;
+    bool                  _sequential;  // not a regular file, plain read()/write()
+    vector<Run>           _runs;
+    vector<struct iovec>  _iov;         // slot i belongs to transfer i
+#ifdef MP4V2_USE_URING
+    Ring*                 _ring;
+    bool                  _ringFailed;  // kernel refused, use the fallback
+#endif
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+UringFileProvider::UringFileProvider()
+    : _fd           ( -1 )
+    , _position     ( 0 )
+    , _bufferPos    ( 0 )
+    , _bufferLength ( 0 )
+    , _dirty        ( false )
+    , _sequential   ( false )
+#ifdef MP4V2_USE_URING
+    , _ring         ( NULL )
+    , _ringFailed   ( false )
+#endif
+{
+}
+
+UringFileProvider::~UringFileProvider()
+{
+    close();
+#ifdef MP4V2_USE_URING
+    delete _ring;
+#endif
+}
+
+bool
+UringFileProvider::open( std::string name, Mode mode )
+{
+    int flags;
+    switch( mode ) {
+        case MODE_UNDEFINED:
+        case MODE_READ:
+        default:
+            flags = O_RDONLY;
+            break;
+
+        case MODE_MODIFY:
+            flags = O_RDWR;
+            break;
+
+        case MODE_CREATE:
+            flags = O_RDWR | O_CREAT | O_TRUNC;
+            break;
+    }
+
+    _fd = ::open( name.c_str(), flags, 0666 );
+    _position = 0;
+    _bufferLength = 0;
+    _dirty = false;
+    if( _fd < 0 )
+        return true;
+
+    // pipes, sockets and devices have no positions to read or write at
+    struct stat st;
+    if( fstat( _fd, &st )) {
+        close();
+        return true;
+    }
+    _sequential = !S_ISREG( st.st_mode );
+    return false;
+}
+
+bool
+UringFileProvider::seek( Size pos )
+{
+    if( _sequential && pos != _position )
+        return true;
+    _position = pos;
+    return false;
+}
+
+bool
+UringFileProvider::read( void* buffer, Size size, Size& nin, Size maxChunkSize )
+{
+    nin = 0;
+    if( flush() )
+        return true;
+
+    if( size >= BufferSize || _sequential ) {
+        if( readAt( buffer, size, _position, nin ))
+            return true;
+        _position += nin;
+        return false;
+    }
+
+    if( _position < _bufferPos || _position + size > _bufferPos + _bufferLength ) {
+        _buffer.resize( BufferSize );
+        _bufferPos = _position;
+        if( readAt( &_buffer[0], BufferSize, _position, _bufferLength )) {
+            // a partial fill must not be served later
+            _bufferLength = 0;
+            return true;
+        }
+    }
+
+    nin = max( Size( 0 ), min( size, _bufferPos + _bufferLength - _position ));
+    memcpy( buffer, &_buffer[size_t( _position - _bufferPos )], size_t( nin ));
+    _position += nin;
+    return false;
+}
+
+bool
+UringFileProvider::write( const void* buffer, Size size, Size& nout, Size maxChunkSize )
+{
+    nout = 0;
+    if( !_dirty )
+        _bufferLength = 0;
+    if( _dirty && (_bufferPos + _bufferLength != _position || _bufferLength + size > BufferSize) ) {
+        if( flush() )
+            return true;
+    }
+
+    if( size >= BufferSize || _sequential ) {
+        if( writeAt( buffer, size, _position ))
+            return true;
+    }
+    else {
+        _buffer.resize( BufferSize );
+        if( !_dirty ) {
+            _bufferPos = _position;
+            _dirty = true;
+        }
+        memcpy( &_buffer[size_t( _bufferLength )], buffer, size_t( size ));
+        _bufferLength += size;
+    }
+
+    nout = size;
+    _position += size;
+    return false;
+}
+
+bool
+UringFileProvider::close()
+{
+    if( _fd < 0 )
+        return false;
+    const bool failed = flush();
+    const int result = ::close( _fd );
+    _fd = -1;
+    _bufferLength = 0;
+    return failed || result != 0;
+}
+
+bool
+UringFileProvider::readBatch( Transfer* transfers, uint32_t count )
+{
+    if( _sequential )
+        return FileProvider::readBatch( transfers, count );
+    return flush() || transfer( transfers, count, false );
+}
+
+bool
+UringFileProvider::writeBatch( Transfer* transfers, uint32_t count )
+{
+    if( _sequential )
+        return FileProvider::writeBatch( transfers, count );
+    if( flush() )
+        return true;
+    _bufferLength = 0;
+    return transfer( transfers, count, true );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool
+UringFileProvider::readAt( void* buffer, Size size, Size pos, Size& nin )
+{
+    nin = 0;
+    while( nin < size ) {
+        const ssize_t n = _sequential
+            ? ::read( _fd, (uint8_t*)buffer + nin, size_t( size - nin ))
+            : ::pread( _fd, (uint8_t*)buffer + nin, size_t( size - nin ), pos + nin );
+        if( n < 0 && errno == EINTR )
+            continue;
+        if( n < 0 )
+            return true;
+        if( n == 0 )
+            break;
+        nin += n;
+    }
+    return false;
+}
+
+bool
+UringFileProvider::writeAt( const void* buffer, Size size, Size pos )
+{
+    Size nout = 0;
+    while( nout < size ) {
+        const ssize_t n = _sequential
+            ? ::write( _fd, (const uint8_t*)buffer + nout, size_t( size - nout ))
+            : ::pwrite( _fd, (const uint8_t*)buffer + nout, size_t( size - nout ), pos + nout );
+        if( n < 0 && errno == EINTR )
+            continue;
+        if( n <= 0 )
+            return true;
+        nout += n;
+    }
+    return false;
+}
+
+// writes out what write() collected, leaving the buffer empty
+bool
+UringFileProvider::flush()
+{
+    if( !_dirty )
+        return false;
+    _dirty = false;
+    const Size length = _bufferLength;
+    _bufferLength = 0;
+    return writeAt( &_buffer[0], length, _bufferPos );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool
+UringFileProvider::transfer( Transfer* transfers, uint32_t count, bool write )
+{
+#if defined( HAVE_PREADV ) && defined( HAVE_PWRITEV )
+    const uint32_t maxVectors = __maxVectors;
+#else
+    const uint32_t maxVectors = 1;
+#endif
+
+    _runs.clear();
+    for( uint32_t i = 0; i < count; i++ ) {
+        Transfer& t = transfers[i];
+        t.count = 0;
+        if( t.size == 0 )
+            continue;
+
+        if( !_runs.empty() ) {
+            Run& last = _runs.back();
+            if( last.first + last.count == i && last.pos + last.size == t.pos && last.count < maxVectors ) {
+                last.count++;
+                last.size += t.size;
+                continue;
+            }
+        }
+        Run run;
+        run.first = i;
+        run.count = 1;
+        run.pos   = t.pos;
+        run.size  = t.size;
+        run.done  = 0;
+        _runs.push_back( run );
+    }
+    if( _runs.empty() )
+        return false;
+    if( _iov.size() < count )
+        _iov.resize( count );
+
+#ifdef MP4V2_USE_URING
+    if( !_ring && !_ringFailed ) {
+        _ring = new Ring();
+        if( _ring->setup( RingEntries )) {
+            delete _ring;
+            _ring = NULL;
+            _ringFailed = true;
+        }
+    }
+    // a single run gains nothing from the ring
+    if( _ring && _runs.size() > 1 )
+        return submit( transfers, write );
+#endif
+
+    for( uint32_t r = 0; r < _runs.size(); r++ ) {
+        Run& run = _runs[r];
+        while( run.done < run.size ) {
+            const uint32_t n = vectors( transfers, run );
+            const ssize_t result = transferAt( &_iov[run.first], n, run.pos + run.done, write );
+            if( result < 0 && errno == EINTR )
+                continue;
+            if( result < 0 || (result == 0 && write) )
+                return true;
+            if( result == 0 )
+                break;
+            run.done += result;
+        }
+        finish( transfers, run );
+    }
+    return false;
+}
+
+// fills the slots of the run with its bytes not transferred yet
+uint32_t
+UringFileProvider::vectors( Transfer* transfers, const Run& run )
+{
+    Size skip = run.done;
+    uint32_t n = 0;
+    for( uint32_t i = run.first; i < run.first + run.count; i++ ) {
+        const Transfer& t = transfers[i];
+        if( skip >= t.size ) {
+            skip -= t.size;
+            continue;
+        }
+        struct iovec& v = _iov[run.first + n++];
+        v.iov_base = (uint8_t*)t.buffer + skip;
+        v.iov_len  = size_t( t.size - skip );
+        skip = 0;
+    }
+    return n;
+}
+
+ssize_t
+UringFileProvider::transferAt( const struct iovec* iov, uint32_t n, Size pos, bool write )
+{
+    if( write ) {
+#ifdef HAVE_PWRITEV
+        return ::pwritev( _fd, iov, int( n ), pos );
+#else
+        return ::pwrite( _fd, iov[0].iov_base, iov[0].iov_len, pos );
+#endif
+    }
+
+#ifdef HAVE_PREADV
+    return ::preadv( _fd, iov, int( n ), pos );
+#else
+    return ::pread( _fd, iov[0].iov_base, iov[0].iov_len, pos );
+#endif
+}
+
+// hands the bytes done by the run to its transfers, in order
+void
+UringFileProvider::finish( Transfer* transfers, const Run& run )
+{
+    Size done = run.done;
+    for( uint32_t i = run.first; i < run.first + run.count; i++ ) {
+        Transfer& t = transfers[i];
+        t.count = min( t.size, done );
+        done -= t.count;
+    }
+}
+
+#ifdef MP4V2_USE_URING
+
+// Keeps the ring full with the runs still to do, partial runs going back
+// to the end of the list. Once something failed no more is submitted, but
+// what is in flight is waited for as it still uses the buffers.
+bool
+UringFileProvider::submit( Transfer* transfers, bool write )
+{
+    vector<uint32_t> todo;
+    todo.reserve( _runs.size() );
+    for( uint32_t r = 0; r < _runs.size(); r++ )
+        todo.push_back( r );
+
+    bool failed = false;
+    int error = 0;
+    uint32_t next = 0;
+    unsigned inFlight = 0;
+
+    while( next < todo.size() || inFlight > 0 ) {
+        for( ; next < todo.size() && inFlight < _ring->entries(); next++, inFlight++ ) {
+            const Run& run = _runs[todo[next]];
+            const uint32_t n = vectors( transfers, run );
+            _ring->prepare( write, _fd, &_iov[run.first], n, run.pos + run.done, todo[next] );
+        }
+
+        if( _ring->enter( 1 )) {
+            // nothing can be known of what is in flight, give up the ring
+            delete _ring;
+            _ring = NULL;
+            _ringFailed = true;
+            return true;
+        }
+
+        uint64_t data;
+        int result;
+        while( _ring->complete( data, result )) {
+            inFlight--;
+            Run& run = _runs[uint32_t( data )];
+            if( result == -EINTR || result == -EAGAIN ) {
+                todo.push_back( uint32_t( data ));
+            }
+            else if( result < 0 || (result == 0 && write) ) {
+                failed = true;
+                error = result < 0 ? -result : EIO;
+            }
+            else if( result == 0 ) {
+                finish( transfers, run );
+            }
+            else {
+                run.done += result;
+                if( run.done < run.size )
+                    todo.push_back( uint32_t( data ));
+                else
+                    finish( transfers, run );
+            }
+        }
+        if( failed )
+            next = uint32_t( todo.size() );
+    }
+
+    if( failed )
+        errno = error;
+    return failed;
+}
+
+#endif // MP4V2_USE_URING
+
+///////////////////////////////////////////////////////////////////////////////
+
 FileProvider&
 FileProvider::standard()
 {
+    if( __standard == STANDARD_URING )
+        return *new UringFileProvider();
     return *new StandardFileProvider();
 }
 
+bool
+FileProvider::setStandard( Standard standard_ )
+{
+    __standard = standard_;
+    return false;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }}} // namespace mp4v2::platform::io
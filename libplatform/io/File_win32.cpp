@@ -253,6 +253,13 @@ FileProvider::standard()
     return *new StandardFileProvider();
 }
 
+bool
+FileProvider::setStandard( Standard standard_ )
+{
+    // io_uring is Linux only, there is no other implementation to select
+    return standard_ != STANDARD_STREAM;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }}} // namespace mp4v2::platform::io
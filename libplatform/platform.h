@@ -36,6 +36,7 @@
 #include "libplatform/process/process.h"
 #include "libplatform/prog/option.h"
 #include "libplatform/sys/error.h"
+#include "libplatform/thread/thread.h"
 #include "libplatform/time/time.h"
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -3,6 +3,7 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <deque>
 #include <fstream>
 #include <iomanip>
 #include <iostream>
@@ -29,6 +30,12 @@
 #include <cwchar>
 #include <cwctype>
 
+// SSE2 is part of the x86-64 baseline, no runtime dispatch needed
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#   include <emmintrin.h>
+#   define MP4V2_HAVE_SSE2 1
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 
 #endif // MP4V2_PLATFORM_BASE_H
@@ -58,6 +58,11 @@ namespace mp4v2 { namespace platform {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// storage class for POD variables with a per-thread instance
+#define MP4V2_THREAD_LOCAL __thread
+
+///////////////////////////////////////////////////////////////////////////////
+
 // win32 platform requires O_BINARY when using old open() calls so we add
 // this harmless bit-flag for posix to avoid .cpp platform conditionals
 #ifndef O_BINARY
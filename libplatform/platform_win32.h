@@ -45,6 +45,11 @@ namespace mp4v2 { namespace platform {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// storage class for POD variables with a per-thread instance
+#define MP4V2_THREAD_LOCAL __declspec(thread)
+
+///////////////////////////////////////////////////////////////////////////////
+
 // fprintf macros for unsigned types - mingw32 is a good source if more needed
 #define PRId8   "d"
 #define PRId16  "d"
@@ -0,0 +1,139 @@
+#ifndef MP4V2_PLATFORM_THREAD_THREAD_H
+#define MP4V2_PLATFORM_THREAD_THREAD_H
+
+/// @namespace mp4v2::platform::thread (private) Threads.
+/// <b>WARNING: THIS IS A PRIVATE NAMESPACE. NOT FOR PUBLIC CONSUMPTION.</b>
+namespace mp4v2 { namespace platform { namespace thread {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Non-recursive mutual exclusion lock.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4V2_EXPORT Mutex
+{
+public:
+    Mutex();
+    ~Mutex();
+
+    void lock();
+    void unlock();
+
+private:
+    Mutex( const Mutex& );
+    Mutex& operator=( const Mutex& );
+
+    struct Impl;
+    Impl* _impl;
+
+    friend class Condition;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Scoped lock; the mutex is held for the lifetime of the object.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4V2_EXPORT MutexLock
+{
+public:
+    explicit MutexLock( Mutex& mutex )
+        : _mutex( mutex )
+    {
+        _mutex.lock();
+    }
+
+    ~MutexLock()
+    {
+        _mutex.unlock();
+    }
+
+private:
+    MutexLock( const MutexLock& );
+    MutexLock& operator=( const MutexLock& );
+
+    Mutex& _mutex;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Condition variable bound to a mutex.
+///
+/// wait(), signal() and broadcast() must all be called with the bound mutex
+/// held. Wakeups may be spurious so callers always re-test their predicate.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4V2_EXPORT Condition
+{
+public:
+    explicit Condition( Mutex& mutex );
+    ~Condition();
+
+    void wait();
+    void signal();
+    void broadcast();
+
+private:
+    Condition( const Condition& );
+    Condition& operator=( const Condition& );
+
+    struct Impl;
+    Impl*  _impl;
+    Mutex& _mutex;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Joinable thread of execution.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4V2_EXPORT Thread
+{
+public:
+    //! type of function executed by a thread
+    typedef void (*Function)( void* );
+
+public:
+    Thread();
+
+    //! Destructor. A running thread is joined before destruction.
+    ~Thread();
+
+    ///////////////////////////////////////////////////////////////////////////
+    //!
+    //! Start thread.
+    //!
+    //! @param func function to execute on the new thread.
+    //! @param arg argument passed to <b>func</b>.
+    //!
+    //! @return true on failure, false on success.
+    //!
+    ///////////////////////////////////////////////////////////////////////////
+
+    bool start( Function func, void* arg );
+
+    //! Wait for a started thread to finish; no-op if not started.
+    void join();
+
+private:
+    Thread( const Thread& );
+    Thread& operator=( const Thread& );
+
+    struct Impl;
+    Impl* _impl;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+//! Get number of online processors; always at least 1.
+MP4V2_EXPORT uint32_t getProcessorCount();
+
+///////////////////////////////////////////////////////////////////////////////
+
+}}} // namespace mp4v2::platform::thread
+
+#endif // MP4V2_PLATFORM_THREAD_THREAD_H
@@ -0,0 +1,147 @@
+#include "libplatform/impl.h"
+#include <pthread.h>
+
+namespace mp4v2 { namespace platform { namespace thread {
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct Mutex::Impl
+{
+    pthread_mutex_t mutex;
+};
+
+Mutex::Mutex()
+    : _impl( new Impl )
+{
+    pthread_mutex_init( &_impl->mutex, NULL );
+}
+
+Mutex::~Mutex()
+{
+    pthread_mutex_destroy( &_impl->mutex );
+    delete _impl;
+}
+
+void
+Mutex::lock()
+{
+    pthread_mutex_lock( &_impl->mutex );
+}
+
+void
+Mutex::unlock()
+{
+    pthread_mutex_unlock( &_impl->mutex );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct Condition::Impl
+{
+    pthread_cond_t cond;
+};
+
+Condition::Condition( Mutex& mutex )
+    : _impl  ( new Impl )
+    , _mutex ( mutex )
+{
+    pthread_cond_init( &_impl->cond, NULL );
+}
+
+Condition::~Condition()
+{
+    pthread_cond_destroy( &_impl->cond );
+    delete _impl;
+}
+
+void
+Condition::wait()
+{
+    pthread_cond_wait( &_impl->cond, &_mutex._impl->mutex );
+}
+
+void
+Condition::signal()
+{
+    pthread_cond_signal( &_impl->cond );
+}
+
+void
+Condition::broadcast()
+{
+    pthread_cond_broadcast( &_impl->cond );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct Thread::Impl
+{
+    pthread_t thread;
+    bool      started;
+    Function  func;
+    void*     arg;
+
+    static void*
+    entry( void* self )
+    {
+        Impl& impl = *static_cast<Impl*>( self );
+        impl.func( impl.arg );
+        return NULL;
+    }
+};
+
+Thread::Thread()
+    : _impl( new Impl )
+{
+    _impl->started = false;
+    _impl->func    = NULL;
+    _impl->arg     = NULL;
+}
+
+Thread::~Thread()
+{
+    join();
+    delete _impl;
+}
+
+bool
+Thread::start( Function func, void* arg )
+{
+    if( _impl->started )
+        return true;
+
+    _impl->func = func;
+    _impl->arg  = arg;
+    if( pthread_create( &_impl->thread, NULL, Impl::entry, _impl ))
+        return true;
+
+    _impl->started = true;
+    return false;
+}
+
+void
+Thread::join()
+{
+    if( !_impl->started )
+        return;
+
+    pthread_join( _impl->thread, NULL );
+    _impl->started = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t
+getProcessorCount()
+{
+#if defined( _SC_NPROCESSORS_ONLN )
+    long n = sysconf( _SC_NPROCESSORS_ONLN );
+    if( n > 0 )
+        return uint32_t( n );
+#endif
+    return 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}}} // namespace mp4v2::platform::thread
@@ -0,0 +1,157 @@
+#include "libplatform/impl.h"
+#include <process.h>
+
+namespace mp4v2 { namespace platform { namespace thread {
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct Mutex::Impl
+{
+    CRITICAL_SECTION cs;
+};
+
+Mutex::Mutex()
+    : _impl( new Impl )
+{
+    InitializeCriticalSection( &_impl->cs );
+}
+
+Mutex::~Mutex()
+{
+    DeleteCriticalSection( &_impl->cs );
+    delete _impl;
+}
+
+void
+Mutex::lock()
+{
+    EnterCriticalSection( &_impl->cs );
+}
+
+void
+Mutex::unlock()
+{
+    LeaveCriticalSection( &_impl->cs );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Native condition variables require Vista; we target Windows 2000 so the
+// condition is built from a semaphore. The waiter count is only touched
+// with the bound mutex held, which is why signal/broadcast require it too.
+struct Condition::Impl
+{
+    HANDLE sema;
+    LONG   waiters;
+};
+
+Condition::Condition( Mutex& mutex )
+    : _impl  ( new Impl )
+    , _mutex ( mutex )
+{
+    _impl->sema    = CreateSemaphore( NULL, 0, LONG_MAX, NULL );
+    _impl->waiters = 0;
+}
+
+Condition::~Condition()
+{
+    CloseHandle( _impl->sema );
+    delete _impl;
+}
+
+void
+Condition::wait()
+{
+    _impl->waiters++;
+    _mutex.unlock();
+    WaitForSingleObject( _impl->sema, INFINITE );
+    _mutex.lock();
+}
+
+void
+Condition::signal()
+{
+    if( _impl->waiters == 0 )
+        return;
+
+    _impl->waiters--;
+    ReleaseSemaphore( _impl->sema, 1, NULL );
+}
+
+void
+Condition::broadcast()
+{
+    if( _impl->waiters == 0 )
+        return;
+
+    ReleaseSemaphore( _impl->sema, _impl->waiters, NULL );
+    _impl->waiters = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct Thread::Impl
+{
+    HANDLE   handle;
+    Function func;
+    void*    arg;
+
+    static unsigned __stdcall
+    entry( void* self )
+    {
+        Impl& impl = *static_cast<Impl*>( self );
+        impl.func( impl.arg );
+        return 0;
+    }
+};
+
+Thread::Thread()
+    : _impl( new Impl )
+{
+    _impl->handle = NULL;
+    _impl->func   = NULL;
+    _impl->arg    = NULL;
+}
+
+Thread::~Thread()
+{
+    join();
+    delete _impl;
+}
+
+bool
+Thread::start( Function func, void* arg )
+{
+    if( _impl->handle )
+        return true;
+
+    _impl->func = func;
+    _impl->arg  = arg;
+    _impl->handle = (HANDLE)_beginthreadex( NULL, 0, Impl::entry, _impl, 0, NULL );
+    return _impl->handle == NULL;
+}
+
+void
+Thread::join()
+{
+    if( !_impl->handle )
+        return;
+
+    WaitForSingleObject( _impl->handle, INFINITE );
+    CloseHandle( _impl->handle );
+    _impl->handle = NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t
+getProcessorCount()
+{
+    SYSTEM_INFO info;
+    GetSystemInfo( &info );
+    return info.dwNumberOfProcessors > 0 ? uint32_t( info.dwNumberOfProcessors ) : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}}} // namespace mp4v2::platform::thread
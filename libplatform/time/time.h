@@ -5,12 +5,29 @@
 /// <b>WARNING: THIS IS A PRIVATE NAMESPACE. NOT FOR PUBLIC CONSUMPTION.</b>
 namespace mp4v2 { namespace platform { namespace time {
 
+//! type used to represent microseconds
+typedef int64_t microseconds_t;
+
 //! type used to represent milliseconds
 typedef int64_t milliseconds_t;
 
 //! type used to represent seconds
 typedef int64_t seconds_t;
 
+///////////////////////////////////////////////////////////////////////////////
+//!
+//! Get local-time in microseconds.
+//!
+//! getLocalTimeMicroseconds obtains the system's notion of current Greenwich
+//! time, adjusted according to the current timezone of the host system.
+//! The time is expressed as an absolute value since midnight (0 hour),
+//! January 1, 1970. This is commonly referred to as the "epoch".
+//!
+//! @return local-time in microseconds elapsed since the epoch.
+//!
+///////////////////////////////////////////////////////////////////////////////
+MP4V2_EXPORT microseconds_t getLocalTimeMicroseconds();
+
 ///////////////////////////////////////////////////////////////////////////////
 //!
 //! Get local-time in milliseconds.
@@ -5,6 +5,17 @@ namespace mp4v2 { namespace platform { namespace time {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+microseconds_t
+getLocalTimeMicroseconds()
+{
+    timeval buf;
+    if( gettimeofday( &buf, 0 ))
+        memset( &buf, 0, sizeof( buf ));
+    return microseconds_t( buf.tv_sec ) * 1000000 + buf.tv_usec;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 milliseconds_t
 getLocalTimeMilliseconds()
 {
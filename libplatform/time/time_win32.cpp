@@ -5,6 +5,53 @@ namespace mp4v2 { namespace platform { namespace time {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+namespace {
+
+// _ftime64 only resolves milliseconds, so microseconds come from the
+// performance counter, anchored to the epoch once when the library loads.
+struct PreciseClock
+{
+    LARGE_INTEGER  frequency;  // 0 if there is no performance counter
+    LARGE_INTEGER  start;
+    microseconds_t epoch;      // local-time at start
+
+    PreciseClock()
+    {
+        __timeb64 buf;
+        _ftime64( &buf );
+        epoch = microseconds_t( buf.time ) * 1000000 + microseconds_t( buf.millitm ) * 1000;
+
+        if( !QueryPerformanceFrequency( &frequency ) || !QueryPerformanceCounter( &start ))
+            frequency.QuadPart = 0;
+    }
+};
+
+PreciseClock preciseClock;
+
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+microseconds_t
+getLocalTimeMicroseconds()
+{
+    LARGE_INTEGER now;
+    if( !preciseClock.frequency.QuadPart || !QueryPerformanceCounter( &now )) {
+        __timeb64 buf;
+        _ftime64( &buf );
+        return microseconds_t( buf.time ) * 1000000 + microseconds_t( buf.millitm ) * 1000;
+    }
+
+    // split into seconds and remainder so the product cannot overflow
+    const int64_t ticks = now.QuadPart - preciseClock.start.QuadPart;
+    const int64_t freq  = preciseClock.frequency.QuadPart;
+    return preciseClock.epoch
+        + microseconds_t( ticks / freq ) * 1000000
+        + microseconds_t( ticks % freq ) * 1000000 / freq;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 milliseconds_t
 getLocalTimeMilliseconds()
 {
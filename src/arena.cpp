@@ -0,0 +1,126 @@
+#include "src/impl.h"
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    // keeps the objects that follow suitably aligned for any member
+    union ArenaHeader {
+        MP4Arena* arena;
+        double    alignDouble;
+        uint64_t  alignInt;
+        void*     alignPointer[2];
+    };
+
+    MP4V2_THREAD_LOCAL MP4Arena* currentArena = NULL;
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4Arena::MP4Arena( uint32_t blockSize )
+    : m_pos           ( NULL )
+    , m_left          ( 0 )
+    , m_blockSize     ( blockSize )
+    , m_bytesUsed     ( 0 )
+    , m_bytesReserved ( 0 )
+{
+}
+
+MP4Arena::~MP4Arena()
+{
+    for( size_t i = 0; i < m_blocks.size(); i++ )
+        MP4Free( m_blocks[i] );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void*
+MP4Arena::Alloc( size_t size )
+{
+    size = (size + sizeof(ArenaHeader) - 1) / sizeof(ArenaHeader) * sizeof(ArenaHeader);
+
+    if( size > m_left ) {
+        // oversized requests get a block of their own
+        size_t blockSize = max( size, size_t( m_blockSize ));
+        uint8_t* block = (uint8_t*)MP4Malloc( blockSize );
+        m_blocks.push_back( block );
+        m_bytesReserved += blockSize;
+
+        if( blockSize > m_blockSize ) {
+            m_bytesUsed += size;
+            return block;
+        }
+        m_pos = block;
+        m_left = blockSize;
+    }
+
+    void* p = m_pos;
+    m_pos += size;
+    m_left -= size;
+    m_bytesUsed += size;
+    return p;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4Arena*
+MP4Arena::GetCurrent()
+{
+    return currentArena;
+}
+
+void
+MP4Arena::SetCurrent( MP4Arena* arena )
+{
+    currentArena = arena;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4ArenaScope::MP4ArenaScope( MP4Arena* arena )
+    : m_previous( MP4Arena::GetCurrent() )
+{
+    MP4Arena::SetCurrent( arena );
+}
+
+MP4ArenaScope::~MP4ArenaScope()
+{
+    MP4Arena::SetCurrent( m_previous );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void*
+MP4ArenaObject::operator new( size_t size )
+{
+    MP4Arena* arena = MP4Arena::GetCurrent();
+
+    ArenaHeader* header;
+    if( arena ) {
+        header = (ArenaHeader*)arena->Alloc( sizeof(ArenaHeader) + size );
+    }
+    else {
+        header = (ArenaHeader*)malloc( sizeof(ArenaHeader) + size );
+        if( header == NULL )
+            throw std::bad_alloc();
+    }
+
+    header->arena = arena;
+    return header + 1;
+}
+
+void
+MP4ArenaObject::operator delete( void* p )
+{
+    if( p == NULL )
+        return;
+
+    ArenaHeader* header = (ArenaHeader*)p - 1;
+    if( header->arena == NULL )
+        free( header );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
@@ -0,0 +1,94 @@
+#ifndef MP4V2_IMPL_ARENA_H
+#define MP4V2_IMPL_ARENA_H
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Monotonic allocator owning the atom tree of a file.
+///
+/// Memory is carved from large blocks and only returned when the arena is
+/// destroyed, so tearing down a parsed tree costs one free per block rather
+/// than one per atom, property and descriptor. Objects derived from
+/// MP4ArenaObject are placed in the arena that is current on the calling
+/// thread, see MP4ArenaScope, and on the heap otherwise.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4Arena
+{
+public:
+    static const uint32_t DefaultBlockSize = 64 * 1024;
+
+public:
+    explicit MP4Arena( uint32_t blockSize = DefaultBlockSize );
+    ~MP4Arena();
+
+    void* Alloc( size_t size );
+
+    uint64_t GetBytesUsed() const     { return m_bytesUsed; }
+    uint64_t GetBytesReserved() const { return m_bytesReserved; }
+
+    // arena new objects go to on this thread, or NULL for the heap
+    static MP4Arena* GetCurrent();
+
+private:
+    friend class MP4ArenaScope;
+    static void SetCurrent( MP4Arena* arena );
+
+private:
+    vector<uint8_t*> m_blocks;
+    uint8_t*         m_pos;
+    size_t           m_left;
+    uint32_t         m_blockSize;
+    uint64_t         m_bytesUsed;
+    uint64_t         m_bytesReserved;
+
+private:
+    MP4Arena( const MP4Arena& );
+    MP4Arena& operator=( const MP4Arena& );
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Makes an arena current on this thread for the lifetime of the object.
+/// A NULL arena sends allocations to the heap. Scopes nest.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4ArenaScope
+{
+public:
+    explicit MP4ArenaScope( MP4Arena* arena );
+    ~MP4ArenaScope();
+
+private:
+    MP4Arena* m_previous;
+
+private:
+    MP4ArenaScope( const MP4ArenaScope& );
+    MP4ArenaScope& operator=( const MP4ArenaScope& );
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Base of atom tree classes that may be allocated in an arena.
+///
+/// Each allocation is prefixed with the arena it came from, so objects may
+/// be deleted regardless of where they were created. Destructors still run;
+/// deleting an arena object just leaves its memory to the arena.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4ArenaObject
+{
+public:
+    static void* operator new( size_t size );
+    static void  operator delete( void* p );
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
+
+#endif // MP4V2_IMPL_ARENA_H
@@ -52,10 +52,13 @@ MP4Avc1Atom::MP4Avc1Atom(MP4File &file)
 
     AddReserved(*this, "reserved4", 4); /* 7 */
 
-    ExpectChildAtom("avcC", Required, OnlyOne);
-    ExpectChildAtom("btrt", Optional, OnlyOne);
-    ExpectChildAtom("colr", Optional, OnlyOne);
-    ExpectChildAtom("pasp", Optional, OnlyOne);
+    static const MP4AtomInfo children[] = {
+        { "avcC", Required, OnlyOne },
+        { "btrt", Optional, OnlyOne },
+        { "colr", Optional, OnlyOne },
+        { "pasp", Optional, OnlyOne },
+    };
+    ExpectChildAtoms(children);
     // for now ExpectChildAtom("m4ds", Optional, OnlyOne);
 }
 
@@ -42,8 +42,11 @@ MP4EncaAtom::MP4EncaAtom(MP4File &file)
 
     AddReserved(*this, "reserved3", 2); /* 4 */
 
-    ExpectChildAtom("esds", Required, OnlyOne);
-    ExpectChildAtom("sinf", Required, OnlyOne);
+    static const MP4AtomInfo children[] = {
+        { "esds", Required, OnlyOne },
+        { "sinf", Required, OnlyOne },
+    };
+    ExpectChildAtoms(children);
 }
 
 void MP4EncaAtom::Generate()
@@ -52,9 +52,12 @@ MP4EncvAtom::MP4EncvAtom(MP4File &file)
     AddProperty(pProp); /* 6 */
     AddReserved(*this, "reserved4", 4); /* 7 */
 
-    ExpectChildAtom("esds", Required, OnlyOne);
-    ExpectChildAtom("sinf", Required, OnlyOne);
-    ExpectChildAtom("avcC", Optional, OnlyOne);
+    static const MP4AtomInfo children[] = {
+        { "esds", Required, OnlyOne },
+        { "sinf", Required, OnlyOne },
+        { "avcC", Optional, OnlyOne },
+    };
+    ExpectChildAtoms(children);
 }
 
 void MP4EncvAtom::Generate()
@@ -28,18 +28,21 @@ namespace mp4v2 { namespace impl {
 MP4HinfAtom::MP4HinfAtom(MP4File &file)
         : MP4Atom(file, "hinf")
 {
-    ExpectChildAtom("trpy", Optional, OnlyOne);
-    ExpectChildAtom("nump", Optional, OnlyOne);
-    ExpectChildAtom("tpyl", Optional, OnlyOne);
-    ExpectChildAtom("maxr", Optional, Many);
-    ExpectChildAtom("dmed", Optional, OnlyOne);
-    ExpectChildAtom("dimm", Optional, OnlyOne);
-    ExpectChildAtom("drep", Optional, OnlyOne);
-    ExpectChildAtom("tmin", Optional, OnlyOne);
-    ExpectChildAtom("tmax", Optional, OnlyOne);
-    ExpectChildAtom("pmax", Optional, OnlyOne);
-    ExpectChildAtom("dmax", Optional, OnlyOne);
-    ExpectChildAtom("payt", Optional, OnlyOne);
+    static const MP4AtomInfo children[] = {
+        { "trpy", Optional, OnlyOne },
+        { "nump", Optional, OnlyOne },
+        { "tpyl", Optional, OnlyOne },
+        { "maxr", Optional, Many },
+        { "dmed", Optional, OnlyOne },
+        { "dimm", Optional, OnlyOne },
+        { "drep", Optional, OnlyOne },
+        { "tmin", Optional, OnlyOne },
+        { "tmax", Optional, OnlyOne },
+        { "pmax", Optional, OnlyOne },
+        { "dmax", Optional, OnlyOne },
+        { "payt", Optional, OnlyOne },
+    };
+    ExpectChildAtoms(children);
 }
 
 void MP4HinfAtom::Generate()
@@ -48,9 +51,9 @@ void MP4HinfAtom::Generate()
     // are optional (on read), if we generate it for writing
     // we really want all the children
 
-    for (uint32_t i = 0; i < m_pChildAtomInfos.Size(); i++) {
+    for (uint32_t i = 0; i < m_numChildAtomInfos; i++) {
         MP4Atom* pChildAtom =
-            CreateAtom(m_File, this, m_pChildAtomInfos[i]->m_name);
+            CreateAtom(m_File, this, m_pChildAtomInfos[i].m_name);
 
         AddChildAtom(pChildAtom);
 
@@ -36,9 +36,15 @@ void MP4HntiAtom::Read()
     MP4Atom* grandParent = m_pParentAtom->GetParentAtom();
     ASSERT(grandParent);
     if (ATOMID(grandParent->GetType()) == ATOMID("trak")) {
-        ExpectChildAtom("sdp ", Optional, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "sdp ", Optional, OnlyOne },
+        };
+        ExpectChildAtoms(children);
     } else {
-        ExpectChildAtom("rtp ", Optional, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "rtp ", Optional, OnlyOne },
+        };
+        ExpectChildAtoms(children);
     }
 
     MP4Atom::Read();
@@ -40,6 +40,9 @@ MP4DataAtom::MP4DataAtom(MP4File &file)
     AddProperty( &typeCode );
     AddProperty( &locale );
     AddProperty( &metadata );
+
+    // cover art can be megabytes, most readers never look at it
+    metadata.EnableDeferredRead();
 }
 
 void
@@ -66,9 +69,12 @@ MP4FullAtom::MP4FullAtom( MP4File &file, const char* type )
 MP4ItemAtom::MP4ItemAtom( MP4File &file, const char* type )
     : MP4Atom( file, type )
 {
-    ExpectChildAtom( "mean", Optional, OnlyOne );
-    ExpectChildAtom( "name", Optional, OnlyOne );
-    ExpectChildAtom( "data", Required, Many );
+    static const MP4AtomInfo children[] = {
+        { "mean", Optional, OnlyOne },
+        { "name", Optional, OnlyOne },
+        { "data", Required, Many },
+    };
+    ExpectChildAtoms(children);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
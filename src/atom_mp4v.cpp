@@ -52,9 +52,12 @@ MP4Mp4vAtom::MP4Mp4vAtom(MP4File &file)
 
     AddReserved(*this, "reserved4", 4); /* 7 */
 
-    ExpectChildAtom("colr", Optional, OnlyOne);
-    ExpectChildAtom("esds", Required, OnlyOne);
-    ExpectChildAtom("pasp", Optional, OnlyOne);
+    static const MP4AtomInfo children[] = {
+        { "colr", Optional, OnlyOne },
+        { "esds", Required, OnlyOne },
+        { "pasp", Optional, OnlyOne },
+    };
+    ExpectChildAtoms(children);
 }
 
 void MP4Mp4vAtom::Generate()
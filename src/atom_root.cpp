@@ -32,13 +32,16 @@ MP4RootAtom::MP4RootAtom(MP4File &file)
     , m_rewrite_free         ( NULL )
     , m_rewrite_freePosition ( 0 )
 {
-    ExpectChildAtom( "moov", Required, OnlyOne );
-    ExpectChildAtom( "ftyp", Optional, OnlyOne );
-    ExpectChildAtom( "mdat", Optional, Many );
-    ExpectChildAtom( "free", Optional, Many );
-    ExpectChildAtom( "skip", Optional, Many );
-    ExpectChildAtom( "udta", Optional, Many );
-    ExpectChildAtom( "moof", Optional, Many );
+    static const MP4AtomInfo children[] = {
+        { "moov", Required, OnlyOne },
+        { "ftyp", Optional, OnlyOne },
+        { "mdat", Optional, Many },
+        { "free", Optional, Many },
+        { "skip", Optional, Many },
+        { "udta", Optional, Many },
+        { "moof", Optional, Many },
+    };
+    ExpectChildAtoms(children);
 }
 
 void MP4RootAtom::BeginWrite(bool use64)
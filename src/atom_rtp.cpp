@@ -50,9 +50,12 @@ void MP4RtpAtom::AddPropertiesStsdType()
     AddProperty( /* 4 */
         new MP4Integer32Property(*this, "maxPacketSize"));
 
-    ExpectChildAtom("tims", Required, OnlyOne);
-    ExpectChildAtom("tsro", Optional, OnlyOne);
-    ExpectChildAtom("snro", Optional, OnlyOne);
+    static const MP4AtomInfo children[] = {
+        { "tims", Required, OnlyOne },
+        { "tsro", Optional, OnlyOne },
+        { "snro", Optional, OnlyOne },
+    };
+    ExpectChildAtoms(children);
 }
 
 void MP4RtpAtom::AddPropertiesHntiType()
@@ -108,7 +111,7 @@ void MP4RtpAtom::Read()
         AddPropertiesHntiType();
         ReadHntiType();
     } else {
-        log.verbose1f("rtp atom in unexpected context, can not read");
+        MP4V2_LOG_VERBOSE1( log, "rtp atom in unexpected context, can not read");
     }
 
     Skip(); // to end of atom
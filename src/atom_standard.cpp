@@ -78,7 +78,10 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
          * d???
          */
     } else if (ATOMID(type) == ATOMID("dinf")) {
-        ExpectChildAtom("dref", Required, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "dref", Required, OnlyOne },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("dimm")) {
         AddProperty( // bytes of immediate data
@@ -99,7 +102,10 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
          * e???
          */
     } else if (ATOMID(type) == ATOMID("edts")) {
-        ExpectChildAtom("elst", Required, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "elst", Required, OnlyOne },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("esds")) {
         AddVersionAndFlags();
@@ -116,9 +122,12 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
          * g???
          */
     } else if (ATOMID(type) == ATOMID("gmhd")) {
-        ExpectChildAtom("gmin", Required, OnlyOne);
-        ExpectChildAtom("tmcd", Optional, OnlyOne);
-        ExpectChildAtom("text", Optional, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "gmin", Required, OnlyOne },
+            { "tmcd", Optional, OnlyOne },
+            { "text", Optional, OnlyOne },
+        };
+        ExpectChildAtoms(children);
     } else if (ATOMID(type) == ATOMID("hmhd")) {
         AddVersionAndFlags();
 
@@ -147,57 +156,60 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
             new MP4Integer8Property(*this, "IV-length"));
 
     } else if (ATOMID(type) == ATOMID("ilst")) {
-        ExpectChildAtom("\251nam", Optional, OnlyOne); /* name */
-        ExpectChildAtom("\251ART", Optional, OnlyOne); /* artist */
-        ExpectChildAtom("\251wrt", Optional, OnlyOne); /* writer */
-        ExpectChildAtom("\251alb", Optional, OnlyOne); /* album */
-        ExpectChildAtom("\251day", Optional, OnlyOne); /* date */
-        ExpectChildAtom("\251too", Optional, OnlyOne); /* tool */
-        ExpectChildAtom("\251cmt", Optional, OnlyOne); /* comment */
-        ExpectChildAtom("\251gen", Optional, OnlyOne); /* custom genre */
-        ExpectChildAtom("trkn", Optional, OnlyOne); /* tracknumber */
-        ExpectChildAtom("disk", Optional, OnlyOne); /* disknumber */
-        ExpectChildAtom("gnre", Optional, OnlyOne); /* genre (ID3v1 index + 1) */
-        ExpectChildAtom("cpil", Optional, OnlyOne); /* compilation */
-        ExpectChildAtom("tmpo", Optional, OnlyOne); /* BPM */
-        ExpectChildAtom("covr", Optional, OnlyOne); /* cover art */
-        ExpectChildAtom("aART", Optional, OnlyOne); /* album artist */
-        ExpectChildAtom("----", Optional, Many); /* ---- free form */
-        ExpectChildAtom("pgap", Optional, OnlyOne); /* part of gapless album */
-        ExpectChildAtom("tvsh", Optional, OnlyOne); /* TV show */
-        ExpectChildAtom("tvsn", Optional, OnlyOne); /* TV season */
-        ExpectChildAtom("tven", Optional, OnlyOne); /* TV episode number */
-        ExpectChildAtom("tvnn", Optional, OnlyOne); /* TV network name */
-        ExpectChildAtom("tves", Optional, OnlyOne); /* TV epsidoe */
-        ExpectChildAtom("desc", Optional, OnlyOne); /* description */
-        ExpectChildAtom("ldes", Optional, OnlyOne); /* long description */
-        ExpectChildAtom("soal", Optional, OnlyOne); /* sort album */
-        ExpectChildAtom("soar", Optional, OnlyOne); /* sort artist */
-        ExpectChildAtom("soaa", Optional, OnlyOne); /* sort album artist */
-        ExpectChildAtom("sonm", Optional, OnlyOne); /* sort name */
-        ExpectChildAtom("soco", Optional, OnlyOne); /* sort composer */
-        ExpectChildAtom("sosn", Optional, OnlyOne); /* sort show */
-        ExpectChildAtom("hdvd", Optional, OnlyOne); /* HD video */
-        ExpectChildAtom("enc", Optional, OnlyOne); /* Encoded by */
-        ExpectChildAtom("pcst", Optional, OnlyOne); /* Podcast flag */
-        ExpectChildAtom("keyw", Optional, OnlyOne); /* Keywords (for podcasts?) */
-        ExpectChildAtom("catg", Optional, OnlyOne); /* Category (for podcasts?) */
-        ExpectChildAtom("purl", Optional, OnlyOne); /* Podcast URL */
-        ExpectChildAtom("egid", Optional, OnlyOne); /* Podcast episode global unique ID */
-        ExpectChildAtom("rtng", Optional, OnlyOne); /* Content Rating */
-        ExpectChildAtom("stik", Optional, OnlyOne); /* MediaType */
-        ExpectChildAtom("\251grp", Optional, OnlyOne); /* Grouping */
-        ExpectChildAtom("\251lyr", Optional, OnlyOne); /* Lyrics */
-        ExpectChildAtom("cprt", Optional, OnlyOne); /* Copyright */
-        ExpectChildAtom("apID", Optional, OnlyOne); /* iTunes Account */
-        ExpectChildAtom("akID", Optional, OnlyOne); /* iTunes Account Type */
-        ExpectChildAtom("sfID", Optional, OnlyOne); /* iTunes Country */
-        ExpectChildAtom("cnID", Optional, OnlyOne); /* Content ID */
-        ExpectChildAtom("atID", Optional, OnlyOne); /* Artist ID */
-        ExpectChildAtom("plID", Optional, OnlyOne); /* Playlist ID */
-        ExpectChildAtom("geID", Optional, OnlyOne); /* Genre ID */
-        ExpectChildAtom("cmID", Optional, OnlyOne); /* Composer ID */
-        ExpectChildAtom("xid ", Optional, OnlyOne); /* XID */
+        static const MP4AtomInfo children[] = {
+            { "\251nam", Optional, OnlyOne }, /* name */
+            { "\251ART", Optional, OnlyOne }, /* artist */
+            { "\251wrt", Optional, OnlyOne }, /* writer */
+            { "\251alb", Optional, OnlyOne }, /* album */
+            { "\251day", Optional, OnlyOne }, /* date */
+            { "\251too", Optional, OnlyOne }, /* tool */
+            { "\251cmt", Optional, OnlyOne }, /* comment */
+            { "\251gen", Optional, OnlyOne }, /* custom genre */
+            { "trkn", Optional, OnlyOne }, /* tracknumber */
+            { "disk", Optional, OnlyOne }, /* disknumber */
+            { "gnre", Optional, OnlyOne }, /* genre (ID3v1 index + 1) */
+            { "cpil", Optional, OnlyOne }, /* compilation */
+            { "tmpo", Optional, OnlyOne }, /* BPM */
+            { "covr", Optional, OnlyOne }, /* cover art */
+            { "aART", Optional, OnlyOne }, /* album artist */
+            { "----", Optional, Many }, /* ---- free form */
+            { "pgap", Optional, OnlyOne }, /* part of gapless album */
+            { "tvsh", Optional, OnlyOne }, /* TV show */
+            { "tvsn", Optional, OnlyOne }, /* TV season */
+            { "tven", Optional, OnlyOne }, /* TV episode number */
+            { "tvnn", Optional, OnlyOne }, /* TV network name */
+            { "tves", Optional, OnlyOne }, /* TV epsidoe */
+            { "desc", Optional, OnlyOne }, /* description */
+            { "ldes", Optional, OnlyOne }, /* long description */
+            { "soal", Optional, OnlyOne }, /* sort album */
+            { "soar", Optional, OnlyOne }, /* sort artist */
+            { "soaa", Optional, OnlyOne }, /* sort album artist */
+            { "sonm", Optional, OnlyOne }, /* sort name */
+            { "soco", Optional, OnlyOne }, /* sort composer */
+            { "sosn", Optional, OnlyOne }, /* sort show */
+            { "hdvd", Optional, OnlyOne }, /* HD video */
+            { "enc", Optional, OnlyOne }, /* Encoded by */
+            { "pcst", Optional, OnlyOne }, /* Podcast flag */
+            { "keyw", Optional, OnlyOne }, /* Keywords (for podcasts?) */
+            { "catg", Optional, OnlyOne }, /* Category (for podcasts?) */
+            { "purl", Optional, OnlyOne }, /* Podcast URL */
+            { "egid", Optional, OnlyOne }, /* Podcast episode global unique ID */
+            { "rtng", Optional, OnlyOne }, /* Content Rating */
+            { "stik", Optional, OnlyOne }, /* MediaType */
+            { "\251grp", Optional, OnlyOne }, /* Grouping */
+            { "\251lyr", Optional, OnlyOne }, /* Lyrics */
+            { "cprt", Optional, OnlyOne }, /* Copyright */
+            { "apID", Optional, OnlyOne }, /* iTunes Account */
+            { "akID", Optional, OnlyOne }, /* iTunes Account Type */
+            { "sfID", Optional, OnlyOne }, /* iTunes Country */
+            { "cnID", Optional, OnlyOne }, /* Content ID */
+            { "atID", Optional, OnlyOne }, /* Artist ID */
+            { "plID", Optional, OnlyOne }, /* Playlist ID */
+            { "geID", Optional, OnlyOne }, /* Genre ID */
+            { "cmID", Optional, OnlyOne }, /* Composer ID */
+            { "xid ", Optional, OnlyOne }, /* XID */
+        };
+        ExpectChildAtoms(children);
 
     }  else if (ATOMID(type) == ATOMID("imif")) {
         AddVersionAndFlags();
@@ -217,14 +229,20 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
         AddProperty(new MP4Integer32Property(*this, "bytes"));
 
     } else if (ATOMID(type) == ATOMID("mdia")) {
-        ExpectChildAtom("mdhd", Required, OnlyOne);
-        ExpectChildAtom("hdlr", Required, OnlyOne);
-        ExpectChildAtom("minf", Required, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "mdhd", Required, OnlyOne },
+            { "hdlr", Required, OnlyOne },
+            { "minf", Required, OnlyOne },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("meta")) { // iTunes
         AddVersionAndFlags(); /* 0, 1 */
-        ExpectChildAtom("hdlr", Required, OnlyOne);
-        ExpectChildAtom("ilst", Required, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "hdlr", Required, OnlyOne },
+            { "ilst", Required, OnlyOne },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("mfhd")) {
         AddVersionAndFlags();   /* 0, 1 */
@@ -232,27 +250,39 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
             new MP4Integer32Property(*this, "sequenceNumber"));
 
     } else if (ATOMID(type) == ATOMID("minf")) {
-        ExpectChildAtom("vmhd", Optional, OnlyOne);
-        ExpectChildAtom("smhd", Optional, OnlyOne);
-        ExpectChildAtom("hmhd", Optional, OnlyOne);
-        ExpectChildAtom("nmhd", Optional, OnlyOne);
-        ExpectChildAtom("gmhd", Optional, OnlyOne);
-        ExpectChildAtom("dinf", Required, OnlyOne);
-        ExpectChildAtom("stbl", Required, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "vmhd", Optional, OnlyOne },
+            { "smhd", Optional, OnlyOne },
+            { "hmhd", Optional, OnlyOne },
+            { "nmhd", Optional, OnlyOne },
+            { "gmhd", Optional, OnlyOne },
+            { "dinf", Required, OnlyOne },
+            { "stbl", Required, OnlyOne },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("moof")) {
-        ExpectChildAtom("mfhd", Required, OnlyOne);
-        ExpectChildAtom("traf", Optional, Many);
+        static const MP4AtomInfo children[] = {
+            { "mfhd", Required, OnlyOne },
+            { "traf", Optional, Many },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("moov")) {
-        ExpectChildAtom("mvhd", Required, OnlyOne);
-        ExpectChildAtom("iods", Optional, OnlyOne);
-        ExpectChildAtom("trak", Required, Many);
-        ExpectChildAtom("udta", Optional, Many);
-        ExpectChildAtom("mvex", Optional, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "mvhd", Required, OnlyOne },
+            { "iods", Optional, OnlyOne },
+            { "trak", Required, Many },
+            { "udta", Optional, Many },
+            { "mvex", Optional, OnlyOne },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("mvex")) {
-        ExpectChildAtom("trex", Required, Many);
+        static const MP4AtomInfo children[] = {
+            { "trex", Required, Many },
+        };
+        ExpectChildAtoms(children);
 
         /*
          * n???
@@ -268,7 +298,10 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
           */
     } else if (ATOMID(type) == ATOMID("odkm")) {
         AddVersionAndFlags();
-        ExpectChildAtom("ohdr", Required, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "ohdr", Required, OnlyOne },
+        };
+        ExpectChildAtoms(children);
         /*
          * p???
          */
@@ -277,16 +310,22 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
         AddProperty(new MP4StringProperty(*this, "rtpMap", Counted));
 
     } else if (ATOMID(type) == ATOMID("pinf")) {
-        ExpectChildAtom("frma", Required, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "frma", Required, OnlyOne },
+        };
+        ExpectChildAtoms(children);
     } else if (ATOMID(type) == ATOMID("pmax")) {
         AddProperty( // max packet size
             new MP4Integer32Property(*this, "bytes"));
     } else if (ATOMID(type) == ATOMID("schi")) {
         // not sure if this is child atoms or table of boxes
         // get clarification on spec 9.1.2.5
-        ExpectChildAtom("odkm", Optional, OnlyOne);
-        ExpectChildAtom("iKMS", Optional, OnlyOne);
-        ExpectChildAtom("iSFM", Optional, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "odkm", Optional, OnlyOne },
+            { "iKMS", Optional, OnlyOne },
+            { "iSFM", Optional, OnlyOne },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("schm")) {
         AddVersionAndFlags(); /* 0, 1 */
@@ -297,10 +336,13 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
         // browser URI if flags set, TODO
 
     } else if (ATOMID(type) == ATOMID("sinf")) {
-        ExpectChildAtom("frma", Required, OnlyOne);
-        ExpectChildAtom("imif", Optional, OnlyOne);
-        ExpectChildAtom("schm", Optional, OnlyOne);
-        ExpectChildAtom("schi", Optional, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "frma", Required, OnlyOne },
+            { "imif", Optional, OnlyOne },
+            { "schm", Optional, OnlyOne },
+            { "schi", Optional, OnlyOne },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("smhd")) {
         AddVersionAndFlags();
@@ -366,23 +408,32 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
             new MP4Integer32Property(*this, "milliSecs"));
 
     } else if (ATOMID(type) == ATOMID("traf")) {
-        ExpectChildAtom("tfhd", Required, OnlyOne);
-        ExpectChildAtom("trun", Optional, Many);
+        static const MP4AtomInfo children[] = {
+            { "tfhd", Required, OnlyOne },
+            { "trun", Optional, Many },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("trak")) {
-        ExpectChildAtom("tkhd", Required, OnlyOne);
-        ExpectChildAtom("tref", Optional, OnlyOne);
-        ExpectChildAtom("edts", Optional, OnlyOne);
-        ExpectChildAtom("mdia", Required, OnlyOne);
-        ExpectChildAtom("udta", Optional, Many);
+        static const MP4AtomInfo children[] = {
+            { "tkhd", Required, OnlyOne },
+            { "tref", Optional, OnlyOne },
+            { "edts", Optional, OnlyOne },
+            { "mdia", Required, OnlyOne },
+            { "udta", Optional, Many },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("tref")) {
-        ExpectChildAtom("chap", Optional, OnlyOne);
-        ExpectChildAtom("dpnd", Optional, OnlyOne);
-        ExpectChildAtom("hint", Optional, OnlyOne);
-        ExpectChildAtom("ipir", Optional, OnlyOne);
-        ExpectChildAtom("mpod", Optional, OnlyOne);
-        ExpectChildAtom("sync", Optional, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "chap", Optional, OnlyOne },
+            { "dpnd", Optional, OnlyOne },
+            { "hint", Optional, OnlyOne },
+            { "ipir", Optional, OnlyOne },
+            { "mpod", Optional, OnlyOne },
+            { "sync", Optional, OnlyOne },
+        };
+        ExpectChildAtoms(children);
 
     } else if (ATOMID(type) == ATOMID("trex")) {
         AddVersionAndFlags();   /* 0, 1 */
@@ -406,7 +457,10 @@ MP4StandardAtom::MP4StandardAtom (MP4File &file, const char *type) : MP4Atom(fil
         AddProperty(
             new MP4Integer32Property(*this, "offset"));
     } else if (ATOMID(type) == ATOMID("wave")) {
-        ExpectChildAtom("esds", Required, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "esds", Required, OnlyOne },
+        };
+        ExpectChildAtoms(children);
     } else {
         /*
          * default - unknown type
@@ -28,18 +28,21 @@ namespace mp4v2 { namespace impl {
 MP4StblAtom::MP4StblAtom(MP4File &file)
         : MP4Atom(file, "stbl")
 {
-    ExpectChildAtom("stsd", Required, OnlyOne);
-    ExpectChildAtom("stts", Required, OnlyOne);
-    ExpectChildAtom("ctts", Optional, OnlyOne);
-    ExpectChildAtom("stsz", Required, OnlyOne);
-    ExpectChildAtom("stz2", Optional, OnlyOne);
-    ExpectChildAtom("stsc", Required, OnlyOne);
-    ExpectChildAtom("stco", Optional, OnlyOne);
-    ExpectChildAtom("co64", Optional, OnlyOne);
-    ExpectChildAtom("stss", Optional, OnlyOne);
-    ExpectChildAtom("stsh", Optional, OnlyOne);
-    ExpectChildAtom("stdp", Optional, OnlyOne);
-    ExpectChildAtom("sdtp", Optional, OnlyOne);
+    static const MP4AtomInfo children[] = {
+        { "stsd", Required, OnlyOne },
+        { "stts", Required, OnlyOne },
+        { "ctts", Optional, OnlyOne },
+        { "stsz", Required, OnlyOne },
+        { "stz2", Optional, OnlyOne },
+        { "stsc", Required, OnlyOne },
+        { "stco", Optional, OnlyOne },
+        { "co64", Optional, OnlyOne },
+        { "stss", Optional, OnlyOne },
+        { "stsh", Optional, OnlyOne },
+        { "stdp", Optional, OnlyOne },
+        { "sdtp", Optional, OnlyOne },
+    };
+    ExpectChildAtoms(children);
 }
 
 void MP4StblAtom::Generate()
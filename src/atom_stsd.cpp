@@ -44,21 +44,24 @@ MP4StsdAtom::MP4StsdAtom(MP4File &file)
     pCount->SetReadOnly();
     AddProperty(pCount);
 
-    ExpectChildAtom("mp4a", Optional, Many);
-    ExpectChildAtom("enca", Optional, Many);
-    ExpectChildAtom("mp4s", Optional, Many);
-    ExpectChildAtom("mp4v", Optional, Many);
-    ExpectChildAtom("encv", Optional, Many);
-    ExpectChildAtom("rtp ", Optional, Many);
-    ExpectChildAtom("samr", Optional, Many); // For AMR-NB
-    ExpectChildAtom("sawb", Optional, Many); // For AMR-WB
-    ExpectChildAtom("s263", Optional, Many); // For H.263
-    ExpectChildAtom("avc1", Optional, Many);
-    ExpectChildAtom("alac", Optional, Many);
-    ExpectChildAtom("text", Optional, Many);
-    ExpectChildAtom("tx3g", Optional, Many);
-    ExpectChildAtom("ac-3", Optional, Many);
-    ExpectChildAtom("jpeg", Optional, Many);
+    static const MP4AtomInfo children[] = {
+        { "mp4a", Optional, Many },
+        { "enca", Optional, Many },
+        { "mp4s", Optional, Many },
+        { "mp4v", Optional, Many },
+        { "encv", Optional, Many },
+        { "rtp ", Optional, Many },
+        { "samr", Optional, Many }, // For AMR-NB
+        { "sawb", Optional, Many }, // For AMR-WB
+        { "s263", Optional, Many }, // For H.263
+        { "avc1", Optional, Many },
+        { "alac", Optional, Many },
+        { "text", Optional, Many },
+        { "tx3g", Optional, Many },
+        { "ac-3", Optional, Many },
+        { "jpeg", Optional, Many },
+    };
+    ExpectChildAtoms(children);
 }
 
 void MP4StsdAtom::Read()
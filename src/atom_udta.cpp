@@ -29,22 +29,28 @@ namespace impl {
 MP4UdtaAtom::MP4UdtaAtom(MP4File &file)
         : MP4Atom(file, "udta")
 {
-    ExpectChildAtom("chpl", Optional, OnlyOne);
-    ExpectChildAtom("cprt", Optional, Many);
-    ExpectChildAtom("hnti", Optional, OnlyOne);
-    ExpectChildAtom("meta", Optional, OnlyOne);
-    ExpectChildAtom("\251cpy", Optional, OnlyOne);
-    ExpectChildAtom("\251des", Optional, OnlyOne);
-    ExpectChildAtom("\251nam", Optional, OnlyOne);
-    ExpectChildAtom("\251cmt", Optional, OnlyOne);
-    ExpectChildAtom("\251prd", Optional, OnlyOne);
+    static const MP4AtomInfo children[] = {
+        { "chpl", Optional, OnlyOne },
+        { "cprt", Optional, Many },
+        { "hnti", Optional, OnlyOne },
+        { "meta", Optional, OnlyOne },
+        { "\251cpy", Optional, OnlyOne },
+        { "\251des", Optional, OnlyOne },
+        { "\251nam", Optional, OnlyOne },
+        { "\251cmt", Optional, OnlyOne },
+        { "\251prd", Optional, OnlyOne },
+    };
+    ExpectChildAtoms(children);
 }
 
 void MP4UdtaAtom::Read()
 {
     if (ATOMID(m_pParentAtom->GetType()) == ATOMID("trak")) {
-        ExpectChildAtom("hinf", Optional, OnlyOne);
-        ExpectChildAtom("name", Optional, OnlyOne);
+        static const MP4AtomInfo children[] = {
+            { "hinf", Optional, OnlyOne },
+            { "name", Optional, OnlyOne },
+        };
+        ExpectChildAtoms(children);
     }
 
     MP4Atom::Read();
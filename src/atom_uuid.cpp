@@ -46,5 +46,30 @@ IPodUUIDAtom::IPodUUIDAtom(MP4File &file)
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static uint8_t checksum_magic[] = {
+    0x33, 0x7f, 0x15, 0xa2, 0xa3, 0x18, 0x46, 0x2a,
+    0xbd, 0xdb, 0x10, 0x42, 0x42, 0x47, 0xff, 0x4f
+};
+
+ChecksumUUIDAtom::ChecksumUUIDAtom(MP4File &file)
+        : MP4Atom(file, "uuid")
+{
+    SetExtendedType(checksum_magic);
+
+    AddProperty(new MP4BytesProperty(*this, "data"));
+}
+
+bool ChecksumUUIDAtom::IsChecksumAtom(MP4Atom& atom)
+{
+    if (ATOMID(atom.GetType()) != ATOMID("uuid"))
+        return false;
+
+    uint8_t extendedType[sizeof(checksum_magic)];
+    atom.GetExtendedType(extendedType);
+    return !memcmp(extendedType, checksum_magic, sizeof(checksum_magic));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 }
 } // namespace mp4v2::impl
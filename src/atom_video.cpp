@@ -54,7 +54,10 @@ MP4VideoAtom::MP4VideoAtom (MP4File &file, const char *type)
         new MP4Integer16Property(*this, "depth"));
     AddProperty(/* 8 */
         new MP4Integer16Property(*this, "colorTableId"));
-    ExpectChildAtom("smi ", Optional, OnlyOne);
+    static const MP4AtomInfo children[] = {
+        { "smi ", Optional, OnlyOne },
+    };
+    ExpectChildAtoms(children);
 }
 
 void MP4VideoAtom::Generate()
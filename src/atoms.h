@@ -696,6 +696,17 @@ private:
     IPodUUIDAtom &operator= ( const IPodUUIDAtom &src );
 };
 
+// per-sample or per-chunk CRC-32C digests of a track, kept in trak.udta
+class ChecksumUUIDAtom : public MP4Atom {
+public:
+    ChecksumUUIDAtom(MP4File &file);
+    static bool IsChecksumAtom(MP4Atom& atom);
+private:
+    ChecksumUUIDAtom();
+    ChecksumUUIDAtom( const ChecksumUUIDAtom &src );
+    ChecksumUUIDAtom &operator= ( const ChecksumUUIDAtom &src );
+};
+
 class MP4NmhdAtom : public MP4Atom {
 public:
     MP4NmhdAtom(MP4File &file);
@@ -0,0 +1,129 @@
+#include "src/impl.h"
+
+// the crc32 instruction is not part of the SSE2 baseline, it is compiled
+// for SSE4.2 separately and only called after checking CPUID
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ))
+#   include <cpuid.h>
+#   include <nmmintrin.h>
+#   define MP4V2_HAVE_CRC32_INSN 1
+#   define MP4V2_TARGET_SSE42 __attribute__(( target( "sse4.2" )))
+#elif defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ))
+#   include <intrin.h>
+#   include <nmmintrin.h>
+#   define MP4V2_HAVE_CRC32_INSN 1
+#   define MP4V2_TARGET_SSE42
+#endif
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    const uint32_t POLYNOMIAL = 0x82f63b78; // reflected 0x1edc6f41
+
+    // table[k][b] is the CRC of byte b followed by k zero bytes
+    struct SlicingTables {
+        uint32_t table[8][256];
+
+        SlicingTables()
+        {
+            for( uint32_t b = 0; b < 256; b++ ) {
+                uint32_t crc = b;
+                for( int i = 0; i < 8; i++ )
+                    crc = (crc >> 1) ^ (crc & 1 ? POLYNOMIAL : 0);
+                table[0][b] = crc;
+            }
+            for( uint32_t b = 0; b < 256; b++ ) {
+                for( int k = 1; k < 8; k++ )
+                    table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xff];
+            }
+        }
+    };
+
+    const SlicingTables tables;
+
+    uint32_t
+    crc32cSlicing( uint32_t crc, const uint8_t* p, size_t size )
+    {
+        const uint32_t (*t)[256] = tables.table;
+
+        while( size >= 8 ) {
+            uint32_t lo = crc ^ (uint32_t( p[0] ) | uint32_t( p[1] ) << 8 | uint32_t( p[2] ) << 16 | uint32_t( p[3] ) << 24);
+            crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24]
+                ^ t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+            p += 8;
+            size -= 8;
+        }
+
+        while( size-- )
+            crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+
+        return crc;
+    }
+
+#ifdef MP4V2_HAVE_CRC32_INSN
+    bool
+    haveCrc32Insn()
+    {
+#if defined( _MSC_VER )
+        int info[4];
+        __cpuid( info, 1 );
+        return (info[2] & (1 << 20)) != 0;
+#else
+        unsigned int eax, ebx, ecx, edx;
+        if( !__get_cpuid( 1, &eax, &ebx, &ecx, &edx ))
+            return false;
+        return (ecx & (1 << 20)) != 0;
+#endif
+    }
+
+    const bool useCrc32Insn = haveCrc32Insn();
+
+    MP4V2_TARGET_SSE42 uint32_t
+    crc32cHardware( uint32_t crc, const uint8_t* p, size_t size )
+    {
+        while( size && (size_t( p ) & 7) ) {
+            crc = _mm_crc32_u8( crc, *p++ );
+            size--;
+        }
+
+#if defined( __x86_64__ ) || defined( _M_X64 )
+        uint64_t crc64 = crc;
+        for( ; size >= 8; p += 8, size -= 8 ) {
+            uint64_t v;
+            memcpy( &v, p, sizeof(v) );
+            crc64 = _mm_crc32_u64( crc64, v );
+        }
+        crc = uint32_t( crc64 );
+#endif
+
+        for( ; size >= 4; p += 4, size -= 4 ) {
+            uint32_t v;
+            memcpy( &v, p, sizeof(v) );
+            crc = _mm_crc32_u32( crc, v );
+        }
+
+        while( size-- )
+            crc = _mm_crc32_u8( crc, *p++ );
+
+        return crc;
+    }
+#endif
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t
+MP4Crc32c( const uint8_t* pBytes, size_t numBytes, uint32_t crc )
+{
+    crc = ~crc;
+#ifdef MP4V2_HAVE_CRC32_INSN
+    if( useCrc32Insn )
+        return ~crc32cHardware( crc, pBytes, numBytes );
+#endif
+    return ~crc32cSlicing( crc, pBytes, numBytes );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
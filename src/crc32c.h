@@ -0,0 +1,18 @@
+#ifndef MP4V2_IMPL_CRC32C_H
+#define MP4V2_IMPL_CRC32C_H
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+
+/// CRC-32C (Castagnoli) of a buffer, continuing from a previous result.
+///
+/// Uses the SSE4.2 crc32 instruction when the CPU has it and a
+/// slicing-by-8 table otherwise, both give the same result.
+uint32_t MP4Crc32c( const uint8_t* pBytes, size_t numBytes, uint32_t crc = 0 );
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
+
+#endif // MP4V2_IMPL_CRC32C_H
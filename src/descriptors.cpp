@@ -507,7 +507,7 @@ void MP4ContentIdDescriptor::Read(MP4File& file)
     /* if compatiblity != 0 */
     if (((MP4Integer8Property*)m_pProperties[0])->GetValue() != 0) {
         /* we don't understand it */
-        log.verbose1f("incompatible content id descriptor");
+        MP4V2_LOG_VERBOSE1( log, "incompatible content id descriptor");
         return;
     }
 
@@ -93,4 +93,36 @@ PlatformException::msg() const
 
 ///////////////////////////////////////////////////////////////////////////////
 
+PendingException::PendingException( uint64_t          offset_,
+                                    uint64_t          size_,
+                                    const char        *file_,
+                                    int               line_,
+                                    const char        *function_ )
+    : Exception("data not available yet",file_,line_,function_)
+    , m_offset(offset_)
+    , m_size(size_)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PendingException::~PendingException()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+string
+PendingException::msg() const
+{
+    ostringstream retval;
+
+    retval << function << ": " << what << ": " << m_size << " bytes at " <<
+        m_offset << " (" << file << "," << line << ")";
+
+    return retval.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 }} // namespace mp4v2::impl
@@ -63,6 +63,24 @@ public:
     const int   m_errno;
 };
 
+// data of a file that is still arriving could not be read yet
+class MP4V2_EXPORT PendingException : public Exception
+{
+public:
+    explicit PendingException( uint64_t        offset_,
+                               uint64_t        size_,
+                               const char      *file_,
+                               int             line_,
+                               const char      *function_ );
+    virtual ~PendingException();
+
+    virtual string      msg() const;
+
+public:
+    const uint64_t  m_offset;
+    const uint64_t  m_size;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }} // namespace mp4v2::impl
@@ -0,0 +1,278 @@
+#include "src/impl.h"
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+
+const uint8_t*
+FindH264StartCode( const uint8_t* p, const uint8_t* end )
+{
+#ifdef MP4V2_HAVE_SSE2
+    // test 16 candidate positions at once for 00 at p, 00 at p+1, 01 at p+2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one  = _mm_set1_epi8( 1 );
+    while( end - p >= 18 ) {
+        __m128i a = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)p ), zero );
+        __m128i b = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)(p + 1) ), zero );
+        __m128i c = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)(p + 2) ), one );
+        int mask = _mm_movemask_epi8( _mm_and_si128( _mm_and_si128( a, b ), c ));
+        if( mask ) {
+            while( !(mask & 1) ) {
+                mask >>= 1;
+                p++;
+            }
+            return p;
+        }
+        p += 16;
+    }
+#endif
+
+    // the third byte rules out up to three positions per step
+    while( end - p >= 3 ) {
+        if( p[2] > 1 ) {
+            p += 3;
+        }
+        else if( p[2] == 0 ) {
+            p++;
+        }
+        else {
+            if( p[0] == 0 && p[1] == 0 )
+                return p;
+            p += 3;
+        }
+    }
+
+    return end;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void
+SplitH264AnnexB( const uint8_t* pBytes, uint32_t numBytes, vector<MP4NalUnit>& units )
+{
+    units.clear();
+
+    const uint8_t* end = pBytes + numBytes;
+    const uint8_t* p = FindH264StartCode( pBytes, end );
+    if( p == end )
+        throw new Exception( "no Annex B start code in sample", __FILE__, __LINE__, __FUNCTION__ );
+
+    while( p != end ) {
+        const uint8_t* nal = p + 3;
+        p = FindH264StartCode( nal, end );
+
+        // drops the leading zero of 4 byte start codes and trailing_zero_8bits
+        const uint8_t* last = p;
+        while( last > nal && last[-1] == 0 )
+            last--;
+
+        if( last > nal ) {
+            MP4NalUnit unit;
+            unit.pBytes = nal;
+            unit.size   = uint32_t( last - nal );
+            units.push_back( unit );
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    inline uint32_t
+    readLength( const uint8_t* p, uint8_t lengthSize )
+    {
+        uint32_t length = 0;
+        for( uint8_t i = 0; i < lengthSize; i++ )
+            length = (length << 8) | p[i];
+        return length;
+    }
+} // namespace
+
+uint32_t
+CountH264NalUnits( const uint8_t* pBytes, uint32_t numBytes, uint8_t lengthSize )
+{
+    if( lengthSize < 1 || lengthSize > 4 )
+        throw new Exception( "invalid NAL unit length size", __FILE__, __LINE__, __FUNCTION__ );
+
+    uint32_t count = 0;
+    uint32_t pos = 0;
+    while( pos < numBytes ) {
+        if( numBytes - pos < lengthSize )
+            throw new Exception( "truncated NAL unit length", __FILE__, __LINE__, __FUNCTION__ );
+        uint32_t length = readLength( pBytes + pos, lengthSize );
+        pos += lengthSize;
+        if( length > numBytes - pos )
+            throw new Exception( "NAL unit length exceeds sample", __FILE__, __LINE__, __FUNCTION__ );
+        pos += length;
+        count++;
+    }
+
+    return count;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void
+RewriteH264LengthsInPlace( uint8_t* pBytes, uint32_t numBytes, uint8_t lengthSize )
+{
+    ASSERT( lengthSize == 3 || lengthSize == 4 );
+
+    uint32_t pos = 0;
+    while( pos < numBytes ) {
+        uint32_t length = readLength( pBytes + pos, lengthSize );
+        memset( pBytes + pos, 0, lengthSize - 1 );
+        pBytes[pos + lengthSize - 1] = 1;
+        pos += lengthSize + length;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t
+CopyH264LengthsToStartCodes( uint8_t* pDest, const uint8_t* pBytes,
+                             uint32_t numBytes, uint8_t lengthSize )
+{
+    static const uint8_t startCode[4] = { 0, 0, 0, 1 };
+
+    uint8_t* p = pDest;
+    uint32_t pos = 0;
+    while( pos < numBytes ) {
+        uint32_t length = readLength( pBytes + pos, lengthSize );
+        pos += lengthSize;
+        memcpy( p, startCode, sizeof(startCode) );
+        memcpy( p + sizeof(startCode), pBytes + pos, length );
+        p += sizeof(startCode) + length;
+        pos += length;
+    }
+
+    return uint32_t( p - pDest );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    // reads Exp-Golomb codes from the start of a NAL unit payload,
+    // skipping emulation prevention bytes
+    class BitReader
+    {
+    public:
+        BitReader( const uint8_t* p, uint32_t size )
+            : m_p     ( p )
+            , m_end   ( p + size )
+            , m_bit   ( 0 )
+            , m_zeros ( 0 )
+            , m_cur   ( 0 )
+            , m_valid ( true )
+        {
+        }
+
+        bool valid() const { return m_valid; }
+
+        uint32_t
+        readUe()
+        {
+            uint32_t leadingZeros = 0;
+            while( readBit() == 0 ) {
+                if( !m_valid || ++leadingZeros > 31 ) {
+                    m_valid = false;
+                    return 0;
+                }
+            }
+            uint32_t value = 0;
+            for( uint32_t i = 0; i < leadingZeros; i++ )
+                value = (value << 1) | readBit();
+            return (1u << leadingZeros) - 1 + value;
+        }
+
+    private:
+        uint32_t
+        readBit()
+        {
+            if( m_bit == 0 ) {
+                if( m_zeros >= 2 && m_p < m_end && *m_p == 3 ) {
+                    m_zeros = 0;
+                    m_p++;
+                }
+                if( m_p >= m_end ) {
+                    m_valid = false;
+                    return 0;
+                }
+                m_cur = *m_p++;
+                m_zeros = m_cur ? 0 : m_zeros + 1;
+                m_bit = 8;
+            }
+            m_bit--;
+            return (m_cur >> m_bit) & 1;
+        }
+
+        const uint8_t* m_p;
+        const uint8_t* m_end;
+        uint32_t       m_bit;
+        uint32_t       m_zeros;
+        uint8_t        m_cur;
+        bool           m_valid;
+    };
+} // namespace
+
+MP4H264Dependency::MP4H264Dependency()
+    : m_hasSlice  ( false )
+    , m_intra     ( true )
+    , m_reference ( false )
+{
+}
+
+void
+MP4H264Dependency::AddNalUnit( const uint8_t* pNal, uint32_t size )
+{
+    if( size < 2 )
+        return;
+
+    uint8_t type = pNal[0] & 0x1f;
+    if( type != H264_NAL_TYPE_SLICE && type != H264_NAL_TYPE_IDR_SLICE )
+        return;
+
+    m_hasSlice = true;
+    if( pNal[0] & 0x60 )
+        m_reference = true;
+    if( type == H264_NAL_TYPE_IDR_SLICE )
+        return;
+
+    // first_mb_in_slice, then slice_type
+    BitReader bits( pNal + 1, size - 1 );
+    bits.readUe();
+    uint32_t sliceType = bits.readUe();
+    if( !bits.valid() || (sliceType % 5 != 2 && sliceType % 5 != 4) )
+        m_intra = false;
+}
+
+uint8_t
+MP4H264Dependency::GetFlags() const
+{
+    if( !m_hasSlice )
+        return MP4_SDT_UNKNOWN;
+
+    return (m_intra ? MP4_SDT_IS_INDEPENDENT : MP4_SDT_IS_DEPENDENT)
+         | (m_reference ? MP4_SDT_HAS_DEPENDENTS : MP4_SDT_HAS_NO_DEPENDENTS);
+}
+
+uint8_t
+MP4H264Dependency::ForSample( const uint8_t* pBytes, uint32_t numBytes, uint8_t lengthSize )
+{
+    MP4H264Dependency dependency;
+
+    uint32_t pos = 0;
+    while( numBytes - pos > lengthSize ) {
+        uint32_t length = readLength( pBytes + pos, lengthSize );
+        pos += lengthSize;
+        if( length > numBytes - pos )
+            break;
+        dependency.AddNalUnit( pBytes + pos, length );
+        pos += length;
+    }
+
+    return dependency.GetFlags();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
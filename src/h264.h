@@ -0,0 +1,84 @@
+#ifndef MP4V2_IMPL_H264_H
+#define MP4V2_IMPL_H264_H
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// H.264 NAL unit framing.
+///
+/// Samples of avc1 tracks hold NAL units each preceded by a big-endian
+/// length of avcC.lengthSizeMinusOne+1 bytes, raw elementary streams
+/// (ITU-T H.264 Annex B) separate them with 00 00 01 start codes.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+enum {
+    H264_NAL_TYPE_SLICE         = 1,
+    H264_NAL_TYPE_IDR_SLICE     = 5,
+    H264_NAL_TYPE_SEQ_PARAM_SET = 7,
+    H264_NAL_TYPE_PIC_PARAM_SET = 8
+};
+
+struct MP4NalUnit {
+    const uint8_t* pBytes;
+    uint32_t       size;
+};
+
+/// Returns the first 00 00 01 start code in [p, end), or end if none.
+const uint8_t* FindH264StartCode( const uint8_t* p, const uint8_t* end );
+
+/// Split an Annex B access unit into its NAL units, without start codes
+/// and trailing zero bytes. Throws if the buffer holds no start code.
+void SplitH264AnnexB( const uint8_t* pBytes, uint32_t numBytes, vector<MP4NalUnit>& units );
+
+/// Validate a length prefixed sample, returns the number of NAL units.
+/// Throws if a length runs past the end of the sample.
+uint32_t CountH264NalUnits( const uint8_t* pBytes, uint32_t numBytes, uint8_t lengthSize );
+
+/// Replace the length prefixes of a validated sample with start codes in
+/// place, 00 00 00 01 for a lengthSize of 4 and 00 00 01 for 3.
+void RewriteH264LengthsInPlace( uint8_t* pBytes, uint32_t numBytes, uint8_t lengthSize );
+
+/// Write a validated sample with any lengthSize as Annex B to pDest,
+/// returns the number of bytes written.
+uint32_t CopyH264LengthsToStartCodes( uint8_t* pDest, const uint8_t* pBytes,
+                                      uint32_t numBytes, uint8_t lengthSize );
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Sample dependency of an access unit from its slice headers.
+///
+/// Only nal_ref_idc and slice_type are looked at, so AddNalUnit() needs no
+/// more than the first H264_DEPENDENCY_HEADER_SIZE bytes of each NAL unit.
+/// A sample whose slices are all I or SI does not depend on other samples,
+/// one whose slices all have nal_ref_idc 0 has no dependents.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+const uint32_t H264_DEPENDENCY_HEADER_SIZE = 16;
+
+class MP4H264Dependency
+{
+public:
+    MP4H264Dependency();
+
+    void AddNalUnit( const uint8_t* pNal, uint32_t size );
+
+    /// #MP4SampleDependencyType flags, 0 if no slice was seen.
+    uint8_t GetFlags() const;
+
+    /// Classify every NAL unit of a length prefixed sample.
+    static uint8_t ForSample( const uint8_t* pBytes, uint32_t numBytes, uint8_t lengthSize );
+
+private:
+    bool m_hasSlice;
+    bool m_intra;       // all slices are I or SI
+    bool m_reference;   // some slice has nal_ref_idc != 0
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
+
+#endif // MP4V2_IMPL_H264_H
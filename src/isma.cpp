@@ -200,7 +200,7 @@ void MP4File::MakeIsmaCompliant(bool addIsmaComplianceSdp)
 
     SetSessionSdp(sdpBuf);
 
-    log.verbose1f("\"%s\": IOD SDP = %s", GetFilename().c_str(), sdpBuf);
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": IOD SDP = %s", GetFilename().c_str(), sdpBuf);
 
     MP4Free(iodBase64);
     iodBase64 = NULL;
@@ -296,8 +296,8 @@ void MP4File::CreateIsmaIodFromFile(
                              (MP4Property**)&pUrlProperty))
         pUrlProperty->SetValue(urlBuf);
 
-    log.verbose1f("\"%s\": OD data URL = \042%s\042", GetFilename().c_str(),
-                  urlBuf);
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": OD data URL = \042%s\042", GetFilename().c_str(),
+                             urlBuf);
 
     MP4Free(odCmdBase64);
     odCmdBase64 = NULL;
@@ -366,8 +366,8 @@ void MP4File::CreateIsmaIodFromFile(
                                 (MP4Property**)&pUrlProperty))
         pUrlProperty->SetValue(urlBuf);
 
-    log.verbose1f("\"%s\": Scene data URL = \042%s\042",
-                  GetFilename().c_str(), urlBuf);
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": Scene data URL = \042%s\042",
+                             GetFilename().c_str(), urlBuf);
 
     MP4Free(sceneCmdBase64);
     sceneCmdBase64 = NULL;
@@ -476,8 +476,8 @@ void MP4File::CreateIsmaIodFromParams(
              "data:application/mpeg4-bifs-au;base64,%s",
              sceneCmdBase64);
 
-    log.verbose1f("\"%s\": Scene data URL = \042%s\042", GetFilename().c_str(),
-                  urlBuf);
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": Scene data URL = \042%s\042", GetFilename().c_str(),
+                             urlBuf);
 
     /* MP4Descriptor* pSceneEsd = */
     CreateESD(
@@ -555,7 +555,7 @@ void MP4File::CreateIsmaIodFromParams(
                  "data:application/mpeg4-od-au;base64,%s",
                  odCmdBase64);
 
-        log.verbose1f("\"%s\": OD data URL = \042%s\042", GetFilename().c_str(), urlBuf);
+        MP4V2_LOG_VERBOSE1( log, "\"%s\": OD data URL = \042%s\042", GetFilename().c_str(), urlBuf);
 
         /* MP4Descriptor* pOdEsd = */
         CreateESD(
@@ -239,7 +239,7 @@ Log::dump ( uint8_t       indent,
     va_list     ap;
 
     va_start(ap,format);
-    this->vdump(indent,verbosity,format,ap);
+    this->vdump(indent,verbosity_,format,ap);
     va_end(ap);
 }
 
@@ -90,4 +90,35 @@ extern Log log;
 
 }} // namespace mp4v2::impl
 
+/**
+ * The most detailed log level compiled into the library.  Messages
+ * logged through the MP4V2_LOG_* macros above this level are removed at
+ * compile time.  Configuring with --disable-verbose-log sets it to
+ * #MP4_LOG_INFO.
+ */
+#ifndef MP4V2_LOG_MAX_LEVEL
+#   define MP4V2_LOG_MAX_LEVEL MP4_LOG_VERBOSE4
+#endif
+
+/**
+ * True if @p l would log a message of @p level.  Use it to guard work
+ * done only to build a log message.
+ */
+#define MP4V2_LOG_ENABLED(l,level) \
+    ((level) <= MP4V2_LOG_MAX_LEVEL && (level) <= (l).verbosity)
+
+/**
+ * Level-checked logging for hot paths.  Unlike calling the Log
+ * members directly, neither the arguments are evaluated nor the call
+ * made unless the message would be logged.
+ */
+#define MP4V2_LOG_VERBOSE1(l,...) \
+    do { if( MP4V2_LOG_ENABLED( l, MP4_LOG_VERBOSE1 )) (l).verbose1f( __VA_ARGS__ ); } while( 0 )
+#define MP4V2_LOG_VERBOSE2(l,...) \
+    do { if( MP4V2_LOG_ENABLED( l, MP4_LOG_VERBOSE2 )) (l).verbose2f( __VA_ARGS__ ); } while( 0 )
+#define MP4V2_LOG_VERBOSE3(l,...) \
+    do { if( MP4V2_LOG_ENABLED( l, MP4_LOG_VERBOSE3 )) (l).verbose3f( __VA_ARGS__ ); } while( 0 )
+#define MP4V2_LOG_VERBOSE4(l,...) \
+    do { if( MP4V2_LOG_ENABLED( l, MP4_LOG_VERBOSE4 )) (l).verbose4f( __VA_ARGS__ ); } while( 0 )
+
 #endif // MP4V2_IMPL_LOG_H
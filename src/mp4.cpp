@@ -117,6 +117,11 @@ MP4FileHandle MP4Read( const char* fileName )
 }
 
 MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* fileProvider )
+{
+    return MP4ReadEx( fileName, fileProvider, 0 );
+}
+
+MP4FileHandle MP4ReadEx( const char* fileName, const MP4FileProvider* fileProvider, uint32_t flags )
 {
     if (!fileName)
         return MP4_INVALID_FILE_HANDLE;
@@ -126,7 +131,7 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         return MP4_INVALID_FILE_HANDLE;
 
     try {
-        pFile->Read( fileName, fileProvider );
+        pFile->Read( fileName, fileProvider, flags );
         return (MP4FileHandle)pFile;
     }
     catch( Exception* x ) {
@@ -143,6 +148,189 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
     return MP4_INVALID_FILE_HANDLE;
 }
 
+MP4ProgressiveStatus MP4ReadProgressive( const char* fileName, const MP4ProgressiveProvider* provider,
+                                         uint32_t flags, MP4FileHandle* hFile, MP4ByteRange* pending )
+{
+    if (!fileName || !provider || !hFile)
+        return MP4_PROGRESSIVE_ERROR;
+
+    *hFile = MP4_INVALID_FILE_HANDLE;
+
+    MP4File *pFile = ConstructMP4File();
+    if (!pFile)
+        return MP4_PROGRESSIVE_ERROR;
+
+    MP4ProgressiveStatus status = MP4_PROGRESSIVE_ERROR;
+    try {
+        pFile->ReadProgressive( fileName, provider, flags );
+        *hFile = (MP4FileHandle)pFile;
+        return MP4_PROGRESSIVE_OK;
+    }
+    catch( Exception* x ) {
+        // rethrown by pointer to the base class on the way up
+        PendingException* px = dynamic_cast<PendingException*>( x );
+        if (!px) {
+            mp4v2::impl::log.errorf(*x);
+        }
+        else {
+            if (pending) {
+                pending->offset = px->m_offset;
+                pending->size = px->m_size;
+            }
+            status = MP4_PROGRESSIVE_PENDING;
+        }
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf("%s: \"%s\": failed", __FUNCTION__,
+                                fileName );
+    }
+
+    delete pFile;
+    return status;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MP4EnablePerfCounters( MP4FileHandle hFile, bool enable )
+{
+    if (!MP4_IS_VALID_FILE_HANDLE(hFile))
+        return false;
+
+    try {
+        ((MP4File*)hFile)->EnablePerfCounters( enable );
+        return true;
+    }
+    catch( Exception* x ) {
+        mp4v2::impl::log.errorf(*x);
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+    }
+    return false;
+}
+
+bool MP4EnablePrefetch( MP4FileHandle hFile, uint32_t numBuffers, uint32_t bufferSize )
+{
+    if (!MP4_IS_VALID_FILE_HANDLE(hFile))
+        return false;
+
+    try {
+        ((MP4File*)hFile)->EnablePrefetch( numBuffers,
+                                           bufferSize ? bufferSize : MP4Prefetcher::DefaultBlockSize );
+        return true;
+    }
+    catch( Exception* x ) {
+        mp4v2::impl::log.errorf(*x);
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+    }
+    return false;
+}
+
+bool MP4SetFileIO( MP4FileIO io )
+{
+    switch( io ) {
+        case MP4_FILE_IO_STREAM:
+            return !io::FileProvider::setStandard( io::FileProvider::STANDARD_STREAM );
+        case MP4_FILE_IO_URING:
+            return !io::FileProvider::setStandard( io::FileProvider::STANDARD_URING );
+        default:
+            return false;
+    }
+}
+
+bool MP4GetPerfCounters( MP4FileHandle hFile, MP4PerfCounters* counters, bool reset )
+{
+    if (!MP4_IS_VALID_FILE_HANDLE(hFile) || !counters)
+        return false;
+
+    MP4PerfCounters* pPerf = ((MP4File*)hFile)->GetPerfCounters();
+    if (!pPerf) {
+        memset( counters, 0, sizeof(*counters) );
+        return true;
+    }
+
+    *counters = *pPerf;
+    if (reset)
+        memset( pPerf, 0, sizeof(*pPerf) );
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4StreamHandle MP4StreamOpen( const char* name, const MP4FileProvider* fileProvider )
+{
+    if (!name)
+        return MP4_INVALID_STREAM_HANDLE;
+
+    MP4StreamReader* pStream = NULL;
+    try {
+        pStream = new MP4StreamReader();
+        pStream->Open( name, fileProvider );
+        return (MP4StreamHandle)pStream;
+    }
+    catch( const std::bad_alloc& ) {
+        mp4v2::impl::log.errorf("%s: unable to allocate MP4StreamReader", __FUNCTION__);
+    }
+    catch( Exception* x ) {
+        mp4v2::impl::log.errorf(*x);
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf("%s: \"%s\": failed", __FUNCTION__, name );
+    }
+
+    delete pStream;
+    return MP4_INVALID_STREAM_HANDLE;
+}
+
+MP4FileHandle MP4StreamGetFile( MP4StreamHandle hStream )
+{
+    if (hStream == MP4_INVALID_STREAM_HANDLE)
+        return MP4_INVALID_FILE_HANDLE;
+
+    try {
+        return (MP4FileHandle)&((MP4StreamReader*)hStream)->GetFile();
+    }
+    catch( Exception* x ) {
+        mp4v2::impl::log.errorf(*x);
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+    }
+    return MP4_INVALID_FILE_HANDLE;
+}
+
+MP4StreamStatus MP4StreamReadSample( MP4StreamHandle hStream, MP4StreamSample* sample )
+{
+    if (hStream == MP4_INVALID_STREAM_HANDLE || !sample)
+        return MP4_STREAM_ERROR;
+
+    try {
+        if (((MP4StreamReader*)hStream)->ReadSample( *sample ))
+            return MP4_STREAM_SAMPLE;
+        return MP4_STREAM_END;
+    }
+    catch( Exception* x ) {
+        mp4v2::impl::log.errorf(*x);
+        delete x;
+    }
+    catch( ... ) {
+        mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+    }
+    return MP4_STREAM_ERROR;
+}
+
+void MP4StreamClose( MP4StreamHandle hStream )
+{
+    delete (MP4StreamReader*)hStream;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
     MP4FileHandle MP4Create (const char* fileName,
@@ -202,7 +390,7 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         try {
             ASSERT(pFile);
             // LATER useExtensibleFormat, moov first, then mvex's
-            if (pFile->Modify(fileName))
+            if (pFile->Modify(fileName, flags))
                 return (MP4FileHandle)pFile;
         }
         catch( Exception* x ) {
@@ -565,8 +753,9 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
     {
         if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
             try {
-                *retvalue = ((MP4File*)hFile)->GetIntegerProperty(propName);
-                return true;
+                if (((MP4File*)hFile)->TryGetIntegerProperty(propName, retvalue))
+                    return true;
+                mp4v2::impl::log.errorf("%s: no such property - %s", __FUNCTION__, propName);
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -584,8 +773,9 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
     {
         if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
             try {
-                *retvalue = ((MP4File*)hFile)->GetFloatProperty(propName);
-                return true;
+                if (((MP4File*)hFile)->TryGetFloatProperty(propName, retvalue))
+                    return true;
+                mp4v2::impl::log.errorf("%s: no such property - %s", __FUNCTION__, propName);
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -604,8 +794,9 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
     {
         if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
             try {
-                *retvalue =  ((MP4File*)hFile)->GetStringProperty(propName);
-                return true;
+                if (((MP4File*)hFile)->TryGetStringProperty(propName, retvalue))
+                    return true;
+                mp4v2::impl::log.errorf("%s: no such property - %s", __FUNCTION__, propName);
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -624,8 +815,9 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
     {
         if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
             try {
-                ((MP4File*)hFile)->GetBytesProperty(propName, ppValue, pValueSize);
-                return true;
+                if (((MP4File*)hFile)->TryGetBytesProperty(propName, ppValue, pValueSize))
+                    return true;
+                mp4v2::impl::log.errorf("%s: no such property - %s", __FUNCTION__, propName);
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -717,14 +909,12 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         return false;
     }
 
-    /* track operations */
-
-    MP4TrackId MP4AddTrack(
-        MP4FileHandle hFile, const char* type,uint32_t timeScale)
+    MP4PropertyHandle MP4ResolveProperty(
+        MP4FileHandle hFile, const char* propName)
     {
-        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && propName) {
             try {
-                return ((MP4File*)hFile)->AddSystemsTrack(type, timeScale);
+                return &((MP4File*)hFile)->ResolveProperty(propName);
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -734,15 +924,17 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
                 mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
             }
         }
-        return MP4_INVALID_TRACK_ID;
+        return MP4_INVALID_PROPERTY_HANDLE;
     }
 
-    MP4TrackId MP4AddSystemsTrack(
-        MP4FileHandle hFile, const char* type)
+    bool MP4GetPropertyHandleInteger(
+        MP4FileHandle hFile, MP4PropertyHandle hProperty, uint64_t* retvalue)
     {
-        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && MP4_IS_VALID_PROPERTY_HANDLE(hProperty)) {
             try {
-                return ((MP4File*)hFile)->AddSystemsTrack(type);
+                *retvalue = ((MP4File*)hFile)->GetIntegerProperty(
+                    *(MP4ResolvedProperty*)hProperty);
+                return true;
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -752,14 +944,17 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
                 mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
             }
         }
-        return MP4_INVALID_TRACK_ID;
+        return false;
     }
 
-    MP4TrackId MP4AddODTrack(MP4FileHandle hFile)
+    bool MP4GetPropertyHandleFloat(
+        MP4FileHandle hFile, MP4PropertyHandle hProperty, float* retvalue)
     {
-        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && MP4_IS_VALID_PROPERTY_HANDLE(hProperty)) {
             try {
-                return ((MP4File*)hFile)->AddODTrack();
+                *retvalue = ((MP4File*)hFile)->GetFloatProperty(
+                    *(MP4ResolvedProperty*)hProperty);
+                return true;
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -769,14 +964,17 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
                 mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
             }
         }
-        return MP4_INVALID_TRACK_ID;
+        return false;
     }
 
-    MP4TrackId MP4AddSceneTrack(MP4FileHandle hFile)
+    bool MP4GetPropertyHandleString(
+        MP4FileHandle hFile, MP4PropertyHandle hProperty, const char** retvalue)
     {
-        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && MP4_IS_VALID_PROPERTY_HANDLE(hProperty)) {
             try {
-                return ((MP4File*)hFile)->AddSceneTrack();
+                *retvalue = ((MP4File*)hFile)->GetStringProperty(
+                    *(MP4ResolvedProperty*)hProperty);
+                return true;
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -786,19 +984,18 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
                 mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
             }
         }
-        return MP4_INVALID_TRACK_ID;
+        return false;
     }
 
-    MP4TrackId MP4AddAudioTrack(
-        MP4FileHandle hFile,
-        uint32_t timeScale,
-        MP4Duration sampleDuration,
-        uint8_t audioType)
+    bool MP4GetPropertyHandleBytes(
+        MP4FileHandle hFile, MP4PropertyHandle hProperty,
+        uint8_t** ppValue, uint32_t* pValueSize)
     {
-        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && MP4_IS_VALID_PROPERTY_HANDLE(hProperty)) {
             try {
-                return ((MP4File*)hFile)->
-                       AddAudioTrack(timeScale, sampleDuration, audioType);
+                ((MP4File*)hFile)->GetBytesProperty(
+                    *(MP4ResolvedProperty*)hProperty, ppValue, pValueSize);
+                return true;
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -808,45 +1005,37 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
                 mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
             }
         }
-        return MP4_INVALID_TRACK_ID;
+        return false;
     }
 
-//
-// API to initialize ismacryp properties to sensible defaults.
-// if the input pointer is null then an ismacryp params is malloc'd.
-// caller must see to it that it is properly disposed of.
-//
-    mp4v2_ismacrypParams *MP4DefaultISMACrypParams(mp4v2_ismacrypParams *ptr)
+    bool MP4SetPropertyHandleInteger(
+        MP4FileHandle hFile, MP4PropertyHandle hProperty, int64_t value)
     {
-        try
-        {
-            if (ptr == NULL) {
-                ptr = (mp4v2_ismacrypParams *)MP4Malloc(sizeof(mp4v2_ismacrypParams));
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && MP4_IS_VALID_PROPERTY_HANDLE(hProperty)) {
+            try {
+                ((MP4File*)hFile)->SetIntegerProperty(
+                    *(MP4ResolvedProperty*)hProperty, value);
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
             }
-            memset(ptr, 0, sizeof(*ptr));
-            return ptr;
-        }
-
-        catch (...) {
-            return MP4_INVALID_TRACK_ID;
         }
+        return false;
     }
 
-
-    MP4TrackId MP4AddAC3AudioTrack(
-        MP4FileHandle hFile,
-        uint32_t samplingRate,
-        uint8_t fscod,
-        uint8_t bsid,
-        uint8_t bsmod,
-        uint8_t acmod,
-        uint8_t lfeon,
-        uint8_t bit_rate_code)
+    bool MP4SetPropertyHandleFloat(
+        MP4FileHandle hFile, MP4PropertyHandle hProperty, float value)
     {
-        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && MP4_IS_VALID_PROPERTY_HANDLE(hProperty)) {
             try {
-                return ((MP4File*)hFile)->
-                    AddAC3AudioTrack(samplingRate, fscod, bsid, bsmod, acmod, lfeon, bit_rate_code);
+                ((MP4File*)hFile)->SetFloatProperty(
+                    *(MP4ResolvedProperty*)hProperty, value);
+                return true;
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -856,31 +1045,19 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
                 mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
             }
         }
-        return MP4_INVALID_TRACK_ID;
+        return false;
     }
 
-    MP4TrackId MP4AddEncAudioTrack(MP4FileHandle hFile,
-                                   uint32_t timeScale,
-                                   MP4Duration sampleDuration,
-                                   mp4v2_ismacrypParams *icPp,
-                                   uint8_t audioType)
+    bool MP4SetPropertyHandleString(
+        MP4FileHandle hFile, MP4PropertyHandle hProperty, const char* value)
     {
-        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && MP4_IS_VALID_PROPERTY_HANDLE(hProperty)) {
             try {
-                if (icPp == NULL) {
-                    return ((MP4File*)hFile)->
-                           AddEncAudioTrack(timeScale, sampleDuration, audioType,
-                                            0, 0,
-                                            0, 0,
-                                            false, NULL, false);
-                } else {
-                    return ((MP4File*)hFile)->
-                           AddEncAudioTrack(timeScale, sampleDuration, audioType,
-                                            icPp->scheme_type, icPp->scheme_version,
-                                            icPp->key_ind_len, icPp->iv_len,
-                                            icPp->selective_enc, icPp->kms_uri, true);
-                }
-            } catch( Exception* x ) {
+                ((MP4File*)hFile)->SetStringProperty(
+                    *(MP4ResolvedProperty*)hProperty, value);
+                return true;
+            }
+            catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
                 delete x;
             }
@@ -888,20 +1065,18 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
                 mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
             }
         }
-        return MP4_INVALID_TRACK_ID;
+        return false;
     }
-    MP4TrackId MP4AddAmrAudioTrack(
-        MP4FileHandle hFile,
-        uint32_t timeScale,
-        uint16_t modeSet,
-        uint8_t modeChangePeriod,
-        uint8_t framesPerSample,
-        bool isAmrWB)
+
+    bool MP4SetPropertyHandleBytes(
+        MP4FileHandle hFile, MP4PropertyHandle hProperty,
+        const uint8_t* pValue, uint32_t valueSize)
     {
-        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && MP4_IS_VALID_PROPERTY_HANDLE(hProperty)) {
             try {
-                return ((MP4File*)hFile)->
-                       AddAmrAudioTrack(timeScale, modeSet, modeChangePeriod, framesPerSample, isAmrWB);
+                ((MP4File*)hFile)->SetBytesProperty(
+                    *(MP4ResolvedProperty*)hProperty, pValue, valueSize);
+                return true;
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -911,18 +1086,215 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
                 mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
             }
         }
-        return MP4_INVALID_TRACK_ID;
+        return false;
     }
 
-    void MP4SetAmrVendor(
-        MP4FileHandle hFile,
-        MP4TrackId trackId,
-        uint32_t vendor)
+    /* track operations */
+
+    MP4TrackId MP4AddTrack(
+        MP4FileHandle hFile, const char* type,uint32_t timeScale)
     {
         if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
             try {
-                ((MP4File*)hFile)->
-                SetAmrVendor(trackId, vendor);
+                return ((MP4File*)hFile)->AddSystemsTrack(type, timeScale);
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return MP4_INVALID_TRACK_ID;
+    }
+
+    MP4TrackId MP4AddSystemsTrack(
+        MP4FileHandle hFile, const char* type)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                return ((MP4File*)hFile)->AddSystemsTrack(type);
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return MP4_INVALID_TRACK_ID;
+    }
+
+    MP4TrackId MP4AddODTrack(MP4FileHandle hFile)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                return ((MP4File*)hFile)->AddODTrack();
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return MP4_INVALID_TRACK_ID;
+    }
+
+    MP4TrackId MP4AddSceneTrack(MP4FileHandle hFile)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                return ((MP4File*)hFile)->AddSceneTrack();
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return MP4_INVALID_TRACK_ID;
+    }
+
+    MP4TrackId MP4AddAudioTrack(
+        MP4FileHandle hFile,
+        uint32_t timeScale,
+        MP4Duration sampleDuration,
+        uint8_t audioType)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                return ((MP4File*)hFile)->
+                       AddAudioTrack(timeScale, sampleDuration, audioType);
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return MP4_INVALID_TRACK_ID;
+    }
+
+//
+// API to initialize ismacryp properties to sensible defaults.
+// if the input pointer is null then an ismacryp params is malloc'd.
+// caller must see to it that it is properly disposed of.
+//
+    mp4v2_ismacrypParams *MP4DefaultISMACrypParams(mp4v2_ismacrypParams *ptr)
+    {
+        try
+        {
+            if (ptr == NULL) {
+                ptr = (mp4v2_ismacrypParams *)MP4Malloc(sizeof(mp4v2_ismacrypParams));
+            }
+            memset(ptr, 0, sizeof(*ptr));
+            return ptr;
+        }
+
+        catch (...) {
+            return MP4_INVALID_TRACK_ID;
+        }
+    }
+
+
+    MP4TrackId MP4AddAC3AudioTrack(
+        MP4FileHandle hFile,
+        uint32_t samplingRate,
+        uint8_t fscod,
+        uint8_t bsid,
+        uint8_t bsmod,
+        uint8_t acmod,
+        uint8_t lfeon,
+        uint8_t bit_rate_code)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                return ((MP4File*)hFile)->
+                    AddAC3AudioTrack(samplingRate, fscod, bsid, bsmod, acmod, lfeon, bit_rate_code);
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return MP4_INVALID_TRACK_ID;
+    }
+
+    MP4TrackId MP4AddEncAudioTrack(MP4FileHandle hFile,
+                                   uint32_t timeScale,
+                                   MP4Duration sampleDuration,
+                                   mp4v2_ismacrypParams *icPp,
+                                   uint8_t audioType)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                if (icPp == NULL) {
+                    return ((MP4File*)hFile)->
+                           AddEncAudioTrack(timeScale, sampleDuration, audioType,
+                                            0, 0,
+                                            0, 0,
+                                            false, NULL, false);
+                } else {
+                    return ((MP4File*)hFile)->
+                           AddEncAudioTrack(timeScale, sampleDuration, audioType,
+                                            icPp->scheme_type, icPp->scheme_version,
+                                            icPp->key_ind_len, icPp->iv_len,
+                                            icPp->selective_enc, icPp->kms_uri, true);
+                }
+            } catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return MP4_INVALID_TRACK_ID;
+    }
+    MP4TrackId MP4AddAmrAudioTrack(
+        MP4FileHandle hFile,
+        uint32_t timeScale,
+        uint16_t modeSet,
+        uint8_t modeChangePeriod,
+        uint8_t framesPerSample,
+        bool isAmrWB)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                return ((MP4File*)hFile)->
+                       AddAmrAudioTrack(timeScale, modeSet, modeChangePeriod, framesPerSample, isAmrWB);
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return MP4_INVALID_TRACK_ID;
+    }
+
+    void MP4SetAmrVendor(
+        MP4FileHandle hFile,
+        MP4TrackId trackId,
+        uint32_t vendor)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                ((MP4File*)hFile)->
+                SetAmrVendor(trackId, vendor);
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -2066,6 +2438,94 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         return dstTrackId;
     }
 
+    bool MP4CopyTracks(MP4FileHandle srcFile,
+                       const MP4TrackId* srcTrackIds,
+                       uint32_t numTracks,
+                       MP4FileHandle dstFile,
+                       MP4TrackId* dstTrackIds,
+                       bool applyEdits)
+    {
+        if (!MP4_IS_VALID_FILE_HANDLE(srcFile) || srcTrackIds == NULL) {
+            return false;
+        }
+
+        if (dstFile == NULL) {
+            dstFile = srcFile;
+        }
+
+        MP4TrackId* newTrackIds =
+            (MP4TrackId*)MP4Calloc(numTracks * sizeof(MP4TrackId));
+        bool rc = true;
+
+        // clone media tracks first so hint tracks can reference them
+        for (int pass = 0; pass < 2 && rc; pass++) {
+            for (uint32_t i = 0; i < numTracks && rc; i++) {
+                const char* trackType = MP4GetTrackType(srcFile, srcTrackIds[i]);
+                if (!trackType) {
+                    rc = false;
+                    break;
+                }
+
+                bool isHint = MP4_IS_HINT_TRACK_TYPE(trackType);
+                if (isHint != (pass == 1)) {
+                    continue;
+                }
+
+                MP4TrackId dstRefTrackId = MP4_INVALID_TRACK_ID;
+                if (isHint) {
+                    MP4TrackId srcRefTrackId =
+                        MP4GetHintTrackReferenceTrackId(srcFile, srcTrackIds[i]);
+                    for (uint32_t j = 0; j < numTracks; j++) {
+                        if (srcTrackIds[j] == srcRefTrackId) {
+                            dstRefTrackId = newTrackIds[j];
+                            break;
+                        }
+                    }
+                }
+
+                newTrackIds[i] = MP4CloneTrack(srcFile, srcTrackIds[i],
+                                               dstFile, dstRefTrackId);
+                if (newTrackIds[i] == MP4_INVALID_TRACK_ID) {
+                    rc = false;
+                }
+            }
+        }
+
+        if (rc) {
+            try {
+                MP4File::CopyTracks(
+                    (MP4File*)srcFile,
+                    srcTrackIds,
+                    numTracks,
+                    (MP4File*)dstFile,
+                    newTrackIds,
+                    applyEdits);
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+                rc = false;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+                rc = false;
+            }
+        }
+
+        for (uint32_t i = 0; i < numTracks; i++) {
+            if (!rc && newTrackIds[i] != MP4_INVALID_TRACK_ID) {
+                MP4DeleteTrack(dstFile, newTrackIds[i]);
+                newTrackIds[i] = MP4_INVALID_TRACK_ID;
+            }
+            if (dstTrackIds) {
+                dstTrackIds[i] = newTrackIds[i];
+            }
+        }
+
+        MP4Free(newTrackIds);
+        return rc;
+    }
+
 // Given a source track in a source file, make an encrypted copy of
 // the track in the destination file, including sample encryption
     MP4TrackId MP4EncAndCopyTrack(MP4FileHandle srcFile,
@@ -2160,27 +2620,75 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         return dstTrackId;
     }
 
-    bool MP4DeleteTrack(
-        MP4FileHandle hFile,
-        MP4TrackId trackId)
+    MP4TrackId MP4EncAndCopyTrackPipelined(MP4FileHandle srcFile,
+                                           MP4TrackId srcTrackId,
+                                           mp4v2_ismacrypParams *icPp,
+                                           encryptFunc_t encfcnp,
+                                           uint32_t encfcnparam1,
+                                           uint32_t numThreads,
+                                           MP4FileHandle dstFile,
+                                           bool applyEdits,
+                                           MP4TrackId dstHintTrackReferenceTrack
+                                          )
     {
-        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
-            try {
-                ((MP4File*)hFile)->DeleteTrack(trackId);
-                return true;
-            }
-            catch( Exception* x ) {
-                mp4v2::impl::log.errorf(*x);
-                delete x;
-            }
-            catch( ... ) {
-                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
-            }
+        if (!MP4_IS_VALID_FILE_HANDLE(srcFile) || encfcnp == NULL) {
+            return MP4_INVALID_TRACK_ID;
         }
-        return false;
-    }
 
-    uint32_t MP4GetNumberOfTracks(
+        MP4TrackId dstTrackId =
+            MP4EncAndCloneTrack(srcFile, srcTrackId,
+                                icPp,
+                                dstFile, dstHintTrackReferenceTrack);
+
+        if (dstTrackId == MP4_INVALID_TRACK_ID) {
+            return dstTrackId;
+        }
+
+        try {
+            MP4File::EncAndCopyTrack(
+                (MP4File*)srcFile,
+                srcTrackId,
+                encfcnp,
+                encfcnparam1,
+                numThreads,
+                (MP4File*)dstFile,
+                dstTrackId,
+                applyEdits );
+            return dstTrackId;
+        }
+        catch( Exception* x ) {
+            mp4v2::impl::log.errorf(*x);
+            delete x;
+        }
+        catch( ... ) {
+            mp4v2::impl::log.errorf("%s: failed", __FUNCTION__ );
+        }
+
+        MP4DeleteTrack(dstFile ? dstFile : srcFile, dstTrackId);
+        return MP4_INVALID_TRACK_ID;
+    }
+
+    bool MP4DeleteTrack(
+        MP4FileHandle hFile,
+        MP4TrackId trackId)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                ((MP4File*)hFile)->DeleteTrack(trackId);
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
+    uint32_t MP4GetNumberOfTracks(
         MP4FileHandle hFile,
         const char* type,
         uint8_t subType)
@@ -2417,8 +2925,11 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
             MP4File *pFile = (MP4File *)hFile;
             try {
-                return pFile->GetTrackIntegerProperty(trackId,
-                                                      "mdia.minf.stbl.stsd.*.esds.decConfigDescr.avgBitrate");
+                uint64_t avgBitrate;
+                if (pFile->TryGetTrackIntegerProperty(trackId,
+                                                      "mdia.minf.stbl.stsd.*.esds.decConfigDescr.avgBitrate",
+                                                      &avgBitrate))
+                    return (uint32_t)avgBitrate;
             }
             catch( Exception* x ) {
                 //mp4v2::impl::log.errorf(*x);  we don't really need to print this.
@@ -2454,6 +2965,32 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         return 0;
     }
 
+    bool MP4GetTrackStats(
+        MP4FileHandle hFile, MP4TrackId trackId, MP4TrackStats* stats)
+    {
+        if (!MP4_IS_VALID_FILE_HANDLE(hFile) || stats == NULL)
+            return false;
+
+        try {
+            MP4Track* pTrack = ((MP4File*)hFile)->GetTrack(trackId);
+            stats->numSamples    = pTrack->GetNumberOfSamples();
+            stats->totalBytes    = pTrack->GetTotalOfSampleSizes();
+            stats->maxSampleSize = pTrack->GetMaxSampleSize();
+            stats->avgBitrate    = pTrack->GetAvgBitrate();
+            stats->maxBitrate    = pTrack->GetMaxBitrate();
+            stats->duration      = pTrack->GetDuration();
+            return true;
+        }
+        catch( Exception* x ) {
+            mp4v2::impl::log.errorf(*x);
+            delete x;
+        }
+        catch( ... ) {
+            mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+        }
+        return false;
+    }
+
     bool MP4GetTrackESConfiguration(
         MP4FileHandle hFile, MP4TrackId trackId,
         uint8_t** ppConfig, uint32_t* pConfigSize)
@@ -2740,9 +3277,10 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
     {
         if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
             try {
-                *retvalue = ((MP4File*)hFile)->GetTrackIntegerProperty(trackId,
-                            propName);
-                return true;
+                if (((MP4File*)hFile)->TryGetTrackIntegerProperty(trackId,
+                        propName, retvalue))
+                    return true;
+                mp4v2::impl::log.errorf("%s: no such property - %s", __FUNCTION__, propName);
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -2762,8 +3300,9 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
     {
         if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
             try {
-                *retvalue = ((MP4File*)hFile)->GetTrackFloatProperty(trackId, propName);
-                return true;
+                if (((MP4File*)hFile)->TryGetTrackFloatProperty(trackId, propName, retvalue))
+                    return true;
+                mp4v2::impl::log.errorf("%s: no such property - %s", __FUNCTION__, propName);
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -2783,8 +3322,9 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
     {
         if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
             try {
-                *retvalue = ((MP4File*)hFile)->GetTrackStringProperty(trackId, propName);
-                return true;
+                if (((MP4File*)hFile)->TryGetTrackStringProperty(trackId, propName, retvalue))
+                    return true;
+                mp4v2::impl::log.errorf("%s: no such property - %s", __FUNCTION__, propName);
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -2803,9 +3343,10 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
     {
         if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
             try {
-                ((MP4File*)hFile)->GetTrackBytesProperty(
-                    trackId, propName, ppValue, pValueSize);
-                return true;
+                if (((MP4File*)hFile)->TryGetTrackBytesProperty(
+                        trackId, propName, ppValue, pValueSize))
+                    return true;
+                mp4v2::impl::log.errorf("%s: no such property - %s", __FUNCTION__, propName);
             }
             catch( Exception* x ) {
                 mp4v2::impl::log.errorf(*x);
@@ -2902,6 +3443,24 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         return false;
     }
 
+    MP4PropertyHandle MP4ResolveTrackProperty(
+        MP4FileHandle hFile, MP4TrackId trackId, const char* propName)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && propName) {
+            try {
+                return &((MP4File*)hFile)->ResolveTrackProperty(trackId, propName);
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return MP4_INVALID_PROPERTY_HANDLE;
+    }
+
     /* sample operations */
 
     bool MP4ReadSample(
@@ -2942,6 +3501,37 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         return false;
     }
 
+    bool MP4ReadSamples(
+        MP4FileHandle hFile,
+        MP4TrackId    trackId,
+        MP4SampleId   firstSampleId,
+        uint32_t      numSamples,
+        uint8_t*      pBytes,
+        uint32_t      numBytes,
+        uint32_t*     pSampleSizes)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                ((MP4File*)hFile)->ReadSamples(
+                    trackId,
+                    firstSampleId,
+                    numSamples,
+                    pBytes,
+                    numBytes,
+                    pSampleSizes);
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
     bool MP4ReadSampleFromTime(
         /* input parameters */
         MP4FileHandle hFile,
@@ -3049,6 +3639,66 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         return false;
     }
 
+    bool MP4WriteH264AnnexBSample(
+        MP4FileHandle  hFile,
+        MP4TrackId     trackId,
+        const uint8_t* pBytes,
+        uint32_t       numBytes,
+        MP4Duration    duration,
+        MP4Duration    renderingOffset,
+        bool           isSyncSample )
+    {
+        if( MP4_IS_VALID_FILE_HANDLE( hFile )) {
+            try {
+                ((MP4File*)hFile)->WriteH264AnnexBSample(
+                    trackId,
+                    pBytes,
+                    numBytes,
+                    duration,
+                    renderingOffset,
+                    isSyncSample );
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
+    bool MP4ReadH264AnnexBSample(
+        MP4FileHandle hFile,
+        MP4TrackId    trackId,
+        MP4SampleId   sampleId,
+        uint8_t**     ppBytes,
+        uint32_t*     pNumBytes,
+        bool          withParameterSets )
+    {
+        if( MP4_IS_VALID_FILE_HANDLE( hFile )) {
+            try {
+                ((MP4File*)hFile)->ReadH264AnnexBSample(
+                    trackId,
+                    sampleId,
+                    ppBytes,
+                    pNumBytes,
+                    withParameterSets );
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
     bool MP4CopySample(
         MP4FileHandle srcFile,
         MP4TrackId    srcTrackId,
@@ -3298,6 +3948,290 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         return -1;
     }
 
+    uint32_t MP4GetSampleDependencyFlags(
+        MP4FileHandle hFile,
+        MP4TrackId    trackId,
+        MP4SampleId   sampleId )
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                return ((MP4File*)hFile)->GetSampleDependency(
+                           trackId, sampleId);
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return MP4_SDT_UNKNOWN;
+    }
+
+    MP4SampleId MP4GetNextIndependentSample(
+        MP4FileHandle hFile,
+        MP4TrackId    trackId,
+        MP4SampleId   sampleId )
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                return ((MP4File*)hFile)->GetNextIndependentSample(
+                           trackId, sampleId);
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return MP4_INVALID_SAMPLE_ID;
+    }
+
+    bool MP4GetTrickPlaySamples(
+        MP4FileHandle hFile,
+        MP4TrackId    trackId,
+        MP4SampleId   firstSampleId,
+        MP4SampleId   lastSampleId,
+        uint32_t      speed,
+        MP4SampleId** ppSampleIds,
+        uint32_t*     pNumSamples )
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                vector<MP4SampleId> samples;
+                ((MP4File*)hFile)->GetTrickPlaySamples(
+                    trackId, firstSampleId, lastSampleId, speed, samples);
+
+                *ppSampleIds = NULL;
+                if (!samples.empty()) {
+                    *ppSampleIds = (MP4SampleId*)MP4Malloc(samples.size() * sizeof(MP4SampleId));
+                    memcpy(*ppSampleIds, &samples[0], samples.size() * sizeof(MP4SampleId));
+                }
+                *pNumSamples = (uint32_t)samples.size();
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
+    bool MP4GetTrackChecksums(
+        MP4FileHandle          hFile,
+        MP4TrackId             trackId,
+        MP4ChecksumGranularity granularity,
+        uint32_t**             ppChecksums,
+        uint32_t*              pNumChecksums )
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                vector<uint32_t> checksums;
+                ((MP4File*)hFile)->GetTrackChecksums(
+                    trackId, granularity == MP4_CHECKSUM_CHUNK, checksums);
+
+                *ppChecksums = NULL;
+                if (!checksums.empty()) {
+                    *ppChecksums = (uint32_t*)MP4Malloc(checksums.size() * sizeof(uint32_t));
+                    memcpy(*ppChecksums, &checksums[0], checksums.size() * sizeof(uint32_t));
+                }
+                *pNumChecksums = (uint32_t)checksums.size();
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
+    bool MP4StoreTrackChecksums(
+        MP4FileHandle          hFile,
+        MP4TrackId             trackId,
+        MP4ChecksumGranularity granularity )
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                ((MP4File*)hFile)->StoreTrackChecksums(
+                    trackId, granularity == MP4_CHECKSUM_CHUNK);
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
+    bool MP4VerifyTrackChecksums(
+        MP4FileHandle hFile,
+        MP4TrackId    trackId,
+        MP4SampleId** ppBadSampleIds,
+        uint32_t*     pNumBadSamples )
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                vector<MP4SampleId> badSamples;
+                ((MP4File*)hFile)->VerifyTrackChecksums(trackId, badSamples);
+
+                *ppBadSampleIds = NULL;
+                if (!badSamples.empty()) {
+                    *ppBadSampleIds = (MP4SampleId*)MP4Malloc(badSamples.size() * sizeof(MP4SampleId));
+                    memcpy(*ppBadSampleIds, &badSamples[0], badSamples.size() * sizeof(MP4SampleId));
+                }
+                *pNumBadSamples = (uint32_t)badSamples.size();
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
+
+    MP4ProgressiveStatus MP4ReadSampleProgressive(
+        /* input parameters */
+        MP4FileHandle hFile,
+        MP4TrackId trackId,
+        MP4SampleId sampleId,
+        /* output parameters */
+        uint8_t** ppBytes,
+        uint32_t* pNumBytes,
+        MP4Timestamp* pStartTime,
+        MP4Duration* pDuration,
+        MP4Duration* pRenderingOffset,
+        bool* pIsSyncSample)
+    {
+        MP4ProgressiveStatus status = MP4_PROGRESSIVE_ERROR;
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                ((MP4File*)hFile)->ReadSample(
+                    trackId,
+                    sampleId,
+                    ppBytes,
+                    pNumBytes,
+                    pStartTime,
+                    pDuration,
+                    pRenderingOffset,
+                    pIsSyncSample);
+                return MP4_PROGRESSIVE_OK;
+            }
+            catch( Exception* x ) {
+                // rethrown by pointer to the base class on the way up
+                if (dynamic_cast<PendingException*>( x ))
+                    status = MP4_PROGRESSIVE_PENDING;
+                else
+                    mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        *pNumBytes = 0;
+        return status;
+    }
+
+    bool MP4GetSampleByteRange(
+        MP4FileHandle hFile,
+        MP4TrackId    trackId,
+        MP4SampleId   sampleId,
+        MP4ByteRange* range )
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && range) {
+            try {
+                ((MP4File*)hFile)->GetSampleByteRange(
+                    trackId, sampleId, range->offset, range->size);
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
+    bool MP4GetSampleByteRangeFromTime(
+        MP4FileHandle hFile,
+        MP4TrackId    trackId,
+        MP4Timestamp  when,
+        MP4ByteRange* range )
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && range) {
+            try {
+                ((MP4File*)hFile)->GetSampleByteRangeFromTime(
+                    trackId, when, range->offset, range->size);
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
+    bool MP4GetByteRangesForTime(
+        MP4FileHandle     hFile,
+        const MP4TrackId* trackIds,
+        uint32_t          numTracks,
+        MP4Timestamp      startTime,
+        MP4Timestamp      endTime,
+        uint64_t          maxGap,
+        MP4ByteRange**    ppRanges,
+        uint32_t*         pNumRanges )
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile) && (trackIds || !numTracks)) {
+            try {
+                vector<MP4ByteRange> ranges;
+                ((MP4File*)hFile)->GetByteRangesForTime(
+                    trackIds, numTracks, startTime, endTime, maxGap, ranges);
+
+                *ppRanges = NULL;
+                if (!ranges.empty()) {
+                    *ppRanges = (MP4ByteRange*)MP4Malloc(ranges.size() * sizeof(MP4ByteRange));
+                    memcpy(*ppRanges, &ranges[0], ranges.size() * sizeof(MP4ByteRange));
+                }
+                *pNumRanges = (uint32_t)ranges.size();
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
 
     uint64_t MP4ConvertFromMovieDuration(
         MP4FileHandle hFile,
@@ -3714,6 +4648,85 @@ MP4FileHandle MP4ReadProvider( const char* fileName, const MP4FileProvider* file
         return false;
     }
 
+    bool MP4ReadRtpHintPackets(
+        MP4FileHandle hFile,
+        MP4TrackId hintTrackId,
+        uint8_t* pBuffer,
+        uint32_t* pBufferSize,
+        MP4RtpIovec* pPackets,
+        uint32_t* pNumPackets,
+        uint32_t ssrc,
+        bool includeHeader,
+        bool includePayload)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                return ((MP4File*)hFile)->ReadRtpHintPackets(
+                    hintTrackId, pBuffer, pBufferSize,
+                    pPackets, pNumPackets,
+                    ssrc, includeHeader, includePayload);
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
+    bool MP4SetTrackSampleCacheSize(
+        MP4FileHandle hFile,
+        MP4TrackId trackId,
+        uint32_t maxBytes)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                ((MP4File*)hFile)->GetTrack(trackId)->GetSampleCache().SetMaxBytes(maxBytes);
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
+    bool MP4GetTrackSampleCacheStats(
+        MP4FileHandle hFile,
+        MP4TrackId trackId,
+        uint64_t* pHits,
+        uint64_t* pMisses,
+        bool reset)
+    {
+        if (MP4_IS_VALID_FILE_HANDLE(hFile)) {
+            try {
+                MP4SampleCache& cache = ((MP4File*)hFile)->GetTrack(trackId)->GetSampleCache();
+                if (pHits)
+                    *pHits = cache.GetHits();
+                if (pMisses)
+                    *pMisses = cache.GetMisses();
+                if (reset)
+                    cache.ResetStats();
+                return true;
+            }
+            catch( Exception* x ) {
+                mp4v2::impl::log.errorf(*x);
+                delete x;
+            }
+            catch( ... ) {
+                mp4v2::impl::log.errorf( "%s: failed", __FUNCTION__ );
+            }
+        }
+        return false;
+    }
+
     MP4Timestamp MP4GetRtpTimestampStart(
         MP4FileHandle hFile,
         MP4TrackId hintTrackId)
@@ -37,14 +37,6 @@ namespace mp4v2 { namespace impl {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-MP4AtomInfo::MP4AtomInfo(const char* name, bool mandatory, bool onlyOne)
-{
-    m_name = name;
-    m_mandatory = mandatory;
-    m_onlyOne = onlyOne;
-    m_count = 0;
-}
-
 MP4Atom::MP4Atom(MP4File& file, const char* type)
     : m_File(file)
 {
@@ -56,6 +48,11 @@ MP4Atom::MP4Atom(MP4File& file, const char* type)
     m_size = 0;
     m_pParentAtom = NULL;
     m_depth = 0xFF;
+    m_pChildIndex = NULL;
+    m_childIndexFailed = false;
+    m_pChildAtomInfos = NULL;
+    m_numChildAtomInfos = 0;
+    m_ownChildAtomInfos = false;
 }
 
 MP4Atom::~MP4Atom()
@@ -65,12 +62,13 @@ MP4Atom::~MP4Atom()
     for (i = 0; i < m_pProperties.Size(); i++) {
         delete m_pProperties[i];
     }
-    for (i = 0; i < m_pChildAtomInfos.Size(); i++) {
-        delete m_pChildAtomInfos[i];
+    if (m_ownChildAtomInfos) {
+        MP4Free((void*)m_pChildAtomInfos);
     }
     for (i = 0; i < m_pChildAtoms.Size(); i++) {
         delete m_pChildAtoms[i];
     }
+    delete m_pChildIndex;
 }
 
 MP4Atom* MP4Atom::CreateAtom( MP4File &file, MP4Atom* parent, const char* type )
@@ -93,13 +91,13 @@ void MP4Atom::Generate()
     }
 
     // for all mandatory, single child atom types
-    for (i = 0; i < m_pChildAtomInfos.Size(); i++) {
-        if (m_pChildAtomInfos[i]->m_mandatory
-                && m_pChildAtomInfos[i]->m_onlyOne) {
+    for (i = 0; i < m_numChildAtomInfos; i++) {
+        if (m_pChildAtomInfos[i].m_mandatory
+                && m_pChildAtomInfos[i].m_onlyOne) {
 
             // create the mandatory, single child atom
             MP4Atom* pChildAtom =
-                CreateAtom(m_File, this, m_pChildAtomInfos[i]->m_name);
+                CreateAtom(m_File, this, m_pChildAtomInfos[i].m_name);
 
             AddChildAtom(pChildAtom);
 
@@ -116,7 +114,7 @@ MP4Atom* MP4Atom::ReadAtom(MP4File& file, MP4Atom* pParentAtom)
 
     uint64_t pos = file.GetPosition();
 
-    log.verbose1f("\"%s\": pos = 0x%" PRIx64, file.GetFilename().c_str(), pos);
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": pos = 0x%" PRIx64, file.GetFilename().c_str(), pos);
 
     uint64_t dataSize = file.ReadUInt32();
 
@@ -124,6 +122,11 @@ MP4Atom* MP4Atom::ReadAtom(MP4File& file, MP4Atom* pParentAtom)
     file.ReadBytes((uint8_t*)&type[0], 4);
     type[4] = '\0';
 
+    MP4PerfCounters* pPerf = file.GetPerfCounters();
+    if (pPerf) {
+        pPerf->atomsParsed++;
+    }
+
     // extended size
     const bool largesizeMode = (dataSize == 1);
     if (dataSize == 1) {
@@ -145,21 +148,21 @@ MP4Atom* MP4Atom::ReadAtom(MP4File& file, MP4Atom* pParentAtom)
 
     dataSize -= hdrSize;
 
-    log.verbose1f("\"%s\": type = \"%s\" data-size = %" PRIu64 " (0x%" PRIx64 ") hdr %u",
-                  file.GetFilename().c_str(), type, dataSize, dataSize, hdrSize);
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": type = \"%s\" data-size = %" PRIu64 " (0x%" PRIx64 ") hdr %u",
+                             file.GetFilename().c_str(), type, dataSize, dataSize, hdrSize);
 
     if (pos + hdrSize + dataSize > pParentAtom->GetEnd()) {
         log.errorf("%s: \"%s\": invalid atom size, extends outside parent atom - skipping to end of \"%s\" \"%s\" %" PRIu64 " vs %" PRIu64,
                    __FUNCTION__, file.GetFilename().c_str(), pParentAtom->GetType(), type,
                    pos + hdrSize + dataSize,
                    pParentAtom->GetEnd());
-        log.verbose1f("\"%s\": parent %s (%" PRIu64 ") pos %" PRIu64 " hdr %d data %" PRIu64 " sum %" PRIu64,
-                      file.GetFilename().c_str(), pParentAtom->GetType(),
-                      pParentAtom->GetEnd(),
-                      pos,
-                      hdrSize,
-                      dataSize,
-                      pos + hdrSize + dataSize);
+        MP4V2_LOG_VERBOSE1( log, "\"%s\": parent %s (%" PRIu64 ") pos %" PRIu64 " hdr %d data %" PRIu64 " sum %" PRIu64,
+                                 file.GetFilename().c_str(), pParentAtom->GetType(),
+                                 pParentAtom->GetEnd(),
+                                 pos,
+                                 hdrSize,
+                                 dataSize,
+                                 pos + hdrSize + dataSize);
 #if 0
         throw new Exception("invalid atom size", __FILE__, __LINE__, __FUNCTION__);
 #else
@@ -182,13 +185,16 @@ MP4Atom* MP4Atom::ReadAtom(MP4File& file, MP4Atom* pParentAtom)
             log.warningf("%s: \"%s\": atom type %s is suspect", __FUNCTION__, file.GetFilename().c_str(),
                          pAtom->GetType());
         } else {
-            log.verbose1f("\"%s\": Info: atom type %s is unknown", file.GetFilename().c_str(),
-                          pAtom->GetType());
+            MP4V2_LOG_VERBOSE1( log, "\"%s\": Info: atom type %s is unknown", file.GetFilename().c_str(),
+                                     pAtom->GetType());
         }
 
         if (dataSize > 0) {
-            pAtom->AddProperty(
-                new MP4BytesProperty(*pAtom, "data", dataSize));
+            // sized without a buffer, Read() allocates one unless deferred
+            MP4BytesProperty* pData = new MP4BytesProperty(*pAtom, "data");
+            pData->SetValueSize(dataSize);
+            pData->EnableDeferredRead();
+            pAtom->AddProperty(pData);
         }
     }
 
@@ -225,14 +231,14 @@ bool MP4Atom::IsReasonableType(const char* type)
 void MP4Atom::Read()
 {
     if (ATOMID(m_type) != 0 && m_size > 10000000) {
-        log.verbose1f("%s: \"%s\": %s atom size %" PRIu64 " is suspect", __FUNCTION__,
-                     m_File.GetFilename().c_str(), m_type, m_size);
+        MP4V2_LOG_VERBOSE1( log, "%s: \"%s\": %s atom size %" PRIu64 " is suspect", __FUNCTION__,
+                                m_File.GetFilename().c_str(), m_type, m_size);
     }
 
     ReadProperties();
 
     // read child atoms, if we expect there to be some
-    if (m_pChildAtomInfos.Size() > 0) {
+    if (m_numChildAtomInfos > 0) {
         ReadChildAtoms();
     }
 
@@ -242,8 +248,8 @@ void MP4Atom::Read()
 void MP4Atom::Skip()
 {
     if (m_File.GetPosition() != m_end) {
-        log.verbose1f("\"%s\": Skip: %" PRIu64 " bytes",
-                      m_File.GetFilename().c_str(), m_end - m_File.GetPosition());
+        MP4V2_LOG_VERBOSE1( log, "\"%s\": Skip: %" PRIu64 " bytes",
+                                 m_File.GetFilename().c_str(), m_end - m_File.GetPosition());
     }
     m_File.SetPosition(m_end);
 }
@@ -255,8 +261,8 @@ MP4Atom* MP4Atom::FindAtom(const char* name)
     }
 
     if (!IsRootAtom()) {
-        log.verbose1f("\"%s\": FindAtom: matched %s", 
-                      GetFile().GetFilename().c_str(), name);
+        MP4V2_LOG_VERBOSE1( log, "\"%s\": FindAtom: matched %s", 
+                                 GetFile().GetFilename().c_str(), name);
 
         name = MP4NameAfterFirst(name);
 
@@ -278,8 +284,8 @@ bool MP4Atom::FindProperty(const char *name,
     }
 
     if (!IsRootAtom()) {
-        log.verbose1f("\"%s\": FindProperty: matched %s", 
-                      GetFile().GetFilename().c_str(), name);
+        MP4V2_LOG_VERBOSE1( log, "\"%s\": FindProperty: matched %s", 
+                                 GetFile().GetFilename().c_str(), name);
 
         name = MP4NameAfterFirst(name);
 
@@ -311,6 +317,159 @@ bool MP4Atom::IsMe(const char* name)
     return true;
 }
 
+void MP4Atom::AddChildAtom(MP4Atom* pChildAtom)
+{
+    pChildAtom->SetParentAtom(this);
+    m_pChildAtoms.Add(pChildAtom);
+
+    if (m_pChildIndex) {
+        uint32_t key;
+        if (GetChildIndexKey(pChildAtom->GetType(), &key)) {
+            (*m_pChildIndex)[key].push_back(pChildAtom);
+        } else {
+            DropChildIndex();
+        }
+    }
+
+    m_File.AtomTreeChanged();
+}
+
+void MP4Atom::InsertChildAtom(MP4Atom* pChildAtom, uint32_t index)
+{
+    pChildAtom->SetParentAtom(this);
+    m_pChildAtoms.Insert(pChildAtom, index);
+
+    if (m_pChildIndex) {
+        uint32_t key;
+        if (GetChildIndexKey(pChildAtom->GetType(), &key)) {
+            // keep document order among siblings of the same type
+            uint32_t before = 0;
+            for (uint32_t i = 0; i < index; i++) {
+                uint32_t childKey;
+                if (GetChildIndexKey(m_pChildAtoms[i]->GetType(), &childKey)
+                        && childKey == key) {
+                    before++;
+                }
+            }
+            vector<MP4Atom*>& siblings = (*m_pChildIndex)[key];
+            siblings.insert(siblings.begin() + before, pChildAtom);
+        } else {
+            DropChildIndex();
+        }
+    }
+
+    m_File.AtomTreeChanged();
+}
+
+void MP4Atom::DeleteChildAtom(MP4Atom* pChildAtom)
+{
+    for (MP4ArrayIndex i = 0; i < m_pChildAtoms.Size(); i++) {
+        if (m_pChildAtoms[i] == pChildAtom) {
+            m_pChildAtoms.Delete(i);
+
+            uint32_t key;
+            if (!GetChildIndexKey(pChildAtom->GetType(), &key)) {
+                // the index may be possible without this child
+                m_childIndexFailed = false;
+            } else if (m_pChildIndex) {
+                ChildIndex::iterator it = m_pChildIndex->find(key);
+                if (it != m_pChildIndex->end()) {
+                    vector<MP4Atom*>& siblings = it->second;
+                    for (uint32_t j = 0; j < siblings.size(); j++) {
+                        if (siblings[j] == pChildAtom) {
+                            siblings.erase(siblings.begin() + j);
+                            break;
+                        }
+                    }
+                    if (siblings.empty()) {
+                        m_pChildIndex->erase(it);
+                    }
+                }
+            }
+
+            m_File.AtomTreeChanged();
+            return;
+        }
+    }
+}
+
+// index key for an exact four character type or first name component,
+// folded to lower case since name matching is case insensitive
+bool MP4Atom::GetChildIndexKey(const char* name, uint32_t* pKey)
+{
+    if (name == NULL || name[0] == '*') {
+        return false;
+    }
+
+    uint32_t key = 0;
+    for (uint8_t i = 0; i < 4; i++) {
+        if (name[i] == '\0' || name[i] == '[' || name[i] == '.') {
+            return false;
+        }
+        key = (key << 8) | (uint8_t)tolower((uint8_t)name[i]);
+    }
+    if (name[4] != '\0' && name[4] != '[' && name[4] != '.') {
+        return false;
+    }
+
+    *pKey = key;
+    return true;
+}
+
+bool MP4Atom::BuildChildIndex()
+{
+    if (m_pChildIndex) {
+        return true;
+    }
+    if (m_childIndexFailed) {
+        return false;
+    }
+
+    ChildIndex* pIndex = new ChildIndex;
+    for (uint32_t i = 0; i < m_pChildAtoms.Size(); i++) {
+        uint32_t key;
+        if (!GetChildIndexKey(m_pChildAtoms[i]->GetType(), &key)) {
+            // odd child types only match by prefix, leave them to a scan
+            // until one of them is deleted
+            delete pIndex;
+            m_childIndexFailed = true;
+            return false;
+        }
+        (*pIndex)[key].push_back(m_pChildAtoms[i]);
+    }
+
+    m_pChildIndex = pIndex;
+    return true;
+}
+
+void MP4Atom::DropChildIndex()
+{
+    delete m_pChildIndex;
+    m_pChildIndex = NULL;
+    m_childIndexFailed = false;
+}
+
+// find the atomIndex'th child of the type named by the first component of
+// name through the child index, returns false if the index can't answer
+bool MP4Atom::FindIndexedChildAtom(const char* name, uint32_t atomIndex,
+                                   MP4Atom** ppChildAtom)
+{
+    uint32_t key;
+    if (m_pChildAtoms.Size() < ChildIndexMinChildren
+            || !GetChildIndexKey(name, &key)
+            || !BuildChildIndex()) {
+        return false;
+    }
+
+    *ppChildAtom = NULL;
+
+    ChildIndex::iterator it = m_pChildIndex->find(key);
+    if (it != m_pChildIndex->end() && atomIndex < it->second.size()) {
+        *ppChildAtom = it->second[atomIndex];
+    }
+    return true;
+}
+
 MP4Atom* MP4Atom::FindChildAtom(const char* name)
 {
     uint32_t atomIndex = 0;
@@ -318,6 +477,11 @@ MP4Atom* MP4Atom::FindChildAtom(const char* name)
     // get the index if we have one, e.g. moov.trak[2].mdia...
     (void)MP4NameFirstIndex(name, &atomIndex);
 
+    MP4Atom* pChildAtom;
+    if (FindIndexedChildAtom(name, atomIndex, &pChildAtom)) {
+        return pChildAtom ? pChildAtom->FindAtom(name) : NULL;
+    }
+
     // need to get to the index'th child atom of the right type
     for (uint32_t i = 0; i < m_pChildAtoms.Size(); i++) {
         if (MP4NameFirstMatches(m_pChildAtoms[i]->GetType(), name)) {
@@ -352,19 +516,26 @@ bool MP4Atom::FindContainedProperty(const char *name,
     uint32_t atomIndex = 0;
     (void)MP4NameFirstIndex(name, &atomIndex);
 
-    // need to get to the index'th child atom of the right type
-    for (i = 0; i < m_pChildAtoms.Size(); i++) {
-        if (MP4NameFirstMatches(m_pChildAtoms[i]->GetType(), name)) {
-            if (atomIndex == 0) {
-                // this is the one, ask it to match
-                return m_pChildAtoms[i]->FindProperty(name, ppProperty, pIndex);
+    MP4Atom* pChildAtom;
+    if (FindIndexedChildAtom(name, atomIndex, &pChildAtom)) {
+        if (pChildAtom) {
+            return pChildAtom->FindProperty(name, ppProperty, pIndex);
+        }
+    } else {
+        // need to get to the index'th child atom of the right type
+        for (i = 0; i < m_pChildAtoms.Size(); i++) {
+            if (MP4NameFirstMatches(m_pChildAtoms[i]->GetType(), name)) {
+                if (atomIndex == 0) {
+                    // this is the one, ask it to match
+                    return m_pChildAtoms[i]->FindProperty(name, ppProperty, pIndex);
+                }
+                atomIndex--;
             }
-            atomIndex--;
         }
     }
 
-    log.verbose1f("\"%s\": FindProperty: no match for %s", 
-                  GetFile().GetFilename().c_str(), name);
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": FindProperty: no match for %s", 
+                             GetFile().GetFilename().c_str(), name);
     return false;
 }
 
@@ -378,9 +549,9 @@ void MP4Atom::ReadProperties(uint32_t startIndex, uint32_t count)
         m_pProperties[i]->Read(m_File);
 
         if (m_File.GetPosition() > m_end) {
-            log.verbose1f("ReadProperties: insufficient data for property: %s pos 0x%" PRIx64 " atom end 0x%" PRIx64,
-                          m_pProperties[i]->GetName(),
-                          m_File.GetPosition(), m_end);
+            MP4V2_LOG_VERBOSE1( log, "ReadProperties: insufficient data for property: %s pos 0x%" PRIx64 " atom end 0x%" PRIx64,
+                                     m_pProperties[i]->GetName(),
+                                     m_File.GetPosition(), m_end);
 
             ostringstream oss;
             oss << "atom '" << GetType() << "' is too small; overrun at property: " << m_pProperties[i]->GetName();
@@ -402,7 +573,10 @@ void MP4Atom::ReadChildAtoms()
 {
     bool this_is_udta = ATOMID(m_type) == ATOMID("udta");
 
-    log.verbose1f("\"%s\": of %s", m_File.GetFilename().c_str(), m_type[0] ? m_type : "root");
+    // instances seen of each expected child atom
+    vector<uint32_t> counts(m_numChildAtomInfos, 0);
+
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": of %s", m_File.GetFilename().c_str(), m_type[0] ? m_type : "root");
     for (uint64_t position = m_File.GetPosition();
             position < m_end;
             position = m_File.GetPosition()) {
@@ -431,21 +605,22 @@ void MP4Atom::ReadChildAtoms()
 
         AddChildAtom(pChildAtom);
 
-        MP4AtomInfo* pChildAtomInfo = FindAtomInfo(pChildAtom->GetType());
+        int32_t childAtomInfo = FindAtomInfo(pChildAtom->GetType());
 
         // if child atom is of known type
         // but not expected here print warning
-        if (pChildAtomInfo == NULL && !pChildAtom->IsUnknownType()) {
+        if (childAtomInfo < 0 && !pChildAtom->IsUnknownType()) {
             log.warningf("%s: \"%s\": In atom %s unexpected child atom %s", __FUNCTION__,
                          m_File.GetFilename().c_str(), GetType(), pChildAtom->GetType());
         }
 
         // if child atoms should have just one instance
         // and this is more than one, print warning
-        if (pChildAtomInfo) {
-            pChildAtomInfo->m_count++;
+        if (childAtomInfo >= 0) {
+            counts[childAtomInfo]++;
 
-            if (pChildAtomInfo->m_onlyOne && pChildAtomInfo->m_count > 1) {
+            if (m_pChildAtomInfos[childAtomInfo].m_onlyOne
+                    && counts[childAtomInfo] > 1) {
                 log.warningf("%s: \"%s\": In atom %s multiple child atoms %s", __FUNCTION__,
                              m_File.GetFilename().c_str(), GetType(), pChildAtom->GetType());
             }
@@ -454,27 +629,24 @@ void MP4Atom::ReadChildAtoms()
     }
 
     // if mandatory child atom doesn't exist, print warning
-    uint32_t numAtomInfo = m_pChildAtomInfos.Size();
-    for (uint32_t i = 0; i < numAtomInfo; i++) {
-        if (m_pChildAtomInfos[i]->m_mandatory
-                && m_pChildAtomInfos[i]->m_count == 0) {
+    for (uint32_t i = 0; i < m_numChildAtomInfos; i++) {
+        if (m_pChildAtomInfos[i].m_mandatory && counts[i] == 0) {
             log.warningf("%s: \"%s\": In atom %s missing child atom %s", __FUNCTION__,
-                         m_File.GetFilename().c_str(), GetType(), m_pChildAtomInfos[i]->m_name);
+                         m_File.GetFilename().c_str(), GetType(), m_pChildAtomInfos[i].m_name);
         }
     }
 
-    log.verbose1f("\"%s\": finished %s", m_File.GetFilename().c_str(), m_type);
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": finished %s", m_File.GetFilename().c_str(), m_type);
 }
 
-MP4AtomInfo* MP4Atom::FindAtomInfo(const char* name)
+int32_t MP4Atom::FindAtomInfo(const char* name)
 {
-    uint32_t numAtomInfo = m_pChildAtomInfos.Size();
-    for (uint32_t i = 0; i < numAtomInfo; i++) {
-        if (ATOMID(m_pChildAtomInfos[i]->m_name) == ATOMID(name)) {
-            return m_pChildAtomInfos[i];
+    for (uint32_t i = 0; i < m_numChildAtomInfos; i++) {
+        if (ATOMID(m_pChildAtomInfos[i].m_name) == ATOMID(name)) {
+            return i;
         }
     }
-    return NULL;
+    return -1;
 }
 
 // generic write
@@ -525,8 +697,8 @@ void MP4Atom::FinishWrite(bool use64)
     m_end = m_File.GetPosition();
     m_size = (m_end - m_start);
 
-    log.verbose1f("end: type %s %" PRIu64 " %" PRIu64 " size %" PRIu64,
-                       m_type,m_start, m_end, m_size);
+    MP4V2_LOG_VERBOSE1( log, "end: type %s %" PRIu64 " %" PRIu64 " size %" PRIu64,
+                                  m_type,m_start, m_end, m_size);
     //use64 = m_File.Use64Bits();
     if (use64) {
         m_File.SetPosition(m_start + 8);
@@ -549,7 +721,7 @@ void MP4Atom::WriteProperties(uint32_t startIndex, uint32_t count)
 {
     uint32_t numProperties = min(count, m_pProperties.Size() - startIndex);
 
-    log.verbose1f("Write: \"%s\": type %s", m_File.GetFilename().c_str(), m_type);
+    MP4V2_LOG_VERBOSE1( log, "Write: \"%s\": type %s", m_File.GetFilename().c_str(), m_type);
 
     for (uint32_t i = startIndex; i < startIndex + numProperties; i++) {
         m_pProperties[i]->Write(m_File);
@@ -572,13 +744,14 @@ void MP4Atom::WriteChildAtoms()
         m_pChildAtoms[i]->Write();
     }
 
-    log.verbose1f("Write: \"%s\": finished %s", m_File.GetFilename().c_str(), m_type);
+    MP4V2_LOG_VERBOSE1( log, "Write: \"%s\": finished %s", m_File.GetFilename().c_str(), m_type);
 }
 
 void MP4Atom::AddProperty(MP4Property* pProperty)
 {
     ASSERT(pProperty);
     m_pProperties.Add(pProperty);
+    m_File.AtomTreeChanged();
 }
 
 void MP4Atom::AddVersionAndFlags()
@@ -594,9 +767,29 @@ void MP4Atom::AddReserved(MP4Atom& parentAtom, const char* name, uint32_t size)
     AddProperty(pReserved);
 }
 
-void MP4Atom::ExpectChildAtom(const char* name, bool mandatory, bool onlyOne)
+void MP4Atom::ExpectChildAtoms(const MP4AtomInfo* pInfos, uint32_t count)
 {
-    m_pChildAtomInfos.Add(new MP4AtomInfo(name, mandatory, onlyOne));
+    if (m_numChildAtomInfos == 0) {
+        // the common case, share the caller's static table
+        m_pChildAtomInfos = pInfos;
+        m_numChildAtomInfos = count;
+        return;
+    }
+
+    // expectations from more than one table, keep a merged copy
+    MP4AtomInfo* pMerged = (MP4AtomInfo*)MP4Malloc(
+        (m_numChildAtomInfos + count) * sizeof(MP4AtomInfo));
+    memcpy(pMerged, m_pChildAtomInfos,
+           m_numChildAtomInfos * sizeof(MP4AtomInfo));
+    memcpy(pMerged + m_numChildAtomInfos, pInfos,
+           count * sizeof(MP4AtomInfo));
+
+    if (m_ownChildAtomInfos) {
+        MP4Free((void*)m_pChildAtomInfos);
+    }
+    m_pChildAtomInfos = pMerged;
+    m_numChildAtomInfos += count;
+    m_ownChildAtomInfos = true;
 }
 
 uint8_t MP4Atom::GetVersion()
@@ -717,57 +910,192 @@ MP4Atom::descendsFrom( MP4Atom* parent, const char* type )
     return false;
 }
 
-// UDTA child atom types to be constructed as MP4UdtaElementAtom.
-// List gleaned from QTFF 2007-09-04.
-static const char* const UDTA_ELEMENTS[] = {
-    "\xA9" "arg",
-    "\xA9" "ark",
-    "\xA9" "cok",
-    "\xA9" "com",
-    "\xA9" "cpy",
-    "\xA9" "day",
-    "\xA9" "dir",
-    "\xA9" "ed1",
-    "\xA9" "ed2",
-    "\xA9" "ed3",
-    "\xA9" "ed4",
-    "\xA9" "ed5",
-    "\xA9" "ed6",
-    "\xA9" "ed7",
-    "\xA9" "ed8",
-    "\xA9" "ed9",
-    "\xA9" "fmt",
-    "\xA9" "inf",
-    "\xA9" "isr",
-    "\xA9" "lab",
-    "\xA9" "lal",
-    "\xA9" "mak",
-    "\xA9" "nak",
-    "\xA9" "nam",
-    "\xA9" "pdk",
-    "\xA9" "phg",
-    "\xA9" "prd",
-    "\xA9" "prf",
-    "\xA9" "prk",
-    "\xA9" "prl",
-    "\xA9" "req",
-    "\xA9" "snk",
-    "\xA9" "snm",
-    "\xA9" "src",
-    "\xA9" "swf",
-    "\xA9" "swk",
-    "\xA9" "swr",
-    "\xA9" "wrt",
-    "Allf",
-    "hinf",
-    "hnti",
-    "name",
-    "LOOP",
-    "ptv ",
-    "SelO",
-    "WLOC",
-    NULL // must be last
-};
+namespace {
+    // big-endian FOURCC as a constant expression, equal to ATOMID()
+    #define ATOM_FACTORY_ID(a,b,c,d) \
+        ( (uint32_t(uint8_t(a)) << 24) | (uint32_t(uint8_t(b)) << 16) \
+        | (uint32_t(uint8_t(c)) << 8)  |  uint32_t(uint8_t(d)) )
+
+    typedef MP4Atom* (*AtomConstructor)( MP4File& file, const char* type );
+
+    template <class T>
+    MP4Atom* newAtom( MP4File& file, const char* )
+    {
+        return new T( file );
+    }
+
+    template <class T>
+    MP4Atom* newTypedAtom( MP4File& file, const char* type )
+    {
+        return new T( file, type );
+    }
+
+    struct AtomFactoryEntry {
+        uint32_t        id;
+        AtomConstructor construct;
+    };
+
+    // Atom types with a specialized implementation regardless of context.
+    // Must be kept sorted by id for lookupAtomFactory().
+    const AtomFactoryEntry ATOM_FACTORY[] = {
+        { ATOM_FACTORY_ID( 'S', 'M', 'I', ' ' ), newAtom<MP4SmiAtom> },
+        { ATOM_FACTORY_ID( 'S', 'V', 'Q', '3' ), newTypedAtom<MP4VideoAtom> },
+        { ATOM_FACTORY_ID( 'a', 'c', '-', '3' ), newAtom<MP4Ac3Atom> },
+        { ATOM_FACTORY_ID( 'a', 'l', 'a', 'c' ), newTypedAtom<MP4SoundAtom> },
+        { ATOM_FACTORY_ID( 'a', 'l', 'a', 'w' ), newTypedAtom<MP4SoundAtom> },
+        { ATOM_FACTORY_ID( 'a', 'l', 'i', 's' ), newTypedAtom<MP4UrlAtom> },
+        { ATOM_FACTORY_ID( 'a', 'v', 'c', '1' ), newAtom<MP4Avc1Atom> },
+        { ATOM_FACTORY_ID( 'a', 'v', 'c', 'C' ), newAtom<MP4AvcCAtom> },
+        { ATOM_FACTORY_ID( 'c', '6', '0', '8' ), newAtom<MP4C608Atom> },
+        { ATOM_FACTORY_ID( 'c', 'h', 'a', 'p' ), newTypedAtom<MP4TrefTypeAtom> },
+        { ATOM_FACTORY_ID( 'c', 'h', 'p', 'l' ), newAtom<MP4ChplAtom> },
+        { ATOM_FACTORY_ID( 'c', 'o', 'l', 'r' ), newAtom<MP4ColrAtom> },
+        { ATOM_FACTORY_ID( 'd', '2', '6', '3' ), newAtom<MP4D263Atom> },
+        { ATOM_FACTORY_ID( 'd', 'a', 'c', '3' ), newAtom<MP4DAc3Atom> },
+        { ATOM_FACTORY_ID( 'd', 'a', 'm', 'r' ), newAtom<MP4DamrAtom> },
+        { ATOM_FACTORY_ID( 'd', 'p', 'n', 'd' ), newTypedAtom<MP4TrefTypeAtom> },
+        { ATOM_FACTORY_ID( 'd', 'r', 'e', 'f' ), newAtom<MP4DrefAtom> },
+        { ATOM_FACTORY_ID( 'e', 'l', 's', 't' ), newAtom<MP4ElstAtom> },
+        { ATOM_FACTORY_ID( 'e', 'n', 'c', 'a' ), newAtom<MP4EncaAtom> },
+        { ATOM_FACTORY_ID( 'e', 'n', 'c', 'v' ), newAtom<MP4EncvAtom> },
+        { ATOM_FACTORY_ID( 'f', 'r', 'e', 'e' ), newAtom<MP4FreeAtom> },
+        { ATOM_FACTORY_ID( 'f', 't', 'a', 'b' ), newAtom<MP4FtabAtom> },
+        { ATOM_FACTORY_ID( 'f', 't', 'y', 'p' ), newAtom<MP4FtypAtom> },
+        { ATOM_FACTORY_ID( 'g', 'm', 'i', 'n' ), newAtom<MP4GminAtom> },
+        { ATOM_FACTORY_ID( 'h', '2', '6', '3' ), newTypedAtom<MP4VideoAtom> },
+        { ATOM_FACTORY_ID( 'h', 'd', 'l', 'r' ), newAtom<MP4HdlrAtom> },
+        { ATOM_FACTORY_ID( 'h', 'i', 'n', 'f' ), newAtom<MP4HinfAtom> },
+        { ATOM_FACTORY_ID( 'h', 'i', 'n', 't' ), newTypedAtom<MP4TrefTypeAtom> },
+        { ATOM_FACTORY_ID( 'h', 'n', 't', 'i' ), newAtom<MP4HntiAtom> },
+        { ATOM_FACTORY_ID( 'h', 'r', 'e', 'f' ), newAtom<MP4HrefAtom> },
+        { ATOM_FACTORY_ID( 'i', 'm', 'a', '4' ), newTypedAtom<MP4SoundAtom> },
+        { ATOM_FACTORY_ID( 'i', 'p', 'i', 'r' ), newTypedAtom<MP4TrefTypeAtom> },
+        { ATOM_FACTORY_ID( 'j', 'p', 'e', 'g' ), newTypedAtom<MP4VideoAtom> },
+        { ATOM_FACTORY_ID( 'm', 'd', 'a', 't' ), newAtom<MP4MdatAtom> },
+        { ATOM_FACTORY_ID( 'm', 'd', 'h', 'd' ), newAtom<MP4MdhdAtom> },
+        { ATOM_FACTORY_ID( 'm', 'p', '4', 'a' ), newTypedAtom<MP4SoundAtom> },
+        { ATOM_FACTORY_ID( 'm', 'p', '4', 's' ), newAtom<MP4Mp4sAtom> },
+        { ATOM_FACTORY_ID( 'm', 'p', '4', 'v' ), newAtom<MP4Mp4vAtom> },
+        { ATOM_FACTORY_ID( 'm', 'p', 'o', 'd' ), newTypedAtom<MP4TrefTypeAtom> },
+        { ATOM_FACTORY_ID( 'm', 'v', 'h', 'd' ), newAtom<MP4MvhdAtom> },
+        { ATOM_FACTORY_ID( 'n', 'm', 'h', 'd' ), newAtom<MP4NmhdAtom> },
+        { ATOM_FACTORY_ID( 'o', 'h', 'd', 'r' ), newAtom<MP4OhdrAtom> },
+        { ATOM_FACTORY_ID( 'p', 'a', 's', 'p' ), newAtom<MP4PaspAtom> },
+        { ATOM_FACTORY_ID( 'r', 'a', 'w', ' ' ), newTypedAtom<MP4VideoAtom> },
+        { ATOM_FACTORY_ID( 'r', 't', 'p', ' ' ), newAtom<MP4RtpAtom> },
+        { ATOM_FACTORY_ID( 's', '2', '6', '3' ), newAtom<MP4S263Atom> },
+        { ATOM_FACTORY_ID( 's', 'a', 'm', 'r' ), newTypedAtom<MP4AmrAtom> },
+        { ATOM_FACTORY_ID( 's', 'a', 'w', 'b' ), newTypedAtom<MP4AmrAtom> },
+        { ATOM_FACTORY_ID( 's', 'd', 'p', ' ' ), newAtom<MP4SdpAtom> },
+        { ATOM_FACTORY_ID( 's', 'd', 't', 'p' ), newAtom<MP4SdtpAtom> },
+        { ATOM_FACTORY_ID( 's', 'k', 'i', 'p' ), newTypedAtom<MP4FreeAtom> },
+        { ATOM_FACTORY_ID( 's', 'o', 'w', 't' ), newTypedAtom<MP4SoundAtom> },
+        { ATOM_FACTORY_ID( 's', 't', 'b', 'l' ), newAtom<MP4StblAtom> },
+        { ATOM_FACTORY_ID( 's', 't', 'd', 'p' ), newAtom<MP4StdpAtom> },
+        { ATOM_FACTORY_ID( 's', 't', 's', 'c' ), newAtom<MP4StscAtom> },
+        { ATOM_FACTORY_ID( 's', 't', 's', 'd' ), newAtom<MP4StsdAtom> },
+        { ATOM_FACTORY_ID( 's', 't', 's', 'z' ), newAtom<MP4StszAtom> },
+        { ATOM_FACTORY_ID( 's', 't', 'z', '2' ), newAtom<MP4Stz2Atom> },
+        { ATOM_FACTORY_ID( 's', 'y', 'n', 'c' ), newTypedAtom<MP4TrefTypeAtom> },
+        { ATOM_FACTORY_ID( 't', 'e', 'x', 't' ), newAtom<MP4TextAtom> },
+        { ATOM_FACTORY_ID( 't', 'f', 'h', 'd' ), newAtom<MP4TfhdAtom> },
+        { ATOM_FACTORY_ID( 't', 'k', 'h', 'd' ), newAtom<MP4TkhdAtom> },
+        { ATOM_FACTORY_ID( 't', 'r', 'u', 'n' ), newAtom<MP4TrunAtom> },
+        { ATOM_FACTORY_ID( 't', 'w', 'o', 's' ), newTypedAtom<MP4SoundAtom> },
+        { ATOM_FACTORY_ID( 't', 'x', '3', 'g' ), newAtom<MP4Tx3gAtom> },
+        { ATOM_FACTORY_ID( 'u', 'd', 't', 'a' ), newAtom<MP4UdtaAtom> },
+        { ATOM_FACTORY_ID( 'u', 'l', 'a', 'w' ), newTypedAtom<MP4SoundAtom> },
+        { ATOM_FACTORY_ID( 'u', 'r', 'l', ' ' ), newAtom<MP4UrlAtom> },
+        { ATOM_FACTORY_ID( 'u', 'r', 'n', ' ' ), newAtom<MP4UrnAtom> },
+        { ATOM_FACTORY_ID( 'v', 'm', 'h', 'd' ), newAtom<MP4VmhdAtom> },
+        { ATOM_FACTORY_ID( 'y', 'u', 'v', '2' ), newTypedAtom<MP4VideoAtom> },
+    };
+
+    // UDTA child atom types to be constructed as MP4UdtaElementAtom.
+    // List gleaned from QTFF 2007-09-04, sorted by id for hasUdtaElement().
+    const uint32_t UDTA_ELEMENTS[] = {
+        ATOM_FACTORY_ID( 'A', 'l', 'l', 'f' ),
+        ATOM_FACTORY_ID( 'L', 'O', 'O', 'P' ),
+        ATOM_FACTORY_ID( 'S', 'e', 'l', 'O' ),
+        ATOM_FACTORY_ID( 'W', 'L', 'O', 'C' ),
+        ATOM_FACTORY_ID( 'h', 'i', 'n', 'f' ),
+        ATOM_FACTORY_ID( 'h', 'n', 't', 'i' ),
+        ATOM_FACTORY_ID( 'n', 'a', 'm', 'e' ),
+        ATOM_FACTORY_ID( 'p', 't', 'v', ' ' ),
+        ATOM_FACTORY_ID( 0xA9, 'a', 'r', 'g' ),
+        ATOM_FACTORY_ID( 0xA9, 'a', 'r', 'k' ),
+        ATOM_FACTORY_ID( 0xA9, 'c', 'o', 'k' ),
+        ATOM_FACTORY_ID( 0xA9, 'c', 'o', 'm' ),
+        ATOM_FACTORY_ID( 0xA9, 'c', 'p', 'y' ),
+        ATOM_FACTORY_ID( 0xA9, 'd', 'a', 'y' ),
+        ATOM_FACTORY_ID( 0xA9, 'd', 'i', 'r' ),
+        ATOM_FACTORY_ID( 0xA9, 'e', 'd', '1' ),
+        ATOM_FACTORY_ID( 0xA9, 'e', 'd', '2' ),
+        ATOM_FACTORY_ID( 0xA9, 'e', 'd', '3' ),
+        ATOM_FACTORY_ID( 0xA9, 'e', 'd', '4' ),
+        ATOM_FACTORY_ID( 0xA9, 'e', 'd', '5' ),
+        ATOM_FACTORY_ID( 0xA9, 'e', 'd', '6' ),
+        ATOM_FACTORY_ID( 0xA9, 'e', 'd', '7' ),
+        ATOM_FACTORY_ID( 0xA9, 'e', 'd', '8' ),
+        ATOM_FACTORY_ID( 0xA9, 'e', 'd', '9' ),
+        ATOM_FACTORY_ID( 0xA9, 'f', 'm', 't' ),
+        ATOM_FACTORY_ID( 0xA9, 'i', 'n', 'f' ),
+        ATOM_FACTORY_ID( 0xA9, 'i', 's', 'r' ),
+        ATOM_FACTORY_ID( 0xA9, 'l', 'a', 'b' ),
+        ATOM_FACTORY_ID( 0xA9, 'l', 'a', 'l' ),
+        ATOM_FACTORY_ID( 0xA9, 'm', 'a', 'k' ),
+        ATOM_FACTORY_ID( 0xA9, 'n', 'a', 'k' ),
+        ATOM_FACTORY_ID( 0xA9, 'n', 'a', 'm' ),
+        ATOM_FACTORY_ID( 0xA9, 'p', 'd', 'k' ),
+        ATOM_FACTORY_ID( 0xA9, 'p', 'h', 'g' ),
+        ATOM_FACTORY_ID( 0xA9, 'p', 'r', 'd' ),
+        ATOM_FACTORY_ID( 0xA9, 'p', 'r', 'f' ),
+        ATOM_FACTORY_ID( 0xA9, 'p', 'r', 'k' ),
+        ATOM_FACTORY_ID( 0xA9, 'p', 'r', 'l' ),
+        ATOM_FACTORY_ID( 0xA9, 'r', 'e', 'q' ),
+        ATOM_FACTORY_ID( 0xA9, 's', 'n', 'k' ),
+        ATOM_FACTORY_ID( 0xA9, 's', 'n', 'm' ),
+        ATOM_FACTORY_ID( 0xA9, 's', 'r', 'c' ),
+        ATOM_FACTORY_ID( 0xA9, 's', 'w', 'f' ),
+        ATOM_FACTORY_ID( 0xA9, 's', 'w', 'k' ),
+        ATOM_FACTORY_ID( 0xA9, 's', 'w', 'r' ),
+        ATOM_FACTORY_ID( 0xA9, 'w', 'r', 't' ),
+    };
+
+    #undef ATOM_FACTORY_ID
+
+    AtomConstructor
+    lookupAtomFactory( uint32_t id )
+    {
+        uint32_t lo = 0;
+        uint32_t hi = sizeof(ATOM_FACTORY) / sizeof(ATOM_FACTORY[0]);
+        while( lo < hi ) {
+            const uint32_t mid = (lo + hi) / 2;
+            if( ATOM_FACTORY[mid].id < id )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if( lo < sizeof(ATOM_FACTORY) / sizeof(ATOM_FACTORY[0]) && ATOM_FACTORY[lo].id == id )
+            return ATOM_FACTORY[lo].construct;
+        return NULL;
+    }
+
+    bool
+    hasUdtaElement( uint32_t id )
+    {
+        uint32_t lo = 0;
+        uint32_t hi = sizeof(UDTA_ELEMENTS) / sizeof(UDTA_ELEMENTS[0]);
+        while( lo < hi ) {
+            const uint32_t mid = (lo + hi) / 2;
+            if( UDTA_ELEMENTS[mid] < id )
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo < sizeof(UDTA_ELEMENTS) / sizeof(UDTA_ELEMENTS[0]) && UDTA_ELEMENTS[lo] == id;
+    }
+} // namespace
 
 MP4Atom*
 MP4Atom::factory( MP4File &file, MP4Atom* parent, const char* type )
@@ -776,245 +1104,48 @@ MP4Atom::factory( MP4File &file, MP4Atom* parent, const char* type )
     if( !type )
         return new MP4RootAtom(file);
 
+    const uint32_t id = ATOMID( type );
+
     // construct atoms which are context-savvy
     if( parent ) {
-        const char* const ptype = parent->GetType();
+        const uint32_t pid = ATOMID( parent->GetType() );
 
         if( descendsFrom( parent, "ilst" )) {
-            if( ATOMID( ptype ) == ATOMID( "ilst" ))
+            if( pid == ATOMID( "ilst" ))
                 return new MP4ItemAtom( file, type );
 
-            if( ATOMID( type ) == ATOMID( "data" ))
+            if( id == ATOMID( "data" ))
                 return new MP4DataAtom(file);
 
-            if( ATOMID( ptype ) == ATOMID( "----" )) {
-                if( ATOMID( type ) == ATOMID( "mean" ))
+            if( pid == ATOMID( "----" )) {
+                if( id == ATOMID( "mean" ))
                     return new MP4MeanAtom(file);
-                if( ATOMID( type ) == ATOMID( "name" ))
+                if( id == ATOMID( "name" ))
                     return new MP4NameAtom(file);
             }
         }
-        else if( ATOMID( ptype ) == ATOMID( "meta" )) {
-            if( ATOMID( type ) == ATOMID( "hdlr" ))
+        else if( pid == ATOMID( "meta" )) {
+            if( id == ATOMID( "hdlr" ))
                 return new MP4ItmfHdlrAtom(file);
         }
-        else if( ATOMID( ptype ) == ATOMID( "udta" )) {
-            for( const char* const* p = UDTA_ELEMENTS; *p; p++ )
-                if( !strcmp( type, *p ))
-                    return new MP4UdtaElementAtom( file, type );
+        else if( pid == ATOMID( "udta" )) {
+            // hint track containers share names with QTFF udta elements
+            if( id == ATOMID( "hnti" ))
+                return new MP4HntiAtom(file);
+            if( id == ATOMID( "hinf" ))
+                return new MP4HinfAtom(file);
+            if( strlen( type ) == 4 && hasUdtaElement( id ))
+                return new MP4UdtaElementAtom( file, type );
         }
     }
 
     // no-context construction (old-style)
-    switch( (uint8_t)type[0] ) {
-        case 'S':
-            if( ATOMID(type) == ATOMID("SVQ3") )
-                return new MP4VideoAtom( file, type );
-            if( ATOMID(type) == ATOMID("SMI ") )
-                return new MP4SmiAtom(file);
-            break;
-
-        case 'a':
-            if( ATOMID(type) == ATOMID("avc1") )
-                return new MP4Avc1Atom(file);
-            if( ATOMID(type) == ATOMID("ac-3") )
-                return new MP4Ac3Atom(file);
-            if( ATOMID(type) == ATOMID("avcC") )
-                return new MP4AvcCAtom(file);
-            if( ATOMID(type) == ATOMID("alis") )
-                return new MP4UrlAtom( file, type );
-            if( ATOMID(type) == ATOMID("alaw") )
-                return new MP4SoundAtom( file, type );
-            if( ATOMID(type) == ATOMID("alac") )
-                return new MP4SoundAtom( file, type );
-            break;
-
-        case 'c':
-            if( ATOMID(type) == ATOMID("c608") )
-                return new MP4C608Atom(file);
-            if( ATOMID(type) == ATOMID("chap") )
-                return new MP4TrefTypeAtom( file, type );
-            if( ATOMID(type) == ATOMID("chpl") )
-                return new MP4ChplAtom(file);
-            if( ATOMID(type) == ATOMID("colr") )
-                return new MP4ColrAtom(file);
-            break;
-
-        case 'd':
-            if( ATOMID(type) == ATOMID("d263") )
-                return new MP4D263Atom(file);
-            if( ATOMID(type) == ATOMID("damr") )
-                return new MP4DamrAtom(file);
-            if( ATOMID(type) == ATOMID("dref") )
-                return new MP4DrefAtom(file);
-            if( ATOMID(type) == ATOMID("dpnd") )
-                return new MP4TrefTypeAtom( file, type );
-            if( ATOMID(type) == ATOMID("dac3") )
-                return new MP4DAc3Atom(file);
-            break;
-
-        case 'e':
-            if( ATOMID(type) == ATOMID("elst") )
-                return new MP4ElstAtom(file);
-            if( ATOMID(type) == ATOMID("enca") )
-                return new MP4EncaAtom(file);
-            if( ATOMID(type) == ATOMID("encv") )
-                return new MP4EncvAtom(file);
-            break;
-
-        case 'f':
-            if( ATOMID(type) == ATOMID("free") )
-                return new MP4FreeAtom(file);
-            if( ATOMID(type) == ATOMID("ftyp") )
-                return new MP4FtypAtom(file);
-            if( ATOMID(type) == ATOMID("ftab") )
-                return new MP4FtabAtom(file);
-            break;
-
-        case 'g':
-            if( ATOMID(type) == ATOMID("gmin") )
-                return new MP4GminAtom(file);
-            break;
-
-        case 'h':
-            if( ATOMID(type) == ATOMID("hdlr") )
-                return new MP4HdlrAtom(file);
-            if( ATOMID(type) == ATOMID("hint") )
-                return new MP4TrefTypeAtom( file, type );
-            if( ATOMID(type) == ATOMID("hnti") )
-                return new MP4HntiAtom(file);
-            if( ATOMID(type) == ATOMID("hinf") )
-                return new MP4HinfAtom(file);
-            if( ATOMID(type) == ATOMID("h263") )
-                return new MP4VideoAtom( file, type );
-            if( ATOMID(type) == ATOMID("href") )
-                return new MP4HrefAtom(file);
-            break;
-
-        case 'i':
-            if( ATOMID(type) == ATOMID("ipir") )
-                return new MP4TrefTypeAtom( file, type );
-            if( ATOMID(type) == ATOMID("ima4") )
-                return new MP4SoundAtom( file, type );
-            break;
-
-        case 'j':
-            if( ATOMID(type) == ATOMID("jpeg") )
-                return new MP4VideoAtom(file, "jpeg");
-            break;
-
-        case 'm':
-            if( ATOMID(type) == ATOMID("mdhd") )
-                return new MP4MdhdAtom(file);
-            if( ATOMID(type) == ATOMID("mvhd") )
-                return new MP4MvhdAtom(file);
-            if( ATOMID(type) == ATOMID("mdat") )
-                return new MP4MdatAtom(file);
-            if( ATOMID(type) == ATOMID("mpod") )
-                return new MP4TrefTypeAtom( file, type );
-            if( ATOMID(type) == ATOMID("mp4a") )
-                return new MP4SoundAtom( file, type );
-            if( ATOMID(type) == ATOMID("mp4s") )
-                return new MP4Mp4sAtom(file);
-            if( ATOMID(type) == ATOMID("mp4v") )
-                return new MP4Mp4vAtom(file);
-            break;
-
-        case 'n':
-            if( ATOMID(type) == ATOMID("nmhd") )
-                return new MP4NmhdAtom(file);
-            break;
-
-        case 'o':
-            if( ATOMID(type) == ATOMID("ohdr") )
-                return new MP4OhdrAtom(file);
-            break;
-
-        case 'p':
-            if( ATOMID(type) == ATOMID("pasp") )
-                return new MP4PaspAtom(file);
-            break;
-
-        case 'r':
-            if( ATOMID(type) == ATOMID("rtp ") )
-                return new MP4RtpAtom(file);
-            if( ATOMID(type) == ATOMID("raw ") )
-                return new MP4VideoAtom( file, type );
-            break;
-
-        case 's':
-            if( ATOMID(type) == ATOMID("s263") )
-                return new MP4S263Atom(file);
-            if( ATOMID(type) == ATOMID("samr") )
-                return new MP4AmrAtom( file, type );
-            if( ATOMID(type) == ATOMID("sawb") )
-                return new MP4AmrAtom( file, type );
-            if( ATOMID(type) == ATOMID("sdtp") )
-                return new MP4SdtpAtom(file);
-            if( ATOMID(type) == ATOMID("stbl") )
-                return new MP4StblAtom(file);
-            if( ATOMID(type) == ATOMID("stsd") )
-                return new MP4StsdAtom(file);
-            if( ATOMID(type) == ATOMID("stsz") )
-                return new MP4StszAtom(file);
-            if( ATOMID(type) == ATOMID("stsc") )
-                return new MP4StscAtom(file);
-            if( ATOMID(type) == ATOMID("stz2") )
-                return new MP4Stz2Atom(file);
-            if( ATOMID(type) == ATOMID("stdp") )
-                return new MP4StdpAtom(file);
-            if( ATOMID(type) == ATOMID("sdp ") )
-                return new MP4SdpAtom(file);
-            if( ATOMID(type) == ATOMID("sync") )
-                return new MP4TrefTypeAtom( file, type );
-            if( ATOMID(type) == ATOMID("skip") )
-                return new MP4FreeAtom( file, type );
-            if (ATOMID(type) == ATOMID("sowt") )
-                return new MP4SoundAtom( file, type );
-            break;
-
-        case 't':
-            if( ATOMID(type) == ATOMID("text") )
-                return new MP4TextAtom(file);
-            if( ATOMID(type) == ATOMID("tx3g") )
-                return new MP4Tx3gAtom(file);
-            if( ATOMID(type) == ATOMID("tkhd") )
-                return new MP4TkhdAtom(file);
-            if( ATOMID(type) == ATOMID("tfhd") )
-                return new MP4TfhdAtom(file);
-            if( ATOMID(type) == ATOMID("trun") )
-                return new MP4TrunAtom(file);
-            if( ATOMID(type) == ATOMID("twos") )
-                return new MP4SoundAtom( file, type );
-            break;
-
-        case 'u':
-            if( ATOMID(type) == ATOMID("udta") )
-                return new MP4UdtaAtom(file);
-            if( ATOMID(type) == ATOMID("url ") )
-                return new MP4UrlAtom(file);
-            if( ATOMID(type) == ATOMID("urn ") )
-                return new MP4UrnAtom(file);
-            if( ATOMID(type) == ATOMID("ulaw") )
-                return new MP4SoundAtom( file, type );
-            break;
-
-        case 'v':
-            if( ATOMID(type) == ATOMID("vmhd") )
-                return new MP4VmhdAtom(file);
-            break;
-
-        case 'y':
-            if( ATOMID(type) == ATOMID("yuv2") )
-                return new MP4VideoAtom( file, type );
-            break;
-
-        default:
-            break;
-    }
+    AtomConstructor construct = lookupAtomFactory( id );
+    if( construct )
+        return construct( file, type );
 
     // default to MP4StandardAtom implementation
-    return new MP4StandardAtom( file, type ); 
+    return new MP4StandardAtom( file, type );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -42,23 +42,14 @@ MP4ARRAY_DECL(MP4Atom, MP4Atom*);
 #define Many        false
 #define Counted     true
 
-/* helper class */
-class MP4AtomInfo {
-public:
-    MP4AtomInfo() {
-        m_name = NULL;
-    }
-    MP4AtomInfo(const char* name, bool mandatory, bool onlyOne);
-
+/* expected child atom, kept in static tables shared by all instances */
+struct MP4AtomInfo {
     const char* m_name;
     bool m_mandatory;
     bool m_onlyOne;
-    uint32_t m_count;
 };
 
-MP4ARRAY_DECL(MP4AtomInfo, MP4AtomInfo*);
-
-class MP4Atom
+class MP4Atom : public MP4ArenaObject
 {
 public:
     static MP4Atom* ReadAtom( MP4File& file, MP4Atom* pParentAtom );
@@ -136,24 +127,11 @@ public:
         m_pParentAtom = pParentAtom;
     }
 
-    void AddChildAtom(MP4Atom* pChildAtom) {
-        pChildAtom->SetParentAtom(this);
-        m_pChildAtoms.Add(pChildAtom);
-    }
+    void AddChildAtom(MP4Atom* pChildAtom);
 
-    void InsertChildAtom(MP4Atom* pChildAtom, uint32_t index) {
-        pChildAtom->SetParentAtom(this);
-        m_pChildAtoms.Insert(pChildAtom, index);
-    }
+    void InsertChildAtom(MP4Atom* pChildAtom, uint32_t index);
 
-    void DeleteChildAtom(MP4Atom* pChildAtom) {
-        for (MP4ArrayIndex i = 0; i < m_pChildAtoms.Size(); i++) {
-            if (m_pChildAtoms[i] == pChildAtom) {
-                m_pChildAtoms.Delete(i);
-                return;
-            }
-        }
-    }
+    void DeleteChildAtom(MP4Atom* pChildAtom);
 
     uint32_t GetNumberOfChildAtoms() {
         return m_pChildAtoms.Size();
@@ -202,16 +180,23 @@ protected:
 
     void AddReserved(MP4Atom& parentAtom, const char* name, uint32_t size);
 
-    void ExpectChildAtom(const char* name,
-                         bool mandatory, bool onlyOne = true);
+    // pInfos must outlive the atom, normally a function local static table
+    void ExpectChildAtoms(const MP4AtomInfo* pInfos, uint32_t count);
+    template <size_t N>
+    void ExpectChildAtoms(const MP4AtomInfo (&infos)[N]) {
+        ExpectChildAtoms(infos, N);
+    }
 
-    MP4AtomInfo* FindAtomInfo(const char* name);
+    int32_t FindAtomInfo(const char* name);
 
     bool IsMe(const char* name);
 
     bool FindContainedProperty(const char* name,
                                MP4Property** ppProperty, uint32_t* pIndex);
 
+    bool FindIndexedChildAtom(const char* name, uint32_t atomIndex,
+                              MP4Atom** ppChildAtom);
+
     void ReadProperties(
         uint32_t startIndex = 0, uint32_t count = 0xFFFFFFFF);
     void ReadChildAtoms();
@@ -239,9 +224,22 @@ protected:
     uint8_t m_depth;
 
     MP4PropertyArray    m_pProperties;
-    MP4AtomInfoArray    m_pChildAtomInfos;
+    const MP4AtomInfo*  m_pChildAtomInfos;
+    uint32_t            m_numChildAtomInfos;
+    bool                m_ownChildAtomInfos;    // merged copy of two tables
     MP4AtomArray        m_pChildAtoms;
 private:
+    // children by case folded type, in document order, built on demand
+    typedef map<uint32_t, vector<MP4Atom*> > ChildIndex;
+    enum { ChildIndexMinChildren = 8 };
+
+    static bool GetChildIndexKey(const char* name, uint32_t* pKey);
+    bool BuildChildIndex();
+    void DropChildIndex();
+
+    ChildIndex* m_pChildIndex;
+    bool        m_childIndexFailed;     // a child has no key, scan instead
+
     MP4Atom();
     MP4Atom( const MP4Atom &src );
     MP4Atom &operator= ( const MP4Atom &src );
@@ -46,6 +46,7 @@ void MP4Descriptor::AddProperty(MP4Property* pProperty)
 {
     ASSERT(pProperty);
     m_pProperties.Add(pProperty);
+    m_parentAtom.GetFile().AtomTreeChanged();
 }
 
 bool MP4Descriptor::FindContainedProperty(const char *name,
@@ -85,8 +86,8 @@ void MP4Descriptor::Read(MP4File& file)
 
 void MP4Descriptor::ReadHeader(MP4File& file)
 {
-    log.verbose1f("\"%s\": ReadDescriptor: pos = 0x%" PRIx64, file.GetFilename().c_str(),
-                  file.GetPosition());
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": ReadDescriptor: pos = 0x%" PRIx64, file.GetFilename().c_str(),
+                             file.GetPosition());
 
     // read tag and length
     uint8_t tag = file.ReadUInt8();
@@ -98,8 +99,8 @@ void MP4Descriptor::ReadHeader(MP4File& file)
     m_size = file.ReadMpegLength();
     m_start = file.GetPosition();
 
-    log.verbose1f("\"%s\": ReadDescriptor: tag 0x%02x data size %u (0x%x)",
-                  file.GetFilename().c_str(), m_tag, m_size, m_size);
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": ReadDescriptor: tag 0x%02x data size %u (0x%x)",
+                             file.GetFilename().c_str(), m_tag, m_size, m_size);
 }
 
 void MP4Descriptor::ReadProperties(MP4File& file,
@@ -27,7 +27,7 @@ namespace impl {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-class MP4Descriptor {
+class MP4Descriptor : public MP4ArenaObject {
 public:
     MP4Descriptor(MP4Atom& parentAtom, uint8_t tag = 0);
 
@@ -47,6 +47,10 @@ public:
     virtual void Write(MP4File& file);
     virtual void Dump(uint8_t indent, bool dumpImplicits);
 
+    uint32_t GetCount() {
+        return m_pProperties.Size();
+    }
+
     MP4Property* GetProperty(uint32_t index) {
         return m_pProperties[index];
     }
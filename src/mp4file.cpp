@@ -29,15 +29,40 @@
  */
 
 #include "src/impl.h"
+#include <algorithm>
 
 namespace mp4v2 { namespace impl {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+static void ClearDirty( MP4Atom& atom )
+{
+    for( uint32_t i = 0; i < atom.GetCount(); i++ )
+        atom.GetProperty( i )->SetDirty( false );
+    for( uint32_t i = 0; i < atom.GetNumberOfChildAtoms(); i++ )
+        ClearDirty( *atom.GetChildAtom( i ));
+}
+
+// outermost atoms holding an edited property, each is rewritten whole
+static void FindDirtyAtoms( MP4Atom& atom, vector<MP4Atom*>& atoms )
+{
+    for( uint32_t i = 0; i < atom.GetCount(); i++ ) {
+        if( atom.GetProperty( i )->IsDirty() ) {
+            atoms.push_back( &atom );
+            return;
+        }
+    }
+    for( uint32_t i = 0; i < atom.GetNumberOfChildAtoms(); i++ )
+        FindDirtyAtoms( *atom.GetChildAtom( i ), atoms );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 MP4File::MP4File( ) :
     m_file             ( NULL )
     , m_fileOriginalSize ( 0 )
     , m_createFlags      ( 0 )
+    , m_propertyHandles  ( "", 0 )
 {
     this->Init();
 }
@@ -48,9 +73,18 @@ MP4File::MP4File( ) :
 void MP4File::Init()
 {
     m_pRootAtom = NULL;
+    m_pArena = NULL;
+    m_pPerfCounters = NULL;
+    m_pFileProvider = NULL;
+    m_pPrefetcher = NULL;
     m_odTrackId = MP4_INVALID_TRACK_ID;
 
+    m_atomGeneration = 0;
+
     m_useIsma = false;
+    m_progressive = false;
+    m_patchMode = false;
+    m_patchGeneration = 0;
 
     m_pModificationProperty = NULL;
     m_pTimeScaleProperty = NULL;
@@ -70,12 +104,17 @@ void MP4File::Init()
 
 MP4File::~MP4File()
 {
+    delete m_pPrefetcher;
     delete m_pRootAtom;
     for( uint32_t i = 0; i < m_pTracks.Size(); i++ )
         delete m_pTracks[i];
     MP4Free( m_memoryBuffer ); // just in case
     CHECK_AND_FREE( m_editName );
     delete m_file;
+    delete m_pFileProvider;
+    // last, every arena object has been destroyed with the tree
+    delete m_pArena;
+    delete m_pPerfCounters;
 }
 
 const std::string &
@@ -90,10 +129,70 @@ MP4File::GetFilename() const
     return m_file->name;
 }
 
-void MP4File::Read( const char* name, const MP4FileProvider* provider )
+void MP4File::Read( const char* name, const MP4FileProvider* provider, uint32_t flags )
 {
-    Open( name, File::MODE_READ, provider );
-    ReadFromFile();
+    if( flags & MP4_READ_PERF_COUNTERS )
+        EnablePerfCounters( true );
+
+    if( provider )
+        m_pFileProvider = new MP4FileProvider( *provider );
+    Open( name, File::MODE_READ, provider ? new io::CustomFileProvider( *provider ) : NULL );
+
+    if( flags & MP4_READ_ARENA ) {
+        m_pArena = new MP4Arena();
+        MP4ArenaScope scope( m_pArena );
+        ReadFromFile();
+    }
+    else {
+        ReadFromFile();
+    }
+
+    CacheProperties();
+
+    if( flags & MP4_READ_PREFETCH )
+        EnablePrefetch( MP4Prefetcher::DefaultNumBlocks, MP4Prefetcher::DefaultBlockSize );
+}
+
+void MP4File::ReadFromBuffer( const char* name, uint8_t* pBytes, uint64_t numBytes )
+{
+    ASSERT( !m_file );
+
+    // never opened, the file object only names the source for messages
+    m_file = new File( name, File::MODE_READ );
+    m_fileOriginalSize = numBytes;
+
+    EnableMemoryBuffer( pBytes, numBytes );
+    try {
+        ReadFromFile();
+    }
+    catch( ... ) {
+        DisableMemoryBuffer();
+        throw;
+    }
+    DisableMemoryBuffer();
+
+    CacheProperties();
+}
+
+void MP4File::ReadProgressive( const char* name, const MP4ProgressiveProvider* provider, uint32_t flags )
+{
+    if( flags & MP4_READ_PERF_COUNTERS )
+        EnablePerfCounters( true );
+
+    Open( name, File::MODE_READ, new io::ProgressiveFileProvider( *provider ));
+    m_progressive = true;
+
+    CheckPendingBoxes();
+
+    if( flags & MP4_READ_ARENA ) {
+        m_pArena = new MP4Arena();
+        MP4ArenaScope scope( m_pArena );
+        ReadFromFile();
+    }
+    else {
+        ReadFromFile();
+    }
+
     CacheProperties();
 }
 
@@ -159,11 +258,25 @@ void MP4File::Check64BitStatus (const char *atomName)
 }
 
 
-bool MP4File::Modify( const char* fileName )
+bool MP4File::Modify( const char* fileName, uint32_t flags )
 {
     Open( fileName, File::MODE_MODIFY, NULL );
     ReadFromFile();
 
+    if( !(flags & MP4_MODIFY_PATCH) || !m_pRootAtom->FindAtom( "moov" ))
+        return BeginModify();
+
+    // leave the file as it is until something needs more than a patch,
+    // anything set while reading does not count as an edit
+    CacheProperties();
+    ClearDirty( *m_pRootAtom );
+    m_patchGeneration = m_atomGeneration;
+    m_patchMode = true;
+    return true;
+}
+
+bool MP4File::BeginModify()
+{
     // find the moov atom
     MP4Atom* pMoovAtom = m_pRootAtom->FindAtom("moov");
     uint32_t numAtoms;
@@ -282,6 +395,10 @@ void MP4File::Optimize( const char* srcFileName, const char* dstFileName )
         ReadFromFile();
         CacheProperties(); // of moov atom
 
+        // sdtp for avc1 tracks that lack it, moov is written before mdat
+        for( uint32_t i = 0; i < m_pTracks.Size(); i++ )
+            m_pTracks[i]->UpdateSampleDependencies();
+
         src = m_file;
         m_file = NULL;
 
@@ -319,20 +436,32 @@ void MP4File::Optimize( const char* srcFileName, const char* dstFileName )
         Rename( dname.c_str(), srcFileName );
 }
 
+// Chunks are taken in interleaved order and copied in groups: the chunks of
+// a group are read in one batch into a single buffer, laid out as they are
+// to be written, and written out with one write.
 void MP4File::RewriteMdat( File& src, File& dst )
 {
+    const uint64_t maxGroupSize = 8 * 1024 * 1024;
     uint32_t numTracks = m_pTracks.Size();
 
     MP4ChunkId* chunkIds = new MP4ChunkId[numTracks];
     MP4ChunkId* maxChunkIds = new MP4ChunkId[numTracks];
     MP4Timestamp* nextChunkTimes = new MP4Timestamp[numTracks];
+    vector< vector<MP4Track::ChunkExtent> > chunks( numTracks );
 
     for( uint32_t i = 0; i < numTracks; i++ ) {
+        m_pTracks[i]->GetChunkExtents( chunks[i] );
         chunkIds[i] = 1;
-        maxChunkIds[i] = m_pTracks[i]->GetNumberOfChunks();
+        maxChunkIds[i] = uint32_t( chunks[i].size() );
         nextChunkTimes[i] = MP4_INVALID_TIMESTAMP;
     }
 
+    vector<File::Transfer> transfers;
+    vector<uint32_t> groupTracks;
+    vector<MP4ChunkId> groupChunks;
+    vector<uint8_t> buffer;
+    uint64_t groupSize = 0;
+
     for( ;; ) {
         uint32_t nextTrackIndex = (uint32_t)-1;
         MP4Timestamp nextTime = MP4_INVALID_TIMESTAMP;
@@ -359,21 +488,41 @@ void MP4File::RewriteMdat( File& src, File& dst )
             nextTrackIndex = i;
         }
 
-        if( nextTrackIndex == (uint32_t)-1 )
-            break;
+        const uint32_t chunkSize = nextTrackIndex == (uint32_t)-1
+                                   ? 0 : chunks[nextTrackIndex][chunkIds[nextTrackIndex] - 1].size;
+
+        // copy the group when done or when the next chunk would overflow it
+        if( !groupChunks.empty() && (nextTrackIndex == (uint32_t)-1 || groupSize + chunkSize > maxGroupSize) ) {
+            buffer.resize( size_t( groupSize ) + 1 );
+            transfers.resize( groupChunks.size() );
+            uint64_t position = 0;
+            for( uint32_t i = 0; i < groupChunks.size(); i++ ) {
+                const MP4Track::ChunkExtent& chunk = chunks[groupTracks[i]][groupChunks[i] - 1];
+                transfers[i].pos = chunk.offset;
+                transfers[i].buffer = &buffer[size_t( position )];
+                transfers[i].size = chunk.size;
+                position += chunk.size;
+            }
+            ReadBatch( transfers, &src );
 
-        uint8_t* pChunk;
-        uint32_t chunkSize;
+            position = GetPosition( &dst );
+            WriteBytes( &buffer[0], uint32_t( groupSize ), &dst );
+            for( uint32_t i = 0; i < groupChunks.size(); i++ ) {
+                m_pTracks[groupTracks[i]]->MoveChunk( groupChunks[i], position, uint32_t( transfers[i].size ));
+                position += transfers[i].size;
+            }
 
-        // point into original mp4 file for read chunk call
-        m_file = &src;
-        m_pTracks[nextTrackIndex]->ReadChunk( chunkIds[nextTrackIndex], &pChunk, &chunkSize );
+            groupTracks.clear();
+            groupChunks.clear();
+            groupSize = 0;
+        }
 
-        // point back at the new mp4 file for write chunk
-        m_file = &dst;
-        m_pTracks[nextTrackIndex]->RewriteChunk( chunkIds[nextTrackIndex], pChunk, chunkSize );
+        if( nextTrackIndex == (uint32_t)-1 )
+            break;
 
-        MP4Free( pChunk );
+        groupTracks.push_back( nextTrackIndex );
+        groupChunks.push_back( chunkIds[nextTrackIndex] );
+        groupSize += chunkSize;
 
         chunkIds[nextTrackIndex]++;
         nextChunkTimes[nextTrackIndex] = MP4_INVALID_TIMESTAMP;
@@ -384,11 +533,11 @@ void MP4File::RewriteMdat( File& src, File& dst )
     delete [] nextChunkTimes;
 }
 
-void MP4File::Open( const char* name, File::Mode mode, const MP4FileProvider* provider )
+void MP4File::Open( const char* name, File::Mode mode, io::FileProvider* provider )
 {
     ASSERT( !m_file );
 
-    m_file = new File( name, mode, provider ? new io::CustomFileProvider( *provider ) : NULL );
+    m_file = new File( name, mode, provider );
     if( m_file->open() ) {
         ostringstream msg;
         msg << "open(" << name << ") failed";
@@ -408,8 +557,51 @@ void MP4File::Open( const char* name, File::Mode mode, const MP4FileProvider* pr
     }
 }
 
+// The parser reads every top-level box but mdat, free and skip whole,
+// throw for the first one that has not fully arrived.
+void MP4File::CheckPendingBoxes()
+{
+    const uint64_t fileSize = m_file->size;
+    uint64_t pos = 0;
+
+    while( pos < fileSize ) {
+        uint64_t headerSize = min( fileSize - pos, (uint64_t)16 );
+        if( m_file->pending( pos, headerSize ))
+            throw new PendingException( pos, headerSize, __FILE__, __LINE__, __FUNCTION__ );
+        if( headerSize < 8 )
+            return; // left to the parser to report
+
+        uint8_t header[16];
+        SetPosition( pos );
+        ReadBytes( header, (uint32_t)headerSize );
+
+        uint64_t size = ((uint64_t)header[0] << 24) | (header[1] << 16) | (header[2] << 8) | header[3];
+        if( size == 1 && headerSize == 16 ) {
+            size = 0;
+            for( int i = 8; i < 16; i++ )
+                size = (size << 8) | header[i];
+        }
+        else if( size == 0 ) {
+            size = fileSize - pos;
+        }
+        if( size < 8 )
+            return;
+        size = min( size, fileSize - pos );
+
+        const uint32_t type = ATOMID( (char*)&header[4] );
+        if( type != ATOMID( "mdat" ) && type != ATOMID( "free" ) && type != ATOMID( "skip" )) {
+            if( m_file->pending( pos, size ))
+                throw new PendingException( pos, size, __FILE__, __LINE__, __FUNCTION__ );
+        }
+        pos += size;
+    }
+}
+
 void MP4File::ReadFromFile()
 {
+    const time::microseconds_t start =
+        m_pPerfCounters ? time::getLocalTimeMicroseconds() : 0;
+
     // ensure we start at beginning of file
     SetPosition(0);
 
@@ -427,6 +619,63 @@ void MP4File::ReadFromFile()
 
     // create MP4Track's for any tracks in the file
     GenerateTracks();
+
+    if (m_pPerfCounters) {
+        m_pPerfCounters->readFromFileUsecs +=
+            time::getLocalTimeMicroseconds() - start;
+    }
+}
+
+void MP4File::EnablePerfCounters(bool enable)
+{
+    if (!enable) {
+        delete m_pPerfCounters;
+        m_pPerfCounters = NULL;
+    } else if (!m_pPerfCounters) {
+        m_pPerfCounters = new MP4PerfCounters;
+        memset(m_pPerfCounters, 0, sizeof(*m_pPerfCounters));
+    }
+}
+
+void MP4File::EnablePrefetch(uint32_t numBlocks, uint32_t blockSize)
+{
+    delete m_pPrefetcher;
+    m_pPrefetcher = NULL;
+    if (numBlocks == 0)
+        return;
+
+    if (!m_file || m_file->mode != File::MODE_READ || m_memoryBuffer || m_progressive) {
+        throw new Exception("prefetch needs a file opened for reading",
+                            __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    // the loader thread seeks and reads through a handle of its own
+    File* pFile = new File(m_file->name, File::MODE_READ,
+                           m_pFileProvider ? new io::CustomFileProvider(*m_pFileProvider) : NULL);
+    if (pFile->open()) {
+        delete pFile;
+        ostringstream msg;
+        msg << "open(" << m_file->name << ") failed";
+        throw new Exception(msg.str(), __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    m_pPrefetcher = new MP4Prefetcher(pFile, numBlocks, blockSize);
+}
+
+bool MP4File::ReadPrefetched(MP4Track& track, MP4SampleId sampleId,
+                             uint64_t offset, uint8_t* pBytes, uint32_t numBytes)
+{
+    if (!m_pPrefetcher)
+        return false;
+
+    bool hit = m_pPrefetcher->Read(track, sampleId, offset, pBytes, numBytes);
+    if (m_pPerfCounters) {
+        if (hit)
+            m_pPerfCounters->prefetchHits++;
+        else
+            m_pPerfCounters->prefetchMisses++;
+    }
+    return hit;
 }
 
 void MP4File::GenerateTracks()
@@ -611,9 +860,15 @@ void MP4File::Dump( bool dumpImplicits )
 
 void MP4File::Close()
 {
+    delete m_pPrefetcher;
+    m_pPrefetcher = NULL;
+
     if( IsWriteMode() ) {
         SetIntegerProperty( "moov.mvhd.modificationTime", MP4GetAbsTimestamp() );
-        FinishWrite();
+        if( !m_patchMode || !PatchWrite() ) {
+            EndPatchMode();
+            FinishWrite();
+        }
     }
 
     delete m_file;
@@ -634,6 +889,68 @@ void MP4File::ProtectWriteOperation(const char* file,
         throw new Exception( "operation not permitted in read mode", file, line, func );
 }
 
+void MP4File::EndPatchMode()
+{
+    if( !m_patchMode )
+        return;
+
+    m_patchMode = false;
+    BeginModify();
+}
+
+bool MP4File::PatchWrite()
+{
+    // an added or removed atom, descriptor or property changes the layout
+    if( m_atomGeneration != m_patchGeneration )
+        return false;
+
+    vector<MP4Atom*> atoms;
+    FindDirtyAtoms( *m_pRootAtom, atoms );
+
+    // serialize each edited atom and make sure it still fits exactly
+    vector<uint8_t*> patches( atoms.size(), (uint8_t*)NULL );
+    bool fits = true;
+    for( size_t i = 0; fits && i < atoms.size(); i++ ) {
+        MP4Atom& atom = *atoms[i];
+        const uint64_t start = atom.GetStart();
+        const uint64_t end   = atom.GetEnd();
+        const uint64_t size  = atom.GetSize();
+
+        uint64_t numBytes = 0;
+        EnableMemoryBuffer();
+        try {
+            atom.Write();
+        }
+        catch( Exception* ) {
+            DisableMemoryBuffer( &patches[i], &numBytes );
+            for( size_t j = 0; j <= i; j++ )
+                MP4Free( patches[j] );
+            atom.SetStart( start );
+            atom.SetEnd( end );
+            atom.SetSize( size );
+            throw;
+        }
+        DisableMemoryBuffer( &patches[i], &numBytes );
+
+        atom.SetStart( start );
+        atom.SetEnd( end );
+        atom.SetSize( size );
+        fits = numBytes == end - start;
+    }
+
+    if( fits ) {
+        for( size_t i = 0; i < atoms.size(); i++ ) {
+            SetPosition( atoms[i]->GetStart() );
+            WriteBytes( patches[i], uint32_t( atoms[i]->GetEnd() - atoms[i]->GetStart() ));
+        }
+    }
+
+    for( size_t i = 0; i < patches.size(); i++ )
+        MP4Free( patches[i] );
+
+    return fits;
+}
+
 MP4Track* MP4File::GetTrack(MP4TrackId trackId)
 {
     return m_pTracks[FindTrackIndex(trackId)];
@@ -734,14 +1051,43 @@ bool MP4File::FindProperty(const char* name,
     return m_pRootAtom->FindProperty(name, ppProperty, pIndex);
 }
 
-void MP4File::FindIntegerProperty(const char* name,
-                                  MP4Property** ppProperty, uint32_t* pIndex)
+void MP4File::FindProperty(MP4ResolvedProperty& property,
+                           MP4Property** ppProperty, uint32_t* pIndex)
 {
-    if (!FindProperty(name, ppProperty, pIndex)) {
+    *ppProperty = property.Get(pIndex);
+    if (*ppProperty == NULL) {
         ostringstream msg;
-        msg << "no such property - " << name;
+        msg << "no such property - " << property.GetName();
         throw new Exception(msg.str(), __FILE__, __LINE__, __FUNCTION__);
     }
+}
+
+MP4ResolvedProperty& MP4File::ResolveProperty(const char* name)
+{
+    if (m_pRootAtom == NULL) {
+        throw new Exception("no atom tree", __FILE__, __LINE__, __FUNCTION__);
+    }
+    return m_propertyHandles.Resolve(*m_pRootAtom, name);
+}
+
+MP4ResolvedProperty& MP4File::ResolveTrackProperty(
+    MP4TrackId trackId, const char* name)
+{
+    return GetTrack(trackId)->ResolvePropertyHandle(name);
+}
+
+void MP4File::FindIntegerProperty(const char* name,
+                                  MP4Property** ppProperty, uint32_t* pIndex)
+{
+    uint32_t index;
+    FindIntegerProperty(m_propertyCache.Resolve(*m_pRootAtom, name),
+                        ppProperty, pIndex ? pIndex : &index);
+}
+
+void MP4File::FindIntegerProperty(MP4ResolvedProperty& property,
+                                  MP4Property** ppProperty, uint32_t* pIndex)
+{
+    FindProperty(property, ppProperty, pIndex);
 
     switch ((*ppProperty)->GetType()) {
     case Integer8Property:
@@ -752,7 +1098,7 @@ void MP4File::FindIntegerProperty(const char* name,
         break;
     default:
         ostringstream msg;
-        msg << "type mismatch - property " << name << " type " << (*ppProperty)->GetType();
+        msg << "type mismatch - property " << property.GetName() << " type " << (*ppProperty)->GetType();
         throw new Exception(msg.str(), __FILE__, __LINE__, __FUNCTION__);
     }
 }
@@ -767,6 +1113,16 @@ uint64_t MP4File::GetIntegerProperty(const char* name)
     return ((MP4IntegerProperty*)pProperty)->GetValue(index);
 }
 
+uint64_t MP4File::GetIntegerProperty(MP4ResolvedProperty& property)
+{
+    MP4Property* pProperty;
+    uint32_t index;
+
+    FindIntegerProperty(property, &pProperty, &index);
+
+    return ((MP4IntegerProperty*)pProperty)->GetValue(index);
+}
+
 void MP4File::SetIntegerProperty(const char* name, uint64_t value)
 {
     ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
@@ -779,17 +1135,34 @@ void MP4File::SetIntegerProperty(const char* name, uint64_t value)
     ((MP4IntegerProperty*)pProperty)->SetValue(value, index);
 }
 
+void MP4File::SetIntegerProperty(MP4ResolvedProperty& property, uint64_t value)
+{
+    ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
+
+    MP4Property* pProperty = NULL;
+    uint32_t index = 0;
+
+    FindIntegerProperty(property, &pProperty, &index);
+
+    ((MP4IntegerProperty*)pProperty)->SetValue(value, index);
+}
+
 void MP4File::FindFloatProperty(const char* name,
                                 MP4Property** ppProperty, uint32_t* pIndex)
 {
-    if (!FindProperty(name, ppProperty, pIndex)) {
-        ostringstream msg;
-        msg << "no such property - " << name;
-        throw new Exception(msg.str(), __FILE__, __LINE__, __FUNCTION__);
-    }
+    uint32_t index;
+    FindFloatProperty(m_propertyCache.Resolve(*m_pRootAtom, name),
+                      ppProperty, pIndex ? pIndex : &index);
+}
+
+void MP4File::FindFloatProperty(MP4ResolvedProperty& property,
+                                MP4Property** ppProperty, uint32_t* pIndex)
+{
+    FindProperty(property, ppProperty, pIndex);
+
     if ((*ppProperty)->GetType() != Float32Property) {
         ostringstream msg;
-        msg << "type mismatch - property " << name << " type " << (*ppProperty)->GetType();
+        msg << "type mismatch - property " << property.GetName() << " type " << (*ppProperty)->GetType();
         throw new Exception(msg.str(), __FILE__, __LINE__, __FUNCTION__);
     }
 }
@@ -804,6 +1177,16 @@ float MP4File::GetFloatProperty(const char* name)
     return ((MP4Float32Property*)pProperty)->GetValue(index);
 }
 
+float MP4File::GetFloatProperty(MP4ResolvedProperty& property)
+{
+    MP4Property* pProperty;
+    uint32_t index;
+
+    FindFloatProperty(property, &pProperty, &index);
+
+    return ((MP4Float32Property*)pProperty)->GetValue(index);
+}
+
 void MP4File::SetFloatProperty(const char* name, float value)
 {
     ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
@@ -816,17 +1199,34 @@ void MP4File::SetFloatProperty(const char* name, float value)
     ((MP4Float32Property*)pProperty)->SetValue(value, index);
 }
 
+void MP4File::SetFloatProperty(MP4ResolvedProperty& property, float value)
+{
+    ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
+
+    MP4Property* pProperty;
+    uint32_t index;
+
+    FindFloatProperty(property, &pProperty, &index);
+
+    ((MP4Float32Property*)pProperty)->SetValue(value, index);
+}
+
 void MP4File::FindStringProperty(const char* name,
                                  MP4Property** ppProperty, uint32_t* pIndex)
 {
-    if (!FindProperty(name, ppProperty, pIndex)) {
-        ostringstream msg;
-        msg << "no such property - " << name;
-        throw new Exception(msg.str(), __FILE__, __LINE__, __FUNCTION__);
-    }
+    uint32_t index;
+    FindStringProperty(m_propertyCache.Resolve(*m_pRootAtom, name),
+                       ppProperty, pIndex ? pIndex : &index);
+}
+
+void MP4File::FindStringProperty(MP4ResolvedProperty& property,
+                                 MP4Property** ppProperty, uint32_t* pIndex)
+{
+    FindProperty(property, ppProperty, pIndex);
+
     if ((*ppProperty)->GetType() != StringProperty) {
         ostringstream msg;
-        msg << "type mismatch - property " << name << " type " << (*ppProperty)->GetType();
+        msg << "type mismatch - property " << property.GetName() << " type " << (*ppProperty)->GetType();
         throw new Exception(msg.str(), __FILE__, __LINE__, __FUNCTION__);
     }
 }
@@ -841,6 +1241,16 @@ const char* MP4File::GetStringProperty(const char* name)
     return ((MP4StringProperty*)pProperty)->GetValue(index);
 }
 
+const char* MP4File::GetStringProperty(MP4ResolvedProperty& property)
+{
+    MP4Property* pProperty;
+    uint32_t index;
+
+    FindStringProperty(property, &pProperty, &index);
+
+    return ((MP4StringProperty*)pProperty)->GetValue(index);
+}
+
 void MP4File::SetStringProperty(const char* name, const char* value)
 {
     ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
@@ -853,17 +1263,34 @@ void MP4File::SetStringProperty(const char* name, const char* value)
     ((MP4StringProperty*)pProperty)->SetValue(value, index);
 }
 
+void MP4File::SetStringProperty(MP4ResolvedProperty& property, const char* value)
+{
+    ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
+
+    MP4Property* pProperty;
+    uint32_t index;
+
+    FindStringProperty(property, &pProperty, &index);
+
+    ((MP4StringProperty*)pProperty)->SetValue(value, index);
+}
+
 void MP4File::FindBytesProperty(const char* name,
                                 MP4Property** ppProperty, uint32_t* pIndex)
 {
-    if (!FindProperty(name, ppProperty, pIndex)) {
-        ostringstream msg;
-        msg << "no such property " << name;
-        throw new Exception(msg.str(), __FILE__, __LINE__, __FUNCTION__);
-    }
+    uint32_t index;
+    FindBytesProperty(m_propertyCache.Resolve(*m_pRootAtom, name),
+                      ppProperty, pIndex ? pIndex : &index);
+}
+
+void MP4File::FindBytesProperty(MP4ResolvedProperty& property,
+                                MP4Property** ppProperty, uint32_t* pIndex)
+{
+    FindProperty(property, ppProperty, pIndex);
+
     if ((*ppProperty)->GetType() != BytesProperty) {
         ostringstream msg;
-        msg << "type mismatch - property " << name << " - type " <<  (*ppProperty)->GetType();
+        msg << "type mismatch - property " << property.GetName() << " - type " <<  (*ppProperty)->GetType();
         throw new Exception(msg.str(), __FILE__, __LINE__, __FUNCTION__);
     }
 }
@@ -879,6 +1306,17 @@ void MP4File::GetBytesProperty(const char* name,
     ((MP4BytesProperty*)pProperty)->GetValue(ppValue, pValueSize, index);
 }
 
+void MP4File::GetBytesProperty(MP4ResolvedProperty& property,
+                               uint8_t** ppValue, uint32_t* pValueSize)
+{
+    MP4Property* pProperty;
+    uint32_t index;
+
+    FindBytesProperty(property, &pProperty, &index);
+
+    ((MP4BytesProperty*)pProperty)->GetValue(ppValue, pValueSize, index);
+}
+
 void MP4File::SetBytesProperty(const char* name,
                                const uint8_t* pValue, uint32_t valueSize)
 {
@@ -892,6 +1330,88 @@ void MP4File::SetBytesProperty(const char* name,
     ((MP4BytesProperty*)pProperty)->SetValue(pValue, valueSize, index);
 }
 
+void MP4File::SetBytesProperty(MP4ResolvedProperty& property,
+                               const uint8_t* pValue, uint32_t valueSize)
+{
+    ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
+
+    MP4Property* pProperty;
+    uint32_t index;
+
+    FindBytesProperty(property, &pProperty, &index);
+
+    ((MP4BytesProperty*)pProperty)->SetValue(pValue, valueSize, index);
+}
+
+bool MP4File::TryGetIntegerProperty(const char* name, uint64_t* pValue)
+{
+    return TryGetIntegerProperty(m_propertyCache.Resolve(*m_pRootAtom, name),
+                                 pValue);
+}
+
+bool MP4File::TryGetIntegerProperty(MP4ResolvedProperty& property,
+                                    uint64_t* pValue)
+{
+    uint32_t index;
+    if (property.Get(&index) == NULL) {
+        return false;
+    }
+    *pValue = GetIntegerProperty(property);
+    return true;
+}
+
+bool MP4File::TryGetFloatProperty(const char* name, float* pValue)
+{
+    return TryGetFloatProperty(m_propertyCache.Resolve(*m_pRootAtom, name),
+                               pValue);
+}
+
+bool MP4File::TryGetFloatProperty(MP4ResolvedProperty& property,
+                                  float* pValue)
+{
+    uint32_t index;
+    if (property.Get(&index) == NULL) {
+        return false;
+    }
+    *pValue = GetFloatProperty(property);
+    return true;
+}
+
+bool MP4File::TryGetStringProperty(const char* name, const char** pValue)
+{
+    return TryGetStringProperty(m_propertyCache.Resolve(*m_pRootAtom, name),
+                                pValue);
+}
+
+bool MP4File::TryGetStringProperty(MP4ResolvedProperty& property,
+                                   const char** pValue)
+{
+    uint32_t index;
+    if (property.Get(&index) == NULL) {
+        return false;
+    }
+    *pValue = GetStringProperty(property);
+    return true;
+}
+
+bool MP4File::TryGetBytesProperty(const char* name,
+                                  uint8_t** ppValue, uint32_t* pValueSize)
+{
+    return TryGetBytesProperty(m_propertyCache.Resolve(*m_pRootAtom, name),
+                               ppValue, pValueSize);
+}
+
+bool MP4File::TryGetBytesProperty(MP4ResolvedProperty& property,
+                                  uint8_t** ppValue, uint32_t* pValueSize)
+{
+    uint32_t index;
+    if (property.Get(&index) == NULL) {
+        return false;
+    }
+    GetBytesProperty(property, ppValue, pValueSize);
+    return true;
+}
+
 
 // track functions
 
@@ -2001,9 +2521,20 @@ void MP4File::AddH264PictureParameterSet (MP4TrackId trackId,
         const uint8_t *pPict,
         uint16_t pictLen)
 {
-    MP4Atom *avcCAtom =
-        FindAtom(MakeTrackName(trackId,
-                               "mdia.minf.stbl.stsd.avc1.avcC"));
+    const char *format;
+    MP4Atom *avcCAtom;
+
+    // get 4cc media format - can be avc1 or encv for ismacrypted track
+    format = GetTrackMediaDataName(trackId);
+
+    if (!strcasecmp(format, "avc1"))
+        avcCAtom = FindAtom(MakeTrackName(trackId, "mdia.minf.stbl.stsd.avc1.avcC"));
+    else if (!strcasecmp(format, "encv"))
+        avcCAtom = FindAtom(MakeTrackName(trackId, "mdia.minf.stbl.stsd.encv.avcC"));
+    else
+        // huh?  unknown track format
+        return;
+
     MP4Integer8Property *pCount;
     MP4Integer16Property *pLength;
     MP4BytesProperty *pUnit;
@@ -2029,8 +2560,8 @@ void MP4File::AddH264PictureParameterSet (MP4TrackId trackId,
                 uint32_t seqlen;
                 pUnit->GetValue(&seq, &seqlen, index);
                 if (memcmp(seq, pPict, pictLen) == 0) {
-                    log.verbose1f("\"%s\": picture matches %d", 
-                                  GetFilename().c_str(), index);
+                    MP4V2_LOG_VERBOSE1( log, "\"%s\": picture matches %d", 
+                                             GetFilename().c_str(), index);
                     free(seq);
                     return;
                 }
@@ -2041,8 +2572,8 @@ void MP4File::AddH264PictureParameterSet (MP4TrackId trackId,
     pLength->AddValue(pictLen);
     pUnit->AddValue(pPict, pictLen);
     pCount->IncrementValue();
-    log.verbose1f("\"%s\": new picture added %d", GetFilename().c_str(),
-                  pCount->GetValue());
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": new picture added %d", GetFilename().c_str(),
+                             pCount->GetValue());
 
     return;
 }
@@ -3056,22 +3587,264 @@ MP4Timestamp MP4File::GetSampleTime(
 MP4Duration MP4File::GetSampleDuration(
     MP4TrackId trackId, MP4SampleId sampleId)
 {
-    MP4Duration duration;
-    m_pTracks[FindTrackIndex(trackId)]->
-    GetSampleTimes(sampleId, NULL, &duration);
-    return duration;
+    MP4Duration duration;
+    m_pTracks[FindTrackIndex(trackId)]->
+    GetSampleTimes(sampleId, NULL, &duration);
+    return duration;
+}
+
+MP4Duration MP4File::GetSampleRenderingOffset(
+    MP4TrackId trackId, MP4SampleId sampleId)
+{
+    return m_pTracks[FindTrackIndex(trackId)]->
+           GetSampleRenderingOffset(sampleId);
+}
+
+bool MP4File::GetSampleSync(MP4TrackId trackId, MP4SampleId sampleId)
+{
+    return m_pTracks[FindTrackIndex(trackId)]->IsSyncSample(sampleId);
+}
+
+uint8_t MP4File::GetSampleDependency(MP4TrackId trackId, MP4SampleId sampleId)
+{
+    return m_pTracks[FindTrackIndex(trackId)]->GetSampleDependency(sampleId);
+}
+
+MP4SampleId MP4File::GetNextIndependentSample(MP4TrackId trackId, MP4SampleId sampleId)
+{
+    return m_pTracks[FindTrackIndex(trackId)]->GetNextIndependentSample(sampleId);
+}
+
+void MP4File::GetTrickPlaySamples(
+    MP4TrackId           trackId,
+    MP4SampleId          firstSampleId,
+    MP4SampleId          lastSampleId,
+    uint32_t             speed,
+    vector<MP4SampleId>& samples )
+{
+    m_pTracks[FindTrackIndex(trackId)]->GetTrickPlaySamples(
+        firstSampleId, lastSampleId, speed, samples );
+}
+
+void MP4File::GetTrackChecksums(
+    MP4TrackId        trackId,
+    bool              perChunk,
+    vector<uint32_t>& checksums )
+{
+    m_pTracks[FindTrackIndex(trackId)]->GetChecksums(perChunk, checksums);
+}
+
+static MP4Atom* FindChecksumAtom( MP4Track& track )
+{
+    MP4Atom* pUdta = track.GetTrakAtom().FindChildAtom("udta");
+    if (!pUdta)
+        return NULL;
+
+    for (uint32_t i = 0; i < pUdta->GetNumberOfChildAtoms(); i++) {
+        MP4Atom* pChild = pUdta->GetChildAtom(i);
+        if (ChecksumUUIDAtom::IsChecksumAtom(*pChild))
+            return pChild;
+    }
+    return NULL;
+}
+
+// The box payload is a version byte, 24 bits of flags with bit 0 set for
+// per chunk digests, a 32-bit count and the digests, all big endian.
+void MP4File::StoreTrackChecksums(MP4TrackId trackId, bool perChunk)
+{
+    ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
+
+    MP4Track* pTrack = m_pTracks[FindTrackIndex(trackId)];
+
+    vector<uint32_t> checksums;
+    pTrack->GetChecksums(perChunk, checksums);
+
+    vector<uint8_t> data(8 + 4 * checksums.size());
+    data[3] = perChunk ? 1 : 0;
+    for (uint32_t i = 0; i <= checksums.size(); i++) {
+        uint32_t value = i ? checksums[i - 1] : (uint32_t)checksums.size();
+        uint8_t* p = &data[4 + 4 * i];
+        p[0] = (uint8_t)(value >> 24);
+        p[1] = (uint8_t)(value >> 16);
+        p[2] = (uint8_t)(value >> 8);
+        p[3] = (uint8_t)value;
+    }
+
+    MP4Atom* pAtom = FindChecksumAtom(*pTrack);
+    if (!pAtom) {
+        MP4Atom* pUdta = AddDescendantAtoms(&pTrack->GetTrakAtom(), "udta");
+        pAtom = new ChecksumUUIDAtom(*this);
+        pUdta->AddChildAtom(pAtom);
+    }
+
+    MP4Property* pProperty;
+    if (!pAtom->FindProperty("uuid.data", &pProperty)) {
+        throw new Exception("checksum box has no payload",
+                            __FILE__, __LINE__, __FUNCTION__);
+    }
+    ((MP4BytesProperty*)pProperty)->SetValue(&data[0], (uint32_t)data.size());
+}
+
+void MP4File::VerifyTrackChecksums(
+    MP4TrackId           trackId,
+    vector<MP4SampleId>& badSamples )
+{
+    MP4Track* pTrack = m_pTracks[FindTrackIndex(trackId)];
+
+    badSamples.clear();
+
+    MP4Atom* pAtom = FindChecksumAtom(*pTrack);
+    MP4Property* pProperty;
+    if (!pAtom || !pAtom->FindProperty("uuid.data", &pProperty)) {
+        ostringstream msg;
+        msg << "track " << trackId << " has no stored checksums";
+        throw new Exception(msg.str(), __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    uint8_t* pData;
+    uint32_t dataSize;
+    ((MP4BytesProperty*)pProperty)->GetValue(&pData, &dataSize);
+
+    uint32_t count = dataSize >= 8
+                     ? (pData[4] << 24) | (pData[5] << 16) | (pData[6] << 8) | pData[7]
+                     : 0;
+    if (dataSize < 8 || pData[0] != 0 || (dataSize - 8) / 4 < count) {
+        MP4Free(pData);
+        throw new Exception("checksum box is malformed",
+                            __FILE__, __LINE__, __FUNCTION__);
+    }
+    bool perChunk = (pData[3] & 1) != 0;
+
+    vector<uint32_t> checksums;
+    vector<MP4SampleId> chunkSamples;
+    try {
+        pTrack->GetChecksums(perChunk, checksums, &chunkSamples);
+    }
+    catch (...) {
+        MP4Free(pData);
+        throw;
+    }
+
+    if (checksums.size() != count) {
+        MP4Free(pData);
+        ostringstream msg;
+        msg << "track " << trackId << " has " << checksums.size()
+            << (perChunk ? " chunks" : " samples") << ", checksum box holds " << count;
+        throw new Exception(msg.str(), __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t* p = pData + 8 + 4 * i;
+        uint32_t stored = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+        if (stored == checksums[i])
+            continue;
+
+        if (!perChunk) {
+            badSamples.push_back(i + 1);
+            continue;
+        }
+
+        // every sample of a mismatching chunk is suspect
+        MP4SampleId endSampleId = i + 1 < count
+                                  ? chunkSamples[i + 1]
+                                  : pTrack->GetNumberOfSamples() + 1;
+        for (MP4SampleId sampleId = chunkSamples[i]; sampleId < endSampleId; sampleId++)
+            badSamples.push_back(sampleId);
+    }
+
+    MP4Free(pData);
+}
+
+void MP4File::GetSampleByteRange(
+    MP4TrackId  trackId,
+    MP4SampleId sampleId,
+    uint64_t&   offset,
+    uint64_t&   size )
+{
+    m_pTracks[FindTrackIndex(trackId)]->GetSampleByteRange(sampleId, sampleId, offset, size);
+}
+
+void MP4File::GetSampleByteRangeFromTime(
+    MP4TrackId   trackId,
+    MP4Timestamp when,
+    uint64_t&    offset,
+    uint64_t&    size )
+{
+    MP4Track* pTrack = m_pTracks[FindTrackIndex(trackId)];
+
+    MP4SampleId sampleId = pTrack->GetSampleIdFromTime(when);
+    MP4SampleId syncSampleId = sampleId;
+    while (syncSampleId > 1 && !pTrack->IsSyncSample(syncSampleId))
+        syncSampleId--;
+
+    pTrack->GetSampleByteRange(syncSampleId, sampleId, offset, size);
 }
 
-MP4Duration MP4File::GetSampleRenderingOffset(
-    MP4TrackId trackId, MP4SampleId sampleId)
+static bool CompareExtentOffsets(const MP4Track::ChunkExtent& a, const MP4Track::ChunkExtent& b)
 {
-    return m_pTracks[FindTrackIndex(trackId)]->
-           GetSampleRenderingOffset(sampleId);
+    return a.offset < b.offset;
 }
 
-bool MP4File::GetSampleSync(MP4TrackId trackId, MP4SampleId sampleId)
+void MP4File::GetByteRangesForTime(
+    const MP4TrackId*     trackIds,
+    uint32_t              numTracks,
+    MP4Timestamp          startTime,
+    MP4Timestamp          endTime,
+    uint64_t              maxGap,
+    vector<MP4ByteRange>& ranges )
 {
-    return m_pTracks[FindTrackIndex(trackId)]->IsSyncSample(sampleId);
+    ranges.clear();
+
+    uint32_t movieTimeScale = GetTimeScale();
+    vector<MP4Track::ChunkExtent> extents;
+
+    for (uint32_t i = 0; i < numTracks; i++) {
+        MP4Track* pTrack = m_pTracks[FindTrackIndex(trackIds[i])];
+        uint32_t numSamples = pTrack->GetNumberOfSamples();
+        uint32_t timeScale = pTrack->GetTimeScale();
+        MP4Duration duration = pTrack->GetDuration();
+
+        // widen to whole track time units
+        MP4Timestamp start = MP4ConvertTime(startTime, movieTimeScale, timeScale);
+        MP4Timestamp end = MP4ConvertTime(endTime, movieTimeScale, timeScale);
+        if (MP4ConvertTime(end, timeScale, movieTimeScale) < endTime)
+            end++;
+
+        if (numSamples == 0 || start >= duration || end <= start)
+            continue;
+
+        // decoding the first sample needs the preceding sync sample
+        MP4SampleId firstSampleId = pTrack->GetSampleIdFromTime(start);
+        while (firstSampleId > 1 && !pTrack->IsSyncSample(firstSampleId))
+            firstSampleId--;
+
+        MP4SampleId lastSampleId = end < duration
+                                   ? pTrack->GetSampleIdFromTime(end - 1)
+                                   : numSamples;
+        lastSampleId = min(lastSampleId, numSamples);
+        if (firstSampleId > lastSampleId)
+            continue;
+
+        pTrack->GetSampleExtents(firstSampleId, lastSampleId, extents);
+    }
+
+    std::sort(extents.begin(), extents.end(), CompareExtentOffsets);
+
+    for (uint32_t i = 0; i < extents.size(); i++) {
+        uint64_t offset = extents[i].offset;
+        uint64_t end = offset + extents[i].size;
+        if (!ranges.empty()) {
+            MP4ByteRange& last = ranges.back();
+            if (offset <= last.offset + last.size + maxGap) {
+                last.size = max(last.offset + last.size, end) - last.offset;
+                continue;
+            }
+        }
+        MP4ByteRange range;
+        range.offset = offset;
+        range.size = end - offset;
+        ranges.push_back(range);
+    }
 }
 
 void MP4File::ReadSample(
@@ -3098,6 +3871,22 @@ void MP4File::ReadSample(
         dependencyFlags );
 }
 
+void MP4File::ReadSamples(
+    MP4TrackId  trackId,
+    MP4SampleId firstSampleId,
+    uint32_t    numSamples,
+    uint8_t*    pBytes,
+    uint32_t    numBytes,
+    uint32_t*   pSampleSizes )
+{
+    m_pTracks[FindTrackIndex(trackId)]->ReadSamples(
+        firstSampleId,
+        numSamples,
+        pBytes,
+        numBytes,
+        pSampleSizes );
+}
+
 void MP4File::WriteSample(
     MP4TrackId     trackId,
     const uint8_t* pBytes,
@@ -3127,6 +3916,147 @@ void MP4File::WriteSampleDependency(
     m_pModificationProperty->SetValue( MP4GetAbsTimestamp() );
 }
 
+void MP4File::WriteH264AnnexBSample(
+    MP4TrackId     trackId,
+    const uint8_t* pBytes,
+    uint32_t       numBytes,
+    MP4Duration    duration,
+    MP4Duration    renderingOffset,
+    bool           isSyncSample )
+{
+    ProtectWriteOperation(__FILE__, __LINE__, __FUNCTION__);
+
+    uint8_t lengthSize = GetTrackH264LengthSize(trackId);
+    if (lengthSize < 1 || lengthSize > 4) {
+        throw new Exception("invalid NAL unit length size", __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    SplitH264AnnexB(pBytes, numBytes, m_h264Units);
+
+    // start codes are at least 3 bytes, so this bounds the converted size
+    m_h264Buffer.resize(numBytes + m_h264Units.size());
+    uint8_t* pDest = &m_h264Buffer[0];
+
+    for (uint32_t i = 0; i < m_h264Units.size(); i++) {
+        const MP4NalUnit& unit = m_h264Units[i];
+        uint8_t type = unit.pBytes[0] & 0x1f;
+
+        // parameter sets belong in avcC, duplicates are dropped there
+        if (type == H264_NAL_TYPE_SEQ_PARAM_SET || type == H264_NAL_TYPE_PIC_PARAM_SET) {
+            if (unit.size > 0xffff) {
+                throw new Exception("parameter set too large for avcC", __FILE__, __LINE__, __FUNCTION__);
+            }
+            if (type == H264_NAL_TYPE_SEQ_PARAM_SET) {
+                AddH264SequenceParameterSet(trackId, unit.pBytes, (uint16_t)unit.size);
+            } else {
+                AddH264PictureParameterSet(trackId, unit.pBytes, (uint16_t)unit.size);
+            }
+            continue;
+        }
+
+        if (lengthSize < 4 && (unit.size >> (lengthSize * 8)) != 0) {
+            throw new Exception("NAL unit too large for avcC length size", __FILE__, __LINE__, __FUNCTION__);
+        }
+        for (int shift = (lengthSize - 1) * 8; shift >= 0; shift -= 8) {
+            *pDest++ = (uint8_t)(unit.size >> shift);
+        }
+        memcpy(pDest, unit.pBytes, unit.size);
+        pDest += unit.size;
+    }
+
+    // an access unit of parameter sets only adds no sample
+    uint32_t size = (uint32_t)(pDest - &m_h264Buffer[0]);
+    if (size > 0) {
+        WriteSample(trackId, &m_h264Buffer[0], size, duration, renderingOffset, isSyncSample);
+    }
+}
+
+void MP4File::ReadH264AnnexBSample(
+    MP4TrackId  trackId,
+    MP4SampleId sampleId,
+    uint8_t**   ppBytes,
+    uint32_t*   pNumBytes,
+    bool        withParameterSets )
+{
+    MP4Track* pTrack = m_pTracks[FindTrackIndex(trackId)];
+    uint8_t lengthSize = GetTrackH264LengthSize(trackId);
+
+    // sync samples are led by the parameter sets of avcC so the output
+    // can be decoded on its own
+    MP4BytesProperty* pSets[2] = { NULL, NULL };
+    uint32_t setBytes = 0;
+    if (withParameterSets && pTrack->IsSyncSample(sampleId)) {
+        MP4Atom* avcCAtom = FindAtom(MakeTrackName(trackId, "mdia.minf.stbl.stsd.avc1.avcC"));
+        if (!avcCAtom) {
+            avcCAtom = FindAtom(MakeTrackName(trackId, "mdia.minf.stbl.stsd.encv.avcC"));
+        }
+        if (!avcCAtom ||
+                !avcCAtom->FindProperty("avcC.sequenceEntries.sequenceParameterSetNALUnit",
+                                        (MP4Property **)&pSets[0]) ||
+                !avcCAtom->FindProperty("avcC.pictureEntries.pictureParameterSetNALUnit",
+                                        (MP4Property **)&pSets[1])) {
+            throw new Exception("track has no avcC parameter sets", __FILE__, __LINE__, __FUNCTION__);
+        }
+        for (uint32_t s = 0; s < 2; s++) {
+            for (uint32_t i = 0; i < pSets[s]->GetCount(); i++) {
+                setBytes += 4 + pSets[s]->GetValueSize(i);
+            }
+        }
+    }
+
+    uint32_t sampleSize = pTrack->GetSampleSize(sampleId);
+    uint32_t outSize;
+    const uint8_t* pSource = NULL;
+    if (lengthSize >= 3) {
+        // prefixes become start codes of the same size
+        outSize = setBytes + sampleSize;
+    } else {
+        m_h264Buffer.resize(sampleSize + 1);
+        uint8_t* pScratch = &m_h264Buffer[0];
+        pTrack->ReadSample(sampleId, &pScratch, &sampleSize);
+        uint32_t count = CountH264NalUnits(pScratch, sampleSize, lengthSize);
+        outSize = setBytes + sampleSize + count * (4 - lengthSize);
+        pSource = pScratch;
+    }
+
+    bool allocated = false;
+    if (*ppBytes == NULL) {
+        *ppBytes = (uint8_t*)MP4Malloc(outSize);
+        allocated = true;
+    } else if (*pNumBytes < outSize) {
+        throw new Exception("sample buffer is too small", __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    try {
+        uint8_t* pDest = *ppBytes;
+        for (uint32_t s = 0; s < 2 && pSets[s]; s++) {
+            for (uint32_t i = 0; i < pSets[s]->GetCount(); i++) {
+                static const uint8_t startCode[4] = { 0, 0, 0, 1 };
+                memcpy(pDest, startCode, sizeof(startCode));
+                pSets[s]->CopyValue(pDest + sizeof(startCode), i);
+                pDest += sizeof(startCode) + pSets[s]->GetValueSize(i);
+            }
+        }
+
+        if (pSource) {
+            CopyH264LengthsToStartCodes(pDest, pSource, sampleSize, lengthSize);
+        } else if (sampleSize > 0) {
+            pTrack->ReadSample(sampleId, &pDest, &sampleSize);
+            CountH264NalUnits(pDest, sampleSize, lengthSize);
+            RewriteH264LengthsInPlace(pDest, sampleSize, lengthSize);
+        }
+    }
+    catch (...) {
+        if (allocated) {
+            MP4Free(*ppBytes);
+            *ppBytes = NULL;
+        }
+        throw;
+    }
+
+    *pNumBytes = outSize;
+}
+
 void MP4File::SetSampleRenderingOffset(MP4TrackId trackId,
                                        MP4SampleId sampleId, MP4Duration renderingOffset)
 {
@@ -3178,49 +4108,77 @@ MP4Atom *MP4File::FindTrackAtom (MP4TrackId trackId, const char *name)
     return FindAtom(MakeTrackName(trackId, name));
 }
 
+// track properties are resolved relative to the track's trak atom
+// and cached by the track, so repeated lookups skip the tree walk
+
 uint64_t MP4File::GetTrackIntegerProperty(MP4TrackId trackId, const char* name)
 {
-    return GetIntegerProperty(MakeTrackName(trackId, name));
+    return GetIntegerProperty(GetTrack(trackId)->ResolveProperty(name));
 }
 
 void MP4File::SetTrackIntegerProperty(MP4TrackId trackId, const char* name,
                                       int64_t value)
 {
-    SetIntegerProperty(MakeTrackName(trackId, name), value);
+    SetIntegerProperty(GetTrack(trackId)->ResolveProperty(name), value);
 }
 
 float MP4File::GetTrackFloatProperty(MP4TrackId trackId, const char* name)
 {
-    return GetFloatProperty(MakeTrackName(trackId, name));
+    return GetFloatProperty(GetTrack(trackId)->ResolveProperty(name));
 }
 
 void MP4File::SetTrackFloatProperty(MP4TrackId trackId, const char* name,
                                     float value)
 {
-    SetFloatProperty(MakeTrackName(trackId, name), value);
+    SetFloatProperty(GetTrack(trackId)->ResolveProperty(name), value);
 }
 
 const char* MP4File::GetTrackStringProperty(MP4TrackId trackId, const char* name)
 {
-    return GetStringProperty(MakeTrackName(trackId, name));
+    return GetStringProperty(GetTrack(trackId)->ResolveProperty(name));
 }
 
 void MP4File::SetTrackStringProperty(MP4TrackId trackId, const char* name,
                                      const char* value)
 {
-    SetStringProperty(MakeTrackName(trackId, name), value);
+    SetStringProperty(GetTrack(trackId)->ResolveProperty(name), value);
 }
 
 void MP4File::GetTrackBytesProperty(MP4TrackId trackId, const char* name,
                                     uint8_t** ppValue, uint32_t* pValueSize)
 {
-    GetBytesProperty(MakeTrackName(trackId, name), ppValue, pValueSize);
+    GetBytesProperty(GetTrack(trackId)->ResolveProperty(name), ppValue, pValueSize);
 }
 
 void MP4File::SetTrackBytesProperty(MP4TrackId trackId, const char* name,
                                     const uint8_t* pValue, uint32_t valueSize)
 {
-    SetBytesProperty(MakeTrackName(trackId, name), pValue, valueSize);
+    SetBytesProperty(GetTrack(trackId)->ResolveProperty(name), pValue, valueSize);
+}
+
+bool MP4File::TryGetTrackIntegerProperty(MP4TrackId trackId, const char* name,
+                                         uint64_t* pValue)
+{
+    return TryGetIntegerProperty(GetTrack(trackId)->ResolveProperty(name), pValue);
+}
+
+bool MP4File::TryGetTrackFloatProperty(MP4TrackId trackId, const char* name,
+                                       float* pValue)
+{
+    return TryGetFloatProperty(GetTrack(trackId)->ResolveProperty(name), pValue);
+}
+
+bool MP4File::TryGetTrackStringProperty(MP4TrackId trackId, const char* name,
+                                        const char** pValue)
+{
+    return TryGetStringProperty(GetTrack(trackId)->ResolveProperty(name), pValue);
+}
+
+bool MP4File::TryGetTrackBytesProperty(MP4TrackId trackId, const char* name,
+                                       uint8_t** ppValue, uint32_t* pValueSize)
+{
+    return TryGetBytesProperty(GetTrack(trackId)->ResolveProperty(name),
+                               ppValue, pValueSize);
 }
 
 bool MP4File::GetTrackLanguage( MP4TrackId trackId, char* code )
@@ -3518,14 +4476,14 @@ MP4Duration MP4File::GetTrackDuration(MP4TrackId trackId)
 uint8_t MP4File::GetTrackEsdsObjectTypeId(MP4TrackId trackId)
 {
     // changed mp4a to * to handle enca case
-    try {
-        return GetTrackIntegerProperty(trackId,
-                                       "mdia.minf.stbl.stsd.*.esds.decConfigDescr.objectTypeId");
-    } catch (Exception *x) {
-        delete x;
-        return GetTrackIntegerProperty(trackId,
-                                       "mdia.minf.stbl.stsd.*.*.esds.decConfigDescr.objectTypeId");
+    uint64_t objectTypeId;
+    if (TryGetTrackIntegerProperty(trackId,
+                                   "mdia.minf.stbl.stsd.*.esds.decConfigDescr.objectTypeId",
+                                   &objectTypeId)) {
+        return objectTypeId;
     }
+    return GetTrackIntegerProperty(trackId,
+                                   "mdia.minf.stbl.stsd.*.*.esds.decConfigDescr.objectTypeId");
 }
 
 uint8_t MP4File::GetTrackAudioMpeg4Type(MP4TrackId trackId)
@@ -3624,12 +4582,9 @@ bool MP4File::IsWriteMode()
 void MP4File::GetTrackESConfiguration(MP4TrackId trackId,
                                       uint8_t** ppConfig, uint32_t* pConfigSize)
 {
-    try {
-        GetTrackBytesProperty(trackId,
-                              "mdia.minf.stbl.stsd.*[0].esds.decConfigDescr.decSpecificInfo[0].info",
-                              ppConfig, pConfigSize);
-    } catch (Exception *x) {
-        delete x;
+    if (!TryGetTrackBytesProperty(trackId,
+                                  "mdia.minf.stbl.stsd.*[0].esds.decConfigDescr.decSpecificInfo[0].info",
+                                  ppConfig, pConfigSize)) {
         GetTrackBytesProperty(trackId,
                               "mdia.minf.stbl.stsd.*[0].*.esds.decConfigDescr.decSpecificInfo[0].info",
                               ppConfig, pConfigSize);
@@ -3769,6 +4724,12 @@ void MP4File::GetTrackH264SeqPictHeaders (MP4TrackId trackId,
     return ;
 }
 
+uint8_t MP4File::GetTrackH264LengthSize(MP4TrackId trackId)
+{
+    return (uint8_t)(1 + GetTrackIntegerProperty(trackId,
+                     "mdia.minf.stbl.stsd.*[0].avcC.lengthSizeMinusOne"));
+}
+
 
 
 const char* MP4File::GetHintTrackSdp(MP4TrackId hintTrackId)
@@ -3982,6 +4943,26 @@ void MP4File::ReadRtpPacket(
         ssrc, includeHeader, includePayload);
 }
 
+bool MP4File::ReadRtpHintPackets(
+    MP4TrackId hintTrackId,
+    uint8_t* pBuffer,
+    uint32_t* pBufferSize,
+    MP4RtpIovec* pPackets,
+    uint32_t* pNumPackets,
+    uint32_t ssrc,
+    bool includeHeader,
+    bool includePayload)
+{
+    MP4Track* pTrack = m_pTracks[FindTrackIndex(hintTrackId)];
+
+    if (strcmp(pTrack->GetType(), MP4_HINT_TRACK_TYPE)) {
+        throw new Exception("track is not a hint track", __FILE__, __LINE__, __FUNCTION__);
+    }
+    return ((MP4RtpHintTrack*)pTrack)->ReadPackets(
+        pBuffer, pBufferSize, pPackets, pNumPackets,
+        ssrc, includeHeader, includePayload);
+}
+
 MP4Timestamp MP4File::GetRtpTimestampStart(
     MP4TrackId hintTrackId)
 {
@@ -4433,4 +5414,446 @@ void MP4File::EncAndCopySample(
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// per-track state used by MP4File::CopyTracks()
+struct CopyTracksCursor {
+    MP4Track*    srcTrack;
+    MP4TrackId   srcTrackId;
+    MP4TrackId   dstTrackId;
+    bool         isHint;
+    bool         viaEdits;
+    bool         done;
+
+    MP4SampleId  sampleId;          // next sample to copy
+    MP4SampleId  numSamples;
+    MP4Duration  sampleDuration;    // override for sampleId, or invalid
+    MP4Timestamp nextTime;          // start of sampleId in movie timescale
+    MP4Timestamp editWhen;
+    MP4Duration  editsDuration;
+
+    // prefetched source chunk
+    uint8_t*     chunk;
+    uint32_t     chunkSize;
+    MP4SampleId  chunkFirstSampleId;
+    uint32_t     chunkNumSamples;
+    MP4SampleId  chunkNextSampleId;
+    uint32_t     chunkNextOffset;
+};
+
+static void CopyTracksAdvance( CopyTracksCursor& c, uint32_t timeScale )
+{
+    MP4Timestamp startTime;
+    c.sampleDuration = MP4_INVALID_DURATION;
+
+    if( c.viaEdits ) {
+        c.sampleId = c.srcTrack->GetSampleIdFromEditTime( c.editWhen, NULL, &c.sampleDuration );
+        startTime = c.editWhen;
+        c.editWhen += c.sampleDuration;
+
+        // same termination rule as MP4CopyTrack()
+        if( c.editWhen >= c.editsDuration ) {
+            c.done = true;
+            return;
+        }
+    } else {
+        c.sampleId++;
+        if( c.sampleId > c.numSamples ) {
+            c.done = true;
+            return;
+        }
+        c.srcTrack->GetSampleTimes( c.sampleId, &startTime, NULL );
+    }
+
+    c.nextTime = MP4ConvertTime( startTime, c.srcTrack->GetTimeScale(), timeScale );
+}
+
+static void CopyTracksSample( MP4File* srcFile, CopyTracksCursor& c, MP4File* dstFile )
+{
+    // edited tracks do not visit samples in chunk order
+    if( c.viaEdits ) {
+        MP4File::CopySample( srcFile, c.srcTrackId, c.sampleId,
+                             dstFile, c.dstTrackId, c.sampleDuration );
+        return;
+    }
+
+    MP4Track& track = *c.srcTrack;
+
+    if( c.chunk == NULL
+        || c.sampleId != c.chunkNextSampleId
+        || c.sampleId >= c.chunkFirstSampleId + c.chunkNumSamples )
+    {
+        MP4Free( c.chunk );
+        c.chunk = NULL;
+
+        if( !track.ReadSampleChunk( c.sampleId, &c.chunk, &c.chunkSize,
+                                    &c.chunkFirstSampleId, &c.chunkNumSamples ))
+        {
+            // sample data is not in this file, copy it the slow way
+            MP4File::CopySample( srcFile, c.srcTrackId, c.sampleId,
+                                 dstFile, c.dstTrackId, c.sampleDuration );
+            return;
+        }
+
+        c.chunkNextSampleId = c.chunkFirstSampleId;
+        c.chunkNextOffset = 0;
+        while( c.chunkNextSampleId < c.sampleId )
+            c.chunkNextOffset += track.GetSampleSize( c.chunkNextSampleId++ );
+    }
+
+    uint32_t numBytes = track.GetSampleSize( c.sampleId );
+    if( c.chunkNextOffset + numBytes > c.chunkSize )
+        throw new Exception( "sample extends beyond its chunk", __FILE__, __LINE__, __FUNCTION__ );
+
+    const uint8_t* pBytes = c.chunk + c.chunkNextOffset;
+    c.chunkNextOffset += numBytes;
+    c.chunkNextSampleId++;
+
+    MP4Duration sampleDuration = c.sampleDuration;
+    if( sampleDuration == MP4_INVALID_DURATION )
+        track.GetSampleTimes( c.sampleId, NULL, &sampleDuration );
+
+    MP4Duration renderingOffset = track.GetSampleRenderingOffset( c.sampleId );
+    bool isSyncSample = track.IsSyncSample( c.sampleId );
+
+    uint32_t dependencyFlags;
+    if( track.GetSampleDependencyFlags( c.sampleId, &dependencyFlags )) {
+        dstFile->WriteSampleDependency(
+            c.dstTrackId,
+            pBytes,
+            numBytes,
+            sampleDuration,
+            renderingOffset,
+            isSyncSample,
+            dependencyFlags );
+    }
+    else {
+        dstFile->WriteSample(
+            c.dstTrackId,
+            pBytes,
+            numBytes,
+            sampleDuration,
+            renderingOffset,
+            isSyncSample );
+    }
+}
+
+void MP4File::CopyTracks(
+    MP4File*          srcFile,
+    const MP4TrackId* srcTrackIds,
+    uint32_t          numTracks,
+    MP4File*          dstFile,
+    const MP4TrackId* dstTrackIds,
+    bool              applyEdits )
+{
+    // Note: as with CopySample() we leave it up to the caller to ensure
+    // that the source and destination tracks are compatible.
+
+    ASSERT(srcFile);
+    ASSERT(srcTrackIds);
+    ASSERT(dstTrackIds);
+
+    if( !dstFile )
+        dstFile = srcFile;
+
+    // samples are merged in decode order using the same time base
+    // RewriteMdat() uses to order chunks, so each destination track
+    // flushes its chunks interleaved with the others
+    const uint32_t timeScale = srcFile->GetTimeScale();
+
+    CopyTracksCursor* cursors = new CopyTracksCursor[numTracks];
+    memset( cursors, 0, numTracks * sizeof(CopyTracksCursor) );
+
+    try {
+        for( uint32_t i = 0; i < numTracks; i++ ) {
+            CopyTracksCursor& c = cursors[i];
+
+            c.srcTrack   = srcFile->GetTrack( srcTrackIds[i] );
+            c.srcTrackId = srcTrackIds[i];
+            c.dstTrackId = dstTrackIds[i] == MP4_INVALID_TRACK_ID ? srcTrackIds[i] : dstTrackIds[i];
+            c.isHint     = !strcmp( c.srcTrack->GetType(), MP4_HINT_TRACK_TYPE );
+            c.viaEdits   = applyEdits && srcFile->GetTrackNumberOfEdits( c.srcTrackId );
+            c.numSamples = c.srcTrack->GetNumberOfSamples();
+
+            if( c.viaEdits )
+                c.editsDuration = srcFile->GetTrackEditTotalDuration( c.srcTrackId, MP4_INVALID_EDIT_ID );
+
+            CopyTracksAdvance( c, timeScale );
+        }
+
+        for( ;; ) {
+            uint32_t nextIndex = (uint32_t)-1;
+            MP4Timestamp nextTime = MP4_INVALID_TIMESTAMP;
+
+            for( uint32_t i = 0; i < numTracks; i++ ) {
+                const CopyTracksCursor& c = cursors[i];
+                if( c.done )
+                    continue;
+
+                // time is not earliest so far
+                if( c.nextTime > nextTime )
+                    continue;
+
+                // prefer hint tracks to media tracks if times are equal
+                if( c.nextTime == nextTime && !c.isHint )
+                    continue;
+
+                nextTime = c.nextTime;
+                nextIndex = i;
+            }
+
+            if( nextIndex == (uint32_t)-1 )
+                break;
+
+            CopyTracksSample( srcFile, cursors[nextIndex], dstFile );
+            CopyTracksAdvance( cursors[nextIndex], timeScale );
+        }
+    }
+    catch (...) {
+        for( uint32_t i = 0; i < numTracks; i++ )
+            MP4Free( cursors[i].chunk );
+        delete [] cursors;
+        throw;
+    }
+
+    for( uint32_t i = 0; i < numTracks; i++ )
+        MP4Free( cursors[i].chunk );
+    delete [] cursors;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// one in-flight sample of MP4File::EncAndCopyTrack()
+struct EncPipelineSlot {
+    uint8_t*    bytes;
+    uint32_t    numBytes;
+    uint8_t*    encBytes;
+    uint32_t    encNumBytes;
+    MP4SampleId sampleId;
+    MP4Duration duration;
+    MP4Duration renderingOffset;
+    bool        isSyncSample;
+    bool        hasDependencyFlags;
+    uint32_t    dependencyFlags;
+    uint32_t    result;
+    bool        done;
+};
+
+// state shared by the copying thread and the encryption workers.
+// Slots form a ring indexed by sample sequence number; numRead and
+// numClaimed are guarded by mutex as is each slot's result/done.
+struct EncPipeline {
+    encryptFunc_t     encfcnp;
+    uint32_t          encfcnparam1;
+    EncPipelineSlot*  slots;
+    uint32_t          numSlots;
+    uint32_t          numRead;
+    uint32_t          numClaimed;
+    bool              stop;
+    thread::Mutex     mutex;
+    thread::Condition workReady;
+    thread::Condition sampleDone;
+
+    EncPipeline()
+        : workReady  ( mutex )
+        , sampleDone ( mutex )
+    { }
+};
+
+static void EncPipelineWorker( void* arg )
+{
+    EncPipeline& p = *static_cast<EncPipeline*>( arg );
+
+    p.mutex.lock();
+    for( ;; ) {
+        while( !p.stop && p.numClaimed == p.numRead )
+            p.workReady.wait();
+        if( p.stop )
+            break;
+
+        EncPipelineSlot& s = p.slots[p.numClaimed++ % p.numSlots];
+        p.mutex.unlock();
+
+        uint32_t result = p.encfcnp( p.encfcnparam1, s.numBytes, s.bytes, &s.encNumBytes, &s.encBytes );
+
+        p.mutex.lock();
+        s.result = result;
+        s.done = true;
+        p.sampleDone.signal();
+    }
+    p.mutex.unlock();
+}
+
+static void EncPipelineStop( EncPipeline& p, thread::Thread* workers, uint32_t numThreads )
+{
+    p.mutex.lock();
+    p.stop = true;
+    p.workReady.broadcast();
+    p.mutex.unlock();
+
+    for( uint32_t i = 0; i < numThreads; i++ )
+        workers[i].join();
+
+    for( uint32_t i = 0; i < p.numSlots; i++ ) {
+        MP4Free( p.slots[i].bytes );
+        MP4Free( p.slots[i].encBytes );
+    }
+}
+
+void MP4File::EncAndCopyTrack(
+    MP4File*      srcFile,
+    MP4TrackId    srcTrackId,
+    encryptFunc_t encfcnp,
+    uint32_t      encfcnparam1,
+    uint32_t      numThreads,
+    MP4File*      dstFile,
+    MP4TrackId    dstTrackId,
+    bool          applyEdits )
+{
+    // Note: as with EncAndCopySample() we leave it up to the caller to
+    // ensure that the source and destination tracks are compatible.
+
+    ASSERT(srcFile);
+    ASSERT(encfcnp);
+
+    if( !dstFile )
+        dstFile = srcFile;
+
+    if( dstTrackId == MP4_INVALID_TRACK_ID )
+        dstTrackId = srcTrackId;
+
+    if( numThreads == 0 )
+        numThreads = thread::getProcessorCount();
+
+    MP4Track* srcTrack = srcFile->GetTrack( srcTrackId );
+    uint32_t numSamples = srcTrack->GetNumberOfSamples();
+    bool viaEdits = applyEdits && srcFile->GetTrackNumberOfEdits( srcTrackId );
+    MP4Duration editsDuration = viaEdits
+        ? srcTrack->GetEditTotalDuration( MP4_INVALID_EDIT_ID )
+        : 0;
+
+    // reading and writing stay on this thread since MP4File is not
+    // thread-safe; workers only run the encryption callback. The ring
+    // bounds read-ahead so memory use is independent of track length.
+    EncPipeline p;
+    p.encfcnp      = encfcnp;
+    p.encfcnparam1 = encfcnparam1;
+    p.numSlots     = numThreads * 4;
+    p.slots        = new EncPipelineSlot[p.numSlots];
+    p.numRead      = 0;
+    p.numClaimed   = 0;
+    p.stop         = false;
+    memset( p.slots, 0, p.numSlots * sizeof(EncPipelineSlot) );
+
+    thread::Thread* workers = new thread::Thread[numThreads];
+
+    try {
+        for( uint32_t i = 0; i < numThreads; i++ ) {
+            if( workers[i].start( EncPipelineWorker, &p ))
+                throw new Exception( "unable to start encryption thread", __FILE__, __LINE__, __FUNCTION__ );
+        }
+
+        MP4SampleId sampleId = 0;
+        MP4Timestamp when = 0;
+        uint32_t numWritten = 0;
+        bool eof = false;
+
+        for( ;; ) {
+            // read ahead until every slot is in flight
+            while( !eof && p.numRead - numWritten < p.numSlots ) {
+                MP4Duration sampleDuration = MP4_INVALID_DURATION;
+
+                if( viaEdits ) {
+                    sampleId = srcTrack->GetSampleIdFromEditTime( when, NULL, &sampleDuration );
+                    if( sampleId == MP4_INVALID_SAMPLE_ID )
+                        throw new Exception( "invalid sample id from edit time", __FILE__, __LINE__, __FUNCTION__ );
+
+                    when += sampleDuration;
+                    if( when >= editsDuration ) {
+                        eof = true;
+                        break;
+                    }
+                } else if( ++sampleId > numSamples ) {
+                    eof = true;
+                    break;
+                }
+
+                EncPipelineSlot& s = p.slots[p.numRead % p.numSlots];
+                s.sampleId = sampleId;
+                srcFile->ReadSample(
+                    srcTrackId,
+                    sampleId,
+                    &s.bytes,
+                    &s.numBytes,
+                    NULL,
+                    &s.duration,
+                    &s.renderingOffset,
+                    &s.isSyncSample,
+                    &s.hasDependencyFlags,
+                    &s.dependencyFlags );
+
+                if( sampleDuration != MP4_INVALID_DURATION )
+                    s.duration = sampleDuration;
+
+                p.mutex.lock();
+                p.numRead++;
+                p.workReady.signal();
+                p.mutex.unlock();
+            }
+
+            if( numWritten == p.numRead )
+                break;
+
+            // write samples back in order as their encryption completes
+            EncPipelineSlot& s = p.slots[numWritten % p.numSlots];
+
+            p.mutex.lock();
+            while( !s.done )
+                p.sampleDone.wait();
+            p.mutex.unlock();
+
+            if( s.result != 0 ) {
+                ostringstream msg;
+                msg << "can't encrypt sample " << s.sampleId;
+                throw new Exception( msg.str(), __FILE__, __LINE__, __FUNCTION__ );
+            }
+
+            if( s.hasDependencyFlags ) {
+                dstFile->WriteSampleDependency(
+                    dstTrackId,
+                    s.encBytes,
+                    s.encNumBytes,
+                    s.duration,
+                    s.renderingOffset,
+                    s.isSyncSample,
+                    s.dependencyFlags );
+            }
+            else {
+                dstFile->WriteSample(
+                    dstTrackId,
+                    s.encBytes,
+                    s.encNumBytes,
+                    s.duration,
+                    s.renderingOffset,
+                    s.isSyncSample );
+            }
+
+            MP4Free( s.bytes );
+            MP4Free( s.encBytes );
+            memset( &s, 0, sizeof(s) );
+            numWritten++;
+        }
+    }
+    catch (...) {
+        EncPipelineStop( p, workers, numThreads );
+        delete [] workers;
+        delete [] p.slots;
+        throw;
+    }
+
+    EncPipelineStop( p, workers, numThreads );
+    delete [] workers;
+    delete [] p.slots;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 }} // namespace mp4v2::impl
@@ -44,6 +44,7 @@ class MP4StringProperty;
 class MP4BytesProperty;
 class MP4Descriptor;
 class MP4DescriptorProperty;
+class MP4Prefetcher;
 
 class MP4File
 {
@@ -66,6 +67,24 @@ public:
         MP4TrackId    dstTrackId,
         MP4Duration   dstSampleDuration );
 
+    static void CopyTracks(
+        MP4File*          srcFile,
+        const MP4TrackId* srcTrackIds,
+        uint32_t          numTracks,
+        MP4File*          dstFile,
+        const MP4TrackId* dstTrackIds,
+        bool              applyEdits );
+
+    static void EncAndCopyTrack(
+        MP4File*      srcFile,
+        MP4TrackId    srcTrackId,
+        encryptFunc_t encfcnp,
+        uint32_t      encfcnparam1,
+        uint32_t      numThreads,
+        MP4File*      dstFile,
+        MP4TrackId    dstTrackId,
+        bool          applyEdits );
+
 public:
     MP4File();
     ~MP4File();
@@ -84,8 +103,13 @@ public:
                  uint32_t    supportedBrandsCount = 0 );
 
     const std::string &GetFilename() const;
-    void Read( const char* name, const MP4FileProvider* provider );
-    bool Modify( const char* fileName );
+    void Read( const char* name, const MP4FileProvider* provider, uint32_t flags = 0 );
+    // parse header boxes held in memory, sample data is not accessible
+    void ReadFromBuffer( const char* name, uint8_t* pBytes, uint64_t numBytes );
+    // throws PendingException until the header boxes have arrived
+    void ReadProgressive( const char* name, const MP4ProgressiveProvider* provider,
+                          uint32_t flags = 0 );
+    bool Modify( const char* fileName, uint32_t flags = 0 );
     void Optimize( const char* srcFileName, const char* dstFileName = NULL );
     bool CopyClose( const string& copyFileName );
     void Dump( bool dumpImplicits = false );
@@ -107,6 +131,62 @@ public:
     void SetBytesProperty(const char* name,
                           const uint8_t* pValue, uint32_t valueSize);
 
+    /* resolved property handles */
+
+    MP4ResolvedProperty& ResolveProperty(const char* name);
+
+    MP4ResolvedProperty& ResolveTrackProperty(
+        MP4TrackId trackId, const char* name);
+
+    uint64_t GetIntegerProperty(MP4ResolvedProperty& property);
+    float GetFloatProperty(MP4ResolvedProperty& property);
+    const char* GetStringProperty(MP4ResolvedProperty& property);
+    void GetBytesProperty(MP4ResolvedProperty& property,
+                          uint8_t** ppValue, uint32_t* pValueSize);
+
+    void SetIntegerProperty(MP4ResolvedProperty& property, uint64_t value);
+    void SetFloatProperty(MP4ResolvedProperty& property, float value);
+    void SetStringProperty(MP4ResolvedProperty& property, const char* value);
+    void SetBytesProperty(MP4ResolvedProperty& property,
+                          const uint8_t* pValue, uint32_t valueSize);
+
+    // lookups that return false instead of throwing when the property
+    // does not exist, a type mismatch still throws
+    bool TryGetIntegerProperty(const char* name, uint64_t* pValue);
+    bool TryGetFloatProperty(const char* name, float* pValue);
+    bool TryGetStringProperty(const char* name, const char** pValue);
+    bool TryGetBytesProperty(const char* name,
+                             uint8_t** ppValue, uint32_t* pValueSize);
+
+    bool TryGetIntegerProperty(MP4ResolvedProperty& property, uint64_t* pValue);
+    bool TryGetFloatProperty(MP4ResolvedProperty& property, float* pValue);
+    bool TryGetStringProperty(MP4ResolvedProperty& property, const char** pValue);
+    bool TryGetBytesProperty(MP4ResolvedProperty& property,
+                             uint8_t** ppValue, uint32_t* pValueSize);
+
+    // bumped whenever atoms, descriptors or properties are added or removed
+    uint32_t GetAtomGeneration() {
+        return m_atomGeneration;
+    }
+    void AtomTreeChanged() {
+        m_atomGeneration++;
+    }
+
+    /* performance counters */
+
+    void EnablePerfCounters(bool enable);
+    MP4PerfCounters* GetPerfCounters() {
+        return m_pPerfCounters;     // NULL unless counting
+    }
+
+    /* sample data read-ahead */
+
+    void EnablePrefetch(uint32_t numBlocks, uint32_t blockSize);
+    // copies a sample from the read-ahead pool, false if not prefetching
+    // or the sample is not there
+    bool ReadPrefetched(MP4Track& track, MP4SampleId sampleId,
+                        uint64_t offset, uint8_t* pBytes, uint32_t numBytes);
+
     // file level convenience functions
 
     MP4Duration GetDuration();
@@ -159,6 +239,16 @@ public:
         MP4TrackId trackId, const char* name,
         uint8_t** ppValue, uint32_t* pValueSize);
 
+    bool TryGetTrackIntegerProperty(
+        MP4TrackId trackId, const char* name, uint64_t* pValue);
+    bool TryGetTrackFloatProperty(
+        MP4TrackId trackId, const char* name, float* pValue);
+    bool TryGetTrackStringProperty(
+        MP4TrackId trackId, const char* name, const char** pValue);
+    bool TryGetTrackBytesProperty(
+        MP4TrackId trackId, const char* name,
+        uint8_t** ppValue, uint32_t* pValueSize);
+
     void SetTrackIntegerProperty(
         MP4TrackId trackId, const char* name, int64_t value);
     void SetTrackFloatProperty(
@@ -195,6 +285,66 @@ public:
     bool GetSampleSync(
         MP4TrackId trackId, MP4SampleId sampleId);
 
+    uint8_t GetSampleDependency(
+        MP4TrackId trackId, MP4SampleId sampleId);
+
+    MP4SampleId GetNextIndependentSample(
+        MP4TrackId trackId, MP4SampleId sampleId);
+
+    void GetTrickPlaySamples(
+        MP4TrackId           trackId,
+        MP4SampleId          firstSampleId,
+        MP4SampleId          lastSampleId,
+        uint32_t             speed,
+        vector<MP4SampleId>& samples );
+
+    // CRC-32C digests of samples or chunks, stored in a trak.udta uuid box
+    void GetTrackChecksums(
+        MP4TrackId        trackId,
+        bool              perChunk,
+        vector<uint32_t>& checksums );
+
+    void StoreTrackChecksums(
+        MP4TrackId trackId,
+        bool       perChunk );
+
+    void VerifyTrackChecksums(
+        MP4TrackId           trackId,
+        vector<MP4SampleId>& badSamples );
+
+    // file extent of a sample, and of the samples from the preceding sync
+    // sample through the sample at a time
+    void GetSampleByteRange(
+        MP4TrackId  trackId,
+        MP4SampleId sampleId,
+        uint64_t&   offset,
+        uint64_t&   size );
+
+    void GetSampleByteRangeFromTime(
+        MP4TrackId   trackId,
+        MP4Timestamp when,
+        uint64_t&    offset,
+        uint64_t&    size );
+
+    // sorted extents of the samples of the tracks in [startTime, endTime) of
+    // the movie timeline, merged when no more than maxGap bytes apart
+    void GetByteRangesForTime(
+        const MP4TrackId*     trackIds,
+        uint32_t              numTracks,
+        MP4Timestamp          startTime,
+        MP4Timestamp          endTime,
+        uint64_t              maxGap,
+        vector<MP4ByteRange>& ranges );
+
+    // consecutive samples back to back into pBytes, read in one batch
+    void ReadSamples(
+        MP4TrackId  trackId,
+        MP4SampleId firstSampleId,
+        uint32_t    numSamples,
+        uint8_t*    pBytes,
+        uint32_t    numBytes,
+        uint32_t*   pSampleSizes );
+
     void ReadSample(
         // input parameters
         MP4TrackId trackId,
@@ -226,6 +376,22 @@ public:
         bool           isSyncSample,
         uint32_t       dependencyFlags );
 
+    // H.264 samples in Annex B byte stream format
+    void WriteH264AnnexBSample(
+        MP4TrackId     trackId,
+        const uint8_t* pBytes,
+        uint32_t       numBytes,
+        MP4Duration    duration = 0,
+        MP4Duration    renderingOffset = 0,
+        bool           isSyncSample = true );
+
+    void ReadH264AnnexBSample(
+        MP4TrackId  trackId,
+        MP4SampleId sampleId,
+        uint8_t**   ppBytes,
+        uint32_t*   pNumBytes,
+        bool        withParameterSets = true );
+
     void SetSampleRenderingOffset(
         MP4TrackId  trackId,
         MP4SampleId sampleId,
@@ -559,6 +725,7 @@ public:
                                     uint32_t **pSeqHeaderSize,
                                     uint8_t ***pPictHeader,
                                     uint32_t **pPictHeaderSize);
+    uint8_t GetTrackH264LengthSize(MP4TrackId trackId);
     const char* GetHintTrackSdp(MP4TrackId hintTrackId);
     void SetHintTrackSdp(MP4TrackId hintTrackId, const char* sdpString);
     void AppendHintTrackSdp(MP4TrackId hintTrackId, const char* sdpString);
@@ -668,6 +835,16 @@ public:
         bool includeHeader = true,
         bool includePayload = true);
 
+    bool ReadRtpHintPackets(
+        MP4TrackId hintTrackId,
+        uint8_t* pBuffer,
+        uint32_t* pBufferSize,
+        MP4RtpIovec* pPackets,
+        uint32_t* pNumPackets,
+        uint32_t ssrc = 0,
+        bool includeHeader = true,
+        bool includePayload = true);
+
     MP4Timestamp GetRtpTimestampStart(
         MP4TrackId hintTrackId);
 
@@ -777,6 +954,14 @@ public:
     void ReadBytes( uint8_t* buf, uint32_t bufsiz, File* file = NULL );
     void PeekBytes( uint8_t* buf, uint32_t bufsiz, File* file = NULL );
 
+    // every transfer at its own position in one batch, position unchanged
+    void ReadBatch( vector<File::Transfer>& transfers, File* file = NULL );
+
+    // payloads left on disk by MP4BytesProperty::EnableDeferredRead()
+    File* GetDeferredReadFile();
+    void ReadDeferredBytes( File& file, uint64_t pos, uint8_t* buf, uint32_t bufsiz );
+    void CopyDeferredBytes( File& file, uint64_t pos, uint64_t size );
+
     uint64_t ReadUInt(uint8_t size);
     uint8_t ReadUInt8();
     uint16_t ReadUInt16();
@@ -820,6 +1005,9 @@ public:
 
     bool IsWriteMode();
 
+    // called before media data is written, see MP4_MODIFY_PATCH
+    void EndPatchMode();
+
     MP4Track* GetTrack(MP4TrackId trackId);
 
     void UpdateDuration(MP4Duration duration);
@@ -854,11 +1042,14 @@ public:
 
 protected:
     void Init();
-    void Open( const char* name, File::Mode mode, const MP4FileProvider* provider );
+    void Open( const char* name, File::Mode mode, io::FileProvider* provider );
+    void CheckPendingBoxes();
     void ReadFromFile();
     void GenerateTracks();
     void BeginWrite();
     void FinishWrite();
+    bool BeginModify();
+    bool PatchWrite();
     void CacheProperties();
     void RewriteMdat( File& src, File& dst );
     bool ShallHaveIods();
@@ -876,8 +1067,19 @@ protected:
     void FindBytesProperty(const char* name,
                            MP4Property** ppProperty, uint32_t* pIndex = NULL);
 
+    void FindIntegerProperty(MP4ResolvedProperty& property,
+                             MP4Property** ppProperty, uint32_t* pIndex);
+    void FindFloatProperty(MP4ResolvedProperty& property,
+                           MP4Property** ppProperty, uint32_t* pIndex);
+    void FindStringProperty(MP4ResolvedProperty& property,
+                            MP4Property** ppProperty, uint32_t* pIndex);
+    void FindBytesProperty(MP4ResolvedProperty& property,
+                           MP4Property** ppProperty, uint32_t* pIndex);
+
     bool FindProperty(const char* name,
                       MP4Property** ppProperty, uint32_t* pIndex = NULL);
+    void FindProperty(MP4ResolvedProperty& property,
+                      MP4Property** ppProperty, uint32_t* pIndex);
 
     MP4TrackId AddVideoTrackDefault(
         uint32_t timeScale,
@@ -960,12 +1162,25 @@ protected:
     File*    m_file;
     uint64_t m_fileOriginalSize;
     uint32_t m_createFlags;
+    MP4FileProvider* m_pFileProvider;   // copy of the provider Read() was given
+
+    MP4Prefetcher*    m_pPrefetcher;
 
     MP4Atom*          m_pRootAtom;
+    MP4Arena*         m_pArena;     // owns the parsed tree with MP4_READ_ARENA
+    MP4PerfCounters*  m_pPerfCounters;
     MP4Integer32Array m_trakIds;
     MP4TrackArray     m_pTracks;
     MP4TrackId        m_odTrackId;
     bool              m_useIsma;
+    bool              m_progressive;      // reads of m_file may find data missing
+    bool              m_patchMode;        // MP4_MODIFY_PATCH, layout untouched so far
+    uint32_t          m_patchGeneration;  // m_atomGeneration when the patch began
+
+    // resolved property paths
+    uint32_t                 m_atomGeneration;
+    MP4ResolvedPropertyCache m_propertyCache;
+    MP4ResolvedPropertyCache m_propertyHandles;
 
     // cached properties
     MP4IntegerProperty*     m_pModificationProperty;
@@ -986,6 +1201,10 @@ protected:
     char m_trakName[1024];
     char *m_editName;
 
+    // scratch for H.264 framing conversion, reused across samples
+    vector<MP4NalUnit> m_h264Units;
+    vector<uint8_t>    m_h264Buffer;
+
  private:
     MP4File ( const MP4File &src );
     MP4File &operator= ( const MP4File &src );
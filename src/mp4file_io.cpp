@@ -43,7 +43,8 @@ uint64_t MP4File::GetPosition( File* file )
 void MP4File::SetPosition( uint64_t pos, File* file )
 {
     if( m_memoryBuffer ) {
-        if( pos >= m_memoryBufferSize )
+        // the end is a valid position, as it is for files
+        if( pos > m_memoryBufferSize )
             throw new Exception( "position out of range", __FILE__, __LINE__, __FUNCTION__ );
         m_memoryBufferPosition = pos;
         return;
@@ -53,6 +54,8 @@ void MP4File::SetPosition( uint64_t pos, File* file )
         file = m_file;
 
     ASSERT( file );
+    if( m_pPerfCounters )
+        m_pPerfCounters->seekCalls++;
     if( file->seek( pos ))
         throw new PlatformException( "seek failed", sys::getLastError(), __FILE__, __LINE__, __FUNCTION__ );
 }
@@ -89,6 +92,12 @@ void MP4File::ReadBytes( uint8_t* buf, uint32_t bufsiz, File* file )
         file = m_file;
 
     ASSERT( file );
+    if( m_progressive && file == m_file && file->pending( file->position, bufsiz ))
+        throw new PendingException( file->position, bufsiz, __FILE__, __LINE__, __FUNCTION__ );
+    if( m_pPerfCounters ) {
+        m_pPerfCounters->readCalls++;
+        m_pPerfCounters->readBytes += bufsiz;
+    }
     File::Size nin;
     if( file->read( buf, bufsiz, nin ))
         throw new PlatformException( "read failed", sys::getLastError(), __FILE__, __LINE__, __FUNCTION__ );
@@ -103,6 +112,78 @@ void MP4File::PeekBytes( uint8_t* buf, uint32_t bufsiz, File* file )
     SetPosition( pos, file );
 }
 
+void MP4File::ReadBatch( vector<File::Transfer>& transfers, File* file )
+{
+    if( transfers.empty() )
+        return;
+
+    if( !file )
+        file = m_file;
+
+    ASSERT( file );
+    uint64_t bytes = 0;
+    for( size_t i = 0; i < transfers.size(); i++ ) {
+        const File::Transfer& t = transfers[i];
+        if( m_progressive && file == m_file && file->pending( t.pos, t.size ))
+            throw new PendingException( t.pos, t.size, __FILE__, __LINE__, __FUNCTION__ );
+        bytes += t.size;
+    }
+    if( m_pPerfCounters ) {
+        m_pPerfCounters->readCalls++;
+        m_pPerfCounters->readBytes += bytes;
+    }
+    if( file->readBatch( &transfers[0], uint32_t( transfers.size() )))
+        throw new PlatformException( "read failed", sys::getLastError(), __FILE__, __LINE__, __FUNCTION__ );
+    for( size_t i = 0; i < transfers.size(); i++ ) {
+        if( transfers[i].count != transfers[i].size )
+            throw new Exception( "not enough bytes, reached end-of-file", __FILE__, __LINE__, __FUNCTION__ );
+    }
+}
+
+File* MP4File::GetDeferredReadFile()
+{
+    // only a read-only file is sure to keep its bytes where they were parsed
+    if( m_memoryBuffer || !m_file || m_file->mode != File::MODE_READ )
+        return NULL;
+    return m_file;
+}
+
+void MP4File::ReadDeferredBytes( File& file, uint64_t pos, uint8_t* buf, uint32_t bufsiz )
+{
+    // bypasses any memory buffer and leaves the file position unchanged
+    const File::Size saved = file.position;
+    if( m_progressive && &file == m_file && file.pending( pos, bufsiz ))
+        throw new PendingException( pos, bufsiz, __FILE__, __LINE__, __FUNCTION__ );
+
+    if( m_pPerfCounters ) {
+        m_pPerfCounters->seekCalls += 2;
+        m_pPerfCounters->readCalls++;
+        m_pPerfCounters->readBytes += bufsiz;
+    }
+    if( file.seek( pos ))
+        throw new PlatformException( "seek failed", sys::getLastError(), __FILE__, __LINE__, __FUNCTION__ );
+    File::Size nin;
+    if( file.read( buf, bufsiz, nin ))
+        throw new PlatformException( "read failed", sys::getLastError(), __FILE__, __LINE__, __FUNCTION__ );
+    if( nin != bufsiz )
+        throw new Exception( "not enough bytes, reached end-of-file", __FILE__, __LINE__, __FUNCTION__ );
+    if( file.seek( saved ))
+        throw new PlatformException( "seek failed", sys::getLastError(), __FILE__, __LINE__, __FUNCTION__ );
+}
+
+void MP4File::CopyDeferredBytes( File& file, uint64_t pos, uint64_t size )
+{
+    const uint32_t chunkSize = 64 * 1024;
+    vector<uint8_t> buf( size_t( min( size, uint64_t( chunkSize ))));
+
+    for( uint64_t done = 0; done < size; ) {
+        const uint32_t n = uint32_t( min( size - done, uint64_t( chunkSize )));
+        ReadDeferredBytes( file, pos + done, &buf[0], n );
+        WriteBytes( &buf[0], n );
+        done += n;
+    }
+}
+
 void MP4File::EnableMemoryBuffer( uint8_t* pBytes, uint64_t numBytes )
 {
     ASSERT( !m_memoryBuffer );
@@ -158,6 +239,10 @@ void MP4File::WriteBytes( uint8_t* buf, uint32_t bufsiz, File* file )
         file = m_file;
 
     ASSERT( file );
+    if( m_pPerfCounters ) {
+        m_pPerfCounters->writeCalls++;
+        m_pPerfCounters->writeBytes += bufsiz;
+    }
     File::Size nout;
     if( file->write( buf, bufsiz, nout ))
         throw new PlatformException( "write failed", sys::getLastError(), __FILE__, __LINE__, __FUNCTION__ );
@@ -32,6 +32,7 @@ MP4Property::MP4Property(MP4Atom& parentAtom, const char* name)
     m_name = name;
     m_readOnly = false;
     m_implicit = false;
+    m_dirty = false;
 }
 
 bool MP4Property::FindProperty(const char* name,
@@ -42,8 +43,8 @@ bool MP4Property::FindProperty(const char* name,
     }
 
     if (!strcasecmp(m_name, name)) {
-        log.verbose1f("\"%s\": FindProperty: matched %s", 
-                      m_parentAtom.GetFile().GetFilename().c_str(), name);
+        MP4V2_LOG_VERBOSE1( log, "\"%s\": FindProperty: matched %s", 
+                                 m_parentAtom.GetFile().GetFilename().c_str(), name);
         *ppProperty = this;
         return true;
     }
@@ -348,6 +349,7 @@ void MP4StringProperty::SetCount(uint32_t count)
     for (uint32_t i = oldCount; i < count; i++) {
         m_values[i] = NULL;
     }
+    m_dirty = true;
 }
 
 void MP4StringProperty::SetValue(const char* value, uint32_t index)
@@ -372,6 +374,7 @@ void MP4StringProperty::SetValue(const char* value, uint32_t index)
             m_values[index] = NULL;
         }
     }
+    m_dirty = true;
 }
 
 void MP4StringProperty::Read( MP4File& file, uint32_t index )
@@ -485,11 +488,19 @@ void MP4StringProperty::Dump( uint8_t indent, bool dumpImplicits, uint32_t index
 
 // MP4BytesProperty
 
+namespace {
+    // payloads smaller than this are always read immediately
+    const uint32_t DeferredReadThreshold = 4096;
+} // namespace
+
 MP4BytesProperty::MP4BytesProperty(MP4Atom& parentAtom, const char* name, uint32_t valueSize,
                                    uint32_t defaultValueSize)
         : MP4Property(parentAtom, name)
         , m_fixedValueSize(0)
         , m_defaultValueSize(defaultValueSize)
+        , m_deferrable(false)
+        , m_deferredFile(NULL)
+        , m_deferredPosition(0)
 {
     SetCount(1);
     m_values[0] = (uint8_t*)MP4Calloc(valueSize);
@@ -506,6 +517,8 @@ MP4BytesProperty::~MP4BytesProperty()
 
 void MP4BytesProperty::SetCount(uint32_t count)
 {
+    ResolveDeferred();
+
     uint32_t oldCount = m_values.Size();
 
     m_values.Resize(count);
@@ -515,6 +528,7 @@ void MP4BytesProperty::SetCount(uint32_t count)
         m_values[i] = NULL;
         m_valueSizes[i] = m_defaultValueSize;
     }
+    m_dirty = true;
 }
 
 void MP4BytesProperty::SetValue(const uint8_t* pValue, uint32_t valueSize,
@@ -525,6 +539,9 @@ void MP4BytesProperty::SetValue(const uint8_t* pValue, uint32_t valueSize,
         msg << "property " << m_name << "is read-only";
         throw new PlatformException(msg.str().c_str(), EACCES, __FILE__, __LINE__, __FUNCTION__ );
     }
+    if (index == 0) {
+        m_deferredFile = NULL;
+    }
     if (m_fixedValueSize) {
         if (valueSize > m_fixedValueSize) {
             ostringstream msg;
@@ -549,6 +566,7 @@ void MP4BytesProperty::SetValue(const uint8_t* pValue, uint32_t valueSize,
             m_valueSizes[index] = 0;
         }
     }
+    m_dirty = true;
 }
 
 void MP4BytesProperty::SetValueSize(uint32_t valueSize, uint32_t index)
@@ -557,10 +575,12 @@ void MP4BytesProperty::SetValueSize(uint32_t valueSize, uint32_t index)
         throw new Exception("can't change size of fixed sized property",
                             __FILE__, __LINE__, __FUNCTION__ );
     }
+    ResolveDeferred();
     if (m_values[index] != NULL) {
         m_values[index] = (uint8_t*)MP4Realloc(m_values[index], valueSize);
     }
     m_valueSizes[index] = valueSize;
+    m_dirty = true;
 }
 
 void MP4BytesProperty::SetFixedSize(uint32_t fixedSize)
@@ -570,6 +590,7 @@ void MP4BytesProperty::SetFixedSize(uint32_t fixedSize)
         SetValueSize(fixedSize, i);
     }
     m_fixedValueSize = fixedSize;
+    m_dirty = true;
 }
 
 void MP4BytesProperty::Read(MP4File& file, uint32_t index)
@@ -577,16 +598,56 @@ void MP4BytesProperty::Read(MP4File& file, uint32_t index)
     if (m_implicit) {
         return;
     }
-    MP4Free(m_values[index]);
-    m_values[index] = (uint8_t*)MP4Malloc(m_valueSizes[index]);
+    if (index == 0) {
+        m_deferredFile = NULL;
+    }
+
+    // skip over a large payload, LoadDeferred() reads it when needed
+    if (m_deferrable && index == 0 && GetCount() == 1 && m_fixedValueSize == 0
+        && m_valueSizes[0] >= DeferredReadThreshold) {
+        File* source = file.GetDeferredReadFile();
+        if (source) {
+            MP4Free(m_values[0]);
+            m_values[0] = NULL;
+            m_deferredFile = source;
+            m_deferredPosition = file.GetPosition();
+            file.SetPosition(m_deferredPosition + m_valueSizes[0]);
+            return;
+        }
+    }
+
+    // a fixed size value keeps its buffer across reads
+    if (m_fixedValueSize == 0 || m_values[index] == NULL) {
+        MP4Free(m_values[index]);
+        m_values[index] = (uint8_t*)MP4Malloc(m_valueSizes[index]);
+    }
     file.ReadBytes(m_values[index], m_valueSizes[index]);
 }
 
+void MP4BytesProperty::LoadDeferred()
+{
+    uint8_t* value = (uint8_t*)MP4Malloc(m_valueSizes[0]);
+    try {
+        m_parentAtom.GetFile().ReadDeferredBytes(*m_deferredFile, m_deferredPosition,
+                                                 value, m_valueSizes[0]);
+    }
+    catch (Exception*) {
+        MP4Free(value);
+        throw;
+    }
+    m_values[0] = value;
+    m_deferredFile = NULL;
+}
+
 void MP4BytesProperty::Write(MP4File& file, uint32_t index)
 {
     if (m_implicit) {
         return;
     }
+    if (index == 0 && m_deferredFile) {
+        file.CopyDeferredBytes(*m_deferredFile, m_deferredPosition, m_valueSizes[0]);
+        return;
+    }
     file.WriteBytes(m_values[index], m_valueSizes[index]);
 }
 
@@ -596,6 +657,8 @@ void MP4BytesProperty::Dump(uint8_t indent,
     if( m_implicit && !dumpImplicits )
         return;
 
+    ResolveDeferred();
+
     const uint32_t size  = m_valueSizes[index];
     const uint8_t* const value = m_values[index];
 
@@ -690,6 +753,30 @@ void MP4TableProperty::AddProperty(MP4Property* pProperty)
     ASSERT(pProperty->GetType() != DescriptorProperty);
     m_pProperties.Add(pProperty);
     pProperty->SetCount(0);
+    m_dirty = true;
+}
+
+bool MP4TableProperty::IsDirty()
+{
+    if (m_dirty) {
+        return true;
+    }
+    for (uint32_t i = 0; i < m_pProperties.Size(); i++) {
+        if (m_pProperties[i]->IsDirty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void MP4TableProperty::SetDirty(bool value)
+{
+    m_dirty = value;
+    if (!value) {
+        for (uint32_t i = 0; i < m_pProperties.Size(); i++) {
+            m_pProperties[i]->SetDirty(false);
+        }
+    }
 }
 
 bool MP4TableProperty::FindProperty(const char *name,
@@ -714,8 +801,8 @@ bool MP4TableProperty::FindProperty(const char *name,
         }
     }
     
-    log.verbose1f("\"%s\": FindProperty: matched %s", 
-                  m_parentAtom.GetFile().GetFilename().c_str(), name);
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": FindProperty: matched %s", 
+                             m_parentAtom.GetFile().GetFilename().c_str(), name);
 
     // get name of table property
     const char *tablePropName = MP4NameAfterFirst(name);
@@ -761,6 +848,11 @@ void MP4TableProperty::Read(MP4File& file, uint32_t index)
 
     uint32_t numEntries = GetCount();
 
+    MP4PerfCounters* pPerf = file.GetPerfCounters();
+    if (pPerf) {
+        pPerf->tableEntries += numEntries;
+    }
+
     /* for each property set size */
     for (uint32_t j = 0; j < numProperties; j++) {
         m_pProperties[j]->SetCount(numEntries);
@@ -871,14 +963,61 @@ MP4Descriptor* MP4DescriptorProperty::AddDescriptor(uint8_t tag)
     ASSERT(pDescriptor);
 
     m_pDescriptors.Add(pDescriptor);
+    m_parentAtom.GetFile().AtomTreeChanged();
+    m_dirty = true;
 
     return pDescriptor;
 }
 
+void MP4DescriptorProperty::SetCount(uint32_t count)
+{
+    m_pDescriptors.Resize(count);
+    m_parentAtom.GetFile().AtomTreeChanged();
+    m_dirty = true;
+}
+
+void MP4DescriptorProperty::AppendDescriptor(MP4Descriptor* pDescriptor)
+{
+    m_pDescriptors.Add(pDescriptor);
+    m_parentAtom.GetFile().AtomTreeChanged();
+    m_dirty = true;
+}
+
 void MP4DescriptorProperty::DeleteDescriptor(uint32_t index)
 {
     delete m_pDescriptors[index];
     m_pDescriptors.Delete(index);
+    m_parentAtom.GetFile().AtomTreeChanged();
+    m_dirty = true;
+}
+
+bool MP4DescriptorProperty::IsDirty()
+{
+    if (m_dirty) {
+        return true;
+    }
+    for (uint32_t i = 0; i < m_pDescriptors.Size(); i++) {
+        MP4Descriptor* pDescriptor = m_pDescriptors[i];
+        for (uint32_t j = 0; j < pDescriptor->GetCount(); j++) {
+            if (pDescriptor->GetProperty(j)->IsDirty()) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void MP4DescriptorProperty::SetDirty(bool value)
+{
+    m_dirty = value;
+    if (!value) {
+        for (uint32_t i = 0; i < m_pDescriptors.Size(); i++) {
+            MP4Descriptor* pDescriptor = m_pDescriptors[i];
+            for (uint32_t j = 0; j < pDescriptor->GetCount(); j++) {
+                pDescriptor->GetProperty(j)->SetDirty(false);
+            }
+        }
+    }
 }
 
 void MP4DescriptorProperty::Generate()
@@ -913,9 +1052,9 @@ bool MP4DescriptorProperty::FindProperty(const char *name,
         return false;
     }
 
-    log.verbose1f("\"%s\": matched %s",
-                  m_parentAtom.GetFile().GetFilename().c_str(),
-                  name);
+    MP4V2_LOG_VERBOSE1( log, "\"%s\": matched %s",
+                             m_parentAtom.GetFile().GetFilename().c_str(),
+                             name);
 
     // get name of descriptor property
     name = MP4NameAfterFirst(name);
@@ -1109,6 +1248,7 @@ void
 MP4LanguageCodeProperty::SetValue( bmff::LanguageCode value )
 {
     _value = value;
+    m_dirty = true;
 }
 
 void
@@ -1177,6 +1317,7 @@ void
 MP4BasicTypeProperty::SetValue( itmf::BasicType value )
 {
     _value = value;
+    m_dirty = true;
 }
 
 void
@@ -47,7 +47,7 @@ enum MP4PropertyType {
     BasicTypeProperty,
 };
 
-class MP4Property {
+class MP4Property : public MP4ArenaObject {
 public:
     MP4Property(MP4Atom& parentAtom, const char *name = NULL);
 
@@ -77,6 +77,14 @@ public:
         m_implicit = value;
     }
 
+    // set by every mutator, lets a patch close find the atoms to rewrite
+    virtual bool IsDirty() {
+        return m_dirty;
+    }
+    virtual void SetDirty(bool value = true) {
+        m_dirty = value;
+    }
+
     virtual uint32_t GetCount() = 0;
     virtual void SetCount(uint32_t count) = 0;
 
@@ -97,6 +105,7 @@ protected:
     const char* m_name;
     bool m_readOnly;
     bool m_implicit;
+    bool m_dirty;
 
 private:
     MP4Property();
@@ -146,11 +155,15 @@ private:
         } \
         void SetCount(uint32_t count) { \
             m_values.Resize(count); \
+            m_dirty = true; \
         } \
         \
         uint##isize##_t GetValue(uint32_t index = 0) { \
             return m_values[index]; \
         } \
+        const uint##isize##_t* GetValues() { \
+            return m_values.Size() ? &m_values[0] : NULL; \
+        } \
         \
         void SetValue(uint##isize##_t value, uint32_t index = 0) { \
             if (m_readOnly) { \
@@ -159,18 +172,23 @@ private:
                 throw new PlatformException(msg.str().c_str(), EACCES, __FILE__, __LINE__, __FUNCTION__); \
             } \
             m_values[index] = value; \
+            m_dirty = true; \
         } \
         void AddValue(uint##isize##_t value) { \
             m_values.Add(value); \
+            m_dirty = true; \
         } \
         void InsertValue(uint##isize##_t value, uint32_t index) { \
             m_values.Insert(value, index); \
+            m_dirty = true; \
         } \
         void DeleteValue(uint32_t index) { \
             m_values.Delete(index); \
+            m_dirty = true; \
         } \
         void IncrementValue(int32_t increment = 1, uint32_t index = 0) { \
             m_values[index] += increment; \
+            m_dirty = true; \
         } \
         void Read(MP4File& file, uint32_t index = 0) { \
             if (m_implicit) { \
@@ -219,6 +237,7 @@ public:
     }
     void SetNumBits(uint8_t numBits) {
         m_numBits = numBits;
+        m_dirty = true;
     }
 
     void Read(MP4File& file, uint32_t index = 0);
@@ -254,6 +273,7 @@ public:
     }
     void SetCount(uint32_t count) {
         m_values.Resize(count);
+        m_dirty = true;
     }
 
     float GetValue(uint32_t index = 0) {
@@ -267,14 +287,17 @@ public:
             throw new PlatformException(msg.str().c_str(), EACCES, __FILE__, __LINE__, __FUNCTION__);
         }
         m_values[index] = value;
+        m_dirty = true;
     }
 
     void AddValue(float value) {
         m_values.Add(value);
+        m_dirty = true;
     }
 
     void InsertValue(float value, uint32_t index) {
         m_values.Insert(value, index);
+        m_dirty = true;
     }
 
     bool IsFixed16Format() {
@@ -283,6 +306,7 @@ public:
 
     void SetFixed16Format(bool useFixed16Format = true) {
         m_useFixed16Format = useFixed16Format;
+        m_dirty = true;
     }
 
     bool IsFixed32Format() {
@@ -291,6 +315,7 @@ public:
 
     void SetFixed32Format(bool useFixed32Format = true) {
         m_useFixed32Format = useFixed32Format;
+        m_dirty = true;
     }
 
     void Read(MP4File& file, uint32_t index = 0);
@@ -344,6 +369,7 @@ public:
 
     void SetCountedFormat(bool useCountedFormat) {
         m_useCountedFormat = useCountedFormat;
+        m_dirty = true;
     }
 
     bool IsExpandedCountedFormat() {
@@ -352,6 +378,7 @@ public:
 
     void SetExpandedCountedFormat(bool useExpandedCount) {
         m_useExpandedCount = useExpandedCount;
+        m_dirty = true;
     }
 
     bool IsUnicode() {
@@ -360,6 +387,7 @@ public:
 
     void SetUnicode(bool useUnicode) {
         m_useUnicode = useUnicode;
+        m_dirty = true;
     }
 
     uint32_t GetFixedLength() {
@@ -368,6 +396,7 @@ public:
 
     void SetFixedLength(uint32_t fixedLength) {
         m_fixedLength = fixedLength;
+        m_dirty = true;
     }
 
     void Read(MP4File& file, uint32_t index = 0);
@@ -410,12 +439,14 @@ public:
     void GetValue(uint8_t** ppValue, uint32_t* pValueSize,
                   uint32_t index = 0) {
         // N.B. caller must free memory
+        ResolveDeferred();
         *ppValue = (uint8_t*)MP4Malloc(m_valueSizes[index]);
         memcpy(*ppValue, m_values[index], m_valueSizes[index]);
         *pValueSize = m_valueSizes[index];
     }
 
     char* GetValueStringAlloc( uint32_t index = 0 ) {
+        ResolveDeferred();
         char* buf = (char*)MP4Malloc( m_valueSizes[index] + 1 );
         memcpy( buf, m_values[index], m_valueSizes[index] );
         buf[m_valueSizes[index]] = '\0';
@@ -423,12 +454,14 @@ public:
     }
 
     bool CompareToString( const string& s, uint32_t index = 0 ) {
+        ResolveDeferred();
         return string( (const char*)m_values[index], m_valueSizes[index] ) != s;
     }
 
     void CopyValue(uint8_t* pValue, uint32_t index = 0) {
         // N.B. caller takes responsbility for valid pointer
         // and sufficient memory at the destination
+        ResolveDeferred();
         memcpy(pValue, m_values[index], m_valueSizes[index]);
     }
 
@@ -453,18 +486,40 @@ public:
 
     void SetFixedSize(uint32_t fixedSize);
 
+    // leave large payloads of read-only files on disk until first accessed,
+    // Write() then copies them from the source file in bounded chunks
+    void EnableDeferredRead() {
+        m_deferrable = true;
+    }
+
+    bool IsDeferred() {
+        return m_deferredFile != NULL;
+    }
+
     void Read(MP4File& file, uint32_t index = 0);
     void Write(MP4File& file, uint32_t index = 0);
     void Dump(uint8_t indent,
               bool dumpImplicits, uint32_t index = 0);
 
 protected:
+    void ResolveDeferred() {
+        if (m_deferredFile) {
+            LoadDeferred();
+        }
+    }
+
     uint32_t        m_fixedValueSize;
     uint32_t        m_defaultValueSize;
     MP4Integer32Array   m_valueSizes;
     MP4BytesArray       m_values;
 
+    bool            m_deferrable;
+    File*           m_deferredFile;     // source of a deferred value 0
+    uint64_t        m_deferredPosition;
+
 private:
+    void LoadDeferred();
+
     MP4BytesProperty();
     MP4BytesProperty ( const MP4BytesProperty &src );
     MP4BytesProperty &operator= ( const MP4BytesProperty &src );
@@ -493,6 +548,9 @@ public:
         m_pCountProperty->SetValue(count);
     }
 
+    bool IsDirty();
+    void SetDirty(bool value = true);
+
     void Read(MP4File& file, uint32_t index = 0);
     void Write(MP4File& file, uint32_t index = 0);
     void Dump(uint8_t indent,
@@ -539,9 +597,7 @@ public:
     uint32_t GetCount() {
         return m_pDescriptors.Size();
     }
-    void SetCount(uint32_t count) {
-        m_pDescriptors.Resize(count);
-    }
+    void SetCount(uint32_t count);
 
     void SetTags(uint8_t tagsStart, uint8_t tagsEnd = 0) {
         m_tagsStart = tagsStart;
@@ -550,12 +606,13 @@ public:
 
     MP4Descriptor* AddDescriptor(uint8_t tag);
 
-    void AppendDescriptor(MP4Descriptor* pDescriptor) {
-        m_pDescriptors.Add(pDescriptor);
-    }
+    void AppendDescriptor(MP4Descriptor* pDescriptor);
 
     void DeleteDescriptor(uint32_t index);
 
+    bool IsDirty();
+    void SetDirty(bool value = true);
+
     void Generate();
     void Read(MP4File& file, uint32_t index = 0);
     void Write(MP4File& file, uint32_t index = 0);
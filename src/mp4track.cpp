@@ -40,14 +40,12 @@ namespace mp4v2 { namespace impl {
 MP4Track::MP4Track(MP4File& file, MP4Atom& trakAtom)
     : m_File(file)
     , m_trakAtom(trakAtom)
+    , m_propertyCache("trak.")
+    , m_propertyHandles("trak.", 0)
 {
     m_lastStsdIndex = 0;
     m_lastSampleFile = NULL;
 
-    m_cachedReadSampleId = MP4_INVALID_SAMPLE_ID;
-    m_pCachedReadSample = NULL;
-    m_cachedReadSampleSize = 0;
-
     m_writeSampleId = 1;
     m_fixedSampleDuration = 0;
     m_pChunkBuffer = NULL;
@@ -63,9 +61,12 @@ MP4Track::MP4Track(MP4File& file, MP4Atom& trakAtom)
     m_durationPerChunk = 0;
     m_isAmr = AMR_UNINITIALIZED;
     m_curMode = 0;
+    m_sdtpExplicit = false;
+    m_h264LengthSize = -1;
 
     m_cachedSttsSid = MP4_INVALID_SAMPLE_ID;
     m_cachedCttsSid = MP4_INVALID_SAMPLE_ID;
+    m_cachedStscIndex = 0;
 
     bool success = true;
 
@@ -236,6 +237,22 @@ MP4Track::MP4Track(MP4File& file, MP4Atom& trakAtom)
     }
     CalculateBytesPerSample();
 
+    m_writeStatsValid = (GetNumberOfSamples() == 0);
+    m_writeTotalBytes = 0;
+    m_writeMaxSampleSize = 0;
+    m_writeElapsed = 0;
+    m_writeMaxBytesPerSec = 0;
+    m_writeBytesThisSec = 0;
+    m_writeThisSecStart = 0;
+    m_writeLastSampleTime = 0;
+    m_writeLastSampleSize = 0;
+
+    m_tableStatsValid = false;
+    m_tableTotalSizes = 0;
+    m_tableMaxSize = 0;
+    m_tableMaxBitrateValid = false;
+    m_tableMaxBitrate = 0;
+
     // update sdtp log from sdtp atom
     MP4SdtpAtom* sdtp = (MP4SdtpAtom*)m_trakAtom.FindAtom( "trak.mdia.minf.stbl.sdtp" );
     if( sdtp ) {
@@ -249,8 +266,6 @@ MP4Track::MP4Track(MP4File& file, MP4Atom& trakAtom)
 
 MP4Track::~MP4Track()
 {
-    MP4Free(m_pCachedReadSample);
-    m_pCachedReadSample = NULL;
     MP4Free(m_pChunkBuffer);
     m_pChunkBuffer = NULL;
 }
@@ -279,6 +294,10 @@ void MP4Track::ReadSample(
     if( sampleId == MP4_INVALID_SAMPLE_ID )
         throw new Exception( "sample id can't be zero", __FILE__, __LINE__, __FUNCTION__ );
 
+    // a log derived from slice headers may not reach this sample yet
+    if( !m_sdtpLog.empty() )
+        AnalyzeSampleDependencies( sampleId );
+
     if( hasDependencyFlags )
         *hasDependencyFlags = !m_sdtpLog.empty();
 
@@ -312,8 +331,8 @@ void MP4Track::ReadSample(
     }
     *pNumBytes = sampleSize;
 
-    log.verbose3f("\"%s\": ReadSample: track %u id %u offset 0x%" PRIx64 " size %u (0x%x)",
-                  GetFile().GetFilename().c_str(), m_trackId, sampleId, fileOffset, *pNumBytes, *pNumBytes);
+    MP4V2_LOG_VERBOSE3( log, "\"%s\": ReadSample: track %u id %u offset 0x%" PRIx64 " size %u (0x%x)",
+                             GetFile().GetFilename().c_str(), m_trackId, sampleId, fileOffset, *pNumBytes, *pNumBytes);
 
     bool bufferMalloc = false;
     if (*ppBytes == NULL) {
@@ -323,27 +342,29 @@ void MP4Track::ReadSample(
 
     uint64_t oldPos = m_File.GetPosition( fin ); // only used in mode == 'w'
     try {
-        m_File.SetPosition( fileOffset, fin );
-        m_File.ReadBytes( *ppBytes, *pNumBytes, fin );
+        if( fin || !m_File.ReadPrefetched( *this, sampleId, fileOffset, *ppBytes, *pNumBytes )) {
+            m_File.SetPosition( fileOffset, fin );
+            m_File.ReadBytes( *ppBytes, *pNumBytes, fin );
+        }
 
         if (pStartTime || pDuration) {
             GetSampleTimes(sampleId, pStartTime, pDuration);
 
-            log.verbose3f("\"%s\": ReadSample:  start %" PRIu64 " duration %" PRId64,
-                          GetFile().GetFilename().c_str(), (pStartTime ? *pStartTime : 0),
-                          (pDuration ? *pDuration : 0));
+            MP4V2_LOG_VERBOSE3( log, "\"%s\": ReadSample:  start %" PRIu64 " duration %" PRId64,
+                                     GetFile().GetFilename().c_str(), (pStartTime ? *pStartTime : 0),
+                                     (pDuration ? *pDuration : 0));
         }
         if (pRenderingOffset) {
             *pRenderingOffset = GetSampleRenderingOffset(sampleId);
 
-            log.verbose3f("\"%s\": ReadSample:  renderingOffset %" PRId64,
-                          GetFile().GetFilename().c_str(), *pRenderingOffset);
+            MP4V2_LOG_VERBOSE3( log, "\"%s\": ReadSample:  renderingOffset %" PRId64,
+                                     GetFile().GetFilename().c_str(), *pRenderingOffset);
         }
         if (pIsSyncSample) {
             *pIsSyncSample = IsSyncSample(sampleId);
 
-            log.verbose3f("\"%s\": ReadSample:  isSyncSample %u",
-                          GetFile().GetFilename().c_str(), *pIsSyncSample);
+            MP4V2_LOG_VERBOSE3( log, "\"%s\": ReadSample:  isSyncSample %u",
+                                     GetFile().GetFilename().c_str(), *pIsSyncSample);
         }
     }
 
@@ -363,6 +384,56 @@ void MP4Track::ReadSample(
         m_File.SetPosition( oldPos, fin );
 }
 
+// The samples are taken from the chunks holding them, one transfer per
+// chunk, and read in a single batch.
+void MP4Track::ReadSamples(
+    MP4SampleId firstSampleId,
+    uint32_t    numSamples,
+    uint8_t*    pBytes,
+    uint32_t    numBytes,
+    uint32_t*   pSampleSizes )
+{
+    if( numSamples == 0 )
+        return;
+
+    ASSERT( pBytes );
+    const MP4SampleId lastSampleId = firstSampleId + numSamples - 1;
+    if( lastSampleId < firstSampleId )
+        throw new Exception( "invalid sample id range", __FILE__, __LINE__, __FUNCTION__ );
+
+    if (m_pChunkBuffer && lastSampleId >= m_writeSampleId - m_chunkSamples) {
+        WriteChunkBuffer();
+    }
+
+    vector<ChunkExtent> extents;
+    GetSampleExtents( firstSampleId, lastSampleId, extents );
+
+    uint64_t size = 0;
+    for( size_t i = 0; i < extents.size(); i++ )
+        size += extents[i].size;
+    if( size > numBytes )
+        throw new Exception( "sample buffer is too small", __FILE__, __LINE__, __FUNCTION__ );
+
+    MP4V2_LOG_VERBOSE3( log, "\"%s\": ReadSamples: track %u id %u count %u chunks %u size %" PRIu64,
+                             GetFile().GetFilename().c_str(), m_trackId, firstSampleId, numSamples,
+                             uint32_t( extents.size() ), size );
+
+    vector<File::Transfer> transfers( extents.size() );
+    size = 0;
+    for( size_t i = 0; i < extents.size(); i++ ) {
+        transfers[i].pos = extents[i].offset;
+        transfers[i].buffer = pBytes + size;
+        transfers[i].size = extents[i].size;
+        size += extents[i].size;
+    }
+    m_File.ReadBatch( transfers );
+
+    if( pSampleSizes ) {
+        for( uint32_t i = 0; i < numSamples; i++ )
+            pSampleSizes[i] = GetSampleSize( firstSampleId + i );
+    }
+}
+
 void MP4Track::ReadSampleFragment(
     MP4SampleId sampleId,
     uint32_t sampleOffset,
@@ -374,26 +445,27 @@ void MP4Track::ReadSampleFragment(
                             __FILE__, __LINE__, __FUNCTION__ );
     }
 
-    if (sampleId != m_cachedReadSampleId) {
-        MP4Free(m_pCachedReadSample);
-        m_pCachedReadSample = NULL;
-        m_cachedReadSampleSize = 0;
-        m_cachedReadSampleId = MP4_INVALID_SAMPLE_ID;
+    uint32_t sampleSize = 0;
+    const uint8_t* pSample = m_sampleCache.Find(sampleId, &sampleSize);
+
+    if (pSample == NULL) {
+        uint8_t* pBytes = NULL;
 
         ReadSample(
             sampleId,
-            &m_pCachedReadSample,
-            &m_cachedReadSampleSize);
+            &pBytes,
+            &sampleSize);
 
-        m_cachedReadSampleId = sampleId;
+        m_sampleCache.Insert(sampleId, pBytes, sampleSize);
+        pSample = pBytes;
     }
 
-    if (sampleOffset + sampleLength > m_cachedReadSampleSize) {
+    if (sampleOffset + sampleLength > sampleSize) {
         throw new Exception("offset and/or length are too large",
                             __FILE__, __LINE__, __FUNCTION__ );
     }
 
-    memcpy(pDest, &m_pCachedReadSample[sampleOffset], sampleLength);
+    memcpy(pDest, &pSample[sampleOffset], sampleLength);
 }
 
 void MP4Track::WriteSample(
@@ -405,9 +477,12 @@ void MP4Track::WriteSample(
 {
     uint8_t curMode = 0;
 
-    log.verbose3f("\"%s\": WriteSample: track %u id %u size %u (0x%x) ",
-                  GetFile().GetFilename().c_str(),
-                  m_trackId, m_writeSampleId, numBytes, numBytes);
+    // media data can't be patched in, set the file up for appending
+    m_File.EndPatchMode();
+
+    MP4V2_LOG_VERBOSE3( log, "\"%s\": WriteSample: track %u id %u size %u (0x%x) ",
+                             GetFile().GetFilename().c_str(),
+                             m_trackId, m_writeSampleId, numBytes, numBytes);
 
     if (pBytes == NULL && numBytes > 0) {
         throw new Exception("no sample data", __FILE__, __LINE__, __FUNCTION__ );
@@ -428,12 +503,19 @@ void MP4Track::WriteSample(
         curMode = (pBytes[0] >> 3) &0x000F; // The mode is in the first byte
     }
 
+    // derive sdtp from the slice headers unless the caller supplies it
+    if (!m_sdtpExplicit && GetH264LengthSize()) {
+        AnalyzeSampleDependencies(m_writeSampleId - 1);
+        m_sdtpLog.push_back((char)MP4H264Dependency::ForSample(
+            pBytes, numBytes, GetH264LengthSize()));
+    }
+
     if (duration == MP4_INVALID_DURATION) {
         duration = GetFixedSampleDuration();
     }
 
-    log.verbose3f("\"%s\": duration %" PRIu64, GetFile().GetFilename().c_str(), 
-                  duration);
+    MP4V2_LOG_VERBOSE3( log, "\"%s\": duration %" PRIu64, GetFile().GetFilename().c_str(), 
+                             duration);
 
     if ((m_isAmr == AMR_TRUE) &&
             (m_curMode != curMode)) {
@@ -457,6 +539,8 @@ void MP4Track::WriteSample(
 
     UpdateSampleSizes(m_writeSampleId, numBytes);
 
+    UpdateWriteStats(numBytes, duration);
+
     UpdateSampleTimes(duration);
 
     UpdateRenderingOffsets(m_writeSampleId, renderingOffset);
@@ -483,6 +567,7 @@ void MP4Track::WriteSampleDependency(
     bool           isSyncSample,
     uint32_t       dependencyFlags )
 {
+    m_sdtpExplicit = true;
     m_sdtpLog.push_back( dependencyFlags ); // record dependency flags for processing at finish
     WriteSample( pBytes, numBytes, duration, renderingOffset, isSyncSample );
 }
@@ -493,15 +578,16 @@ void MP4Track::WriteChunkBuffer()
         return;
     }
 
+    m_File.EndPatchMode();
     uint64_t chunkOffset = m_File.GetPosition();
 
     // write chunk buffer
     m_File.WriteBytes(m_pChunkBuffer, m_sizeOfDataInChunkBuffer);
 
-    log.verbose3f("\"%s\": WriteChunk: track %u offset 0x%" PRIx64 " size %u (0x%x) numSamples %u",
-                  GetFile().GetFilename().c_str(), 
-                  m_trackId, chunkOffset, m_sizeOfDataInChunkBuffer,
-                  m_sizeOfDataInChunkBuffer, m_chunkSamples);
+    MP4V2_LOG_VERBOSE3( log, "\"%s\": WriteChunk: track %u offset 0x%" PRIx64 " size %u (0x%x) numSamples %u",
+                             GetFile().GetFilename().c_str(), 
+                             m_trackId, chunkOffset, m_sizeOfDataInChunkBuffer,
+                             m_sizeOfDataInChunkBuffer, m_chunkSamples);
 
     UpdateSampleToChunk(m_writeSampleId,
                         m_pChunkCountProperty->GetValue() + 1,
@@ -586,6 +672,11 @@ void MP4Track::FinishSdtp()
     if( m_sdtpLog.empty() )
         return;
 
+    // nor write a derived one that knows nothing, e.g. for avc1 samples
+    // without slices; an explicitly written log is always kept
+    if( !m_sdtpExplicit && m_sdtpLog.find_first_not_of( '\0' ) == string::npos )
+        return;
+
     MP4SdtpAtom* sdtp = (MP4SdtpAtom*)m_trakAtom.FindAtom( "trak.mdia.minf.stbl.sdtp" );
     if( !sdtp )
         sdtp = (MP4SdtpAtom*)AddAtom( "trak.mdia.minf.stbl", "sdtp" );
@@ -647,6 +738,10 @@ uint32_t MP4Track::GetSampleSize(MP4SampleId sampleId)
 
 uint32_t MP4Track::GetMaxSampleSize()
 {
+    if (m_writeStatsValid) {
+        return m_writeMaxSampleSize;
+    }
+
     if (m_pStszFixedSampleSizeProperty != NULL) {
         uint32_t fixedSampleSize =
             m_pStszFixedSampleSizeProperty->GetValue();
@@ -656,20 +751,16 @@ uint32_t MP4Track::GetMaxSampleSize()
         }
     }
 
-    uint32_t maxSampleSize = 0;
-    uint32_t numSamples = m_pStszSampleSizeProperty->GetCount();
-    for (MP4SampleId sid = 1; sid <= numSamples; sid++) {
-        uint32_t sampleSize =
-            m_pStszSampleSizeProperty->GetValue(sid - 1);
-        if (sampleSize > maxSampleSize) {
-            maxSampleSize = sampleSize;
-        }
-    }
-    return maxSampleSize * m_bytesPerSample;
+    CalculateTableStats();
+    return m_tableMaxSize * m_bytesPerSample;
 }
 
 uint64_t MP4Track::GetTotalOfSampleSizes()
 {
+    if (m_writeStatsValid) {
+        return m_writeTotalBytes;
+    }
+
     uint64_t retval;
     if (m_pStszFixedSampleSizeProperty != NULL) {
         uint32_t fixedSampleSize =
@@ -685,14 +776,89 @@ uint64_t MP4Track::GetTotalOfSampleSizes()
     }
 
     // else non-fixed sample size, sum them
-    uint64_t totalSampleSizes = 0;
+    CalculateTableStats();
+    return m_tableTotalSizes * m_bytesPerSample;
+}
+
+// Sum and maximum of a 32-bit size table. With SSE2 four sizes are
+// processed per step, summed in 64-bit lanes so large tables can't
+// overflow, and compared biased by 2^31 since SSE2 only has a signed
+// 32-bit compare.
+static void ReduceSampleSizes(const uint32_t* pSizes, uint32_t count,
+                              uint64_t* pTotal, uint32_t* pMax)
+{
+    uint64_t total = 0;
+    uint32_t maxSize = 0;
+    uint32_t i = 0;
+
+#ifdef MP4V2_HAVE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi32((int)0x80000000);
+    __m128i sumLo = zero;
+    __m128i sumHi = zero;
+    __m128i maxBiased = bias;
+
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)&pSizes[i]);
+        sumLo = _mm_add_epi64(sumLo, _mm_unpacklo_epi32(v, zero));
+        sumHi = _mm_add_epi64(sumHi, _mm_unpackhi_epi32(v, zero));
+
+        __m128i biased = _mm_xor_si128(v, bias);
+        __m128i greater = _mm_cmpgt_epi32(biased, maxBiased);
+        maxBiased = _mm_or_si128(_mm_and_si128(greater, biased),
+                                 _mm_andnot_si128(greater, maxBiased));
+    }
+
+    uint64_t sums[2];
+    _mm_storeu_si128((__m128i*)sums, _mm_add_epi64(sumLo, sumHi));
+    total = sums[0] + sums[1];
+
+    uint32_t maxs[4];
+    _mm_storeu_si128((__m128i*)maxs, _mm_xor_si128(maxBiased, bias));
+    for (uint32_t j = 0; j < 4; j++) {
+        if (maxs[j] > maxSize) {
+            maxSize = maxs[j];
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        total += pSizes[i];
+        if (pSizes[i] > maxSize) {
+            maxSize = pSizes[i];
+        }
+    }
+
+    *pTotal = total;
+    *pMax = maxSize;
+}
+
+void MP4Track::CalculateTableStats()
+{
+    if (m_tableStatsValid) {
+        return;
+    }
+
     uint32_t numSamples = m_pStszSampleSizeProperty->GetCount();
-    for (MP4SampleId sid = 1; sid <= numSamples; sid++) {
-        uint32_t sampleSize =
-            m_pStszSampleSizeProperty->GetValue(sid - 1);
-        totalSampleSizes += sampleSize;
+
+    if (m_pStszSampleSizeProperty->GetType() == Integer32Property) {
+        ReduceSampleSizes(
+            ((MP4Integer32Property*)m_pStszSampleSizeProperty)->GetValues(),
+            numSamples, &m_tableTotalSizes, &m_tableMaxSize);
+    } else {
+        m_tableTotalSizes = 0;
+        m_tableMaxSize = 0;
+        for (MP4SampleId sid = 1; sid <= numSamples; sid++) {
+            uint32_t sampleSize =
+                m_pStszSampleSizeProperty->GetValue(sid - 1);
+            m_tableTotalSizes += sampleSize;
+            if (sampleSize > m_tableMaxSize) {
+                m_tableMaxSize = sampleSize;
+            }
+        }
     }
-    return totalSampleSizes * m_bytesPerSample;
+
+    m_tableStatsValid = true;
 }
 
 void MP4Track::SampleSizePropertyAddValue (uint32_t size)
@@ -810,6 +976,13 @@ uint32_t MP4Track::GetAvgBitrate()
 
 uint32_t MP4Track::GetMaxBitrate()
 {
+    if (m_writeStatsValid) {
+        return m_writeMaxBytesPerSec * 8;
+    }
+    if (m_tableMaxBitrateValid) {
+        return m_tableMaxBitrate;
+    }
+
     uint32_t timeScale = GetTimeScale();
     MP4SampleId numSamples = GetNumberOfSamples();
     uint32_t maxBytesPerSec = 0;
@@ -858,7 +1031,80 @@ uint32_t MP4Track::GetMaxBitrate()
         }
     }
 
-    return maxBytesPerSec * 8;
+    m_tableMaxBitrate = maxBytesPerSec * 8;
+    m_tableMaxBitrateValid = true;
+    return m_tableMaxBitrate;
+}
+
+// Incremental form of the GetMaxBitrate() scan, fed one sample at a time.
+// m_writeSecWindow holds the samples from the start of the current window
+// up to the last one written, i.e. what the scan re-reads from the tables.
+void MP4Track::UpdateWriteStats(uint32_t numBytes, MP4Duration duration)
+{
+    if (!m_writeStatsValid) {
+        // appending to a track that already had samples, stsz has been
+        // updated so extend the table aggregates if they are still exact
+        m_tableMaxBitrateValid = false;
+        if (m_tableStatsValid) {
+            uint32_t fixedSampleSize = 0;
+            if (m_pStszFixedSampleSizeProperty != NULL) {
+                fixedSampleSize = m_pStszFixedSampleSizeProperty->GetValue();
+            }
+            if (fixedSampleSize == 0
+                    && m_pStszSampleSizeProperty->GetType() == Integer32Property) {
+                uint32_t sampleSize = numBytes / m_bytesPerSample;
+                m_tableTotalSizes += sampleSize;
+                if (sampleSize > m_tableMaxSize) {
+                    m_tableMaxSize = sampleSize;
+                }
+            } else {
+                m_tableStatsValid = false;
+            }
+        }
+        return;
+    }
+
+    // account for sizes as recorded in stsz
+    uint32_t sampleSize = numBytes;
+    if (m_bytesPerSample > 1) {
+        sampleSize -= numBytes % m_bytesPerSample;
+    }
+    MP4Timestamp sampleTime = m_writeElapsed;
+    m_writeElapsed += duration;
+
+    m_writeTotalBytes += sampleSize;
+    if (sampleSize > m_writeMaxSampleSize) {
+        m_writeMaxSampleSize = sampleSize;
+    }
+
+    m_writeSecWindow.push_back(make_pair(sampleTime, sampleSize));
+
+    if (sampleTime < m_writeThisSecStart + GetTimeScale()) {
+        m_writeBytesThisSec += sampleSize;
+        m_writeLastSampleSize = sampleSize;
+        m_writeLastSampleTime = sampleTime;
+        return;
+    }
+
+    MP4Duration overflow_dur =
+        (m_writeThisSecStart + GetTimeScale()) - m_writeLastSampleTime;
+    MP4Duration lastSampleDur = sampleTime - m_writeLastSampleTime;
+    uint32_t overflow_bytes = 0;
+    if (lastSampleDur != 0) {
+        overflow_bytes =
+            ((m_writeLastSampleSize * overflow_dur) + (lastSampleDur - 1)) / lastSampleDur;
+    }
+
+    if (m_writeBytesThisSec - overflow_bytes > m_writeMaxBytesPerSec) {
+        m_writeMaxBytesPerSec = m_writeBytesThisSec - overflow_bytes;
+    }
+
+    m_writeLastSampleTime = sampleTime;
+    m_writeLastSampleSize = sampleSize;
+    m_writeBytesThisSec += sampleSize;
+    m_writeBytesThisSec -= m_writeSecWindow.front().second;
+    m_writeSecWindow.pop_front();
+    m_writeThisSecStart = m_writeSecWindow.front().first;
 }
 
 uint32_t MP4Track::GetSampleStscIndex(MP4SampleId sampleId)
@@ -870,6 +1116,23 @@ uint32_t MP4Track::GetSampleStscIndex(MP4SampleId sampleId)
         throw new Exception("No data chunks exist", __FILE__, __LINE__, __FUNCTION__ );
     }
 
+    MP4PerfCounters* pPerf = m_File.GetPerfCounters();
+
+    // consecutive samples usually fall in the same stsc entry,
+    // checked against the table since it grows while writing
+    if (m_cachedStscIndex < numStscs
+            && sampleId >= m_pStscFirstSampleProperty->GetValue(m_cachedStscIndex)
+            && (m_cachedStscIndex + 1 == numStscs
+                || sampleId < m_pStscFirstSampleProperty->GetValue(m_cachedStscIndex + 1))) {
+        if (pPerf) {
+            pPerf->stscHits++;
+        }
+        return m_cachedStscIndex;
+    }
+    if (pPerf) {
+        pPerf->stscMisses++;
+    }
+
     for (stscIndex = 0; stscIndex < numStscs; stscIndex++) {
         if (sampleId < m_pStscFirstSampleProperty->GetValue(stscIndex)) {
             ASSERT(stscIndex != 0);
@@ -882,6 +1145,7 @@ uint32_t MP4Track::GetSampleStscIndex(MP4SampleId sampleId)
         stscIndex -= 1;
     }
 
+    m_cachedStscIndex = stscIndex;
     return stscIndex;
 }
 
@@ -929,8 +1193,8 @@ File* MP4Track::GetSampleFile( MP4SampleId sampleId )
 
         const char* url = pLocationProperty->GetValue();
 
-        log.verbose3f("\"%s\": dref url = %s", GetFile().GetFilename().c_str(), 
-                      url);
+        MP4V2_LOG_VERBOSE3( log, "\"%s\": dref url = %s", GetFile().GetFilename().c_str(), 
+                                 url);
 
         file = (File*)-1;
 
@@ -1064,13 +1328,21 @@ void MP4Track::GetSampleTimes(MP4SampleId sampleId,
     MP4Duration elapsed;
 
 
+    MP4PerfCounters* pPerf = m_File.GetPerfCounters();
+
     if (m_cachedSttsSid != MP4_INVALID_SAMPLE_ID && sampleId >= m_cachedSttsSid) {
         sid   = m_cachedSttsSid;
         elapsed   = m_cachedSttsElapsed;
+        if (pPerf) {
+            pPerf->sttsHits++;
+        }
     } else {
         m_cachedSttsIndex = 0;
         sid   = 1;
         elapsed   = 0;
+        if (pPerf) {
+            pPerf->sttsMisses++;
+        }
     }
 
     for (uint32_t sttsIndex = m_cachedSttsIndex; sttsIndex < numStts; sttsIndex++) {
@@ -1170,11 +1442,19 @@ uint32_t MP4Track::GetSampleCttsIndex(MP4SampleId sampleId,
     uint32_t numCtts = m_pCttsCountProperty->GetValue();
     MP4SampleId sid;
 
+    MP4PerfCounters* pPerf = m_File.GetPerfCounters();
+
     if (m_cachedCttsSid != MP4_INVALID_SAMPLE_ID && sampleId >= m_cachedCttsSid) {
         sid   = m_cachedCttsSid;
+        if (pPerf) {
+            pPerf->cttsHits++;
+        }
     } else {
         m_cachedCttsIndex = 0;
         sid = 1;
+        if (pPerf) {
+            pPerf->cttsMisses++;
+        }
     }
 
     for (uint32_t cttsIndex = m_cachedCttsIndex; cttsIndex < numCtts; cttsIndex++) {
@@ -1586,9 +1866,9 @@ void MP4Track::ReadChunk(MP4ChunkId chunkId,
     *pChunkSize = GetChunkSize(chunkId);
     *ppChunk = (uint8_t*)MP4Malloc(*pChunkSize);
 
-    log.verbose3f("\"%s\": ReadChunk: track %u id %u offset 0x%" PRIx64 " size %u (0x%x)",
-                  GetFile().GetFilename().c_str(),
-                  m_trackId, chunkId, chunkOffset, *pChunkSize, *pChunkSize);
+    MP4V2_LOG_VERBOSE3( log, "\"%s\": ReadChunk: track %u id %u offset 0x%" PRIx64 " size %u (0x%x)",
+                             GetFile().GetFilename().c_str(),
+                             m_trackId, chunkId, chunkOffset, *pChunkSize, *pChunkSize);
 
     uint64_t oldPos = m_File.GetPosition(); // only used in mode == 'w'
     try {
@@ -1609,18 +1889,437 @@ void MP4Track::ReadChunk(MP4ChunkId chunkId,
         m_File.SetPosition( oldPos );
 }
 
-void MP4Track::RewriteChunk(MP4ChunkId chunkId,
-                            uint8_t* pChunk, uint32_t chunkSize)
+void MP4Track::MoveChunk(MP4ChunkId chunkId,
+                         uint64_t chunkOffset, uint32_t chunkSize)
 {
-    uint64_t chunkOffset = m_File.GetPosition();
+    m_pChunkOffsetProperty->SetValue(chunkOffset, chunkId - 1);
 
-    m_File.WriteBytes(pChunk, chunkSize);
+    MP4V2_LOG_VERBOSE3( log, "\"%s\": MoveChunk: track %u id %u offset 0x%" PRIx64 " size %u (0x%x)",
+                             GetFile().GetFilename().c_str(),
+                             m_trackId, chunkId, chunkOffset, chunkSize, chunkSize);
+}
 
-    m_pChunkOffsetProperty->SetValue(chunkOffset, chunkId - 1);
+// Read the whole chunk holding sampleId with a single seek+read.
+// Returns false if the sample lives in an external (dref) file, in
+// which case the caller must fall back to ReadSample().
+bool MP4Track::ReadSampleChunk(MP4SampleId sampleId,
+                               uint8_t** ppChunk, uint32_t* pChunkSize,
+                               MP4SampleId* pFirstSampleId, uint32_t* pNumSamples)
+{
+    ASSERT(ppChunk);
+    ASSERT(pChunkSize);
+    ASSERT(pFirstSampleId);
+    ASSERT(pNumSamples);
+
+    if (sampleId == MP4_INVALID_SAMPLE_ID) {
+        throw new Exception("sample id can't be zero",
+                            __FILE__, __LINE__, __FUNCTION__ );
+    }
 
-    log.verbose3f("\"%s\": RewriteChunk: track %u id %u offset 0x%" PRIx64 " size %u (0x%x)",
-                  GetFile().GetFilename().c_str(),
-                  m_trackId, chunkId, chunkOffset, chunkSize, chunkSize);
+    // handle unusual case of wanting to read a sample
+    // that is still sitting in the write chunk buffer
+    if (m_pChunkBuffer && sampleId >= m_writeSampleId - m_chunkSamples) {
+        WriteChunkBuffer();
+    }
+
+    if (GetSampleFile(sampleId) != NULL) {
+        return false;
+    }
+
+    uint32_t stscIndex = GetSampleStscIndex(sampleId);
+
+    uint32_t firstChunk =
+        m_pStscFirstChunkProperty->GetValue(stscIndex);
+    MP4SampleId firstSample =
+        m_pStscFirstSampleProperty->GetValue(stscIndex);
+    uint32_t samplesPerChunk =
+        m_pStscSamplesPerChunkProperty->GetValue(stscIndex);
+
+    MP4ChunkId chunkId = firstChunk +
+                         ((sampleId - firstSample) / samplesPerChunk);
+
+    *pFirstSampleId = sampleId - ((sampleId - firstSample) % samplesPerChunk);
+    *pNumSamples = samplesPerChunk;
+
+    ReadChunk(chunkId, ppChunk, pChunkSize);
+    return true;
+}
+
+// Only the stsc entries and chunks that hold the samples are visited, and
+// sample sizes are summed in order rather than looked up per sample.
+void MP4Track::GetSampleExtents(
+    MP4SampleId          firstSampleId,
+    MP4SampleId          lastSampleId,
+    vector<ChunkExtent>& extents)
+{
+    if (firstSampleId == MP4_INVALID_SAMPLE_ID
+            || firstSampleId > lastSampleId
+            || lastSampleId > GetNumberOfSamples()) {
+        throw new Exception("invalid sample id range",
+                            __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    uint32_t numChunks = GetNumberOfChunks();
+    uint32_t numStsc = m_pStscCountProperty->GetValue();
+    uint32_t stscIndex = GetSampleStscIndex(firstSampleId);
+    MP4SampleId sampleId = m_pStscFirstSampleProperty->GetValue(stscIndex);
+
+    for (; stscIndex < numStsc && sampleId <= lastSampleId; stscIndex++) {
+        MP4ChunkId chunkId = m_pStscFirstChunkProperty->GetValue(stscIndex);
+        uint32_t lastChunk = stscIndex + 1 < numStsc
+                             ? m_pStscFirstChunkProperty->GetValue(stscIndex + 1) - 1
+                             : numChunks;
+        uint32_t samplesPerChunk = m_pStscSamplesPerChunkProperty->GetValue(stscIndex);
+        if (samplesPerChunk == 0) {
+            continue;
+        }
+
+        // whole chunks ahead of the first sample
+        if (sampleId < firstSampleId) {
+            uint32_t skip = (firstSampleId - sampleId) / samplesPerChunk;
+            chunkId += skip;
+            sampleId += skip * samplesPerChunk;
+        }
+
+        for (; chunkId <= lastChunk && sampleId <= lastSampleId; chunkId++) {
+            if (GetSampleFile(sampleId) != NULL) {
+                throw new Exception("sample is not located in this file",
+                                    __FILE__, __LINE__, __FUNCTION__);
+            }
+
+            MP4SampleId chunkEnd = sampleId + samplesPerChunk;
+            ChunkExtent extent;
+            extent.offset = m_pChunkOffsetProperty->GetValue(chunkId - 1);
+            for (; sampleId < firstSampleId; sampleId++) {
+                extent.offset += GetSampleSize(sampleId);
+            }
+            extent.size = 0;
+            extent.firstSampleId = sampleId;
+            extent.numSamples = 0;
+            for (; sampleId < chunkEnd && sampleId <= lastSampleId; sampleId++) {
+                extent.size += GetSampleSize(sampleId);
+                extent.numSamples++;
+            }
+            extents.push_back(extent);
+            sampleId = chunkEnd;
+        }
+    }
+}
+
+void MP4Track::GetSampleByteRange(
+    MP4SampleId firstSampleId,
+    MP4SampleId lastSampleId,
+    uint64_t&   offset,
+    uint64_t&   size)
+{
+    vector<ChunkExtent> extents;
+    GetSampleExtents(firstSampleId, lastSampleId, extents);
+    if (extents.empty()) {
+        throw new Exception("samples are not in any chunk",
+                            __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    uint64_t begin = ~uint64_t(0);
+    uint64_t end = 0;
+    for (uint32_t i = 0; i < extents.size(); i++) {
+        begin = min(begin, extents[i].offset);
+        end = max(end, extents[i].offset + extents[i].size);
+    }
+
+    offset = begin;
+    size = end - begin;
+}
+
+void MP4Track::GetChunkExtents(vector<ChunkExtent>& extents)
+{
+    uint32_t numChunks = GetNumberOfChunks();
+    uint32_t numSamples = GetNumberOfSamples();
+    uint32_t numStsc = m_pStscCountProperty->GetValue();
+    MP4SampleId sampleId = 1;
+
+    extents.clear();
+    extents.reserve(numChunks);
+    for (uint32_t stscIndex = 0; stscIndex < numStsc; stscIndex++) {
+        uint32_t firstChunk = m_pStscFirstChunkProperty->GetValue(stscIndex);
+        uint32_t lastChunk = stscIndex + 1 < numStsc
+                             ? m_pStscFirstChunkProperty->GetValue(stscIndex + 1) - 1
+                             : numChunks;
+        uint32_t samplesPerChunk = m_pStscSamplesPerChunkProperty->GetValue(stscIndex);
+
+        for (MP4ChunkId chunkId = firstChunk; chunkId <= lastChunk; chunkId++) {
+            ChunkExtent extent;
+            extent.offset = m_pChunkOffsetProperty->GetValue(chunkId - 1);
+            extent.firstSampleId = sampleId;
+            extent.numSamples = min(samplesPerChunk, numSamples + 1 - sampleId);
+            extent.size = 0;
+            for (uint32_t i = 0; i < extent.numSamples; i++) {
+                extent.size += GetSampleSize(sampleId + i);
+            }
+            extents.push_back(extent);
+            sampleId += extent.numSamples;
+        }
+    }
+}
+
+// Chunks are read whole, and runs of chunks that follow each other in the
+// file are read together up to MaxReadSize, so checksumming a track costs
+// few large reads rather than one per sample.
+void MP4Track::GetChecksums(bool perChunk, vector<uint32_t>& checksums,
+                            vector<MP4SampleId>* pChunkSamples)
+{
+    static const uint32_t MaxReadSize = 4 * 1024 * 1024;
+
+    checksums.clear();
+
+    if (m_pChunkBuffer) {
+        WriteChunkBuffer();
+    }
+
+    vector<ChunkExtent> chunks;
+    GetChunkExtents(chunks);
+
+    checksums.reserve(perChunk ? chunks.size() : GetNumberOfSamples());
+    if (perChunk && pChunkSamples) {
+        pChunkSamples->clear();
+        for (uint32_t i = 0; i < chunks.size(); i++) {
+            pChunkSamples->push_back(chunks[i].firstSampleId);
+        }
+    }
+
+    vector<uint8_t> buffer;
+    uint64_t oldPos = m_File.GetPosition(); // only used in mode == 'w'
+    try {
+        for (uint32_t i = 0; i < chunks.size(); ) {
+            File* fin = GetSampleFile(chunks[i].firstSampleId);
+            if (fin == (File*)-1) {
+                throw new Exception("sample is located in an inaccessible file",
+                                    __FILE__, __LINE__, __FUNCTION__);
+            }
+
+            // extend the read over the chunks directly behind this one
+            uint64_t start = chunks[i].offset;
+            uint64_t end = start + chunks[i].size;
+            uint32_t last = i;
+            while (last + 1 < chunks.size() &&
+                    chunks[last + 1].offset == end &&
+                    end - start + chunks[last + 1].size <= MaxReadSize &&
+                    GetSampleFile(chunks[last + 1].firstSampleId) == fin) {
+                last++;
+                end += chunks[last].size;
+            }
+
+            buffer.resize((size_t)(end - start) + 1);
+            m_File.SetPosition(start, fin);
+            m_File.ReadBytes(&buffer[0], (uint32_t)(end - start), fin);
+
+            const uint8_t* p = &buffer[0];
+            for (; i <= last; i++) {
+                if (perChunk) {
+                    checksums.push_back(MP4Crc32c(p, chunks[i].size));
+                    p += chunks[i].size;
+                    continue;
+                }
+                for (uint32_t s = 0; s < chunks[i].numSamples; s++) {
+                    uint32_t sampleSize = GetSampleSize(chunks[i].firstSampleId + s);
+                    checksums.push_back(MP4Crc32c(p, sampleSize));
+                    p += sampleSize;
+                }
+            }
+        }
+    }
+    catch (...) {
+        if (m_File.IsWriteMode())
+            m_File.SetPosition(oldPos);
+        throw;
+    }
+
+    if (m_File.IsWriteMode())
+        m_File.SetPosition(oldPos);
+}
+
+bool MP4Track::GetSampleDependencyFlags(MP4SampleId sampleId,
+                                        uint32_t* pDependencyFlags)
+{
+    if (m_sdtpLog.empty()) {
+        *pDependencyFlags = 0;
+        return false;
+    }
+
+    AnalyzeSampleDependencies(sampleId);
+    if (sampleId > m_sdtpLog.size()) {
+        throw new Exception("sample id > sdtp logsize",
+                            __FILE__, __LINE__, __FUNCTION__ );
+    }
+
+    *pDependencyFlags = (uint8_t)m_sdtpLog[sampleId-1]; // sampleId is 1-based
+    return true;
+}
+
+uint8_t MP4Track::GetH264LengthSize()
+{
+    if (m_h264LengthSize < 0) {
+        MP4IntegerProperty* pLengthSizeMinusOne;
+        if (m_trakAtom.FindProperty("trak.mdia.minf.stbl.stsd.avc1.avcC.lengthSizeMinusOne",
+                                    (MP4Property**)&pLengthSizeMinusOne)) {
+            m_h264LengthSize = (int)pLengthSizeMinusOne->GetValue() + 1;
+        } else {
+            m_h264LengthSize = 0;
+        }
+    }
+    return (uint8_t)m_h264LengthSize;
+}
+
+// Extend m_sdtpLog up to lastSampleId from the slice headers in the file.
+// Only the first bytes of every NAL unit are read, not whole samples.
+void MP4Track::AnalyzeSampleDependencies(MP4SampleId lastSampleId)
+{
+    if (m_sdtpExplicit || m_sdtpLog.size() >= lastSampleId) {
+        return;
+    }
+
+    uint8_t lengthSize = GetH264LengthSize();
+    if (lengthSize == 0) {
+        return;
+    }
+
+    if (m_pChunkBuffer && lastSampleId >= m_writeSampleId - m_chunkSamples) {
+        WriteChunkBuffer();
+    }
+
+    uint8_t header[4 + H264_DEPENDENCY_HEADER_SIZE];
+
+    for (MP4SampleId sampleId = (MP4SampleId)m_sdtpLog.size() + 1;
+            sampleId <= lastSampleId; sampleId++) {
+        File* fin = GetSampleFile(sampleId);
+        if (fin == (File*)-1) {
+            m_sdtpLog.push_back((char)MP4_SDT_UNKNOWN);
+            continue;
+        }
+
+        uint64_t fileOffset = GetSampleFileOffset(sampleId);
+        uint32_t sampleSize = GetSampleSize(sampleId);
+        MP4H264Dependency dependency;
+
+        uint64_t oldPos = m_File.GetPosition(fin); // only used in mode == 'w'
+        try {
+            uint32_t pos = 0;
+            while (sampleSize - pos > lengthSize) {
+                uint32_t numBytes = min(sampleSize - pos, (uint32_t)sizeof(header));
+                if (numBytes > lengthSize + H264_DEPENDENCY_HEADER_SIZE) {
+                    numBytes = lengthSize + H264_DEPENDENCY_HEADER_SIZE;
+                }
+                m_File.SetPosition(fileOffset + pos, fin);
+                m_File.ReadBytes(header, numBytes, fin);
+
+                uint32_t length = 0;
+                for (uint8_t i = 0; i < lengthSize; i++) {
+                    length = (length << 8) | header[i];
+                }
+                pos += lengthSize;
+                if (length > sampleSize - pos) {
+                    break;
+                }
+                dependency.AddNalUnit(header + lengthSize, min(length, numBytes - lengthSize));
+                pos += length;
+            }
+        }
+        catch (...) {
+            if (m_File.IsWriteMode())
+                m_File.SetPosition(oldPos, fin);
+            throw;
+        }
+
+        if (m_File.IsWriteMode())
+            m_File.SetPosition(oldPos, fin);
+
+        m_sdtpLog.push_back((char)dependency.GetFlags());
+    }
+}
+
+uint8_t MP4Track::GetSampleDependency(MP4SampleId sampleId)
+{
+    if (sampleId == MP4_INVALID_SAMPLE_ID || sampleId > GetNumberOfSamples()) {
+        throw new Exception("invalid sample id", __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    AnalyzeSampleDependencies(sampleId);
+    if (sampleId > m_sdtpLog.size()) {
+        return MP4_SDT_UNKNOWN;
+    }
+    return (uint8_t)m_sdtpLog[sampleId-1]; // sampleId is 1-based
+}
+
+// N.B. "next" is inclusive of this sample id
+MP4SampleId MP4Track::GetNextIndependentSample(MP4SampleId sampleId)
+{
+    uint32_t numSamples = GetNumberOfSamples();
+    if (sampleId == MP4_INVALID_SAMPLE_ID) {
+        sampleId = 1;
+    }
+
+    for (; sampleId <= numSamples; sampleId++) {
+        if (IsSyncSample(sampleId) ||
+                (GetSampleDependency(sampleId) & MP4_SDT_IS_INDEPENDENT)) {
+            return sampleId;
+        }
+    }
+    return MP4_INVALID_SAMPLE_ID;
+}
+
+// Pick the samples to decode for playback at speed times normal rate from
+// the decodable subsets, finest first: all samples, samples that others
+// depend on, independent samples only, and an even selection of those.
+// The first subset that fits 1/speed of the range wins.
+void MP4Track::GetTrickPlaySamples(
+    MP4SampleId firstSampleId,
+    MP4SampleId lastSampleId,
+    uint32_t speed,
+    vector<MP4SampleId>& samples)
+{
+    samples.clear();
+
+    if (firstSampleId == MP4_INVALID_SAMPLE_ID || firstSampleId > lastSampleId ||
+            lastSampleId > GetNumberOfSamples() || speed == 0) {
+        throw new Exception("invalid sample range or speed", __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    // samples before the first independent one can't be decoded on their own
+    MP4SampleId start = GetNextIndependentSample(firstSampleId);
+    if (start == MP4_INVALID_SAMPLE_ID || start > lastSampleId) {
+        return;
+    }
+
+    uint32_t budget = (lastSampleId - firstSampleId + speed) / speed;
+
+    for (uint32_t level = 0; level < 3; level++) {
+        samples.clear();
+        for (MP4SampleId sampleId = start; sampleId <= lastSampleId; sampleId++) {
+            uint8_t flags = GetSampleDependency(sampleId);
+            if (level >= 1 && (flags & MP4_SDT_HAS_NO_DEPENDENTS)) {
+                continue;
+            }
+            if (level >= 2 && !IsSyncSample(sampleId) && !(flags & MP4_SDT_IS_INDEPENDENT)) {
+                continue;
+            }
+            samples.push_back(sampleId);
+        }
+        if (samples.size() <= budget) {
+            return;
+        }
+    }
+
+    vector<MP4SampleId> independent;
+    independent.swap(samples);
+    for (uint32_t i = 0; i < budget; i++) {
+        samples.push_back(independent[(uint64_t)i * independent.size() / budget]);
+    }
+}
+
+// For MP4Optimize(), which writes moov before the media data.
+void MP4Track::UpdateSampleDependencies()
+{
+    AnalyzeSampleDependencies(GetNumberOfSamples());
+    FinishSdtp();
 }
 
 // map track type name aliases to official names
@@ -1855,11 +2554,11 @@ MP4SampleId MP4Track::GetSampleIdFromEditTime(
                 *pDuration = editSampleDuration;
             }
 
-            log.verbose2f("\"%s\": GetSampleIdFromEditTime: when %" PRIu64 " "
-                          "sampleId %u start %" PRIu64 " duration %" PRId64,
-                          GetFile().GetFilename().c_str(),
-                          editWhen, sampleId,
-                          editSampleStartTime, editSampleDuration);
+            MP4V2_LOG_VERBOSE2( log, "\"%s\": GetSampleIdFromEditTime: when %" PRIu64 " "
+                                     "sampleId %u start %" PRIu64 " duration %" PRId64,
+                                     GetFile().GetFilename().c_str(),
+                                     editWhen, sampleId,
+                                     editSampleStartTime, editSampleDuration);
 
             return sampleId;
         }
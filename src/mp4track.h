@@ -82,6 +82,14 @@ public:
         bool*         hasDependencyFlags = NULL,
         uint32_t*     dependencyFlags = NULL );
 
+    // consecutive samples back to back into pBytes, read in one batch
+    void ReadSamples(
+        MP4SampleId firstSampleId,
+        uint32_t    numSamples,
+        uint8_t*    pBytes,
+        uint32_t    numBytes,
+        uint32_t*   pSampleSizes );
+
     void WriteSample(
         const uint8_t* pBytes,
         uint32_t numBytes,
@@ -148,6 +156,19 @@ public:
         uint16_t sampleLength,
         uint8_t* pDest);
 
+    MP4SampleCache& GetSampleCache() {
+        return m_sampleCache;
+    }
+
+    // resolve a property path within this track's trak atom
+    MP4ResolvedProperty& ResolveProperty(const char* name) {
+        return m_propertyCache.Resolve(m_trakAtom, name);
+    }
+    // as above, but kept until the track is deleted
+    MP4ResolvedProperty& ResolvePropertyHandle(const char* name) {
+        return m_propertyHandles.Resolve(m_trakAtom, name);
+    }
+
     // special operations for use during optimization
 
     uint32_t GetNumberOfChunks();
@@ -157,8 +178,51 @@ public:
     void ReadChunk(MP4ChunkId chunkId,
                    uint8_t** ppChunk, uint32_t* pChunkSize);
 
-    void RewriteChunk(MP4ChunkId chunkId,
-                      uint8_t* pChunk, uint32_t chunkSize);
+    // records the offset a chunk was copied to
+    void MoveChunk(MP4ChunkId chunkId,
+                   uint64_t chunkOffset, uint32_t chunkSize);
+
+    // special operations for use during multi-track copy
+
+    bool ReadSampleChunk(MP4SampleId sampleId,
+                         uint8_t** ppChunk, uint32_t* pChunkSize,
+                         MP4SampleId* pFirstSampleId, uint32_t* pNumSamples);
+
+    struct ChunkExtent {
+        uint64_t    offset;
+        uint32_t    size;
+        MP4SampleId firstSampleId;
+        uint32_t    numSamples;
+    };
+
+    // file extent and samples of every chunk, in chunk order
+    void GetChunkExtents(vector<ChunkExtent>& extents);
+
+    // appends the part of every chunk holding some of the samples
+    // firstSampleId..lastSampleId, in chunk order, throws if one of them
+    // is stored in another file
+    void GetSampleExtents(MP4SampleId firstSampleId, MP4SampleId lastSampleId,
+                          vector<ChunkExtent>& extents);
+
+    // smallest file extent holding the samples firstSampleId..lastSampleId
+    void GetSampleByteRange(MP4SampleId firstSampleId, MP4SampleId lastSampleId,
+                            uint64_t& offset, uint64_t& size);
+
+    // CRC-32C of every sample, or of every chunk if perChunk, in which case
+    // pChunkSamples receives the first sample id of every chunk
+    void GetChecksums(bool perChunk, vector<uint32_t>& checksums,
+                      vector<MP4SampleId>* pChunkSamples = NULL);
+
+    bool GetSampleDependencyFlags(MP4SampleId sampleId,
+                                  uint32_t* pDependencyFlags);
+
+    // sdtp flags, derived from the slice headers for avc1 tracks that
+    // were written without MP4WriteSampleDependency()
+    uint8_t     GetSampleDependency(MP4SampleId sampleId);
+    MP4SampleId GetNextIndependentSample(MP4SampleId sampleId);
+    void        GetTrickPlaySamples(MP4SampleId firstSampleId, MP4SampleId lastSampleId,
+                                    uint32_t speed, vector<MP4SampleId>& samples);
+    void        UpdateSampleDependencies();
 
     MP4Duration GetDurationPerChunk();
     void        SetDurationPerChunk( MP4Duration );
@@ -198,8 +262,14 @@ protected:
 
     void CalculateBytesPerSample();
 
+    void UpdateWriteStats(uint32_t numBytes, MP4Duration duration);
+    void CalculateTableStats();
+
     void FinishSdtp();
 
+    uint8_t GetH264LengthSize();
+    void    AnalyzeSampleDependencies(MP4SampleId lastSampleId);
+
 protected:
     MP4File&    m_File;
     MP4Atom&    m_trakAtom;         // moov.trak[]
@@ -210,9 +280,10 @@ protected:
     File*    m_lastSampleFile;
 
     // for efficient construction of hint track packets
-    MP4SampleId m_cachedReadSampleId;
-    uint8_t*    m_pCachedReadSample;
-    uint32_t    m_cachedReadSampleSize;
+    MP4SampleCache m_sampleCache;
+
+    MP4ResolvedPropertyCache m_propertyCache;
+    MP4ResolvedPropertyCache m_propertyHandles;
 
     // for writing
     MP4SampleId m_writeSampleId;
@@ -229,6 +300,31 @@ protected:
 
     uint32_t       m_bytesPerSample;
 
+    // running sample statistics kept by WriteSample() so that FinishWrite()
+    // and MP4GetTrackStats() need not rescan the sample tables. Only valid
+    // when every sample of the track was written through this object.
+    bool         m_writeStatsValid;
+    uint64_t     m_writeTotalBytes;
+    uint32_t     m_writeMaxSampleSize;
+    MP4Timestamp m_writeElapsed;
+
+    // sliding window used for max bitrate, see GetMaxBitrate()
+    uint32_t     m_writeMaxBytesPerSec;
+    uint32_t     m_writeBytesThisSec;
+    MP4Timestamp m_writeThisSecStart;
+    MP4Timestamp m_writeLastSampleTime;
+    uint32_t     m_writeLastSampleSize;
+    deque< pair<MP4Timestamp, uint32_t> > m_writeSecWindow;
+
+    // aggregates of a variable size stsz table for tracks that were not
+    // written from empty, computed on first use and kept current by
+    // WriteSample(). Sizes are in stsz units, before m_bytesPerSample.
+    bool         m_tableStatsValid;
+    uint64_t     m_tableTotalSizes;
+    uint32_t     m_tableMaxSize;
+    bool         m_tableMaxBitrateValid;
+    uint32_t     m_tableMaxBitrate;
+
     // controls for AMR chunking
     int     m_isAmr;
     uint8_t m_curMode;
@@ -269,6 +365,8 @@ protected:
     uint32_t    m_cachedCttsIndex;
     MP4SampleId m_cachedCttsSid;
 
+    uint32_t    m_cachedStscIndex;
+
     MP4Integer32Property* m_pCttsCountProperty;
     MP4Integer32Property* m_pCttsSampleCountProperty;
     MP4Integer32Property* m_pCttsSampleOffsetProperty;
@@ -282,7 +380,9 @@ protected:
     MP4Integer16Property* m_pElstRateProperty;
     MP4Integer16Property* m_pElstReservedProperty;
 
-    string m_sdtpLog; // records frame types for H264 samples
+    string m_sdtpLog;       // records frame types for H264 samples
+    bool   m_sdtpExplicit;  // m_sdtpLog comes from WriteSampleDependency()
+    int    m_h264LengthSize; // avcC NAL length size, 0 if not avc1, -1 until known
 };
 
 MP4ARRAY_DECL(MP4Track, MP4Track*);
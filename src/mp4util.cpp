@@ -306,7 +306,7 @@ const char* MP4NormalizeTrackType (const char* type)
         return MP4_CNTL_TRACK_TYPE;
     }
 
-    log.verbose1f("Attempt to normalize %s did not match",type);
+    MP4V2_LOG_VERBOSE1( log, "Attempt to normalize %s did not match",type);
 
     return type;
 }
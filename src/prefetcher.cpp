@@ -0,0 +1,301 @@
+#include "src/impl.h"
+#include <algorithm>
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+
+const uint32_t MP4Prefetcher::DefaultNumBlocks;
+const uint32_t MP4Prefetcher::DefaultBlockSize;
+
+namespace {
+    bool
+    chunkStartsAfter( MP4SampleId sampleId, const MP4Track::ChunkExtent& chunk )
+    {
+        return sampleId < chunk.firstSampleId;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4Prefetcher::MP4Prefetcher( File* pFile, uint32_t numBlocks, uint32_t blockSize )
+    : m_pFile     ( pFile )
+    , m_blockSize ( blockSize )
+    , m_blocks    ( numBlocks )
+    , m_stop      ( false )
+    , m_queued    ( m_mutex )
+    , m_loaded    ( m_mutex )
+{
+    ASSERT( numBlocks > 0 && blockSize > 0 );
+
+    for( uint32_t i = 0; i < m_blocks.size(); i++ ) {
+        m_blocks[i].index = 0;
+        m_blocks[i].state = BLOCK_EMPTY;
+        m_blocks[i].sequence = 0;
+        m_blocks[i].length = 0;
+        m_blocks[i].pData = NULL;
+    }
+
+    try {
+        for( uint32_t i = 0; i < m_blocks.size(); i++ )
+            m_blocks[i].pData = (uint8_t*)MP4Malloc( m_blockSize );
+        if( m_thread.start( Run, this ))
+            throw new Exception( "unable to start prefetch thread", __FILE__, __LINE__, __FUNCTION__ );
+    }
+    catch( ... ) {
+        for( uint32_t i = 0; i < m_blocks.size(); i++ )
+            MP4Free( m_blocks[i].pData );
+        delete m_pFile;
+        throw;
+    }
+}
+
+MP4Prefetcher::~MP4Prefetcher()
+{
+    m_mutex.lock();
+    m_stop = true;
+    m_queued.broadcast();
+    m_mutex.unlock();
+    m_thread.join();
+
+    for( uint32_t i = 0; i < m_blocks.size(); i++ )
+        MP4Free( m_blocks[i].pData );
+    delete m_pFile;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool
+MP4Prefetcher::Read( MP4Track& track, MP4SampleId sampleId,
+                     uint64_t offset, uint8_t* pBytes, uint32_t numBytes )
+{
+    if( numBytes == 0 )
+        return false;
+
+    TrackState& state = GetTrackState( track );
+    if( state.chunks.empty() )
+        return false;
+
+    // samples are mostly read in order, so try the last chunk and the next
+    uint32_t i = state.chunkIndex;
+    if( sampleId < state.chunks[i].firstSampleId ||
+        sampleId >= state.chunks[i].firstSampleId + state.chunks[i].numSamples )
+    {
+        if( i + 1 < state.chunks.size() && sampleId >= state.chunks[i + 1].firstSampleId &&
+            sampleId < state.chunks[i + 1].firstSampleId + state.chunks[i + 1].numSamples )
+        {
+            i++;
+        }
+        else {
+            vector<MP4Track::ChunkExtent>::const_iterator it =
+                upper_bound( state.chunks.begin(), state.chunks.end(), sampleId, chunkStartsAfter );
+            if( it == state.chunks.begin() )
+                return false;
+            i = uint32_t( it - state.chunks.begin() ) - 1;
+        }
+    }
+
+    thread::MutexLock lock( m_mutex );
+
+    // a new block is reached, move the read-ahead window along
+    const uint64_t blockIndex = state.chunks[i].offset / m_blockSize;
+    state.chunkIndex = i;
+    if( blockIndex != state.blockIndex ) {
+        state.blockIndex = blockIndex;
+        Plan();
+    }
+
+    const uint64_t end = offset + numBytes;
+    for( uint64_t index = offset / m_blockSize; index <= (end - 1) / m_blockSize; index++ ) {
+        Block* pBlock = FindBlock( index );
+        if( !pBlock )
+            return false;
+
+        if( pBlock->state == BLOCK_QUEUED ) {
+            pBlock->sequence = 0;
+            m_queued.signal();
+        }
+        while( pBlock->state == BLOCK_QUEUED || pBlock->state == BLOCK_LOADING )
+            m_loaded.wait();
+        if( pBlock->state != BLOCK_READY )
+            return false;
+
+        const uint64_t blockStart = index * m_blockSize;
+        const uint64_t from = max( offset, blockStart );
+        const uint64_t to = min( end, blockStart + m_blockSize );
+        if( to > blockStart + pBlock->length )
+            return false;
+        memcpy( pBytes + (from - offset), pBlock->pData + (from - blockStart), size_t( to - from ));
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void
+MP4Prefetcher::Run( void* arg )
+{
+    static_cast<MP4Prefetcher*>( arg )->Load();
+}
+
+void
+MP4Prefetcher::Load()
+{
+    vector<Block*> batch;
+    vector<File::Transfer> transfers;
+
+    m_mutex.lock();
+    for( ;; ) {
+        batch.clear();
+        for( uint32_t i = 0; i < m_blocks.size(); i++ ) {
+            if( m_blocks[i].state == BLOCK_QUEUED )
+                batch.push_back( &m_blocks[i] );
+        }
+        if( m_stop )
+            break;
+        if( batch.empty() ) {
+            m_queued.wait();
+            continue;
+        }
+
+        // every queued block in one batch, only this thread touches them
+        // while they are loading
+        sort( batch.begin(), batch.end(), LoadsBefore );
+        transfers.resize( batch.size() );
+        for( uint32_t i = 0; i < batch.size(); i++ ) {
+            Block& block = *batch[i];
+            block.state = BLOCK_LOADING;
+
+            // never read past the end, a short read counts as a failure
+            File::Transfer& t = transfers[i];
+            t.pos = File::Size( block.index * m_blockSize );
+            t.buffer = block.pData;
+            t.size = t.pos < m_pFile->size ? min( File::Size( m_blockSize ), File::Size( m_pFile->size - t.pos )) : 0;
+            t.count = 0;
+        }
+        m_mutex.unlock();
+
+        const bool failed = m_pFile->readBatch( &transfers[0], uint32_t( transfers.size() ));
+
+        m_mutex.lock();
+        for( uint32_t i = 0; i < batch.size(); i++ ) {
+            const File::Transfer& t = transfers[i];
+            const bool loaded = !failed && t.size > 0 && t.count == t.size;
+            batch[i]->length = loaded ? uint32_t( t.count ) : 0;
+            batch[i]->state = loaded ? BLOCK_READY : BLOCK_FAILED;
+        }
+        m_loaded.broadcast();
+    }
+    m_mutex.unlock();
+}
+
+bool
+MP4Prefetcher::LoadsBefore( const Block* a, const Block* b )
+{
+    return a->sequence < b->sequence;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4Prefetcher::TrackState&
+MP4Prefetcher::GetTrackState( MP4Track& track )
+{
+    for( uint32_t i = 0; i < m_tracks.size(); i++ ) {
+        if( m_tracks[i].pTrack == &track )
+            return m_tracks[i];
+    }
+
+    m_tracks.push_back( TrackState() );
+    TrackState& state = m_tracks.back();
+    state.pTrack = &track;
+    track.GetChunkExtents( state.chunks );
+    state.chunkIndex = 0;
+    state.blockIndex = ~uint64_t( 0 );
+    return state;
+}
+
+MP4Prefetcher::Block*
+MP4Prefetcher::FindBlock( uint64_t index )
+{
+    for( uint32_t i = 0; i < m_blocks.size(); i++ ) {
+        if( m_blocks[i].state != BLOCK_EMPTY && m_blocks[i].index == index )
+            return &m_blocks[i];
+    }
+    return NULL;
+}
+
+// Called with m_mutex held. Each track lists the blocks of its chunks from
+// the current one on, the lists are merged taking turns up to the size of
+// the pool, and the pool is made to hold exactly those blocks as far as
+// blocks still loading allow.
+void
+MP4Prefetcher::Plan()
+{
+    const uint32_t numBlocks = uint32_t( m_blocks.size() );
+
+    vector< vector<uint64_t> > upcoming( m_tracks.size() );
+    for( uint32_t t = 0; t < m_tracks.size(); t++ ) {
+        const TrackState& state = m_tracks[t];
+        if( state.blockIndex == ~uint64_t( 0 ))
+            continue;
+        vector<uint64_t>& list = upcoming[t];
+        for( uint32_t c = state.chunkIndex; c < state.chunks.size() && list.size() < numBlocks; c++ ) {
+            const MP4Track::ChunkExtent& chunk = state.chunks[c];
+            if( chunk.size == 0 )
+                continue;
+            const uint64_t last = (chunk.offset + chunk.size - 1) / m_blockSize;
+            for( uint64_t index = chunk.offset / m_blockSize; index <= last && list.size() < numBlocks; index++ ) {
+                if( list.empty() || list.back() != index )
+                    list.push_back( index );
+            }
+        }
+    }
+
+    vector<uint64_t> wanted;
+    for( uint32_t j = 0; wanted.size() < numBlocks; j++ ) {
+        bool more = false;
+        for( uint32_t t = 0; t < upcoming.size() && wanted.size() < numBlocks; t++ ) {
+            if( j >= upcoming[t].size() )
+                continue;
+            more = true;
+            if( find( wanted.begin(), wanted.end(), upcoming[t][j] ) == wanted.end() )
+                wanted.push_back( upcoming[t][j] );
+        }
+        if( !more )
+            break;
+    }
+
+    for( uint32_t i = 0; i < numBlocks; i++ ) {
+        Block& block = m_blocks[i];
+        if( block.state == BLOCK_EMPTY || block.state == BLOCK_LOADING )
+            continue;
+        if( find( wanted.begin(), wanted.end(), block.index ) == wanted.end() )
+            block.state = BLOCK_EMPTY;
+    }
+
+    uint32_t next = 0;
+    for( uint32_t w = 0; w < wanted.size(); w++ ) {
+        Block* pBlock = FindBlock( wanted[w] );
+        if( pBlock ) {
+            if( pBlock->state == BLOCK_QUEUED )
+                pBlock->sequence = w + 1;
+            continue;
+        }
+        while( next < numBlocks && m_blocks[next].state != BLOCK_EMPTY )
+            next++;
+        if( next == numBlocks )
+            break;
+        pBlock = &m_blocks[next];
+        pBlock->index = wanted[w];
+        pBlock->state = BLOCK_QUEUED;
+        pBlock->sequence = w + 1;
+        pBlock->length = 0;
+    }
+
+    m_queued.signal();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
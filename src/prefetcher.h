@@ -0,0 +1,85 @@
+#ifndef MP4V2_IMPL_PREFETCHER_H
+#define MP4V2_IMPL_PREFETCHER_H
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Read-ahead of sample data for sequential demux.
+///
+/// The file is divided in blocks of a fixed size. The upcoming chunks of
+/// each track being read are taken from its sample tables and mapped to
+/// the blocks holding them, and a background thread loads those blocks
+/// into a bounded pool through its own handle of the file, nearest first
+/// and taking turns between tracks. The blocks queued when the thread
+/// wakes up are read in one batch. Samples lying in loaded blocks are
+/// copied from the pool, all others are read from the file as usual.
+///
+/// Only the thread reading samples calls Read(), the pool is shared with
+/// the loader under m_mutex.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4Prefetcher
+{
+public:
+    static const uint32_t DefaultNumBlocks = 8;
+    static const uint32_t DefaultBlockSize = 1024 * 1024;
+
+    // takes ownership of the opened file
+    MP4Prefetcher( File* pFile, uint32_t numBlocks, uint32_t blockSize );
+    ~MP4Prefetcher();
+
+    // copies a sample of track, false if its data is not in the pool
+    bool Read( MP4Track& track, MP4SampleId sampleId,
+               uint64_t offset, uint8_t* pBytes, uint32_t numBytes );
+
+private:
+    enum BlockState {
+        BLOCK_EMPTY,
+        BLOCK_QUEUED,
+        BLOCK_LOADING,
+        BLOCK_READY,
+        BLOCK_FAILED
+    };
+
+    struct Block {
+        uint64_t   index;       // file offset / m_blockSize
+        BlockState state;
+        uint32_t   sequence;    // load order of queued blocks, 0 is urgent
+        uint32_t   length;      // bytes loaded, short at the end of the file
+        uint8_t*   pData;
+    };
+
+    struct TrackState {
+        MP4Track*                     pTrack;
+        vector<MP4Track::ChunkExtent> chunks;
+        uint32_t                      chunkIndex;   // chunk of the last sample read
+        uint64_t                      blockIndex;   // block of that chunk
+    };
+
+    static void Run( void* arg );
+    static bool LoadsBefore( const Block* a, const Block* b );
+
+    void        Load();
+    TrackState& GetTrackState( MP4Track& track );
+    Block*      FindBlock( uint64_t index );
+    void        Plan();
+
+private:
+    File*              m_pFile;
+    uint32_t           m_blockSize;
+    vector<Block>      m_blocks;
+    vector<TrackState> m_tracks;
+    bool               m_stop;
+    thread::Mutex      m_mutex;
+    thread::Condition  m_queued;    // the loader has work or must stop
+    thread::Condition  m_loaded;    // a block finished loading
+    thread::Thread     m_thread;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
+
+#endif // MP4V2_IMPL_PREFETCHER_H
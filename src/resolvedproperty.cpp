@@ -0,0 +1,103 @@
+#include "src/impl.h"
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4ResolvedProperty::MP4ResolvedProperty( MP4Atom& base, const char* name )
+    : m_base       ( base )
+    , m_name       ( MP4Stralloc( name ))
+    , m_indexed    ( strchr( name, '[' ) != NULL )
+    , m_generation ( 0 )
+    , m_pProperty  ( NULL )
+    , m_index      ( 0 )
+    , m_missing    ( false )
+{
+}
+
+MP4ResolvedProperty::~MP4ResolvedProperty()
+{
+    MP4Free( m_name );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4Property*
+MP4ResolvedProperty::Get( uint32_t* pIndex )
+{
+    uint32_t generation = m_base.GetFile().GetAtomGeneration();
+
+    if( m_missing && m_generation == generation )
+        return NULL;
+
+    if( m_pProperty == NULL || m_generation != generation ) {
+        MP4Property* pProperty = NULL;
+        uint32_t index = 0;
+        if( !m_base.FindProperty( m_name, &pProperty, &index ))
+            pProperty = NULL;
+
+        m_pProperty  = pProperty;
+        m_index      = index;
+        m_generation = generation;
+        m_missing    = m_pProperty == NULL && !m_indexed;
+
+        if( m_pProperty == NULL )
+            return NULL;
+    }
+
+    // table entry does not exist, e.g. in an empty table, or was removed
+    if( m_index >= m_pProperty->GetCount() )
+        return NULL;
+
+    *pIndex = m_index;
+    return m_pProperty;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4ResolvedPropertyCache::MP4ResolvedPropertyCache( const char* prefix, uint32_t maxEntries )
+    : m_prefix     ( prefix )
+    , m_maxEntries ( maxEntries )
+{
+}
+
+MP4ResolvedPropertyCache::~MP4ResolvedPropertyCache()
+{
+    Clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4ResolvedProperty&
+MP4ResolvedPropertyCache::Resolve( MP4Atom& base, const char* name )
+{
+    if( name == NULL )
+        name = "";
+
+    EntryMap::iterator found = m_entries.find( name );
+    if( found != m_entries.end() )
+        return *found->second;
+
+    if( m_maxEntries && m_entries.size() >= m_maxEntries )
+        Clear();
+
+    string path = m_prefix + name;
+    MP4ResolvedProperty* entry = new MP4ResolvedProperty( base, path.c_str() );
+    m_entries[MP4Stralloc( name )] = entry;
+
+    return *entry;
+}
+
+void
+MP4ResolvedPropertyCache::Clear()
+{
+    for( EntryMap::iterator it = m_entries.begin(); it != m_entries.end(); it++ ) {
+        delete it->second;
+        MP4Free( (void*)it->first );
+    }
+    m_entries.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
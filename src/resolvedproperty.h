@@ -0,0 +1,101 @@
+#ifndef MP4V2_IMPL_RESOLVEDPROPERTY_H
+#define MP4V2_IMPL_RESOLVEDPROPERTY_H
+
+namespace mp4v2 { namespace impl {
+
+class MP4Atom;
+class MP4Property;
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Property path resolved once and reused.
+///
+/// Resolving a dotted path such as "mdia.minf.stbl.stsd.*.width" walks the
+/// atom tree with case-insensitive name matching and index parsing at every
+/// level. A resolved property remembers the result and the atom tree
+/// generation of its owning MP4File, and only walks the tree again once
+/// atoms, descriptors or properties have been added or removed since.
+///
+/// Missing properties are remembered as well, unless the path names a
+/// table entry by index, since such an entry can come into existence
+/// without the tree itself changing.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4ResolvedProperty
+{
+public:
+    // name is relative to base, e.g. "trak.tkhd.width" for a trak atom
+    MP4ResolvedProperty( MP4Atom& base, const char* name );
+    ~MP4ResolvedProperty();
+
+    // returns property and index, or NULL if the path names no property
+    MP4Property* Get( uint32_t* pIndex );
+
+    const char* GetName() const { return m_name; }
+
+private:
+    MP4Atom&     m_base;
+    char*        m_name;
+    bool         m_indexed;     // path contains an index, e.g. "entries[3]"
+    uint32_t     m_generation;
+    MP4Property* m_pProperty;
+    uint32_t     m_index;
+    bool         m_missing;     // path named no property at m_generation
+
+private:
+    MP4ResolvedProperty( const MP4ResolvedProperty& );
+    MP4ResolvedProperty& operator=( const MP4ResolvedProperty& );
+};
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Resolved properties keyed by path.
+///
+/// Owned by MP4File for paths from the root and by MP4Track for paths
+/// within its trak atom. A cache with a maximum number of entries is
+/// simply emptied when full, so callers must not keep its entries beyond
+/// the next Resolve(); a cache without maximum never drops entries and
+/// backs the handles returned by MP4ResolveProperty().
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4ResolvedPropertyCache
+{
+public:
+    static const uint32_t DefaultMaxEntries = 256;
+
+public:
+    // prefix is prepended to each name before it is resolved against base
+    explicit MP4ResolvedPropertyCache( const char* prefix = "",
+                                       uint32_t maxEntries = DefaultMaxEntries );
+    ~MP4ResolvedPropertyCache();
+
+    MP4ResolvedProperty& Resolve( MP4Atom& base, const char* name );
+
+    void Clear();
+
+private:
+    struct NameLess {
+        bool operator()( const char* a, const char* b ) const {
+            return strcmp( a, b ) < 0;
+        }
+    };
+
+    typedef map<const char*, MP4ResolvedProperty*, NameLess> EntryMap;
+
+private:
+    string   m_prefix;
+    uint32_t m_maxEntries;
+    EntryMap m_entries;     // keys are MP4Stralloc'd copies of the names
+
+private:
+    MP4ResolvedPropertyCache( const MP4ResolvedPropertyCache& );
+    MP4ResolvedPropertyCache& operator=( const MP4ResolvedPropertyCache& );
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
+
+#endif // MP4V2_IMPL_RESOLVEDPROPERTY_H
@@ -40,8 +40,10 @@ MP4RtpHintTrack::MP4RtpHintTrack(MP4File& file, MP4Atom& trakAtom)
     m_pTsroProperty = NULL;
 
     m_pReadHint = NULL;
+    m_readHintValid = false;
     m_pReadHintSample = NULL;
     m_readHintSampleSize = 0;
+    m_readHintBufferSize = 0;
 
     m_pWriteHint = NULL;
     m_writeHintId = MP4_INVALID_SAMPLE_ID;
@@ -70,7 +72,7 @@ MP4RtpHintTrack::MP4RtpHintTrack(MP4File& file, MP4Atom& trakAtom)
 MP4RtpHintTrack::~MP4RtpHintTrack()
 {
     delete m_pReadHint;
-    delete m_pReadHintSample;
+    MP4Free(m_pReadHintSample);
     delete m_pWriteHint;
 }
 
@@ -121,62 +123,71 @@ void MP4RtpHintTrack::ReadHint(
         InitRtpStart();
     }
 
-    // dispose of any old hint
-    delete m_pReadHint;
-    m_pReadHint = NULL;
-    delete m_pReadHintSample;
-    m_pReadHintSample = NULL;
-    m_readHintSampleSize = 0;
+    m_readHintValid = false;
+
+    // read the desired hint sample into memory,
+    // growing the buffer kept from earlier hints only when needed
+    uint32_t sampleSize = GetSampleSize(hintSampleId);
+    if (sampleSize > m_readHintBufferSize) {
+        m_pReadHintSample =
+            (uint8_t*)MP4Realloc(m_pReadHintSample, sampleSize);
+        m_readHintBufferSize = sampleSize;
+    }
+    m_readHintSampleSize = m_readHintBufferSize;
 
-    // read the desired hint sample into memory
     ReadSample(
         hintSampleId,
         &m_pReadHintSample,
         &m_readHintSampleSize,
         &m_readHintTimestamp);
 
-    m_File.EnableMemoryBuffer(m_pReadHintSample, m_readHintSampleSize);
-
-    m_pReadHint = new MP4RtpHint(*this);
-    m_pReadHint->Read(m_File);
+    if (m_pReadHint == NULL) {
+        m_pReadHint = new MP4RtpHint(*this);
+    }
 
+    m_File.EnableMemoryBuffer(m_pReadHintSample, m_readHintSampleSize);
+    try {
+        m_pReadHint->Read(m_File);
+    }
+    catch (Exception* x) {
+        m_File.DisableMemoryBuffer();
+        throw x;
+    }
     m_File.DisableMemoryBuffer();
 
+    m_readHintValid = true;
+
     if (pNumPackets) {
         *pNumPackets = GetHintNumberOfPackets();
     }
 }
 
-uint16_t MP4RtpHintTrack::GetHintNumberOfPackets()
+MP4RtpHint* MP4RtpHintTrack::GetReadHint()
 {
-    if (m_pReadHint == NULL) {
+    if (!m_readHintValid) {
         throw new Exception("no hint has been read",
                             __FILE__, __LINE__, __FUNCTION__);
     }
-    return m_pReadHint->GetNumberOfPackets();
+    return m_pReadHint;
+}
+
+uint16_t MP4RtpHintTrack::GetHintNumberOfPackets()
+{
+    return GetReadHint()->GetNumberOfPackets();
 }
 
 bool MP4RtpHintTrack::GetPacketBFrame(uint16_t packetIndex)
 {
-    if (m_pReadHint == NULL) {
-        throw new Exception("no hint has been read",
-                            __FILE__, __LINE__, __FUNCTION__);
-    }
     MP4RtpPacket* pPacket =
-        m_pReadHint->GetPacket(packetIndex);
+        GetReadHint()->GetPacket(packetIndex);
 
     return pPacket->IsBFrame();
 }
 
 uint16_t MP4RtpHintTrack::GetPacketTransmitOffset(uint16_t packetIndex)
 {
-    if (m_pReadHint == NULL) {
-        throw new Exception("no hint has been read",
-                            __FILE__, __LINE__, __FUNCTION__);
-     }
-
     MP4RtpPacket* pPacket =
-        m_pReadHint->GetPacket(packetIndex);
+        GetReadHint()->GetPacket(packetIndex);
 
     return pPacket->GetTransmitOffset();
 }
@@ -189,17 +200,13 @@ void MP4RtpHintTrack::ReadPacket(
     bool addHeader,
     bool addPayload)
 {
-    if (m_pReadHint == NULL) {
-        throw new Exception("no hint has been read",
-                            __FILE__, __LINE__, __FUNCTION__);
-    }
     if (!addHeader && !addPayload) {
         throw new Exception("no data requested",
                              __FILE__, __LINE__, __FUNCTION__);
     }
 
     MP4RtpPacket* pPacket =
-        m_pReadHint->GetPacket(packetIndex);
+        GetReadHint()->GetPacket(packetIndex);
 
     *pNumBytes = 0;
     if (addHeader) {
@@ -218,31 +225,7 @@ void MP4RtpHintTrack::ReadPacket(
     }
 
     try {
-        uint8_t* pDest = *ppBytes;
-
-        if (addHeader) {
-            *pDest++ =
-                0x80 | (pPacket->GetPBit() << 5) | (pPacket->GetXBit() << 4);
-
-            *pDest++ =
-                (pPacket->GetMBit() << 7) | pPacket->GetPayload();
-
-            *((uint16_t*)pDest) =
-                MP4V2_HTONS(m_rtpSequenceStart + pPacket->GetSequenceNumber());
-            pDest += 2;
-
-            *((uint32_t*)pDest) =
-                MP4V2_HTONL(m_rtpTimestampStart + (uint32_t)m_readHintTimestamp);
-            pDest += 4;
-
-            *((uint32_t*)pDest) =
-                MP4V2_HTONL(ssrc);
-            pDest += 4;
-        }
-
-        if (addPayload) {
-            pPacket->GetData(pDest);
-        }
+        WritePacket(pPacket, *ppBytes, ssrc, addHeader, addPayload);
     }
     catch (Exception* x) {
         if (buffer_malloc) {
@@ -257,6 +240,97 @@ void MP4RtpHintTrack::ReadPacket(
                 packetIndex);
 }
 
+bool MP4RtpHintTrack::ReadPackets(
+    uint8_t* pBuffer,
+    uint32_t* pBufferSize,
+    MP4RtpIovec* pPackets,
+    uint32_t* pNumPackets,
+    uint32_t ssrc,
+    bool addHeader,
+    bool addPayload)
+{
+    if (!addHeader && !addPayload) {
+        throw new Exception("no data requested",
+                             __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    MP4RtpHint* pHint = GetReadHint();
+    uint16_t numPackets = pHint->GetNumberOfPackets();
+
+    // total up what the hint needs before touching the caller's buffer
+    uint32_t numBytes = 0;
+    for (uint16_t i = 0; i < numPackets; i++) {
+        if (addHeader) {
+            numBytes += 12;
+        }
+        if (addPayload) {
+            numBytes += pHint->GetPacket(i)->GetDataSize();
+        }
+    }
+
+    bool fits = (numPackets <= *pNumPackets && numBytes <= *pBufferSize);
+
+    *pNumPackets = numPackets;
+    *pBufferSize = numBytes;
+
+    if (!fits) {
+        return false;
+    }
+
+    uint8_t* pDest = pBuffer;
+    for (uint16_t i = 0; i < numPackets; i++) {
+        uint32_t packetSize = WritePacket(
+            pHint->GetPacket(i), pDest, ssrc, addHeader, addPayload);
+
+        pPackets[i].base = pDest;
+        pPackets[i].length = packetSize;
+
+        log.hexDump(0, MP4_LOG_VERBOSE1, pDest, packetSize,
+                    "\"%s\": %u ", GetFile().GetFilename().c_str(), i);
+
+        pDest += packetSize;
+    }
+
+    return true;
+}
+
+uint32_t MP4RtpHintTrack::WritePacket(
+    MP4RtpPacket* pPacket,
+    uint8_t* pDest,
+    uint32_t ssrc,
+    bool addHeader,
+    bool addPayload)
+{
+    uint8_t* pStart = pDest;
+
+    if (addHeader) {
+        *pDest++ =
+            0x80 | (pPacket->GetPBit() << 5) | (pPacket->GetXBit() << 4);
+
+        *pDest++ =
+            (pPacket->GetMBit() << 7) | pPacket->GetPayload();
+
+        *((uint16_t*)pDest) =
+            MP4V2_HTONS(m_rtpSequenceStart + pPacket->GetSequenceNumber());
+        pDest += 2;
+
+        *((uint32_t*)pDest) =
+            MP4V2_HTONL(m_rtpTimestampStart + (uint32_t)m_readHintTimestamp);
+        pDest += 4;
+
+        *((uint32_t*)pDest) =
+            MP4V2_HTONL(ssrc);
+        pDest += 4;
+    }
+
+    if (addPayload) {
+        pPacket->GetData(pDest);
+        pDest += pPacket->GetDataSize();
+    }
+
+    return (uint32_t)(pDest - pStart);
+}
+
 MP4Timestamp MP4RtpHintTrack::GetRtpTimestampStart()
 {
     if (m_pRefTrack == NULL) {
@@ -714,6 +788,9 @@ MP4RtpHint::~MP4RtpHint()
     for (uint32_t i = 0; i < m_rtpPackets.Size(); i++) {
         delete m_rtpPackets[i];
     }
+    for (uint32_t i = 0; i < m_freePackets.Size(); i++) {
+        delete m_freePackets[i];
+    }
 }
 
 MP4RtpPacket* MP4RtpHint::AddPacket()
@@ -732,6 +809,15 @@ MP4RtpPacket* MP4RtpHint::AddPacket()
 
 void MP4RtpHint::Read(MP4File& file)
 {
+    // the hint object is reused by the track for each hint it reads,
+    // so set aside the packets of the previous one for reuse
+    while (m_rtpPackets.Size() > 0) {
+        MP4RtpPacket* pPacket = m_rtpPackets[m_rtpPackets.Size() - 1];
+        m_rtpPackets.Delete(m_rtpPackets.Size() - 1);
+        pPacket->Recycle();
+        m_freePackets.Add(pPacket);
+    }
+
     // call base class Read for required properties
     MP4Container::Read(file);
 
@@ -739,15 +825,22 @@ void MP4RtpHint::Read(MP4File& file)
         ((MP4Integer16Property*)m_pProperties[0])->GetValue();
 
     for (uint16_t i = 0; i < numPackets; i++) {
-        MP4RtpPacket* pPacket = new MP4RtpPacket(*this);
+        MP4RtpPacket* pPacket;
+
+        if (m_freePackets.Size() > 0) {
+            pPacket = m_freePackets[m_freePackets.Size() - 1];
+            m_freePackets.Delete(m_freePackets.Size() - 1);
+        } else {
+            pPacket = new MP4RtpPacket(*this);
+        }
 
         m_rtpPackets.Add(pPacket);
 
         pPacket->Read(file);
     }
 
-    if (log.verbosity >= MP4_LOG_VERBOSE1) {
-        log.verbose1f("\"%s\": ReadHint:", GetTrack().GetFile().GetFilename().c_str());
+    if (MP4V2_LOG_ENABLED(log, MP4_LOG_VERBOSE1)) {
+        MP4V2_LOG_VERBOSE1( log, "\"%s\": ReadHint:", GetTrack().GetFile().GetFilename().c_str());
         Dump(10, false);
     }
 }
@@ -784,8 +877,10 @@ void MP4RtpHint::Write(MP4File& file)
 
     file.SetPosition(endPos);
 
-    log.verbose1f("\"%s\": WriteRtpHint:", GetTrack().GetFile().GetFilename().c_str());
-    Dump(14, false);
+    if (MP4V2_LOG_ENABLED(log, MP4_LOG_VERBOSE1)) {
+        MP4V2_LOG_VERBOSE1( log, "\"%s\": WriteRtpHint:", GetTrack().GetFile().GetFilename().c_str());
+        Dump(14, false);
+    }
 }
 
 void MP4RtpHint::Dump(uint8_t indent, bool dumpImplicits)
@@ -835,6 +930,54 @@ MP4RtpPacket::~MP4RtpPacket()
     for (uint32_t i = 0; i < m_rtpData.Size(); i++) {
         delete m_rtpData[i];
     }
+    for (uint8_t type = 0; type < NumDataTypes; type++) {
+        for (uint32_t i = 0; i < m_freeData[type].Size(); i++) {
+            delete m_freeData[type][i];
+        }
+    }
+}
+
+void MP4RtpPacket::Recycle()
+{
+    // drop the rtpo properties a previous read may have added
+    while (m_pProperties.Size() > BaseProperties) {
+        delete m_pProperties[m_pProperties.Size() - 1];
+        m_pProperties.Delete(m_pProperties.Size() - 1);
+    }
+
+    while (m_rtpData.Size() > 0) {
+        MP4RtpData* pData = m_rtpData[m_rtpData.Size() - 1];
+        m_rtpData.Delete(m_rtpData.Size() - 1);
+
+        uint8_t dataType =
+            ((MP4Integer8Property*)pData->GetProperty(0))->GetValue();
+        m_freeData[dataType].Add(pData);
+    }
+}
+
+MP4RtpData* MP4RtpPacket::NewData(uint8_t dataType)
+{
+    if (dataType >= NumDataTypes) {
+        throw new Exception("unknown packet data entry type", __FILE__, __LINE__, __FUNCTION__ );
+    }
+
+    MP4RtpDataArray& freeData = m_freeData[dataType];
+    if (freeData.Size() > 0) {
+        MP4RtpData* pData = freeData[freeData.Size() - 1];
+        freeData.Delete(freeData.Size() - 1);
+        return pData;
+    }
+
+    switch (dataType) {
+    case 0:
+        return new MP4RtpNullData(*this);
+    case 1:
+        return new MP4RtpImmediateData(*this);
+    case 2:
+        return new MP4RtpSampleData(*this);
+    default:
+        return new MP4RtpSampleDescriptionData(*this);
+    }
 }
 
 void MP4RtpPacket::AddExtraProperties()
@@ -878,24 +1021,7 @@ void MP4RtpPacket::Read(MP4File& file)
         uint8_t dataType;
         file.PeekBytes(&dataType, 1);
 
-        MP4RtpData* pData;
-
-        switch (dataType) {
-        case 0:
-            pData = new MP4RtpNullData(*this);
-            break;
-        case 1:
-            pData = new MP4RtpImmediateData(*this);
-            break;
-        case 2:
-            pData = new MP4RtpSampleData(*this);
-            break;
-        case 3:
-            pData = new MP4RtpSampleDescriptionData(*this);
-            break;
-        default:
-            throw new Exception("unknown packet data entry type", __FILE__, __LINE__, __FUNCTION__ );
-        }
+        MP4RtpData* pData = NewData(dataType);
 
         m_rtpData.Add(pData);
 
@@ -1138,12 +1264,15 @@ uint16_t MP4RtpImmediateData::GetDataSize()
 
 void MP4RtpImmediateData::GetData(uint8_t* pDest)
 {
-    uint8_t* pValue;
-    uint32_t valueSize;
-    ((MP4BytesProperty*)m_pProperties[2])->GetValue(&pValue, &valueSize);
+    if (GetDataSize() > 14) {
+        throw new Exception("immediate data count too large",
+                            __FILE__, __LINE__, __FUNCTION__);
+    }
+
+    uint8_t value[14];
+    ((MP4BytesProperty*)m_pProperties[2])->CopyValue(value);
 
-    memcpy(pDest, pValue, GetDataSize());
-    MP4Free(pValue);
+    memcpy(pDest, value, GetDataSize());
 }
 
 MP4RtpSampleData::MP4RtpSampleData(MP4RtpPacket& packet)
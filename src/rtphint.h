@@ -170,6 +170,8 @@ public:
 
     void ReadExtra(MP4File& file);
 
+    void Recycle();
+
     void Write(MP4File& file);
 
     void WriteEmbeddedData(MP4File& file, uint64_t startPos);
@@ -177,8 +179,18 @@ public:
     void Dump(uint8_t indent, bool dumpImplicits);
 
 protected:
+    MP4RtpData* NewData(uint8_t dataType);
+
+    enum {
+        BaseProperties = 13,
+        NumDataTypes = 4
+    };
+
     MP4RtpHint&         m_hint;
     MP4RtpDataArray     m_rtpData;
+
+    // data entries of earlier reads, kept for reuse by type
+    MP4RtpDataArray     m_freeData[NumDataTypes];
 };
 
 MP4ARRAY_DECL(MP4RtpPacket, MP4RtpPacket*)
@@ -234,6 +246,9 @@ protected:
     MP4RtpHintTrack&    m_track;
     MP4RtpPacketArray   m_rtpPackets;
 
+    // packets of earlier reads, kept for reuse
+    MP4RtpPacketArray   m_freePackets;
+
     // values when adding packets to a hint (write mode)
     bool                m_isBFrame;
     uint32_t            m_timestampOffset;
@@ -290,6 +305,15 @@ public:
         bool includeHeader = true,
         bool includePayload = true);
 
+    bool ReadPackets(
+        uint8_t* pBuffer,
+        uint32_t* pBufferSize,
+        MP4RtpIovec* pPackets,
+        uint32_t* pNumPackets,
+        uint32_t ssrc,
+        bool includeHeader = true,
+        bool includePayload = true);
+
     MP4Timestamp GetRtpTimestampStart();
 
     void SetRtpTimestampStart(MP4Timestamp start);
@@ -310,6 +334,15 @@ public:
     void FinishWrite();
 
 protected:
+    MP4RtpHint* GetReadHint();
+
+    uint32_t WritePacket(
+        MP4RtpPacket* pPacket,
+        uint8_t* pDest,
+        uint32_t ssrc,
+        bool includeHeader,
+        bool includePayload);
+
     MP4Track*   m_pRefTrack;
 
     MP4StringProperty*      m_pRtpMapProperty;
@@ -321,9 +354,12 @@ protected:
     uint32_t                m_rtpTimestampStart;
 
     // reading
+    // the hint object and sample buffer are reused from one hint to the next
     MP4RtpHint* m_pReadHint;
+    bool        m_readHintValid;
     uint8_t*    m_pReadHintSample;
     uint32_t    m_readHintSampleSize;
+    uint32_t    m_readHintBufferSize;
     MP4Timestamp m_readHintTimestamp;
 
     // writing
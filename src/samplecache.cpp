@@ -0,0 +1,108 @@
+#include "src/impl.h"
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4SampleCache::MP4SampleCache( uint32_t maxBytes )
+    : m_bytes    ( 0 )
+    , m_maxBytes ( maxBytes )
+    , m_hits     ( 0 )
+    , m_misses   ( 0 )
+{
+}
+
+MP4SampleCache::~MP4SampleCache()
+{
+    Clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const uint8_t*
+MP4SampleCache::Find( MP4SampleId sampleId, uint32_t* pSize )
+{
+    EntryIndex::iterator found = m_index.find( sampleId );
+    if( found == m_index.end() ) {
+        m_misses++;
+        return NULL;
+    }
+
+    m_hits++;
+    EntryList::iterator entry = found->second;
+    if( entry != m_entries.begin() )
+        m_entries.splice( m_entries.begin(), m_entries, entry );
+
+    *pSize = entry->size;
+    return entry->pBytes;
+}
+
+void
+MP4SampleCache::Insert( MP4SampleId sampleId, uint8_t* pBytes, uint32_t size )
+{
+    EntryIndex::iterator found = m_index.find( sampleId );
+    if( found != m_index.end() ) {
+        EntryList::iterator entry = found->second;
+        m_bytes -= entry->size;
+        MP4Free( entry->pBytes );
+        m_entries.erase( entry );
+        m_index.erase( found );
+    }
+
+    Entry entry;
+    entry.sampleId = sampleId;
+    entry.pBytes   = pBytes;
+    entry.size     = size;
+
+    m_entries.push_front( entry );
+    m_index[sampleId] = m_entries.begin();
+    m_bytes += size;
+
+    Evict();
+}
+
+void
+MP4SampleCache::Clear()
+{
+    for( EntryList::iterator it = m_entries.begin(); it != m_entries.end(); it++ )
+        MP4Free( it->pBytes );
+
+    m_entries.clear();
+    m_index.clear();
+    m_bytes = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void
+MP4SampleCache::SetMaxBytes( uint32_t maxBytes )
+{
+    m_maxBytes = maxBytes;
+    Evict();
+}
+
+void
+MP4SampleCache::ResetStats()
+{
+    m_hits = 0;
+    m_misses = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void
+MP4SampleCache::Evict()
+{
+    // never evict the most recently used entry
+    while( m_bytes > m_maxBytes && m_entries.size() > 1 ) {
+        Entry& victim = m_entries.back();
+        m_bytes -= victim.size;
+        MP4Free( victim.pBytes );
+        m_index.erase( victim.sampleId );
+        m_entries.pop_back();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
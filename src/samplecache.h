@@ -0,0 +1,70 @@
+#ifndef MP4V2_IMPL_SAMPLECACHE_H
+#define MP4V2_IMPL_SAMPLECACHE_H
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Size-bounded LRU cache of whole samples.
+///
+/// Used by MP4Track::ReadSampleFragment() so hint packets that reference
+/// several samples in turn do not re-read them from the file. The most
+/// recently inserted sample is always kept, even if it alone exceeds the
+/// capacity, so a capacity of 0 degenerates to a single-sample cache.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4SampleCache
+{
+public:
+    static const uint32_t DefaultMaxBytes = 2 * 1024 * 1024;
+
+public:
+    explicit MP4SampleCache( uint32_t maxBytes = DefaultMaxBytes );
+    ~MP4SampleCache();
+
+    // returns cached sample and marks it most recently used, or NULL
+    const uint8_t* Find( MP4SampleId sampleId, uint32_t* pSize );
+
+    // takes ownership of MP4Malloc'd bytes
+    void Insert( MP4SampleId sampleId, uint8_t* pBytes, uint32_t size );
+
+    void Clear();
+
+    uint32_t GetMaxBytes() const { return m_maxBytes; }
+    void     SetMaxBytes( uint32_t maxBytes );
+
+    uint64_t GetHits() const   { return m_hits; }
+    uint64_t GetMisses() const { return m_misses; }
+    void     ResetStats();
+
+private:
+    struct Entry {
+        MP4SampleId sampleId;
+        uint8_t*    pBytes;
+        uint32_t    size;
+    };
+
+    typedef list<Entry> EntryList;
+    typedef map<MP4SampleId, EntryList::iterator> EntryIndex;
+
+    void Evict();
+
+private:
+    EntryList  m_entries;   // front is most recently used
+    EntryIndex m_index;
+    uint64_t   m_bytes;
+    uint32_t   m_maxBytes;
+    uint64_t   m_hits;
+    uint64_t   m_misses;
+
+private:
+    MP4SampleCache( const MP4SampleCache& );
+    MP4SampleCache& operator=( const MP4SampleCache& );
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
+
+#endif // MP4V2_IMPL_SAMPLECACHE_H
@@ -27,8 +27,15 @@ namespace mp4v2 { namespace impl {
 #include "log.h"
 #include "mp4util.h"
 #include "mp4array.h"
+#include "arena.h"
+#include "samplecache.h"
+#include "h264.h"
+#include "crc32c.h"
+#include "resolvedproperty.h"
 #include "mp4track.h"
 #include "mp4file.h"
+#include "streamreader.h"
+#include "prefetcher.h"
 #include "mp4property.h"
 #include "mp4container.h"
 
@@ -0,0 +1,629 @@
+#include "src/impl.h"
+#include <algorithm>
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+    // largest ftyp, moov or moof held in memory
+    const uint64_t MAX_HEADER_BOX_SIZE = 0x7fffffff;
+
+    const uint32_t TFHD_BASE_DATA_OFFSET     = 0x000001;
+    const uint32_t TFHD_SAMPLE_DESCRIPTION   = 0x000002;
+    const uint32_t TFHD_DEFAULT_DURATION     = 0x000008;
+    const uint32_t TFHD_DEFAULT_SIZE         = 0x000010;
+    const uint32_t TFHD_DEFAULT_FLAGS        = 0x000020;
+    const uint32_t TFHD_DEFAULT_BASE_IS_MOOF = 0x020000;
+
+    const uint32_t TRUN_DATA_OFFSET          = 0x000001;
+    const uint32_t TRUN_FIRST_SAMPLE_FLAGS   = 0x000004;
+    const uint32_t TRUN_DURATION             = 0x000100;
+    const uint32_t TRUN_SIZE                 = 0x000200;
+    const uint32_t TRUN_FLAGS                = 0x000400;
+    const uint32_t TRUN_COMPOSITION_OFFSET   = 0x000800;
+
+    const uint32_t SAMPLE_IS_NON_SYNC        = 0x010000;
+
+    // bounds checked big-endian reads from a box held in memory
+    class BoxReader
+    {
+    public:
+        BoxReader( const uint8_t* p, const uint8_t* end )
+            : m_p( p ), m_end( end )
+        {
+        }
+
+        bool AtEnd() const { return m_p >= m_end; }
+        const uint8_t* Position() const { return m_p; }
+        uint64_t Remaining() const { return m_end - m_p; }
+
+        uint8_t ReadUInt8()
+        {
+            Need( 1 );
+            return *m_p++;
+        }
+
+        uint32_t ReadUInt24()
+        {
+            Need( 3 );
+            uint32_t value = (m_p[0] << 16) | (m_p[1] << 8) | m_p[2];
+            m_p += 3;
+            return value;
+        }
+
+        uint32_t ReadUInt32()
+        {
+            Need( 4 );
+            uint32_t value = (uint32_t( m_p[0] ) << 24) | (m_p[1] << 16) | (m_p[2] << 8) | m_p[3];
+            m_p += 4;
+            return value;
+        }
+
+        uint64_t ReadUInt64()
+        {
+            uint64_t high = ReadUInt32();
+            return (high << 32) | ReadUInt32();
+        }
+
+        void Skip( uint64_t numBytes )
+        {
+            Need( numBytes );
+            m_p += numBytes;
+        }
+
+    private:
+        void Need( uint64_t numBytes )
+        {
+            if( Remaining() < numBytes )
+                throw new Exception( "fragment box is truncated", __FILE__, __LINE__, __FUNCTION__ );
+        }
+
+    private:
+        const uint8_t* m_p;
+        const uint8_t* m_end;
+    };
+
+    // reads a child box header, returns the end of the child
+    const uint8_t*
+    readChildHeader( BoxReader& reader, const uint8_t* end, uint32_t& type )
+    {
+        const uint8_t* start = reader.Position();
+        uint64_t size = reader.ReadUInt32();
+        type = reader.ReadUInt32();
+        if( size == 1 )
+            size = reader.ReadUInt64();
+        else if( size == 0 )
+            size = end - start;
+        if( size < uint64_t( reader.Position() - start ) || size > uint64_t( end - start ))
+            throw new Exception( "fragment box is truncated", __FILE__, __LINE__, __FUNCTION__ );
+        return start + size;
+    }
+} // namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+const uint32_t MP4StreamReader::NoRunSamples;
+const uint64_t MP4StreamReader::Unbounded;
+
+MP4StreamReader::MP4StreamReader()
+    : m_pStream        ( NULL )
+    , m_pFile          ( NULL )
+    , m_position       ( 0 )
+    , m_boxEnd         ( 0 )
+    , m_failed         ( false )
+    , m_nextExtent     ( 0 )
+    , m_haveCurrent    ( false )
+    , m_currentSample  ( 0 )
+    , m_bufferPosition ( 0 )
+{
+}
+
+MP4StreamReader::~MP4StreamReader()
+{
+    delete m_pFile;
+    delete m_pStream;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void
+MP4StreamReader::Open( const char* name, const MP4FileProvider* provider )
+{
+    ASSERT( !m_pStream );
+
+    m_pStream = new File( name, File::MODE_READ, provider ? new io::CustomFileProvider( *provider ) : NULL );
+    if( m_pStream->open() ) {
+        ostringstream msg;
+        msg << "open(" << name << ") failed";
+        throw new Exception( msg.str(), __FILE__, __LINE__, __FUNCTION__ );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4File&
+MP4StreamReader::GetFile()
+{
+    CheckFailed();
+    try {
+        while( !m_pFile ) {
+            if( m_boxEnd == Unbounded )
+                throw new Exception( "stream has no moov box", __FILE__, __LINE__, __FUNCTION__ );
+            SkipStream( m_boxEnd - m_position );
+            if( !NextBox() )
+                throw new Exception( "stream has no moov box", __FILE__, __LINE__, __FUNCTION__ );
+        }
+    }
+    catch( ... ) {
+        m_failed = true;
+        throw;
+    }
+    return *m_pFile;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool
+MP4StreamReader::ReadSample( MP4StreamSample& sample )
+{
+    CheckFailed();
+    try {
+        return NextSample( sample );
+    }
+    catch( ... ) {
+        m_failed = true;
+        throw;
+    }
+}
+
+// a stream is left inside a box when reading fails, so it cannot go on
+void
+MP4StreamReader::CheckFailed()
+{
+    if( m_failed )
+        throw new Exception( "stream failed before", __FILE__, __LINE__, __FUNCTION__ );
+}
+
+bool
+MP4StreamReader::NextSample( MP4StreamSample& sample )
+{
+    while( !m_haveCurrent || m_currentSample == m_current.numSamples ) {
+        m_haveCurrent = false;
+
+        // data behind the stream position cannot be reached anymore
+        for( ; m_nextExtent < m_extents.size() && m_extents[m_nextExtent].offset < m_position; m_nextExtent++ ) {
+            const Extent& e = m_extents[m_nextExtent];
+            log.warningf( "%s: \"%s\": data of track %u at offset %" PRIu64 " precedes its box, skipped",
+                          __FUNCTION__, m_pStream->name.c_str(), e.pTrack->GetId(), e.offset );
+        }
+
+        // next chunk or run within the box being streamed through
+        if( m_nextExtent < m_extents.size() && m_extents[m_nextExtent].offset < m_boxEnd ) {
+            const Extent& e = m_extents[m_nextExtent];
+            if( m_boxEnd != Unbounded && e.offset + e.size > m_boxEnd ) {
+                ostringstream msg;
+                msg << "data of track " << e.pTrack->GetId() << " at offset " << e.offset
+                    << " runs past the end of its box";
+                throw new Exception( msg.str(), __FILE__, __LINE__, __FUNCTION__ );
+            }
+            if( e.size > 0xffffffff )
+                throw new Exception( "chunk is too large", __FILE__, __LINE__, __FUNCTION__ );
+
+            SkipStream( e.offset - m_position );
+            m_buffer.resize( size_t( e.size ));
+            if( e.size && !ReadStream( &m_buffer[0], e.size ))
+                throw new Exception( "stream ended inside sample data", __FILE__, __LINE__, __FUNCTION__ );
+
+            m_current = e;
+            m_haveCurrent = true;
+            m_currentSample = 0;
+            m_bufferPosition = 0;
+            m_nextExtent++;
+            continue;
+        }
+
+        // a box without size extends to the end of the stream
+        if( m_boxEnd == Unbounded ) {
+            if( !m_pFile )
+                throw new Exception( "stream has no moov box", __FILE__, __LINE__, __FUNCTION__ );
+            return false;
+        }
+
+        SkipStream( m_boxEnd - m_position );
+        if( !NextBox() ) {
+            if( !m_pFile )
+                throw new Exception( "stream has no moov box", __FILE__, __LINE__, __FUNCTION__ );
+            if( m_nextExtent < m_extents.size() ) {
+                const Extent& e = m_extents[m_nextExtent];
+                ostringstream msg;
+                msg << "stream ended before the data of track " << e.pTrack->GetId()
+                    << " sample " << e.firstSampleId;
+                throw new Exception( msg.str(), __FILE__, __LINE__, __FUNCTION__ );
+            }
+            return false;
+        }
+    }
+
+    const Extent& e = m_current;
+    MP4Track& track = *e.pTrack;
+    MP4SampleId sampleId = e.firstSampleId + m_currentSample;
+
+    sample.trackId  = track.GetId();
+    sample.sampleId = sampleId;
+    if( e.firstRunSample == NoRunSamples ) {
+        sample.numBytes = track.GetSampleSize( sampleId );
+        track.GetSampleTimes( sampleId, &sample.startTime, &sample.duration );
+        sample.renderingOffset = track.GetSampleRenderingOffset( sampleId );
+        sample.isSyncSample = track.IsSyncSample( sampleId );
+    }
+    else {
+        const RunSample& rs = m_runSamples[e.firstRunSample + m_currentSample];
+        sample.numBytes        = rs.size;
+        sample.startTime       = rs.startTime;
+        sample.duration        = rs.duration;
+        sample.renderingOffset = rs.renderingOffset;
+        sample.isSyncSample    = rs.isSync;
+    }
+    sample.fileOffset = e.offset + m_bufferPosition;
+    sample.bytes = sample.numBytes ? &m_buffer[m_bufferPosition] : NULL;
+
+    m_bufferPosition += sample.numBytes;
+    m_currentSample++;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool
+MP4StreamReader::CompareExtents( const Extent& a, const Extent& b )
+{
+    return a.offset < b.offset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Short reads are retried as pipes and sockets return what has arrived.
+// Returns false if the stream ends before the first byte.
+bool
+MP4StreamReader::ReadStream( uint8_t* pBytes, uint64_t numBytes )
+{
+    uint64_t done = 0;
+    while( done < numBytes ) {
+        File::Size nin;
+        if( m_pStream->read( pBytes + done, numBytes - done, nin ))
+            throw new PlatformException( "read failed", sys::getLastError(), __FILE__, __LINE__, __FUNCTION__ );
+        if( nin == 0 ) {
+            if( done == 0 )
+                return false;
+            throw new Exception( "stream ended inside a box", __FILE__, __LINE__, __FUNCTION__ );
+        }
+        done += nin;
+        m_position += nin;
+    }
+    return true;
+}
+
+void
+MP4StreamReader::SkipStream( uint64_t numBytes )
+{
+    uint8_t scratch[64 * 1024];
+    while( numBytes ) {
+        uint64_t n = min( numBytes, uint64_t( sizeof(scratch) ));
+        if( !ReadStream( scratch, n ))
+            throw new Exception( "stream ended inside a box", __FILE__, __LINE__, __FUNCTION__ );
+        numBytes -= n;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Reads the header of the next top-level box. ftyp, moov and moof are read
+// whole, any other box is left to be streamed through up to m_boxEnd.
+bool
+MP4StreamReader::NextBox()
+{
+    const uint64_t start = m_position;
+
+    uint8_t header[16];
+    if( !ReadStream( header, 8 ))
+        return false;
+
+    uint32_t headerSize = 8;
+    uint64_t size = (uint32_t( header[0] ) << 24) | (header[1] << 16) | (header[2] << 8) | header[3];
+    if( size == 1 ) {
+        if( !ReadStream( header + 8, 8 ))
+            throw new Exception( "stream ended inside a box", __FILE__, __LINE__, __FUNCTION__ );
+        headerSize = 16;
+        size = 0;
+        for( int i = 8; i < 16; i++ )
+            size = (size << 8) | header[i];
+    }
+    else if( size == 0 ) {
+        size = Unbounded;
+    }
+
+    if( size < headerSize ) {
+        ostringstream msg;
+        msg << "box at offset " << start << " has invalid size " << size;
+        throw new Exception( msg.str(), __FILE__, __LINE__, __FUNCTION__ );
+    }
+
+    const uint32_t type = ATOMID( (const char*)header + 4 );
+    if( type != ATOMID( "ftyp" ) && type != ATOMID( "moov" ) && type != ATOMID( "moof" )) {
+        if( type == ATOMID( "mdat" ) && !m_pFile && size > headerSize )
+            throw new Exception( "media data precedes the moov box, the stream is not progressive",
+                                 __FILE__, __LINE__, __FUNCTION__ );
+        m_boxEnd = size == Unbounded ? Unbounded : start + size;
+        return true;
+    }
+
+    if( size > MAX_HEADER_BOX_SIZE ) {
+        ostringstream msg;
+        msg << "box " << string( (const char*)header + 4, 4 ) << " at offset " << start << " is too large";
+        throw new Exception( msg.str(), __FILE__, __LINE__, __FUNCTION__ );
+    }
+
+    vector<uint8_t> box( (size_t)size );
+    memcpy( &box[0], header, headerSize );
+    if( size > headerSize && !ReadStream( &box[headerSize], size - headerSize ))
+        throw new Exception( "stream ended inside a box", __FILE__, __LINE__, __FUNCTION__ );
+    m_boxEnd = m_position;
+
+    if( type == ATOMID( "ftyp" )) {
+        if( !m_pFile )
+            m_ftyp.swap( box );
+    }
+    else if( type == ATOMID( "moov" )) {
+        if( m_pFile )
+            throw new Exception( "stream has more than one moov box", __FILE__, __LINE__, __FUNCTION__ );
+        ReadMovie( box );
+    }
+    else {
+        if( !m_pFile )
+            throw new Exception( "moof box precedes the moov box", __FILE__, __LINE__, __FUNCTION__ );
+        ReadFragment( box, headerSize, start );
+    }
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void
+MP4StreamReader::ReadMovie( const vector<uint8_t>& box )
+{
+    // the movie is parsed as a file holding just ftyp and moov
+    vector<uint8_t> movie;
+    movie.reserve( m_ftyp.size() + box.size() );
+    movie.insert( movie.end(), m_ftyp.begin(), m_ftyp.end() );
+    movie.insert( movie.end(), box.begin(), box.end() );
+
+    MP4File* pFile = new MP4File();
+    try {
+        pFile->ReadFromBuffer( m_pStream->name.c_str(), &movie[0], movie.size() );
+    }
+    catch( ... ) {
+        delete pFile;
+        throw;
+    }
+    m_pFile = pFile;
+    m_ftyp.clear();
+
+    uint32_t numTracks = m_pFile->GetNumberOfTracks();
+    for( uint32_t i = 0; i < numTracks; i++ ) {
+        MP4Track* pTrack = m_pFile->GetTrack( m_pFile->FindTrackId( i ));
+
+        vector<MP4Track::ChunkExtent> chunks;
+        pTrack->GetChunkExtents( chunks );
+        for( uint32_t c = 0; c < chunks.size(); c++ ) {
+            if( !chunks[c].numSamples )
+                continue;
+            Extent e;
+            e.offset         = chunks[c].offset;
+            e.size           = chunks[c].size;
+            e.pTrack         = pTrack;
+            e.firstSampleId  = chunks[c].firstSampleId;
+            e.numSamples     = chunks[c].numSamples;
+            e.firstRunSample = NoRunSamples;
+            m_extents.push_back( e );
+        }
+
+        // fragments continue where the samples of moov end
+        TrackState state;
+        state.pTrack          = pTrack;
+        state.nextSampleId    = pTrack->GetNumberOfSamples() + 1;
+        state.nextDecodeTime  = 0;
+        state.defaultDuration = 0;
+        state.defaultSize     = 0;
+        state.defaultFlags    = 0;
+        if( state.nextSampleId > 1 ) {
+            MP4Duration duration;
+            pTrack->GetSampleTimes( state.nextSampleId - 1, &state.nextDecodeTime, &duration );
+            state.nextDecodeTime += duration;
+        }
+        m_tracks.push_back( state );
+    }
+
+    MP4Atom* pMvex = m_pFile->FindAtom( "moov.mvex" );
+    for( uint32_t i = 0; pMvex && i < pMvex->GetNumberOfChildAtoms(); i++ ) {
+        MP4Atom* pTrex = pMvex->GetChildAtom( i );
+        MP4Property* pTrackId;
+        if( ATOMID( pTrex->GetType() ) != ATOMID( "trex" ) || !pTrex->FindProperty( "trex.trackId", &pTrackId ))
+            continue;
+
+        TrackState* pState = NULL;
+        for( uint32_t t = 0; t < m_tracks.size(); t++ ) {
+            if( m_tracks[t].pTrack->GetId() == ((MP4Integer32Property*)pTrackId)->GetValue() )
+                pState = &m_tracks[t];
+        }
+        if( !pState )
+            continue;
+
+        MP4Property* pProperty;
+        if( pTrex->FindProperty( "trex.defaultSampleDuration", &pProperty ))
+            pState->defaultDuration = ((MP4Integer32Property*)pProperty)->GetValue();
+        if( pTrex->FindProperty( "trex.defaultSampleSize", &pProperty ))
+            pState->defaultSize = ((MP4Integer32Property*)pProperty)->GetValue();
+        if( pTrex->FindProperty( "trex.defaultSampleFlags", &pProperty ))
+            pState->defaultFlags = ((MP4Integer32Property*)pProperty)->GetValue();
+    }
+
+    stable_sort( m_extents.begin(), m_extents.end(), CompareExtents );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void
+MP4StreamReader::ReadFragment( const vector<uint8_t>& box, uint32_t headerSize, uint64_t start )
+{
+    // forget fragments whose data has been delivered
+    if( m_nextExtent == m_extents.size() ) {
+        m_extents.clear();
+        m_nextExtent = 0;
+        m_runSamples.clear();
+    }
+
+    // data of the first traf without an explicit base starts at moof
+    uint64_t dataEnd = start;
+
+    const uint8_t* end = &box[0] + box.size();
+    BoxReader reader( &box[0] + headerSize, end );
+    while( !reader.AtEnd() ) {
+        uint32_t type;
+        const uint8_t* childEnd = readChildHeader( reader, end, type );
+        if( type == ATOMID( "traf" ))
+            ReadTrackFragment( reader.Position(), childEnd, start, dataEnd );
+        reader.Skip( childEnd - reader.Position() );
+    }
+
+    // merge with runs still pending from earlier fragments
+    stable_sort( m_extents.begin() + m_nextExtent, m_extents.end(), CompareExtents );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Decodes the runs of a traf, per ISO/IEC 14496-12 8.8.7 and 8.8.8, into
+// extents holding the samples' sizes, times and sync flags.
+void
+MP4StreamReader::ReadTrackFragment( const uint8_t* p, const uint8_t* end,
+                                    uint64_t moofStart, uint64_t& dataEnd )
+{
+    TrackState* pState = NULL;
+    uint64_t base = 0;
+    uint64_t runEnd = 0;
+    uint32_t defaultDuration = 0;
+    uint32_t defaultSize = 0;
+    uint32_t defaultFlags = 0;
+
+    BoxReader reader( p, end );
+    while( !reader.AtEnd() ) {
+        uint32_t type;
+        const uint8_t* childEnd = readChildHeader( reader, end, type );
+        BoxReader child( reader.Position(), childEnd );
+        reader.Skip( childEnd - reader.Position() );
+
+        if( type == ATOMID( "tfhd" )) {
+            child.ReadUInt8();
+            uint32_t flags = child.ReadUInt24();
+            pState = &GetTrackState( child.ReadUInt32() );
+
+            if( flags & TFHD_BASE_DATA_OFFSET )
+                base = child.ReadUInt64();
+            else if( flags & TFHD_DEFAULT_BASE_IS_MOOF )
+                base = moofStart;
+            else
+                base = dataEnd;
+            runEnd = base;
+
+            if( flags & TFHD_SAMPLE_DESCRIPTION )
+                child.ReadUInt32();
+            defaultDuration = flags & TFHD_DEFAULT_DURATION ? child.ReadUInt32() : pState->defaultDuration;
+            defaultSize     = flags & TFHD_DEFAULT_SIZE ? child.ReadUInt32() : pState->defaultSize;
+            defaultFlags    = flags & TFHD_DEFAULT_FLAGS ? child.ReadUInt32() : pState->defaultFlags;
+            continue;
+        }
+
+        if( type != ATOMID( "tfdt" ) && type != ATOMID( "trun" ))
+            continue;
+        if( !pState )
+            throw new Exception( "traf has no tfhd box", __FILE__, __LINE__, __FUNCTION__ );
+
+        uint8_t version = child.ReadUInt8();
+        uint32_t flags = child.ReadUInt24();
+
+        if( type == ATOMID( "tfdt" )) {
+            pState->nextDecodeTime = version == 1 ? child.ReadUInt64() : child.ReadUInt32();
+            continue;
+        }
+
+        uint32_t numSamples = child.ReadUInt32();
+
+        Extent e;
+        e.offset = flags & TRUN_DATA_OFFSET ? base + int32_t( child.ReadUInt32() ) : runEnd;
+        e.size           = 0;
+        e.pTrack         = pState->pTrack;
+        e.firstSampleId  = pState->nextSampleId;
+        e.numSamples     = numSamples;
+        e.firstRunSample = (uint32_t)m_runSamples.size();
+
+        bool hasFirstFlags = (flags & TRUN_FIRST_SAMPLE_FLAGS) != 0;
+        uint32_t firstFlags = hasFirstFlags ? child.ReadUInt32() : 0;
+
+        // every field present takes four bytes per sample
+        uint32_t fieldSize = 0;
+        for( uint32_t field = TRUN_DURATION; field <= TRUN_COMPOSITION_OFFSET; field <<= 1 )
+            fieldSize += flags & field ? 4 : 0;
+        if( uint64_t( numSamples ) * fieldSize > child.Remaining() )
+            throw new Exception( "fragment box is truncated", __FILE__, __LINE__, __FUNCTION__ );
+
+        for( uint32_t i = 0; i < numSamples; i++ ) {
+            RunSample rs;
+            rs.duration = flags & TRUN_DURATION ? child.ReadUInt32() : defaultDuration;
+            rs.size     = flags & TRUN_SIZE ? child.ReadUInt32() : defaultSize;
+
+            uint32_t sampleFlags = defaultFlags;
+            if( flags & TRUN_FLAGS )
+                sampleFlags = child.ReadUInt32();
+            else if( i == 0 && hasFirstFlags )
+                sampleFlags = firstFlags;
+
+            rs.renderingOffset = 0;
+            if( flags & TRUN_COMPOSITION_OFFSET ) {
+                uint32_t offset = child.ReadUInt32();
+                rs.renderingOffset = version ? MP4Duration( int64_t( int32_t( offset ))) : offset;
+            }
+
+            rs.startTime = pState->nextDecodeTime;
+            rs.isSync = !(sampleFlags & SAMPLE_IS_NON_SYNC);
+            pState->nextDecodeTime += rs.duration;
+
+            e.size += rs.size;
+            m_runSamples.push_back( rs );
+        }
+
+        pState->nextSampleId += numSamples;
+        runEnd = e.offset + e.size;
+        dataEnd = runEnd;
+        if( numSamples )
+            m_extents.push_back( e );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MP4StreamReader::TrackState&
+MP4StreamReader::GetTrackState( MP4TrackId trackId )
+{
+    for( uint32_t i = 0; i < m_tracks.size(); i++ ) {
+        if( m_tracks[i].pTrack->GetId() == trackId )
+            return m_tracks[i];
+    }
+
+    ostringstream msg;
+    msg << "fragment of unknown track " << trackId;
+    throw new Exception( msg.str(), __FILE__, __LINE__, __FUNCTION__ );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
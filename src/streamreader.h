@@ -0,0 +1,99 @@
+#ifndef MP4V2_IMPL_STREAMREADER_H
+#define MP4V2_IMPL_STREAMREADER_H
+
+namespace mp4v2 { namespace impl {
+
+///////////////////////////////////////////////////////////////////////////////
+///
+/// Forward-only demuxer for streams that cannot seek.
+///
+/// Top-level boxes are taken in stream order. ftyp and moov are parsed
+/// from memory by an MP4File, each moof is decoded into track runs, and
+/// the bytes of any other box are streamed through: the chunks and runs
+/// that lie inside it are read whole, one at a time, everything else is
+/// skipped. Data that precedes the box declaring it cannot be delivered.
+///
+///////////////////////////////////////////////////////////////////////////////
+
+class MP4StreamReader
+{
+public:
+    MP4StreamReader();
+    ~MP4StreamReader();
+
+    void Open( const char* name, const MP4FileProvider* provider );
+
+    // reads up to the end of moov, throws if the stream has none
+    MP4File& GetFile();
+
+    // next sample in stream order, false at the end of the stream
+    bool ReadSample( MP4StreamSample& sample );
+
+private:
+    // file extent of a chunk, or of a track run of a fragment
+    struct Extent {
+        uint64_t    offset;
+        uint64_t    size;
+        MP4Track*   pTrack;
+        MP4SampleId firstSampleId;
+        uint32_t    numSamples;
+        uint32_t    firstRunSample; // into m_runSamples, NoRunSamples for chunks
+    };
+
+    struct RunSample {
+        uint32_t     size;
+        MP4Timestamp startTime;
+        MP4Duration  duration;
+        MP4Duration  renderingOffset;
+        bool         isSync;
+    };
+
+    // fragment defaults from trex and where each track's timeline stands
+    struct TrackState {
+        MP4Track*    pTrack;
+        MP4SampleId  nextSampleId;
+        MP4Timestamp nextDecodeTime;
+        uint32_t     defaultDuration;
+        uint32_t     defaultSize;
+        uint32_t     defaultFlags;
+    };
+
+    static const uint32_t NoRunSamples = 0xffffffff;
+    static const uint64_t Unbounded = ~uint64_t(0);
+
+    static bool CompareExtents( const Extent& a, const Extent& b );
+
+    void CheckFailed();
+    bool NextSample( MP4StreamSample& sample );
+    bool ReadStream( uint8_t* pBytes, uint64_t numBytes );
+    void SkipStream( uint64_t numBytes );
+    bool NextBox();
+    void ReadMovie( const vector<uint8_t>& box );
+    void ReadFragment( const vector<uint8_t>& box, uint32_t headerSize, uint64_t start );
+    void ReadTrackFragment( const uint8_t* p, const uint8_t* end,
+                            uint64_t moofStart, uint64_t& dataEnd );
+    TrackState& GetTrackState( MP4TrackId trackId );
+
+private:
+    File*              m_pStream;
+    MP4File*           m_pFile;
+    uint64_t           m_position;      // bytes consumed from the stream
+    uint64_t           m_boxEnd;        // end of the box being streamed through
+    bool               m_failed;
+    vector<uint8_t>    m_ftyp;
+    vector<Extent>     m_extents;       // sorted by offset
+    uint32_t           m_nextExtent;
+    vector<RunSample>  m_runSamples;
+    vector<TrackState> m_tracks;
+    Extent             m_current;
+    bool               m_haveCurrent;
+    uint32_t           m_currentSample;
+    vector<uint8_t>    m_buffer;        // data of m_current
+    uint32_t           m_bufferPosition;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}} // namespace mp4v2::impl
+
+#endif // MP4V2_IMPL_STREAMREADER_H
@@ -22,7 +22,8 @@
 // N.B. mp4extract just extracts tracks/samples from an mp4 file
 // For many track types this is insufficient to reconsruct a valid
 // elementary stream (ES). Use "mp4creator -extract=<trackId>" if
-// you need the ES reconstructed.
+// you need the ES reconstructed. The exception is H.264, which --annexb
+// writes as a raw byte stream.
 
 #include "util/impl.h"
 
@@ -31,6 +32,7 @@ using namespace mp4v2::util;
 char* ProgName;
 char* Mp4PathName;
 char* Mp4FileName;
+bool  AnnexB = false;
 
 // forward declaration
 void ExtractTrack( MP4FileHandle mp4File, MP4TrackId trackId,
@@ -39,7 +41,7 @@ void ExtractTrack( MP4FileHandle mp4File, MP4TrackId trackId,
 extern "C" int main( int argc, char** argv )
 {
     const char* const usageString =
-        "[-l] [-t <track-id>] [-s <sample-id>] [-v [<level>]] <file-name>";
+        "[-l] [-a] [-t <track-id>] [-s <sample-id>] [-v [<level>]] <file-name>";
     bool doList = false;
     bool doSamples = false;
     MP4TrackId trackId = MP4_INVALID_TRACK_ID;
@@ -61,6 +63,7 @@ extern "C" int main( int argc, char** argv )
         int option_index = 0;
         static const prog::Option long_options[] = {
             { "list",    prog::Option::NO_ARG,       0, 'l' },
+            { "annexb",  prog::Option::NO_ARG,       0, 'a' },
             { "track",   prog::Option::REQUIRED_ARG, 0, 't' },
             { "sample",  prog::Option::OPTIONAL_ARG, 0, 's' },
             { "verbose", prog::Option::OPTIONAL_ARG, 0, 'v' },
@@ -68,12 +71,15 @@ extern "C" int main( int argc, char** argv )
             { NULL, prog::Option::NO_ARG, 0, 0 }
         };
 
-        c = prog::getOptionSingle( argc, argv, "lt:s::v::V", long_options, &option_index );
+        c = prog::getOptionSingle( argc, argv, "alt:s::v::V", long_options, &option_index );
 
         if ( c == -1 )
             break;
 
         switch ( c ) {
+            case 'a':
+                AnnexB = true;
+                break;
             case 'l':
                 doList = true;
                 break;
@@ -209,6 +215,10 @@ void ExtractTrack( MP4FileHandle mp4File, MP4TrackId trackId,
         }
     }
 
+    // H.264 tracks as raw elementary stream with start codes and parameter sets
+    const char* media = MP4GetTrackMediaDataName( mp4File, trackId );
+    bool annexB = AnnexB && media && !strcasecmp( media, "avc1" );
+
     MP4SampleId numSamples;
 
     if ( sampleMode && sampleId != MP4_INVALID_SAMPLE_ID ) {
@@ -224,7 +234,10 @@ void ExtractTrack( MP4FileHandle mp4File, MP4TrackId trackId,
         uint8_t* pSample = NULL;
         uint32_t sampleSize = 0;
 
-        if( !MP4ReadSample( mp4File, trackId, sampleId, &pSample, &sampleSize )) {
+        bool ok = annexB
+            ? MP4ReadH264AnnexBSample( mp4File, trackId, sampleId, &pSample, &sampleSize )
+            : MP4ReadSample( mp4File, trackId, sampleId, &pSample, &sampleSize );
+        if( !ok ) {
             fprintf( stderr, "%s: read sample %u for %s failed\n", ProgName, sampleId, outName );
             break;
         }
@@ -718,7 +718,7 @@ TrackUtility::actionTrackModifierRemove( JobContext& job )
     if( dryrunAbort() )
         return SUCCESS;
 
-    job.fileHandle = MP4Modify( job.file.c_str() );
+    job.fileHandle = MP4Modify( job.file.c_str(), MP4_MODIFY_PATCH );
     if( job.fileHandle == MP4_INVALID_FILE_HANDLE )
         return herrf( "unable to open for write: %s\n", job.file.c_str() );
 
@@ -757,7 +757,7 @@ TrackUtility::actionTrackModifierSet( JobContext& job )
     if( dryrunAbort() )
         return SUCCESS;
 
-    job.fileHandle = MP4Modify( job.file.c_str() );
+    job.fileHandle = MP4Modify( job.file.c_str(), MP4_MODIFY_PATCH );
     if( job.fileHandle == MP4_INVALID_FILE_HANDLE )
         return herrf( "unable to open for write: %s\n", job.file.c_str() );
 